@@ -0,0 +1,89 @@
+#include "crzbench.h"
+#include "crzarr.h"
+
+#define COUNT 10000
+#define SPLICE_COUNT 1000
+
+DEFINE_ARRAY(IntArray, int)
+
+static IntArray a = ARRAY_NEW();
+
+void fill(void)
+{
+	for (int i = 0; i < SPLICE_COUNT; i++)
+		ARRAY_PUSH(&a, i);
+}
+
+void cleanup(void)
+{
+	ARRAY_FREE(&a);
+}
+
+BENCH_MAIN({
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("ARRAY_PUSH", {
+		BENCH("Pushing into an empty array", COUNT, {
+			for (int i = 0; i < COUNT; i++)
+				ARRAY_PUSH(&a, i);
+			BENCH_DO_NOT_OPTIMIZE(a.ptr);
+		});
+
+		BENCH("Pushing into a pre-grown array", COUNT, {
+			ARRAY_GROW_BY(&a, COUNT);
+			for (int i = 0; i < COUNT; i++)
+				ARRAY_PUSH(&a, i);
+			BENCH_DO_NOT_OPTIMIZE(a.ptr);
+		});
+
+		BENCH("Pushing with DEFINE_ARRAY", COUNT, {
+			for (int i = 0; i < COUNT; i++)
+				IntArray_push(&a, i);
+			BENCH_DO_NOT_OPTIMIZE(a.ptr);
+		});
+	});
+
+	BENCH_GROUP("ARRAY_SPLICE", {
+		BENCH_BEFORE_EACH(fill);
+
+		BENCH("Removing from the front", SPLICE_COUNT, {
+			for (int i = 0; i < SPLICE_COUNT; i++)
+				ARRAY_REMOVE(&a, 0, 1);
+			BENCH_DO_NOT_OPTIMIZE(a.len);
+		});
+
+		BENCH("Inserting at the front", SPLICE_COUNT, {
+			for (int i = 0; i < SPLICE_COUNT; i++)
+				ARRAY_INSERT(&a, 0, &i, 1);
+			BENCH_DO_NOT_OPTIMIZE(a.ptr);
+		});
+
+		BENCH("Removing near the back", SPLICE_COUNT / 2, {
+			for (int i = 0; i < SPLICE_COUNT / 2; i++)
+				ARRAY_REMOVE(&a, a.len - 2, 1);
+			BENCH_DO_NOT_OPTIMIZE(a.len);
+		});
+	});
+
+	BENCH_GROUP("DEFINE_ARRAY splicing", {
+		BENCH_BEFORE_EACH(fill);
+
+		BENCH("Removing from the front", SPLICE_COUNT, {
+			for (int i = 0; i < SPLICE_COUNT; i++)
+				IntArray_remove(&a, 0, 1);
+			BENCH_DO_NOT_OPTIMIZE(a.len);
+		});
+
+		BENCH("Inserting at the front", SPLICE_COUNT, {
+			for (int i = 0; i < SPLICE_COUNT; i++)
+				IntArray_insert(&a, 0, &i, 1);
+			BENCH_DO_NOT_OPTIMIZE(a.ptr);
+		});
+
+		BENCH("Removing near the back", SPLICE_COUNT / 2, {
+			for (int i = 0; i < SPLICE_COUNT / 2; i++)
+				IntArray_remove(&a, a.len - 2, 1);
+			BENCH_DO_NOT_OPTIMIZE(a.len);
+		});
+	});
+})
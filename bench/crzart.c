@@ -0,0 +1,104 @@
+#include "crzart.h"
+#include "crzbench.h"
+#include "crzhash.h"
+
+#define ROUTES 2000
+#define PATHS 10000
+#define KEY_SIZE 48
+
+typedef HASH_TABLE(int) IntTable;
+
+static IntTable ht = HASH_TABLE_NEW();
+static Art tree;
+static char routes[ROUTES][KEY_SIZE];
+static char paths[PATHS][KEY_SIZE];
+
+// Looks up each shorter prefix of `path` ending before a '/', as routing with
+// a hash table does
+static void *route_by_table(const char *path)
+{
+	char prefix[KEY_SIZE];
+	CRZ_SIZE len = CRZ_STRLEN(path);
+	CRZ_MEMCPY(prefix, path, len + 1);
+	for (;;) {
+		void *pair = HASH_TABLE_GET(ht, prefix);
+		if (pair)
+			return pair;
+		while (len > 0 && prefix[len - 1] != '/')
+			len--;
+		if (len == 0)
+			return CRZ_NULL;
+		prefix[--len] = '\0';
+	}
+}
+
+void fill(void)
+{
+	tree = ART_NEW(int);
+	HASH_TABLE_INIT(&ht, ROUTES * 2);
+	for (int i = 0; i < ROUTES; i++) {
+		HASH_TABLE_INSERT(&ht, routes[i], i);
+		ART_INSERT(&tree, SV_FROM_CSTR(routes[i]), &i);
+	}
+}
+
+void cleanup(void)
+{
+	HASH_TABLE_FREE(&ht);
+	ART_FREE(&tree);
+}
+
+BENCH_MAIN({
+	for (int i = 0; i < ROUTES; i++) {
+		// Nested routes, with many sharing a service and a version
+		CRZ_SPRINTF(routes[i], "/svc%d/v%d/resource%d", i % 20,
+			    i / 20 % 3, i / 60);
+	}
+	for (int i = 0; i < PATHS; i++) {
+		int route = (int)((i * 2654435761u) % ROUTES);
+		CRZ_SPRINTF(paths[i], "%s/item/%d/details", routes[route], i);
+	}
+
+	BENCH_BEFORE_EACH(fill);
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Getting existing routes", {
+		BENCH("HASH_TABLE_GET", ROUTES, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < ROUTES; i++) {
+				void *pair = HASH_TABLE_GET(ht, routes[i]);
+				found += pair != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+
+		BENCH("ART_GET", ROUTES, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < ROUTES; i++) {
+				StringView route = SV_FROM_CSTR(routes[i]);
+				found += ART_GET(tree, route) != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+	});
+
+	BENCH_GROUP("Routing paths to their longest route", {
+		BENCH("HASH_TABLE_GET of each shorter prefix", PATHS, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < PATHS; i++)
+				found += route_by_table(paths[i]) != CRZ_NULL;
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+
+		BENCH("ART_LONGEST_PREFIX", PATHS, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < PATHS; i++) {
+				StringView path = SV_FROM_CSTR(paths[i]);
+				StringView route = SV_FROM_CSTR("");
+				ART_LONGEST_PREFIX(tree, path, &route);
+				found += route.len;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+	});
+})
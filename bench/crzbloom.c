@@ -0,0 +1,97 @@
+#include "crzbench.h"
+#include "crzbloom.h"
+
+#define COUNT 10000
+#define KEY_SIZE 24
+
+static HASH_TABLE(int) ht = HASH_TABLE_NEW();
+static FILTERED_HASH_TABLE(int) fht = FILTERED_HASH_TABLE_NEW();
+static CuckooFilter cuckoo = CUCKOO_FILTER_NEW();
+static char hits[COUNT][KEY_SIZE];
+static char misses[COUNT][KEY_SIZE];
+
+void fill(void)
+{
+	HASH_TABLE_INIT(&ht, COUNT * 2);
+	FILTERED_HASH_TABLE_INIT(&fht, COUNT * 2, COUNT, 0.01);
+	CUCKOO_FILTER_INIT(&cuckoo, COUNT);
+	for (int i = 0; i < COUNT; i++) {
+		HASH_TABLE_INSERT(&ht, hits[i], i);
+		FILTERED_HASH_TABLE_INSERT(&fht, hits[i], i);
+		CUCKOO_FILTER_ADD(&cuckoo, hits[i]);
+	}
+}
+
+void cleanup(void)
+{
+	HASH_TABLE_FREE(&ht);
+	FILTERED_HASH_TABLE_FREE(&fht);
+	CUCKOO_FILTER_FREE(&cuckoo);
+}
+
+BENCH_MAIN({
+	for (size_t i = 0; i < COUNT; i++) {
+		// Spread out keys, since `crzhash_djb2` clusters similar ones
+		CRZ_SPRINTF(hits[i], "%016llx",
+			    (unsigned long long)i * 0x9e3779b97f4a7c15ull);
+		CRZ_SPRINTF(misses[i], "%016llx",
+			    (unsigned long long)(i + COUNT) *
+				    0x9e3779b97f4a7c15ull);
+	}
+
+	BENCH_BEFORE_EACH(fill);
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Getting missing keys", {
+		BENCH("HASH_TABLE_GET", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				void *pair = HASH_TABLE_GET(ht, misses[i]);
+				found += pair != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+
+		BENCH("FILTERED_HASH_TABLE_GET", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				char *key = misses[i];
+				void *pair = FILTERED_HASH_TABLE_GET(fht, key);
+				found += pair != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+
+		BENCH("CUCKOO_FILTER_HAS, then HASH_TABLE_GET", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				char *key = misses[i];
+				if (CUCKOO_FILTER_HAS(cuckoo, key))
+					found += HASH_TABLE_GET(ht, key) !=
+						 CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+	});
+
+	BENCH_GROUP("Getting existing keys", {
+		BENCH("HASH_TABLE_GET", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				void *pair = HASH_TABLE_GET(ht, hits[i]);
+				found += pair != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+
+		BENCH("FILTERED_HASH_TABLE_GET", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				char *key = hits[i];
+				void *pair = FILTERED_HASH_TABLE_GET(fht, key);
+				found += pair != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+	});
+})
@@ -0,0 +1,148 @@
+#include "crzarr.h"
+#include "crzbench.h"
+#include "crzbtree.h"
+
+#define COUNT 20000
+#define RANGE 100
+
+DEFINE_BTREE(IntTree, int, int, CRZBTREE_CMP_NUMBER)
+
+static int keys[COUNT];
+static IntTree tree = BTREE_NEW();
+static ARRAY(int) sorted = ARRAY_NEW();
+static ARRAY(IntTree_Entry) entries = ARRAY_NEW();
+
+static CRZ_SIZE lower_index(int key)
+{
+	CRZ_SIZE low = 0;
+	CRZ_SIZE high = sorted.len;
+	while (low < high) {
+		CRZ_SIZE mid = low + (high - low) / 2;
+		if (sorted.ptr[mid] < key)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+static void insert_sorted(int key)
+{
+	CRZ_SIZE index = lower_index(key);
+	if (index < sorted.len && sorted.ptr[index] == key)
+		return;
+	ARRAY_SPLICE(&sorted, index, 0, &key, 1);
+}
+
+void fill(void)
+{
+	for (int i = 0; i < COUNT; i++) {
+		IntTree_insert(&tree, keys[i], i);
+		insert_sorted(keys[i]);
+	}
+}
+
+void fill_entries(void)
+{
+	for (int i = 0; i < COUNT; i++) {
+		IntTree_Entry entry = { .key = i, .value = i };
+		ARRAY_PUSH(&entries, entry);
+	}
+}
+
+void cleanup(void)
+{
+	IntTree_free(&tree);
+	ARRAY_FREE(&sorted);
+	ARRAY_FREE(&entries);
+}
+
+BENCH_MAIN({
+	srand(0);
+	for (int i = 0; i < COUNT; i++)
+		keys[i] = rand();
+
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Inserting random keys", {
+		BENCH("Sorted ARRAY", COUNT, {
+			for (int i = 0; i < COUNT; i++)
+				insert_sorted(keys[i]);
+			BENCH_DO_NOT_OPTIMIZE(sorted.len);
+		});
+
+		BENCH("DEFINE_BTREE", COUNT, {
+			for (int i = 0; i < COUNT; i++)
+				IntTree_insert(&tree, keys[i], i);
+			BENCH_DO_NOT_OPTIMIZE(tree.len);
+		});
+	});
+
+	BENCH_BEFORE_EACH(fill);
+
+	BENCH_GROUP("Looking up random keys", {
+		BENCH("Sorted ARRAY", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				CRZ_SIZE index = lower_index(keys[i]);
+				found += index < sorted.len &&
+					 sorted.ptr[index] == keys[i];
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+
+		BENCH("DEFINE_BTREE", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				int *value = IntTree_get(&tree, keys[i]);
+				found += value != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+	});
+
+	BENCH_GROUP("Scanning ranges of keys", {
+		BENCH("Sorted ARRAY", COUNT, {
+			long sum = 0;
+			for (int i = 0; i < COUNT; i++) {
+				CRZ_SIZE index = lower_index(keys[i]);
+				CRZ_SIZE end = index + RANGE;
+				if (end > sorted.len)
+					end = sorted.len;
+				for (; index < end; index++)
+					sum += sorted.ptr[index];
+			}
+			BENCH_DO_NOT_OPTIMIZE(sum);
+		});
+
+		BENCH("DEFINE_BTREE", COUNT, {
+			long sum = 0;
+			for (int i = 0; i < COUNT; i++) {
+				int count = 0;
+				BTREE_FOR_FROM(IntTree, tree, keys[i], iter)
+				{
+					if (count++ == RANGE)
+						break;
+					sum += BTREE_ITER_KEY(iter);
+				}
+			}
+			BENCH_DO_NOT_OPTIMIZE(sum);
+		});
+	});
+
+	BENCH_BEFORE_EACH(fill_entries);
+
+	BENCH_GROUP("Building from sorted keys", {
+		BENCH("Inserting one by one", COUNT, {
+			for (CRZ_SIZE i = 0; i < entries.len; i++)
+				IntTree_insert(&tree, entries.ptr[i].key,
+					       entries.ptr[i].value);
+			BENCH_DO_NOT_OPTIMIZE(tree.len);
+		});
+
+		BENCH("Bulk loading", COUNT, {
+			IntTree_bulk_load(&tree, entries.ptr, entries.len);
+			BENCH_DO_NOT_OPTIMIZE(tree.len);
+		});
+	});
+})
@@ -0,0 +1,92 @@
+#include "crzbench.h"
+#include "crzcache.h"
+#include <stdlib.h>
+
+#define COUNT 10000
+#define STREAM 100000
+#define BUDGET 1000
+#define KEY_SIZE 24
+
+static HASH_TABLE(int) ht = HASH_TABLE_NEW();
+static CACHE(int) cache = CACHE_NEW();
+static char keys[COUNT][KEY_SIZE];
+static int stream[STREAM];
+
+void fill(void)
+{
+	HASH_TABLE_INIT(&ht, COUNT * 2);
+	CACHE_INIT(&cache, COUNT, 0, CRZ_NULL);
+	for (int i = 0; i < COUNT; i++) {
+		HASH_TABLE_INSERT(&ht, keys[i], i);
+		CACHE_PUT(&cache, keys[i], i, 1);
+	}
+}
+
+void init_empty(void)
+{
+	HASH_TABLE_INIT(&ht, BUDGET * 2);
+	CACHE_INIT(&cache, BUDGET, 0, CRZ_NULL);
+}
+
+void cleanup(void)
+{
+	HASH_TABLE_FREE(&ht);
+	CACHE_FREE(&cache);
+}
+
+BENCH_MAIN({
+	srand(0);
+	for (size_t i = 0; i < COUNT; i++) {
+		// Spread out keys, since `crzhash_djb2` clusters similar ones
+		CRZ_SPRINTF(keys[i], "%016llx",
+			    (unsigned long long)i * 0x9e3779b97f4a7c15ull);
+	}
+	// Skew the stream towards the first keys, as real lookups tend to be
+	for (int i = 0; i < STREAM; i++)
+		stream[i] = (rand() % COUNT) * (rand() % COUNT) / COUNT;
+
+	BENCH_AFTER_EACH(cleanup);
+	BENCH_BEFORE_EACH(fill);
+
+	BENCH_GROUP("Getting existing keys", {
+		BENCH("HASH_TABLE_GET", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				void *pair = HASH_TABLE_GET(ht, keys[i]);
+				found += pair != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+
+		BENCH("CACHE_GET", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				int *value = CACHE_GET(&cache, keys[i]);
+				found += value != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+	});
+
+	BENCH_BEFORE_EACH(init_empty);
+
+	BENCH_GROUP("Caching a skewed stream of keys", {
+		BENCH("Unbounded HASH_TABLE", STREAM, {
+			for (int i = 0; i < STREAM; i++) {
+				char *key = keys[stream[i]];
+				if (HASH_TABLE_GET(ht, key) == CRZ_NULL)
+					HASH_TABLE_INSERT(&ht, key, i);
+			}
+			BENCH_DO_NOT_OPTIMIZE(ht.size);
+		});
+
+		BENCH("CACHE of 1000 entries", STREAM, {
+			for (int i = 0; i < STREAM; i++) {
+				char *key = keys[stream[i]];
+				if (CACHE_GET(&cache, key) == CRZ_NULL)
+					CACHE_PUT(&cache, key, i, 1);
+			}
+			BENCH_DO_NOT_OPTIMIZE(cache.len);
+		});
+	});
+})
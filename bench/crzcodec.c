@@ -0,0 +1,83 @@
+#include "crzbench.h"
+#include "crzcodec.h"
+
+#define BLOB_SIZE 4096
+
+static StringBuilder sb = SB_NEW();
+static unsigned char blob[BLOB_SIZE];
+static char text[BLOB_SIZE];
+
+void init_empty(void)
+{
+	sb = (StringBuilder)SB_NEW();
+}
+
+void cleanup(void)
+{
+	SB_FREE(&sb);
+}
+
+BENCH_MAIN({
+	for (CRZ_SIZE i = 0; i < BLOB_SIZE; i++) {
+		blob[i] = (unsigned char)(i * 167 + i / 256);
+		// Mostly plain text, with a quote or newline every so often
+		text[i] = i % 61 == 0 ? '"' : i % 97 == 0 ? '\n' : 'a' + i % 26;
+	}
+
+	BENCH_BEFORE_EACH(init_empty);
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Hex encoding 4 KiB", {
+		BENCH("SB_PUSH_CHAR", BLOB_SIZE, {
+			for (CRZ_SIZE i = 0; i < BLOB_SIZE; i++) {
+				const char *digits = crzcodec_hex_digits;
+				SB_PUSH_CHAR(&sb, digits[blob[i] >> 4]);
+				SB_PUSH_CHAR(&sb, digits[blob[i] & 15]);
+			}
+			BENCH_DO_NOT_OPTIMIZE(sb.len);
+		});
+
+		BENCH("SB_PUSH_HEX", BLOB_SIZE, {
+			SB_PUSH_HEX(&sb, blob, BLOB_SIZE);
+			BENCH_DO_NOT_OPTIMIZE(sb.len);
+		});
+	});
+
+	BENCH_GROUP("Base64 encoding 4 KiB", {
+		BENCH("SB_PUSH_CHAR", BLOB_SIZE, {
+			for (CRZ_SIZE i = 0; i + 3 <= BLOB_SIZE; i += 3) {
+				uint32_t triple = (uint32_t)blob[i] << 16 |
+						  (uint32_t)blob[i + 1] << 8 |
+						  blob[i + 2];
+				for (int shift = 18; shift >= 0; shift -= 6) {
+					char c = crzcodec_base64_chars
+						[(triple >> shift) & 63];
+					SB_PUSH_CHAR(&sb, c);
+				}
+			}
+			BENCH_DO_NOT_OPTIMIZE(sb.len);
+		});
+
+		BENCH("SB_PUSH_BASE64", BLOB_SIZE, {
+			SB_PUSH_BASE64(&sb, blob, BLOB_SIZE);
+			BENCH_DO_NOT_OPTIMIZE(sb.len);
+		});
+	});
+
+	BENCH_GROUP("JSON escaping 4 KiB of text", {
+		BENCH("SB_PUSH_CHAR", BLOB_SIZE, {
+			for (CRZ_SIZE i = 0; i < BLOB_SIZE; i++) {
+				char c = text[i];
+				if (c == '"' || c == '\n')
+					SB_PUSH_CHAR(&sb, '\\');
+				SB_PUSH_CHAR(&sb, c == '\n' ? 'n' : c);
+			}
+			BENCH_DO_NOT_OPTIMIZE(sb.len);
+		});
+
+		BENCH("SB_PUSH_JSON_ESCAPED", BLOB_SIZE, {
+			SB_PUSH_JSON_ESCAPED(&sb, text, BLOB_SIZE);
+			BENCH_DO_NOT_OPTIMIZE(sb.len);
+		});
+	});
+})
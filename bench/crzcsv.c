@@ -0,0 +1,54 @@
+#include "crzarr.h"
+#include "crzbench.h"
+#include "crzcsv.h"
+#include "crzsb.h"
+
+#define ROWS 20000
+
+static StringBuilder input = ARRAY_NEW();
+
+void fill(void)
+{
+	for (int i = 0; i < ROWS; i++) {
+		char row[128];
+		CRZ_SIZE len = CRZ_SPRINTF(row, "%d,name-%d,\"a, %d\",%d\n", i,
+					   i * 7, i % 13, i * 3);
+		SB_PUSH_BUF(&input, row, len);
+	}
+}
+
+void cleanup(void)
+{
+	SB_FREE(&input);
+}
+
+BENCH_MAIN({
+	BENCH_BEFORE_EACH(fill);
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Splitting CSV into fields", {
+		BENCH("Byte by byte", ROWS, {
+			CRZ_SIZE fields = 0;
+			CRZ_BOOL quoted = CRZ_FALSE;
+			for (CRZ_SIZE i = 0; i < input.len; i++) {
+				char c = input.ptr[i];
+				if (c == '"')
+					quoted = !quoted;
+				else if (!quoted && (c == ',' || c == '\n'))
+					fields++;
+			}
+			BENCH_DO_NOT_OPTIMIZE(fields);
+		});
+
+		BENCH("CSV_NEXT_FIELD", ROWS, {
+			CsvReader reader = CSV_READER_NEW(
+				SV_FROM_BUF(input.ptr, input.len), ',');
+			StringView field;
+			CRZ_BOOL end_of_record;
+			CRZ_SIZE fields = 0;
+			while (CSV_NEXT_FIELD(&reader, &field, &end_of_record))
+				fields++;
+			BENCH_DO_NOT_OPTIMIZE(fields);
+		});
+	});
+})
@@ -0,0 +1,44 @@
+#include "crzarr.h"
+#include "crzbench.h"
+#include "crzdeque.h"
+
+#define COUNT 10000
+
+static ARRAY(int) a = ARRAY_NEW();
+static DEQUE(int) d = DEQUE_NEW();
+
+void fill(void)
+{
+	for (int i = 0; i < COUNT; i++) {
+		ARRAY_PUSH(&a, i);
+		DEQUE_PUSH_BACK(&d, i);
+	}
+}
+
+void cleanup(void)
+{
+	ARRAY_FREE(&a);
+	DEQUE_FREE(&d);
+}
+
+BENCH_MAIN({
+	BENCH_BEFORE_EACH(fill);
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Dequeuing from the front", {
+		BENCH("ARRAY_REMOVE", COUNT, {
+			while (a.len > 0) {
+				int element = a.ptr[0];
+				ARRAY_REMOVE(&a, 0, 1);
+				BENCH_DO_NOT_OPTIMIZE(element);
+			}
+		});
+
+		BENCH("DEQUE_POP_FRONT", COUNT, {
+			while (d.len > 0) {
+				int element = DEQUE_POP_FRONT(&d);
+				BENCH_DO_NOT_OPTIMIZE(element);
+			}
+		});
+	});
+})
@@ -0,0 +1,95 @@
+#include "crzbench.h"
+#include "crzhamt.h"
+
+#define COUNT 10000
+#define UPDATES 100
+#define KEY_SIZE 24
+
+typedef HASH_TABLE(int) IntTable;
+
+static IntTable ht = HASH_TABLE_NEW();
+static Hamt map;
+static char keys[COUNT][KEY_SIZE];
+
+// Copies every pair of `ht` into a new table, as replacing a shared table
+// without a persistent map does
+static void copy_table(IntTable *copyp)
+{
+	HASH_TABLE_INIT(copyp, ht.size);
+	HASH_TABLE_FOR(ht, i)
+	{
+		if (ht.ptr[i])
+			HASH_TABLE_INSERT(copyp, ht.ptr[i]->key,
+					  ht.ptr[i]->value);
+	}
+}
+
+void fill(void)
+{
+	map = HAMT_NEW(int);
+	HASH_TABLE_INIT(&ht, COUNT * 2);
+	for (int i = 0; i < COUNT; i++) {
+		HASH_TABLE_INSERT(&ht, keys[i], i);
+		Hamt next = HAMT_SET(map, keys[i], &i);
+		HAMT_FREE(&map);
+		map = next;
+	}
+}
+
+void cleanup(void)
+{
+	HASH_TABLE_FREE(&ht);
+	HAMT_FREE(&map);
+}
+
+BENCH_MAIN({
+	for (size_t i = 0; i < COUNT; i++) {
+		// Spread out keys, since `crzhash_djb2` clusters similar ones
+		CRZ_SPRINTF(keys[i], "%016llx",
+			    (unsigned long long)i * 0x9e3779b97f4a7c15ull);
+	}
+
+	BENCH_BEFORE_EACH(fill);
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Getting existing keys", {
+		BENCH("HASH_TABLE_GET", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				void *pair = HASH_TABLE_GET(ht, keys[i]);
+				found += pair != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+
+		BENCH("HAMT_GET", COUNT, {
+			CRZ_SIZE found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				const int *value = HAMT_GET(map, keys[i]);
+				found += value != CRZ_NULL;
+			}
+			BENCH_DO_NOT_OPTIMIZE(found);
+		});
+	});
+
+	BENCH_GROUP("Making new versions with one key updated", {
+		BENCH("Copying a HASH_TABLE", UPDATES, {
+			for (int i = 0; i < UPDATES; i++) {
+				IntTable copy = HASH_TABLE_NEW();
+				copy_table(&copy);
+				HASH_TABLE_INSERT(&copy, keys[i], -i);
+				BENCH_DO_NOT_OPTIMIZE(copy.ptr);
+				HASH_TABLE_FREE(&copy);
+			}
+		});
+
+		BENCH("HAMT_SET", UPDATES, {
+			for (int i = 0; i < UPDATES; i++) {
+				int value = -i;
+				Hamt next = HAMT_SET(map, keys[i], &value);
+				BENCH_DO_NOT_OPTIMIZE(next.root);
+				HAMT_FREE(&next);
+			}
+		});
+	});
+})
@@ -0,0 +1,137 @@
+#include "crzbench.h"
+#include "crzhash.h"
+
+#define COUNT 1000
+#define KEY_SIZE 16
+
+// Large enough that the table does not fit in the last-level cache
+#define LARGE_COUNT (1 << 21)
+#define LOOKUP_COUNT (1 << 16)
+#define LARGE_KEY_SIZE 24
+
+static char keys[COUNT][KEY_SIZE];
+static char missing_keys[COUNT][KEY_SIZE];
+static char large_keys[LARGE_COUNT][LARGE_KEY_SIZE];
+static CRZ_STRING lookup_keys[LOOKUP_COUNT];
+static void *results[LOOKUP_COUNT];
+
+static HASH_TABLE(size_t) ht = HASH_TABLE_NEW();
+static HASH_TABLE(size_t) large = HASH_TABLE_NEW();
+
+void init_small(void)
+{
+	HASH_TABLE_INIT(&ht, 16);
+}
+
+void init_large(void)
+{
+	HASH_TABLE_INIT(&ht, COUNT * 2);
+}
+
+void fill(void)
+{
+	init_large();
+	for (size_t i = 0; i < COUNT; i++)
+		HASH_TABLE_INSERT(&ht, keys[i], i);
+}
+
+void cleanup(void)
+{
+	HASH_TABLE_FREE(&ht);
+}
+
+BENCH_MAIN({
+	for (int i = 0; i < COUNT; i++) {
+		CRZ_SPRINTF(keys[i], "key-%d", i);
+		CRZ_SPRINTF(missing_keys[i], "missing-%d", i);
+	}
+
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("HASH_TABLE_INSERT", {
+		BENCH_BEFORE_EACH(init_small);
+		BENCH("Inserting into a small table", COUNT, {
+			for (size_t i = 0; i < COUNT; i++)
+				HASH_TABLE_INSERT(&ht, keys[i], i);
+			BENCH_DO_NOT_OPTIMIZE(ht.ptr);
+		});
+
+		BENCH_BEFORE_EACH(init_large);
+		BENCH("Inserting into a pre-sized table", COUNT, {
+			for (size_t i = 0; i < COUNT; i++)
+				HASH_TABLE_INSERT(&ht, keys[i], i);
+			BENCH_DO_NOT_OPTIMIZE(ht.ptr);
+		});
+	});
+
+	BENCH_GROUP("HASH_TABLE_GET", {
+		BENCH_BEFORE_EACH(fill);
+		BENCH("Getting existing keys", COUNT, {
+			for (size_t i = 0; i < COUNT; i++) {
+				void *result = HASH_TABLE_GET(ht, keys[i]);
+				BENCH_DO_NOT_OPTIMIZE(result);
+			}
+		});
+
+		BENCH("Getting missing keys", COUNT, {
+			for (size_t i = 0; i < COUNT; i++) {
+				void *result =
+					HASH_TABLE_GET(ht, missing_keys[i]);
+				BENCH_DO_NOT_OPTIMIZE(result);
+			}
+		});
+	});
+
+	BENCH_GROUP("Counting keys", {
+		BENCH_BEFORE_EACH(init_large);
+		BENCH("HASH_TABLE_GET then HASH_TABLE_INSERT", COUNT * 4, {
+			for (size_t i = 0; i < COUNT * 4; i++) {
+				HASH_PAIR(size_t) *pair =
+					HASH_TABLE_GET(ht, keys[i % COUNT]);
+				size_t count = pair ? pair->value + 1 : 1;
+				HASH_TABLE_INSERT(&ht, keys[i % COUNT], count);
+			}
+			BENCH_DO_NOT_OPTIMIZE(ht.ptr);
+		});
+
+		BENCH("HASH_TABLE_ENTRY", COUNT * 4, {
+			for (size_t i = 0; i < COUNT * 4; i++) {
+				HASH_PAIR(size_t) *pair = HASH_TABLE_ENTRY(
+					&ht, keys[i % COUNT], CRZ_NULL);
+				pair->value += 1;
+			}
+			BENCH_DO_NOT_OPTIMIZE(ht.ptr);
+		});
+	});
+
+	BENCH_BEFORE_EACH(CRZ_NULL);
+	BENCH_AFTER_EACH(CRZ_NULL);
+	HASH_TABLE_RESERVE(&large, LARGE_COUNT);
+	for (size_t i = 0; i < LARGE_COUNT; i++) {
+		// Spread out keys, since `crzhash_djb2` clusters similar ones
+		CRZ_SPRINTF(large_keys[i], "%016llx",
+			    (unsigned long long)i * 0x9e3779b97f4a7c15ull);
+		HASH_TABLE_INSERT(&large, large_keys[i], i);
+	}
+	srand(0);
+	for (size_t i = 0; i < LOOKUP_COUNT; i++)
+		lookup_keys[i] = large_keys[(size_t)rand() % LARGE_COUNT];
+
+	BENCH_GROUP("HASH_TABLE_GET_BATCH", {
+		BENCH("Getting random keys one at a time", LOOKUP_COUNT, {
+			for (size_t i = 0; i < LOOKUP_COUNT; i++) {
+				results[i] =
+					HASH_TABLE_GET(large, lookup_keys[i]);
+			}
+			BENCH_DO_NOT_OPTIMIZE(results[LOOKUP_COUNT - 1]);
+		});
+
+		BENCH("Getting random keys in a batch", LOOKUP_COUNT, {
+			HASH_TABLE_GET_BATCH(large, lookup_keys, LOOKUP_COUNT,
+					     results);
+			BENCH_DO_NOT_OPTIMIZE(results[LOOKUP_COUNT - 1]);
+		});
+	});
+
+	HASH_TABLE_FREE(&large);
+})
@@ -0,0 +1,63 @@
+#include "crzbench.h"
+#include "crzheap.h"
+
+#define COUNT 100000
+#define K 100
+
+#define INT_LESS(a, b) ((a) < (b))
+
+static int elements[COUNT];
+static ARRAY(int) h = ARRAY_NEW();
+
+void cleanup(void)
+{
+	ARRAY_FREE(&h);
+}
+
+BENCH_MAIN({
+	srand(0);
+	for (int i = 0; i < COUNT; i++)
+		elements[i] = rand();
+
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Pushing and popping every element", {
+		BENCH("HEAP_PUSH and HEAP_POP", COUNT, {
+			for (int i = 0; i < COUNT; i++)
+				HEAP_PUSH(&h, elements[i], INT_LESS);
+			while (h.len > 0) {
+				int popped;
+				HEAP_POP(&h, &popped, INT_LESS);
+				BENCH_DO_NOT_OPTIMIZE(popped);
+			}
+		});
+
+		BENCH("DARY_HEAP_PUSH and DARY_HEAP_POP", COUNT, {
+			for (int i = 0; i < COUNT; i++)
+				DARY_HEAP_PUSH(&h, elements[i], INT_LESS);
+			while (h.len > 0) {
+				int popped;
+				DARY_HEAP_POP(&h, &popped, INT_LESS);
+				BENCH_DO_NOT_OPTIMIZE(popped);
+			}
+		});
+	});
+
+	BENCH_GROUP("Selecting the top K elements", {
+		BENCH("HEAP_PUSH_BOUNDED", COUNT, {
+			for (int i = 0; i < COUNT; i++) {
+				HEAP_PUSH_BOUNDED(&h, elements[i], K,
+						  INT_LESS);
+			}
+			BENCH_DO_NOT_OPTIMIZE(h.ptr[0]);
+		});
+
+		BENCH("DARY_HEAP_PUSH_BOUNDED", COUNT, {
+			for (int i = 0; i < COUNT; i++) {
+				DARY_HEAP_PUSH_BOUNDED(&h, elements[i], K,
+						       INT_LESS);
+			}
+			BENCH_DO_NOT_OPTIMIZE(h.ptr[0]);
+		});
+	});
+})
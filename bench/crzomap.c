@@ -0,0 +1,69 @@
+#include "crzbench.h"
+#include "crzomap.h"
+
+#define COUNT 1000
+#define KEY_SIZE 16
+
+static char keys[COUNT][KEY_SIZE];
+
+static HASH_TABLE(size_t) ht = HASH_TABLE_NEW();
+static ORDERED_TABLE(size_t) ot = ORDERED_TABLE_NEW();
+
+void fill(void)
+{
+	// A sparse table, as left behind by a table which was once larger
+	HASH_TABLE_INIT(&ht, COUNT * 8);
+	for (size_t i = 0; i < COUNT; i++) {
+		HASH_TABLE_INSERT(&ht, keys[i], i);
+		ORDERED_TABLE_INSERT(&ot, keys[i], i);
+	}
+}
+
+void cleanup(void)
+{
+	HASH_TABLE_FREE(&ht);
+	ORDERED_TABLE_FREE(&ot);
+}
+
+BENCH_MAIN({
+	for (int i = 0; i < COUNT; i++)
+		CRZ_SPRINTF(keys[i], "key-%d", i);
+
+	BENCH_BEFORE_EACH(fill);
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Iterating", {
+		BENCH("HASH_TABLE_FOR over a sparse table", COUNT, {
+			size_t sum = 0;
+			HASH_TABLE_FOR(ht, i) {
+				if (ht.ptr[i])
+					sum += ht.ptr[i]->value;
+			}
+			BENCH_DO_NOT_OPTIMIZE(sum);
+		});
+
+		BENCH("ORDERED_TABLE_FOR", COUNT, {
+			size_t sum = 0;
+			ORDERED_TABLE_FOR(ot, i) {
+				sum += ot.pairs.ptr[i].value;
+			}
+			BENCH_DO_NOT_OPTIMIZE(sum);
+		});
+	});
+
+	BENCH_GROUP("Getting", {
+		BENCH("HASH_TABLE_GET", COUNT, {
+			for (size_t i = 0; i < COUNT; i++) {
+				void *result = HASH_TABLE_GET(ht, keys[i]);
+				BENCH_DO_NOT_OPTIMIZE(result);
+			}
+		});
+
+		BENCH("ORDERED_TABLE_GET", COUNT, {
+			for (size_t i = 0; i < COUNT; i++) {
+				void *result = ORDERED_TABLE_GET(ot, keys[i]);
+				BENCH_DO_NOT_OPTIMIZE(result);
+			}
+		});
+	});
+})
@@ -0,0 +1,100 @@
+#include "crzbench.h"
+#include "crzpack.h"
+#include <stdio.h>
+
+#define COUNT 1000000
+
+typedef ARRAY(uint64_t) U64Array;
+typedef ARRAY(uint32_t) U32Array;
+
+static U64Array ids = ARRAY_NEW();
+static U32Array small_ids = ARRAY_NEW();
+static U64Array unpacked = ARRAY_NEW();
+static U32Array small_unpacked = ARRAY_NEW();
+static StringBuilder deltas = ARRAY_NEW();
+static StringBuilder frames = ARRAY_NEW();
+static StringBuilder streams = ARRAY_NEW();
+
+void init_empty(void)
+{
+	unpacked = (U64Array)ARRAY_NEW();
+	small_unpacked = (U32Array)ARRAY_NEW();
+}
+
+void cleanup(void)
+{
+	ARRAY_FREE(&unpacked);
+	ARRAY_FREE(&small_unpacked);
+}
+
+BENCH_MAIN({
+	// Sorted IDs with small gaps, as kept in ID lists
+	uint64_t id = 0;
+	for (uint64_t i = 0; i < COUNT; i++) {
+		id += (i * 0x9e3779b97f4a7c15ull) >> 58;
+		ARRAY_PUSH(&ids, id);
+		ARRAY_PUSH(&small_ids, (uint32_t)id);
+	}
+	PACK_DELTAS(&deltas, ids);
+	PACK_FOR(&frames, ids);
+	PACK_STREAMVBYTE_DELTAS(&streams, small_ids);
+	printf("Packed %d IDs of 8 bytes into %zu bytes as PACK_DELTA, "
+	       "%zu as PACK_FOR and %zu as PACK_STREAMVBYTE_DELTA\n",
+	       COUNT, (size_t)deltas.len, (size_t)frames.len,
+	       (size_t)streams.len);
+
+	BENCH_BEFORE_EACH(init_empty);
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Unpacking sorted IDs", {
+		BENCH("Copying the ARRAY", COUNT, {
+			ARRAY_PUSH_OTHER(&unpacked, ids);
+			BENCH_DO_NOT_OPTIMIZE(unpacked.len);
+		});
+
+		BENCH("UNPACK_DELTAS", COUNT, {
+			UNPACK_DELTAS(SV_FROM_BUF(deltas.ptr, deltas.len),
+				      &unpacked);
+			BENCH_DO_NOT_OPTIMIZE(unpacked.len);
+		});
+
+		BENCH("UNPACK_FOR", COUNT, {
+			UNPACK_FOR(SV_FROM_BUF(frames.ptr, frames.len),
+				   &unpacked);
+			BENCH_DO_NOT_OPTIMIZE(unpacked.len);
+		});
+
+		BENCH("UNPACK_STREAMVBYTE_DELTAS", COUNT, {
+			UNPACK_STREAMVBYTE_DELTAS(
+				SV_FROM_BUF(streams.ptr, streams.len),
+				&small_unpacked);
+			BENCH_DO_NOT_OPTIMIZE(small_unpacked.len);
+		});
+	});
+
+	BENCH_GROUP("Summing sorted IDs", {
+		BENCH("Looping over the ARRAY", COUNT, {
+			uint64_t sum = 0;
+			for (CRZ_SIZE i = 0; i < ids.len; i++)
+				sum += ids.ptr[i];
+			BENCH_DO_NOT_OPTIMIZE(sum);
+		});
+
+		BENCH("PACK_ITER_NEXT over PACK_DELTA", COUNT, {
+			PackIter iter;
+			uint64_t value;
+			uint64_t sum = 0;
+			StringView packed = SV_FROM_BUF(deltas.ptr, deltas.len);
+			PACK_ITER_INIT(&iter, packed);
+			while (PACK_ITER_NEXT(&iter, &value))
+				sum += value;
+			BENCH_DO_NOT_OPTIMIZE(sum);
+		});
+	});
+
+	ARRAY_FREE(&ids);
+	ARRAY_FREE(&small_ids);
+	ARRAY_FREE(&deltas);
+	ARRAY_FREE(&frames);
+	ARRAY_FREE(&streams);
+})
@@ -0,0 +1,32 @@
+#include "crzarr.h"
+#include "crzbench.h"
+#include "crzseg.h"
+
+#define COUNT 1000000
+
+static ARRAY(int) a = ARRAY_NEW();
+static SEGMENTED_ARRAY(int) s = SEGMENTED_ARRAY_NEW();
+
+void cleanup(void)
+{
+	ARRAY_FREE(&a);
+	SEGMENTED_ARRAY_FREE(&s);
+}
+
+BENCH_MAIN({
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Pushing", {
+		BENCH("ARRAY_PUSH", COUNT, {
+			for (int i = 0; i < COUNT; i++)
+				ARRAY_PUSH(&a, i);
+			BENCH_DO_NOT_OPTIMIZE(a.ptr);
+		});
+
+		BENCH("SEGMENTED_ARRAY_PUSH", COUNT, {
+			for (int i = 0; i < COUNT; i++)
+				SEGMENTED_ARRAY_PUSH(&s, i);
+			BENCH_DO_NOT_OPTIMIZE(s.segments[0]);
+		});
+	});
+})
@@ -0,0 +1,61 @@
+#include "crzarr.h"
+#include "crzbench.h"
+#include "crzsoa.h"
+
+#define COUNT 100000
+
+typedef struct {
+	double x;
+	double y;
+	double z;
+	double weight;
+	long id;
+	long flags;
+	char name[16];
+} Record;
+
+#define RECORD_FIELDS(X)  \
+	X(double, x)      \
+	X(double, y)      \
+	X(double, z)      \
+	X(double, weight) \
+	X(long, id)       \
+	X(long, flags)
+DEFINE_SOA(Records, RECORD_FIELDS)
+
+static ARRAY(Record) aos = ARRAY_NEW();
+static Records soa = SOA_NEW();
+
+BENCH_MAIN({
+	for (long i = 0; i < COUNT; i++) {
+		Record record = { 0 };
+		record.x = (double)i;
+		record.weight = 1.0;
+		record.id = i;
+		ARRAY_PUSH(&aos, record);
+		Records_push(&soa, (Records_Record){ .x = (double)i,
+						     .weight = 1.0,
+						     .id = i });
+	}
+
+	BENCH_GROUP("Summing a single field", {
+		BENCH("ARRAY of structs", COUNT, {
+			double sum = 0;
+			ARRAY_FOR(aos, i) {
+				sum += aos.ptr[i].x;
+			}
+			BENCH_DO_NOT_OPTIMIZE(sum);
+		});
+
+		BENCH("DEFINE_SOA", COUNT, {
+			double sum = 0;
+			SOA_FOR(soa, i) {
+				sum += soa.x[i];
+			}
+			BENCH_DO_NOT_OPTIMIZE(sum);
+		});
+	});
+
+	ARRAY_FREE(&aos);
+	Records_free(&soa);
+})
@@ -0,0 +1,53 @@
+#include "crzbench.h"
+#include "crzsb.h"
+#include "crzsv.h"
+
+#define SIZE (1 << 20)
+
+static StringBuilder ascii = ARRAY_NEW();
+static StringBuilder mixed = ARRAY_NEW();
+
+void fill(void)
+{
+	while (ascii.len < SIZE)
+		SB_PUSH_CSTR(&ascii, "The quick brown fox jumps. ");
+	while (mixed.len < SIZE)
+		SB_PUSH_CSTR(&mixed, "\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 ");
+}
+
+void cleanup(void)
+{
+	SB_FREE(&ascii);
+	SB_FREE(&mixed);
+}
+
+BENCH_MAIN({
+	BENCH_BEFORE_EACH(fill);
+	BENCH_AFTER_EACH(cleanup);
+
+	BENCH_GROUP("Validating ASCII text", {
+		BENCH("crzsv_utf8_valid_scalar", SIZE, {
+			CRZ_BOOL valid =
+				crzsv_utf8_valid_scalar(ascii.ptr, ascii.len);
+			BENCH_DO_NOT_OPTIMIZE(valid);
+		});
+
+		BENCH("SV_UTF8_VALID", SIZE, {
+			CRZ_BOOL valid = SV_UTF8_VALID(ascii);
+			BENCH_DO_NOT_OPTIMIZE(valid);
+		});
+	});
+
+	BENCH_GROUP("Validating multibyte text", {
+		BENCH("crzsv_utf8_valid_scalar", SIZE, {
+			CRZ_BOOL valid =
+				crzsv_utf8_valid_scalar(mixed.ptr, mixed.len);
+			BENCH_DO_NOT_OPTIMIZE(valid);
+		});
+
+		BENCH("SV_UTF8_VALID", SIZE, {
+			CRZ_BOOL valid = SV_UTF8_VALID(mixed);
+			BENCH_DO_NOT_OPTIMIZE(valid);
+		});
+	});
+})
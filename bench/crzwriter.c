@@ -0,0 +1,86 @@
+#include "crzbench.h"
+#include "crzwriter.h"
+#include <stdlib.h>
+
+#define LINES 100000
+#define BUFFER_SIZE (64 * 1024)
+
+static Writer writer;
+static StringBuilder sb = SB_NEW();
+static char path[] = "/tmp/crzwriter-bench-XXXXXX";
+static int fd = -1;
+static int flags = 0;
+static char line[] = "2024-01-01T00:00:00Z INFO request served in 42us\n";
+
+void open_file(void)
+{
+	fd = open(path, O_WRONLY | O_TRUNC | flags);
+	sb = (StringBuilder)SB_NEW();
+	SB_GROW_BY(&sb, BUFFER_SIZE);
+}
+
+void open_writer(void)
+{
+	open_file();
+	WRITER_INIT(&writer, fd, 4, BUFFER_SIZE);
+}
+
+void close_file(void)
+{
+	SB_FREE(&sb);
+	close(fd);
+}
+
+// The buffers still being written are left to the untimed cleanup, since
+// the producer would go on without waiting for them
+void close_writer(void)
+{
+	WRITER_FREE(&writer);
+	close_file();
+}
+
+// Compares filling a `StringBuilder` and writing it whenever it is full with
+// pushing to a `Writer`
+static void bench_logging(void)
+{
+	BENCH_BEFORE_EACH(open_file);
+	BENCH_AFTER_EACH(close_file);
+	BENCH("SB_PUSH_BUF and write when full", LINES, {
+		for (int i = 0; i < LINES; i++) {
+			if (sb.len + sizeof(line) - 1 > BUFFER_SIZE) {
+				crzwriter_write_all(fd, sb.ptr, sb.len);
+				sb.len = 0;
+			}
+			SB_PUSH_BUF(&sb, line, sizeof(line) - 1);
+		}
+		BENCH_DO_NOT_OPTIMIZE(sb.len);
+	});
+
+	BENCH_BEFORE_EACH(open_writer);
+	BENCH_AFTER_EACH(close_writer);
+	BENCH("WRITER_PUSH_BUF", LINES, {
+		for (int i = 0; i < LINES; i++) {
+			CRZ_SIZE len = sizeof(line) - 1;
+			WRITER_PUSH_BUF(&writer, line, len);
+		}
+		BENCH_DO_NOT_OPTIMIZE(writer.stalls);
+	});
+}
+
+BENCH_MAIN({
+	int created = mkstemp(path);
+	CRZ_ASSERT(created >= 0 && "Could not create temporary file");
+	close(created);
+
+	BENCH_GROUP("Logging 100k lines to a file", {
+		bench_logging();
+	});
+
+	// Each write waits for the disk, as for logs which must not be lost
+	flags = O_DSYNC;
+	BENCH_GROUP("Logging 100k lines to a file opened with O_DSYNC", {
+		bench_logging();
+	});
+
+	unlink(path);
+})
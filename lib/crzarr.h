@@ -2,6 +2,8 @@
 #define CRZARR_H_
 
 #include "crzdef.h"
+#include "crzstats.h"
+#include <string.h>
 
 #ifndef CRZARR_MINIMUM_CAPACITY
 #define CRZARR_MINIMUM_CAPACITY 8
@@ -63,14 +65,16 @@ typedef ARRAY(void) Crzarr_AnyArray;
 ///
 /// Reallocates the array to create the necessary additional space, if needed.
 /// Copies the memory from `contentsp` using `CRZ_MEMCPY`.
-#define ARRAY_PUSH_MANY(selfp, contentsp, count_elements)                    \
-	do {                                                                 \
-		crzarr_grow_to((Crzarr_AnyArray *)(selfp),                   \
-			       (selfp)->len + (count_elements),              \
-			       ARRAY_ELEMENT_SIZE(*(selfp)));                \
-		CRZ_MEMCPY((selfp)->ptr + (selfp)->len, (contentsp),         \
-			   (count_elements) * ARRAY_ELEMENT_SIZE(*(selfp))); \
-		(selfp)->len += (count_elements);                            \
+#define ARRAY_PUSH_MANY(selfp, contentsp, count_elements)                       \
+	do {                                                                    \
+		crzarr_grow_to((Crzarr_AnyArray *)(selfp),                      \
+			       (selfp)->len + (count_elements),                 \
+			       ARRAY_ELEMENT_SIZE(*(selfp)));                   \
+		CRZ_MEMCPY((selfp)->ptr + (selfp)->len, (contentsp),            \
+			   (count_elements) * ARRAY_ELEMENT_SIZE(*(selfp)));    \
+		CRZ_STATS_ADD(arr, bytes_copied,                                \
+			      (count_elements) * ARRAY_ELEMENT_SIZE(*(selfp))); \
+		(selfp)->len += (count_elements);                               \
 	} while (0)
 
 /// Push the contents of the dynamic array `other` into the dynamic array `selfp` (passed by pointer).
@@ -133,6 +137,82 @@ typedef ARRAY(void) Crzarr_AnyArray;
 		ARRAY_INIT((selfp));    \
 	} while (0)
 
+/// Define a dynamic array type named `Name` with elements of type `T`, along with functions specialized for it.
+///
+/// This defines:
+///   - `Name`, a typedef for `ARRAY(T)`, which still works with all of the `ARRAY_*` macros
+///   - `Name##_reserve`, `Name##_push`, `Name##_get`, `Name##_pop`, `Name##_splice`, `Name##_insert`, `Name##_remove` and `Name##_free`, which mirror the `ARRAY_*` macros
+///
+/// Unlike the `ARRAY_*` macros, which go through the type-erased `crzarr_splice` and `crzarr_grow_to`, these functions know `sizeof(T)` at compile time.
+/// This lets the compiler inline them and specialize their copies, which makes pushing and splicing faster for small element types.
+/// Only growing the array goes through `crzarr_grow_to`, since it is rare and reallocates anyway.
+#define DEFINE_ARRAY(Name, T)                                                 \
+	typedef ARRAY(T) Name;                                                \
+                                                                              \
+	static inline void Name##_reserve(Name *selfp, CRZ_SIZE new_cap)      \
+	{                                                                     \
+		if (selfp->cap < new_cap)                                     \
+			crzarr_grow_to((Crzarr_AnyArray *)selfp, new_cap,     \
+				       sizeof(T));                            \
+	}                                                                     \
+                                                                              \
+	static inline void Name##_push(Name *selfp, T element)                \
+	{                                                                     \
+		Name##_reserve(selfp, selfp->len + 1);                        \
+		selfp->ptr[selfp->len++] = element;                           \
+	}                                                                     \
+                                                                              \
+	static inline T Name##_get(const Name *selfp, CRZ_SIZE index)         \
+	{                                                                     \
+		CRZ_ASSERT(index < selfp->len && "Index out of bounds");      \
+		return selfp->ptr[index];                                     \
+	}                                                                     \
+                                                                              \
+	static inline T Name##_pop(Name *selfp)                               \
+	{                                                                     \
+		return selfp->ptr[--selfp->len];                              \
+	}                                                                     \
+                                                                              \
+	static inline void Name##_splice(Name *selfp, CRZ_SIZE index,         \
+					 CRZ_SIZE remove_amount_elements,     \
+					 const T *contentsp,                  \
+					 CRZ_SIZE count_elements)             \
+	{                                                                     \
+		CRZ_ASSERT(index + remove_amount_elements <= selfp->len &&    \
+			   "Index out of bounds");                            \
+		CRZ_SIZE new_length =                                         \
+			selfp->len + count_elements - remove_amount_elements; \
+		Name##_reserve(selfp, new_length);                            \
+		CRZ_SIZE after = selfp->len - index - remove_amount_elements; \
+		if (after > 0 && count_elements != remove_amount_elements)    \
+			memmove(selfp->ptr + index + count_elements,          \
+				selfp->ptr + index + remove_amount_elements,  \
+				after * sizeof(T));                           \
+		for (CRZ_SIZE i = 0; i < count_elements; i++)                 \
+			selfp->ptr[index + i] = contentsp[i];                 \
+		CRZ_STATS_ADD(arr, bytes_copied,                              \
+			      (new_length - index) * sizeof(T));              \
+		selfp->len = new_length;                                      \
+	}                                                                     \
+                                                                              \
+	static inline void Name##_insert(Name *selfp, CRZ_SIZE index,         \
+					 const T *contentsp,                  \
+					 CRZ_SIZE count_elements)             \
+	{                                                                     \
+		Name##_splice(selfp, index, 0, contentsp, count_elements);    \
+	}                                                                     \
+                                                                              \
+	static inline void Name##_remove(Name *selfp, CRZ_SIZE index,         \
+					 CRZ_SIZE amount_elements)            \
+	{                                                                     \
+		Name##_splice(selfp, index, amount_elements, CRZ_NULL, 0);    \
+	}                                                                     \
+                                                                              \
+	static inline void Name##_free(Name *selfp)                           \
+	{                                                                     \
+		ARRAY_FREE(selfp);                                            \
+	}
+
 /// INTERNAL: you most likely don't want to use this.
 ///           Try `ARRAY_GROW_BY(selfp, amount_elements)` instead.
 void crzarr_grow_to(Crzarr_AnyArray *selfp, CRZ_SIZE new_cap,
@@ -153,6 +233,14 @@ void crzarr_grow_to(Crzarr_AnyArray *selfp, CRZ_SIZE new_cap,
 			selfp->cap = CRZARR_MINIMUM_CAPACITY;
 		if (selfp->cap < new_cap)
 			selfp->cap = new_cap;
+		if (selfp->ptr) {
+			CRZ_STATS_ADD(arr, reallocations, 1);
+			// `CRZ_REALLOC` may need to move the existing elements
+			CRZ_STATS_ADD(arr, bytes_copied, selfp->len * element_size);
+		} else {
+			CRZ_STATS_ADD(arr, allocations, 1);
+		}
+		CRZ_STATS_ADD(arr, bytes_allocated, element_size * selfp->cap);
 		selfp->ptr = CRZ_REALLOC(selfp->ptr, element_size * selfp->cap);
 		CRZ_ASSERT(selfp->ptr &&
 			   "Out of memory when reallocating array");
@@ -183,6 +271,8 @@ void crzarr_splice(Crzarr_AnyArray *selfp, CRZ_SIZE index,
 	memcpy(ptr + index * element_size, contentsp,
 	       element_size * count_elements);
 
+	CRZ_STATS_ADD(arr, bytes_copied, (new_length - index) * element_size);
+
 	selfp->len = new_length;
 }
 
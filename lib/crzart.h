@@ -0,0 +1,885 @@
+#ifndef CRZART_H_
+#define CRZART_H_
+
+#include "crzdef.h"
+#include "crzpool.h"
+#include "crzsv.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) && !defined(CRZART_NO_SIMD)
+#include <emmintrin.h>
+#define CRZART_SSE2
+#endif
+
+/// The amount of bytes of its prefix stored in each inner node of an `Art`.
+///
+/// Longer prefixes are still skipped in one step, with the rest of their bytes found in the key of any leaf below the node.
+#define CRZART_MAX_PREFIX 8
+
+/// The amount of nodes of each kind allocated at once by the pools of an `Art`.
+///
+/// Wider nodes are both larger and rarer, so they come a few at a time, rather than the first `Crzart_Node256` allocating dozens of them at once.
+#ifndef CRZART_POOL_CHUNK
+#define CRZART_POOL_CHUNK 64
+#endif // CRZART_POOL_CHUNK
+#ifndef CRZART_POOL_CHUNK48
+#define CRZART_POOL_CHUNK48 8
+#endif // CRZART_POOL_CHUNK48
+#ifndef CRZART_POOL_CHUNK256
+#define CRZART_POOL_CHUNK256 2
+#endif // CRZART_POOL_CHUNK256
+
+/// INTERNAL: this is the kind of a node of an `Art`, which is the first byte of every node.
+enum {
+	CRZART_LEAF,
+	CRZART_NODE4,
+	CRZART_NODE16,
+	CRZART_NODE48,
+	CRZART_NODE256,
+	CRZART_KINDS,
+};
+
+/// INTERNAL: this is a node holding one key-value pair, with the value stored at `CRZART_VALUE_OFFSET` from its start.
+typedef struct {
+	uint8_t kind;
+	StringView key;
+} Crzart_Leaf;
+
+/// INTERNAL: this is where the value of a `Crzart_Leaf` starts, aligned to 16 bytes.
+#define CRZART_VALUE_OFFSET ((sizeof(Crzart_Leaf) + 15) & ~(CRZ_SIZE)15)
+
+/// INTERNAL: this is the header shared by every inner node of an `Art`.
+///
+/// Every key below the node shares its path from the root, followed by `prefix_len` more bytes, of which the first `CRZART_MAX_PREFIX` are in `prefix`.
+/// The key which ends right after them, if any, is the leaf `end`, and each child continues the keys with a different next byte.
+typedef struct {
+	uint8_t kind;
+	uint16_t count;
+	uint32_t prefix_len;
+	unsigned char prefix[CRZART_MAX_PREFIX];
+	Crzart_Leaf *end;
+} Crzart_Inner;
+
+/// INTERNAL: this is an inner node with up to 4 children, sorted by their byte.
+typedef struct {
+	Crzart_Inner inner;
+	unsigned char keys[4];
+	void *children[4];
+} Crzart_Node4;
+
+/// INTERNAL: this is an inner node with up to 16 children, sorted by their byte, which are searched all at once using SSE2.
+typedef struct {
+	Crzart_Inner inner;
+	unsigned char keys[16];
+	void *children[16];
+} Crzart_Node16;
+
+/// INTERNAL: this is an inner node with up to 48 children, where `index` holds 1 more than the slot of each byte's child, or 0 if it has none.
+typedef struct {
+	Crzart_Inner inner;
+	unsigned char index[256];
+	void *children[48];
+} Crzart_Node48;
+
+/// INTERNAL: this is an inner node with a slot for the child of every byte.
+typedef struct {
+	Crzart_Inner inner;
+	void *children[256];
+} Crzart_Node256;
+
+/// An adaptive radix tree mapping `StringView` keys to values, ordered by their bytes.
+///
+/// Each inner node branches on one byte of the keys, and grows from 4 to 16, 48 and 256 children as needed, so sparse nodes stay small while dense ones are a single index.
+/// Runs of bytes shared by every key below a node are skipped in one step.
+/// Finding a key, or the longest key which prefixes a given string, takes at most one step per byte of it, and never hashes or copies it.
+/// Keys are stored as they are, so the strings of keys must outlive the tree.
+/// Nodes are allocated from pools of chunks of each size, and released nodes are reused by later insertions.
+typedef struct {
+	void *root;
+	CRZ_SIZE len;
+	CRZ_SIZE value_size;
+	Pool pools[CRZART_KINDS];
+} Art;
+
+/// An iterator over the keys of an `Art` which start with a given prefix, in order.
+///
+/// Once `ART_ITER_NEXT` returned `CRZ_TRUE`, `key` and `value` are the current key and a pointer to its value.
+/// The tree must not be modified while iterating over it.
+typedef struct {
+	const void *subtree;
+	CRZ_SIZE depth;
+	const Crzart_Leaf *leaf;
+	StringView key;
+	void *value;
+} ArtIter;
+
+/// Create an empty `Art` with values of type `T`.
+#define ART_NEW(T)                                                         \
+	((Art){ .root = CRZ_NULL,                                          \
+		.len = 0,                                                  \
+		.value_size = sizeof(T),                                   \
+		.pools = {                                                 \
+			[CRZART_LEAF] = POOL_NEW(CRZART_POOL_CHUNK),       \
+			[CRZART_NODE4] = POOL_NEW(CRZART_POOL_CHUNK),      \
+			[CRZART_NODE16] = POOL_NEW(CRZART_POOL_CHUNK),     \
+			[CRZART_NODE48] = POOL_NEW(CRZART_POOL_CHUNK48),   \
+			[CRZART_NODE256] = POOL_NEW(CRZART_POOL_CHUNK256), \
+		} })
+
+/// Get a pointer to the value at the `StringView` key `get_key` in the `Art` `self`, or `CRZ_NULL` if it does not exist.
+#define ART_GET(self, get_key) crzart_get(&(self), (get_key))
+
+/// Set the value at the `StringView` key `set_key` in the `Art` `selfp` (passed by pointer) to the value pointed to by `valuep`, which is copied.
+///
+/// Returns whether the key is new, rather than having its value replaced.
+#define ART_INSERT(selfp, set_key, valuep) \
+	crzart_insert((selfp), (set_key), (valuep))
+
+/// Remove the `StringView` key `remove_key` from the `Art` `selfp` (passed by pointer).
+///
+/// Returns whether the key existed.
+#define ART_REMOVE(selfp, remove_key) crzart_remove((selfp), (remove_key))
+
+/// Get a pointer to the value of the longest key in the `Art` `self` which is a prefix of the `StringView` `search`, or `CRZ_NULL` if there is none.
+///
+/// If `matchedp` (a `StringView`, passed by pointer) is not `CRZ_NULL`, it is set to the matched key.
+#define ART_LONGEST_PREFIX(self, search, matchedp) \
+	crzart_longest_prefix(&(self), (search), (matchedp))
+
+/// Create an iterator over the keys in the `Art` `self` which start with the `StringView` `prefix`, in order.
+#define ART_ITER_PREFIX(self, prefix) crzart_iter_prefix(&(self), (prefix))
+
+/// Move the iterator `iterp` (passed by pointer) to the next key, returning whether there is one.
+#define ART_ITER_NEXT(iterp) crzart_iter_next(iterp)
+
+/// Iterate over the keys and values of the `Art` `self` which start with the `StringView` `prefix`, in order.
+#define ART_FOR_PREFIX(self, prefix, iter)                 \
+	for (ArtIter iter = ART_ITER_PREFIX(self, prefix); \
+	     ART_ITER_NEXT(&(iter));)
+
+/// Iterate over every key and value of the `Art` `self`, in order.
+#define ART_FOR(self, iter) ART_FOR_PREFIX(self, SV_FROM_CSTR(""), iter)
+
+/// Free every node of the `Art` `selfp` (passed by pointer), and empty-out the fields of the struct.
+#define ART_FREE(selfp) crzart_free(selfp)
+
+/// INTERNAL: this is the kind of the node `node`, whether it is a leaf or not.
+uint8_t crzart_kind(const void *node);
+
+/// INTERNAL: this is the size in bytes of nodes of the kind `kind`, with values of `value_size` bytes.
+CRZ_SIZE crzart_node_size(uint8_t kind, CRZ_SIZE value_size);
+
+/// INTERNAL: this is the value of the leaf `leaf`.
+void *crzart_value(const Crzart_Leaf *leaf);
+
+/// INTERNAL: this function takes a zeroed node of the kind `kind` from the pools of `selfp`.
+void *crzart_alloc(Art *selfp, uint8_t kind);
+
+/// INTERNAL: this function gives the node `node` back to the pools of `selfp`.
+void crzart_release(Art *selfp, void *node);
+
+/// INTERNAL: this function makes a leaf with the key `key` and a copy of the value pointed to by `valuep`.
+Crzart_Leaf *crzart_new_leaf(Art *selfp, StringView key, const void *valuep);
+
+/// INTERNAL: this function points `keysp` and `childrenp` to the sorted bytes and children of the `CRZART_NODE4` or `CRZART_NODE16` node `inner`.
+void crzart_sorted(Crzart_Inner *inner, unsigned char **keysp,
+		   void ***childrenp);
+
+/// INTERNAL: this is the slot of the child of `inner` for the byte `byte`, or `CRZ_NULL` if it has none.
+void **crzart_find_child(Crzart_Inner *inner, unsigned char byte);
+
+/// INTERNAL: this is the child of `inner` with the smallest byte greater than `after`, or `CRZ_NULL` if it has none.
+///           Pass -1 as `after` to get its first child.
+void *crzart_next_child(Crzart_Inner *inner, int after);
+
+/// INTERNAL: this function adds `child` for the byte `byte` to the node in `*slot`, replacing it by a larger one if it is full.
+void crzart_add_child(Art *selfp, void **slot, unsigned char byte,
+		      void *child);
+
+/// INTERNAL: this function removes the child for the byte `byte` from `inner`.
+void crzart_remove_child(Crzart_Inner *inner, unsigned char byte);
+
+/// INTERNAL: this function moves `inner` into a new node of the kind `kind`, which must fit its children, returning the new node.
+Crzart_Inner *crzart_resize(Art *selfp, Crzart_Inner *inner, uint8_t kind);
+
+/// INTERNAL: this is the leaf with the smallest key below `node`.
+const Crzart_Leaf *crzart_min_leaf(const void *node);
+
+/// INTERNAL: this is the length of the longest common prefix of the prefix of `inner` and the bytes of `key` from `depth`.
+CRZ_SIZE crzart_prefix_mismatch(Crzart_Inner *inner, StringView key,
+				CRZ_SIZE depth);
+
+/// INTERNAL: this function copies the stored bytes of the prefix of `inner`, which starts at `depth`, from the key of a leaf below it.
+void crzart_refresh_prefix(Crzart_Inner *inner, CRZ_SIZE depth);
+
+/// INTERNAL: this function adds the leaf `leaf` to the node in `*slot`, whose prefix ends at `depth`.
+void crzart_place(Art *selfp, void **slot, Crzart_Leaf *leaf, CRZ_SIZE depth);
+
+/// INTERNAL: this function sets the value of `key` below the node in `*slot`, which starts at `depth`, returning whether it is new.
+CRZ_BOOL crzart_insert_at(Art *selfp, void **slot, StringView key,
+			  CRZ_SIZE depth, const void *valuep);
+
+/// INTERNAL: this function removes `key` below the node in `*slot`, which starts at `depth`, returning whether it existed.
+CRZ_BOOL crzart_remove_at(Art *selfp, void **slot, StringView key,
+			  CRZ_SIZE depth);
+
+/// INTERNAL: this function replaces the node in `*slot`, which starts at `depth`, by a smaller one if it has few enough children.
+void crzart_shrink(Art *selfp, void **slot, CRZ_SIZE depth);
+
+/// INTERNAL: this is the leaf with the smallest key greater than `last` below `node`, which starts at `depth`, or `CRZ_NULL` if there is none.
+///           `last` must be a key below `node`.
+const Crzart_Leaf *crzart_successor(const void *node, CRZ_SIZE depth,
+				    StringView last);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ART_GET(self, get_key)` instead.
+void *crzart_get(const Art *selfp, StringView key);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ART_INSERT(selfp, set_key, valuep)` instead.
+CRZ_BOOL crzart_insert(Art *selfp, StringView key, const void *valuep);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ART_REMOVE(selfp, remove_key)` instead.
+CRZ_BOOL crzart_remove(Art *selfp, StringView key);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ART_LONGEST_PREFIX(self, search, matchedp)` instead.
+void *crzart_longest_prefix(const Art *selfp, StringView search,
+			    StringView *matchedp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ART_ITER_PREFIX(self, prefix)` instead.
+ArtIter crzart_iter_prefix(const Art *selfp, StringView prefix);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ART_ITER_NEXT(iterp)` instead.
+CRZ_BOOL crzart_iter_next(ArtIter *iterp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ART_FREE(selfp)` instead.
+void crzart_free(Art *selfp);
+
+uint8_t crzart_kind(const void *node)
+{
+	// Leaves and inner nodes both start with their kind
+	return *(const uint8_t *)node;
+}
+
+CRZ_SIZE crzart_node_size(uint8_t kind, CRZ_SIZE value_size)
+{
+	switch (kind) {
+	case CRZART_LEAF:
+		return (CRZART_VALUE_OFFSET + value_size + 15) & ~(CRZ_SIZE)15;
+	case CRZART_NODE4:
+		return sizeof(Crzart_Node4);
+	case CRZART_NODE16:
+		return sizeof(Crzart_Node16);
+	case CRZART_NODE48:
+		return sizeof(Crzart_Node48);
+	default:
+		return sizeof(Crzart_Node256);
+	}
+}
+
+void *crzart_value(const Crzart_Leaf *leaf)
+{
+	return (char *)leaf + CRZART_VALUE_OFFSET;
+}
+
+void *crzart_alloc(Art *selfp, uint8_t kind)
+{
+	CRZ_SIZE size = crzart_node_size(kind, selfp->value_size);
+	void *node = POOL_ALLOC(&selfp->pools[kind], size);
+	memset(node, 0, size);
+	*(uint8_t *)node = kind;
+	return node;
+}
+
+void crzart_release(Art *selfp, void *node)
+{
+	POOL_RELEASE(&selfp->pools[crzart_kind(node)], node);
+}
+
+Crzart_Leaf *crzart_new_leaf(Art *selfp, StringView key, const void *valuep)
+{
+	Crzart_Leaf *leaf = crzart_alloc(selfp, CRZART_LEAF);
+	leaf->key = key;
+	CRZ_MEMCPY(crzart_value(leaf), valuep, selfp->value_size);
+	return leaf;
+}
+
+void crzart_sorted(Crzart_Inner *inner, unsigned char **keysp,
+		   void ***childrenp)
+{
+	if (inner->kind == CRZART_NODE4) {
+		*keysp = ((Crzart_Node4 *)inner)->keys;
+		*childrenp = ((Crzart_Node4 *)inner)->children;
+	} else {
+		*keysp = ((Crzart_Node16 *)inner)->keys;
+		*childrenp = ((Crzart_Node16 *)inner)->children;
+	}
+}
+
+void **crzart_find_child(Crzart_Inner *inner, unsigned char byte)
+{
+	switch (inner->kind) {
+	case CRZART_NODE4: {
+		Crzart_Node4 *node = (Crzart_Node4 *)inner;
+		for (CRZ_SIZE i = 0; i < inner->count; i++) {
+			if (node->keys[i] == byte)
+				return &node->children[i];
+		}
+		return CRZ_NULL;
+	}
+	case CRZART_NODE16: {
+		Crzart_Node16 *node = (Crzart_Node16 *)inner;
+#ifdef CRZART_SSE2
+		__m128i keys = _mm_loadu_si128((const __m128i *)node->keys);
+		__m128i found = _mm_cmpeq_epi8(keys, _mm_set1_epi8((char)byte));
+		// Bytes past the children may be left over from removed ones
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(found) &
+				((1u << inner->count) - 1);
+		return mask ? &node->children[CRZ_CTZ(mask)] : CRZ_NULL;
+#else
+		for (CRZ_SIZE i = 0; i < inner->count; i++) {
+			if (node->keys[i] == byte)
+				return &node->children[i];
+		}
+		return CRZ_NULL;
+#endif // CRZART_SSE2
+	}
+	case CRZART_NODE48: {
+		Crzart_Node48 *node = (Crzart_Node48 *)inner;
+		unsigned char index = node->index[byte];
+		return index ? &node->children[index - 1] : CRZ_NULL;
+	}
+	default: {
+		Crzart_Node256 *node = (Crzart_Node256 *)inner;
+		return node->children[byte] ? &node->children[byte] : CRZ_NULL;
+	}
+	}
+}
+
+void *crzart_next_child(Crzart_Inner *inner, int after)
+{
+	switch (inner->kind) {
+	case CRZART_NODE4:
+	case CRZART_NODE16: {
+		unsigned char *keys;
+		void **children;
+		crzart_sorted(inner, &keys, &children);
+		for (CRZ_SIZE i = 0; i < inner->count; i++) {
+			if (keys[i] > after)
+				return children[i];
+		}
+		return CRZ_NULL;
+	}
+	case CRZART_NODE48: {
+		Crzart_Node48 *node = (Crzart_Node48 *)inner;
+		for (int byte = after + 1; byte < 256; byte++) {
+			if (node->index[byte])
+				return node->children[node->index[byte] - 1];
+		}
+		return CRZ_NULL;
+	}
+	default: {
+		Crzart_Node256 *node = (Crzart_Node256 *)inner;
+		for (int byte = after + 1; byte < 256; byte++) {
+			if (node->children[byte])
+				return node->children[byte];
+		}
+		return CRZ_NULL;
+	}
+	}
+}
+
+void crzart_add_child(Art *selfp, void **slot, unsigned char byte,
+		      void *child)
+{
+	Crzart_Inner *inner = *slot;
+	static const CRZ_SIZE capacities[CRZART_KINDS] = { 0, 4, 16, 48, 256 };
+	if (inner->count == capacities[inner->kind]) {
+		inner = crzart_resize(selfp, inner, inner->kind + 1);
+		*slot = inner;
+	}
+
+	switch (inner->kind) {
+	case CRZART_NODE4:
+	case CRZART_NODE16: {
+		unsigned char *keys;
+		void **children;
+		crzart_sorted(inner, &keys, &children);
+		CRZ_SIZE position = 0;
+		while (position < inner->count && keys[position] < byte)
+			position++;
+		CRZ_SIZE after = inner->count - position;
+		memmove(keys + position + 1, keys + position, after);
+		memmove(children + position + 1, children + position,
+			after * sizeof(*children));
+		keys[position] = byte;
+		children[position] = child;
+		break;
+	}
+	case CRZART_NODE48: {
+		Crzart_Node48 *node = (Crzart_Node48 *)inner;
+		// Removed children leave holes, so look for the first free slot
+		CRZ_SIZE free_slot = 0;
+		while (node->children[free_slot] != CRZ_NULL)
+			free_slot++;
+		node->children[free_slot] = child;
+		node->index[byte] = (unsigned char)(free_slot + 1);
+		break;
+	}
+	default:
+		((Crzart_Node256 *)inner)->children[byte] = child;
+	}
+	inner->count++;
+}
+
+void crzart_remove_child(Crzart_Inner *inner, unsigned char byte)
+{
+	switch (inner->kind) {
+	case CRZART_NODE4:
+	case CRZART_NODE16: {
+		unsigned char *keys;
+		void **children;
+		crzart_sorted(inner, &keys, &children);
+		CRZ_SIZE position = 0;
+		while (keys[position] != byte)
+			position++;
+		CRZ_SIZE after = inner->count - position - 1;
+		memmove(keys + position, keys + position + 1, after);
+		memmove(children + position, children + position + 1,
+			after * sizeof(*children));
+		break;
+	}
+	case CRZART_NODE48: {
+		Crzart_Node48 *node = (Crzart_Node48 *)inner;
+		node->children[node->index[byte] - 1] = CRZ_NULL;
+		node->index[byte] = 0;
+		break;
+	}
+	default:
+		((Crzart_Node256 *)inner)->children[byte] = CRZ_NULL;
+	}
+	inner->count--;
+}
+
+Crzart_Inner *crzart_resize(Art *selfp, Crzart_Inner *inner, uint8_t kind)
+{
+	Crzart_Inner *resized = crzart_alloc(selfp, kind);
+	resized->prefix_len = inner->prefix_len;
+	CRZ_MEMCPY(resized->prefix, inner->prefix, CRZART_MAX_PREFIX);
+	resized->end = inner->end;
+
+	// Adding the children in order keeps sorted nodes sorted
+	int byte = -1;
+	void *child;
+	while ((child = crzart_next_child(inner, byte)) != CRZ_NULL) {
+		switch (inner->kind) {
+		case CRZART_NODE4:
+		case CRZART_NODE16: {
+			unsigned char *keys;
+			void **children;
+			crzart_sorted(inner, &keys, &children);
+			CRZ_SIZE i = 0;
+			while (keys[i] <= byte)
+				i++;
+			byte = keys[i];
+			break;
+		}
+		default:
+			byte++;
+			while (crzart_find_child(inner, (unsigned char)byte) ==
+			       CRZ_NULL)
+				byte++;
+		}
+		void *slot = resized;
+		crzart_add_child(selfp, &slot, (unsigned char)byte, child);
+	}
+	crzart_release(selfp, inner);
+	return resized;
+}
+
+const Crzart_Leaf *crzart_min_leaf(const void *node)
+{
+	while (crzart_kind(node) != CRZART_LEAF) {
+		Crzart_Inner *inner = (Crzart_Inner *)node;
+		// The key which ends at a node comes before every key below it
+		if (inner->end)
+			return inner->end;
+		node = crzart_next_child(inner, -1);
+	}
+	return node;
+}
+
+CRZ_SIZE crzart_prefix_mismatch(Crzart_Inner *inner, StringView key,
+				CRZ_SIZE depth)
+{
+	CRZ_SIZE len = inner->prefix_len;
+	if (key.len - depth < len)
+		len = key.len - depth;
+	CRZ_SIZE stored = len < CRZART_MAX_PREFIX ? len : CRZART_MAX_PREFIX;
+	const unsigned char *bytes = (const unsigned char *)key.ptr + depth;
+
+	CRZ_SIZE i = 0;
+	while (i < stored && inner->prefix[i] == bytes[i])
+		i++;
+	if (i < stored || i == len)
+		return i;
+
+	const Crzart_Leaf *leaf = crzart_min_leaf(inner);
+	const unsigned char *below = (const unsigned char *)leaf->key.ptr;
+	while (i < len && below[depth + i] == bytes[i])
+		i++;
+	return i;
+}
+
+void crzart_refresh_prefix(Crzart_Inner *inner, CRZ_SIZE depth)
+{
+	const Crzart_Leaf *leaf = crzart_min_leaf(inner);
+	CRZ_SIZE stored = inner->prefix_len < CRZART_MAX_PREFIX ?
+				  inner->prefix_len :
+				  CRZART_MAX_PREFIX;
+	CRZ_MEMCPY(inner->prefix, leaf->key.ptr + depth, stored);
+}
+
+void crzart_place(Art *selfp, void **slot, Crzart_Leaf *leaf, CRZ_SIZE depth)
+{
+	if (leaf->key.len == depth) {
+		((Crzart_Inner *)*slot)->end = leaf;
+		return;
+	}
+	unsigned char byte = (unsigned char)leaf->key.ptr[depth];
+	crzart_add_child(selfp, slot, byte, leaf);
+}
+
+CRZ_BOOL crzart_insert_at(Art *selfp, void **slot, StringView key,
+			  CRZ_SIZE depth, const void *valuep)
+{
+	if (*slot == CRZ_NULL) {
+		*slot = crzart_new_leaf(selfp, key, valuep);
+		return CRZ_TRUE;
+	}
+
+	if (crzart_kind(*slot) == CRZART_LEAF) {
+		Crzart_Leaf *leaf = *slot;
+		if (SV_EQ(leaf->key, key)) {
+			CRZ_MEMCPY(crzart_value(leaf), valuep,
+				   selfp->value_size);
+			return CRZ_FALSE;
+		}
+
+		// Split the leaf into a node branching where the keys differ
+		CRZ_SIZE common = 0;
+		while (depth + common < leaf->key.len &&
+		       depth + common < key.len &&
+		       leaf->key.ptr[depth + common] == key.ptr[depth + common])
+			common++;
+		Crzart_Inner *inner = crzart_alloc(selfp, CRZART_NODE4);
+		inner->prefix_len = (uint32_t)common;
+		CRZ_MEMCPY(inner->prefix, key.ptr + depth,
+			   common < CRZART_MAX_PREFIX ? common :
+							CRZART_MAX_PREFIX);
+		*slot = inner;
+		crzart_place(selfp, slot, leaf, depth + common);
+		crzart_place(selfp, slot, crzart_new_leaf(selfp, key, valuep),
+			     depth + common);
+		return CRZ_TRUE;
+	}
+
+	Crzart_Inner *inner = *slot;
+	CRZ_SIZE mismatch = crzart_prefix_mismatch(inner, key, depth);
+	if (mismatch < inner->prefix_len) {
+		// Split the prefix, with a new node branching where they differ
+		const Crzart_Leaf *below = crzart_min_leaf(inner);
+		unsigned char byte =
+			(unsigned char)below->key.ptr[depth + mismatch];
+		Crzart_Inner *parent = crzart_alloc(selfp, CRZART_NODE4);
+		parent->prefix_len = (uint32_t)mismatch;
+		CRZ_MEMCPY(parent->prefix, key.ptr + depth,
+			   mismatch < CRZART_MAX_PREFIX ? mismatch :
+							  CRZART_MAX_PREFIX);
+		inner->prefix_len -= (uint32_t)(mismatch + 1);
+		crzart_refresh_prefix(inner, depth + mismatch + 1);
+
+		*slot = parent;
+		crzart_add_child(selfp, slot, byte, inner);
+		crzart_place(selfp, slot, crzart_new_leaf(selfp, key, valuep),
+			     depth + mismatch);
+		return CRZ_TRUE;
+	}
+	depth += inner->prefix_len;
+
+	if (depth == key.len) {
+		if (inner->end) {
+			CRZ_MEMCPY(crzart_value(inner->end), valuep,
+				   selfp->value_size);
+			return CRZ_FALSE;
+		}
+		inner->end = crzart_new_leaf(selfp, key, valuep);
+		return CRZ_TRUE;
+	}
+
+	unsigned char byte = (unsigned char)key.ptr[depth];
+	void **child = crzart_find_child(inner, byte);
+	if (child)
+		return crzart_insert_at(selfp, child, key, depth + 1, valuep);
+	Crzart_Leaf *leaf = crzart_new_leaf(selfp, key, valuep);
+	crzart_add_child(selfp, slot, byte, leaf);
+	return CRZ_TRUE;
+}
+
+CRZ_BOOL crzart_remove_at(Art *selfp, void **slot, StringView key,
+			  CRZ_SIZE depth)
+{
+	if (*slot == CRZ_NULL)
+		return CRZ_FALSE;
+
+	if (crzart_kind(*slot) == CRZART_LEAF) {
+		Crzart_Leaf *leaf = *slot;
+		if (!SV_EQ(leaf->key, key))
+			return CRZ_FALSE;
+		crzart_release(selfp, leaf);
+		*slot = CRZ_NULL;
+		return CRZ_TRUE;
+	}
+
+	Crzart_Inner *inner = *slot;
+	CRZ_SIZE start = depth;
+	if (crzart_prefix_mismatch(inner, key, depth) < inner->prefix_len)
+		return CRZ_FALSE;
+	depth += inner->prefix_len;
+
+	if (depth == key.len) {
+		// Every byte of the path was checked, so this is the key
+		if (inner->end == CRZ_NULL)
+			return CRZ_FALSE;
+		crzart_release(selfp, inner->end);
+		inner->end = CRZ_NULL;
+	} else {
+		unsigned char byte = (unsigned char)key.ptr[depth];
+		void **child = crzart_find_child(inner, byte);
+		if (!child || !crzart_remove_at(selfp, child, key, depth + 1))
+			return CRZ_FALSE;
+		if (*child == CRZ_NULL)
+			crzart_remove_child(inner, byte);
+	}
+	crzart_shrink(selfp, slot, start);
+	return CRZ_TRUE;
+}
+
+void crzart_shrink(Art *selfp, void **slot, CRZ_SIZE depth)
+{
+	Crzart_Inner *inner = *slot;
+	if (inner->count == 0) {
+		// The key which ends at the node, if any, takes its place
+		*slot = inner->end;
+		crzart_release(selfp, inner);
+		return;
+	}
+
+	if (inner->count == 1 && inner->end == CRZ_NULL) {
+		// Merge the node into its only child
+		void *child = crzart_next_child(inner, -1);
+		if (crzart_kind(child) != CRZART_LEAF) {
+			Crzart_Inner *below = child;
+			below->prefix_len += inner->prefix_len + 1;
+			crzart_refresh_prefix(below, depth);
+		}
+		*slot = child;
+		crzart_release(selfp, inner);
+		return;
+	}
+
+	// Shrink well below the capacity of the smaller kind, so that adding
+	// and removing around it does not resize every time
+	static const CRZ_SIZE minimums[CRZART_KINDS] = { 0, 0, 3, 12, 37 };
+	if (inner->count <= minimums[inner->kind])
+		*slot = crzart_resize(selfp, inner, inner->kind - 1);
+}
+
+const Crzart_Leaf *crzart_successor(const void *node, CRZ_SIZE depth,
+				    StringView last)
+{
+	// A leaf on the path of `last` is the leaf of `last` itself
+	if (crzart_kind(node) == CRZART_LEAF)
+		return CRZ_NULL;
+
+	Crzart_Inner *inner = (Crzart_Inner *)node;
+	depth += inner->prefix_len;
+	int after = -1;
+	if (depth < last.len) {
+		unsigned char byte = (unsigned char)last.ptr[depth];
+		void *child = *crzart_find_child(inner, byte);
+		const Crzart_Leaf *next =
+			crzart_successor(child, depth + 1, last);
+		if (next)
+			return next;
+		after = byte;
+	}
+	void *next_child = crzart_next_child(inner, after);
+	return next_child ? crzart_min_leaf(next_child) : CRZ_NULL;
+}
+
+void *crzart_get(const Art *selfp, StringView key)
+{
+	const void *node = selfp->root;
+	CRZ_SIZE depth = 0;
+	while (node != CRZ_NULL) {
+		if (crzart_kind(node) == CRZART_LEAF) {
+			const Crzart_Leaf *leaf = node;
+			return SV_EQ(leaf->key, key) ? crzart_value(leaf) :
+						       CRZ_NULL;
+		}
+
+		// Only the stored bytes of prefixes are checked on the way
+		// down, since the key of the leaf found is checked in full
+		Crzart_Inner *inner = (Crzart_Inner *)node;
+		CRZ_SIZE stored = inner->prefix_len < CRZART_MAX_PREFIX ?
+					  inner->prefix_len :
+					  CRZART_MAX_PREFIX;
+		if (key.len - depth < inner->prefix_len ||
+		    CRZ_MEMCMP(inner->prefix, key.ptr + depth, stored) != 0)
+			return CRZ_NULL;
+		depth += inner->prefix_len;
+
+		if (depth == key.len) {
+			const Crzart_Leaf *end = inner->end;
+			return end && SV_EQ(end->key, key) ? crzart_value(end) :
+							     CRZ_NULL;
+		}
+		void **child = crzart_find_child(inner, key.ptr[depth]);
+		if (child == CRZ_NULL)
+			return CRZ_NULL;
+		node = *child;
+		depth++;
+	}
+	return CRZ_NULL;
+}
+
+CRZ_BOOL crzart_insert(Art *selfp, StringView key, const void *valuep)
+{
+	CRZ_BOOL inserted =
+		crzart_insert_at(selfp, &selfp->root, key, 0, valuep);
+	selfp->len += inserted;
+	return inserted;
+}
+
+CRZ_BOOL crzart_remove(Art *selfp, StringView key)
+{
+	CRZ_BOOL removed = crzart_remove_at(selfp, &selfp->root, key, 0);
+	selfp->len -= removed;
+	return removed;
+}
+
+void *crzart_longest_prefix(const Art *selfp, StringView search,
+			    StringView *matchedp)
+{
+	const Crzart_Leaf *best = CRZ_NULL;
+	const void *node = selfp->root;
+	CRZ_SIZE depth = 0;
+	while (node != CRZ_NULL) {
+		if (crzart_kind(node) == CRZART_LEAF) {
+			const Crzart_Leaf *leaf = node;
+			CRZ_SIZE len = leaf->key.len;
+			if (len <= search.len &&
+			    CRZ_MEMCMP(leaf->key.ptr, search.ptr, len) == 0)
+				best = leaf;
+			break;
+		}
+
+		// Prefixes are checked in full, so the keys which end on the
+		// way down are prefixes of `search`
+		Crzart_Inner *inner = (Crzart_Inner *)node;
+		if (crzart_prefix_mismatch(inner, search, depth) <
+		    inner->prefix_len)
+			break;
+		depth += inner->prefix_len;
+		if (inner->end)
+			best = inner->end;
+		if (depth == search.len)
+			break;
+
+		void **child = crzart_find_child(inner, search.ptr[depth]);
+		if (child == CRZ_NULL)
+			break;
+		node = *child;
+		depth++;
+	}
+
+	if (best == CRZ_NULL)
+		return CRZ_NULL;
+	if (matchedp)
+		*matchedp = best->key;
+	return crzart_value(best);
+}
+
+ArtIter crzart_iter_prefix(const Art *selfp, StringView prefix)
+{
+	ArtIter iter = { .subtree = CRZ_NULL, .depth = 0, .leaf = CRZ_NULL };
+	const void *node = selfp->root;
+	CRZ_SIZE depth = 0;
+	while (node != CRZ_NULL) {
+		if (crzart_kind(node) == CRZART_LEAF) {
+			const Crzart_Leaf *leaf = node;
+			CRZ_SIZE len = prefix.len;
+			if (leaf->key.len >= len &&
+			    CRZ_MEMCMP(leaf->key.ptr, prefix.ptr, len) == 0)
+				iter.subtree = leaf;
+			break;
+		}
+
+		// Every key below a node whose path covers `prefix` has it
+		Crzart_Inner *inner = (Crzart_Inner *)node;
+		CRZ_SIZE remaining = prefix.len - depth;
+		CRZ_SIZE mismatch =
+			crzart_prefix_mismatch(inner, prefix, depth);
+		if (mismatch == remaining) {
+			iter.subtree = inner;
+			iter.depth = depth;
+			break;
+		}
+		if (mismatch < inner->prefix_len)
+			break;
+		depth += inner->prefix_len;
+
+		void **child = crzart_find_child(inner, prefix.ptr[depth]);
+		if (child == CRZ_NULL)
+			break;
+		node = *child;
+		depth++;
+	}
+	return iter;
+}
+
+CRZ_BOOL crzart_iter_next(ArtIter *iterp)
+{
+	if (iterp->subtree == CRZ_NULL)
+		return CRZ_FALSE;
+
+	iterp->leaf = iterp->leaf ? crzart_successor(iterp->subtree,
+						     iterp->depth,
+						     iterp->leaf->key) :
+				    crzart_min_leaf(iterp->subtree);
+	if (iterp->leaf == CRZ_NULL) {
+		iterp->subtree = CRZ_NULL;
+		return CRZ_FALSE;
+	}
+	iterp->key = iterp->leaf->key;
+	iterp->value = crzart_value(iterp->leaf);
+	return CRZ_TRUE;
+}
+
+void crzart_free(Art *selfp)
+{
+	// Every node is in a pool, so there is no need to walk the tree
+	for (CRZ_SIZE kind = 0; kind < CRZART_KINDS; kind++)
+		POOL_FREE(&selfp->pools[kind]);
+	selfp->root = CRZ_NULL;
+	selfp->len = 0;
+}
+
+#endif // CRZART_H_
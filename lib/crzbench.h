@@ -0,0 +1,200 @@
+#ifndef CRZBENCH_H_
+#define CRZBENCH_H_
+
+#include "crzdef.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/// The amount of untimed runs to perform before sampling each `BENCH`.
+#ifndef CRZBENCH_WARMUP
+#define CRZBENCH_WARMUP 10
+#endif // CRZBENCH_WARMUP
+
+/// The amount of timed runs to sample for each `BENCH`.
+#ifndef CRZBENCH_SAMPLES
+#define CRZBENCH_SAMPLES 100
+#endif // CRZBENCH_SAMPLES
+
+/// The clock used to time each run, in nanoseconds.
+#ifndef CRZBENCH_NOW
+#define CRZBENCH_NOW crzbench_now
+#endif // CRZBENCH_NOW
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BENCH_BEFORE_EACH(cb)` instead.
+static void (*crzbench_before_each_cb)(void) = CRZ_NULL;
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BENCH_AFTER_EACH(cb)` instead.
+static void (*crzbench_after_each_cb)(void) = CRZ_NULL;
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BENCH_GROUP(header, block)` instead.
+static int crzbench_padding = 0;
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BENCH_GROUP(header, block)` instead.
+static const char *crzbench_group = "";
+/// INTERNAL: you most likely don't want to use this.
+///           The file machine-readable results are written to, if any.
+static FILE *crzbench_output = CRZ_NULL;
+/// INTERNAL: you most likely don't want to use this.
+///           The timings of each sampled run of the current `BENCH`.
+static unsigned long long crzbench_samples[CRZBENCH_SAMPLES];
+
+/// Define the `main` function for the benchmark file.
+///
+/// If the program is given an argument, the results are also written to that path as CSV, with a header row of:
+///   `group,bench,ops,min_ns,median_ns,p99_ns,ops_per_sec`
+/// so that runs can be compared with one another.
+#define BENCH_MAIN(block)                                                   \
+	int main(int argc, char **argv)                                     \
+	{                                                                   \
+		if (argc > 1) {                                             \
+			crzbench_output = fopen(argv[1], "w");              \
+			CRZ_ASSERT(crzbench_output &&                       \
+				   "Could not open benchmark output file"); \
+			fprintf(crzbench_output,                            \
+				"group,bench,ops,min_ns,median_ns,p99_ns,"  \
+				"ops_per_sec\n");                           \
+		}                                                           \
+		do {                                                        \
+			block;                                              \
+		} while (0);                                                \
+		if (crzbench_output)                                        \
+			fclose(crzbench_output);                            \
+		return 0;                                                   \
+	}
+
+/// Prevent the compiler from optimizing away the computation of `value`.
+#if defined(__GNUC__)
+#define BENCH_DO_NOT_OPTIMIZE(value) \
+	__asm__ volatile("" : : "r,m"(value) : "memory")
+#else
+static volatile const void *crzbench_sink;
+#define BENCH_DO_NOT_OPTIMIZE(value) (crzbench_sink = &(value))
+#endif
+
+/// Prevent the compiler from reordering memory accesses across this point.
+#if defined(__GNUC__)
+#define BENCH_CLOBBER() __asm__ volatile("" : : : "memory")
+#else
+#define BENCH_CLOBBER() ((void)0)
+#endif
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BENCH_GROUP(header, block)` instead.
+#define CRZBENCH_PRINT_PADDING()                             \
+	do {                                                 \
+		for (int i = 0; i < crzbench_padding; i++) { \
+			CRZ_DEBUG(" ");                      \
+		}                                            \
+	} while (0)
+
+/// Define a group of benchmarks.
+#define BENCH_GROUP(header, block)                                \
+	do {                                                      \
+		const char *crz__previous_group = crzbench_group; \
+		crzbench_group = (header);                        \
+		CRZBENCH_PRINT_PADDING();                         \
+		CRZ_DEBUG("GROUP: %s\n", header);                 \
+                                                                  \
+		crzbench_padding += 2;                            \
+		do {                                              \
+			block;                                    \
+		} while (0);                                      \
+		crzbench_padding -= 2;                            \
+		crzbench_group = crz__previous_group;             \
+	} while (0)
+
+/// Define a callback to run before each run of a `BENCH`. The callback is not timed.
+#define BENCH_BEFORE_EACH(cb)                 \
+	do {                                  \
+		crzbench_before_each_cb = cb; \
+	} while (0)
+
+/// Define a callback to run after each run of a `BENCH`. The callback is not timed.
+#define BENCH_AFTER_EACH(cb)                 \
+	do {                                 \
+		crzbench_after_each_cb = cb; \
+	} while (0)
+
+/// Define a benchmark, where each run of `block` performs `ops` operations.
+///
+/// `block` is run `CRZBENCH_WARMUP` times without being timed, and then `CRZBENCH_SAMPLES` times while being timed.
+/// The minimum, median and 99th percentile of the sampled runs are reported, alongside the operations per second (at the median).
+#define BENCH(header, ops, block)                                              \
+	do {                                                                   \
+		for (int crz__run = 0;                                         \
+		     crz__run < CRZBENCH_WARMUP + CRZBENCH_SAMPLES;            \
+		     crz__run++) {                                             \
+			if (crzbench_before_each_cb)                           \
+				crzbench_before_each_cb();                     \
+			BENCH_CLOBBER();                                       \
+			unsigned long long crz__start = CRZBENCH_NOW();        \
+			do {                                                   \
+				block;                                         \
+			} while (0);                                           \
+			BENCH_CLOBBER();                                       \
+			unsigned long long crz__end = CRZBENCH_NOW();          \
+			if (crz__run >= CRZBENCH_WARMUP)                       \
+				crzbench_samples[crz__run - CRZBENCH_WARMUP] = \
+					crz__end - crz__start;                 \
+			if (crzbench_after_each_cb)                            \
+				crzbench_after_each_cb();                      \
+		}                                                              \
+		crzbench_report((header), (ops));                              \
+	} while (0)
+
+/// INTERNAL: this is the default for `CRZBENCH_NOW`, a monotonic clock in nanoseconds.
+unsigned long long crzbench_now(void);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BENCH(header, ops, block)` instead.
+void crzbench_report(const char *header, unsigned long long ops);
+
+/// INTERNAL: the comparison function used to sort the samples of a `BENCH`.
+int crzbench_compare(const void *a, const void *b);
+
+unsigned long long crzbench_now(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ull +
+	       (unsigned long long)now.tv_nsec;
+}
+
+int crzbench_compare(const void *a, const void *b)
+{
+	unsigned long long left = *(const unsigned long long *)a;
+	unsigned long long right = *(const unsigned long long *)b;
+	return (left > right) - (left < right);
+}
+
+void crzbench_report(const char *header, unsigned long long ops)
+{
+	qsort(crzbench_samples, CRZBENCH_SAMPLES, sizeof(*crzbench_samples),
+	      crzbench_compare);
+
+	// Nearest-rank percentiles over the sorted samples
+	unsigned long long min = crzbench_samples[0];
+	unsigned long long median =
+		crzbench_samples[(CRZBENCH_SAMPLES - 1) / 2];
+	unsigned long long p99 =
+		crzbench_samples[(CRZBENCH_SAMPLES * 99 + 99) / 100 - 1];
+	double ops_per_sec =
+		median == 0 ? 0.0 : (double)ops * 1000000000.0 / (double)median;
+
+	CRZBENCH_PRINT_PADDING();
+	CRZ_DEBUG("BENCH: %s\n", header);
+	CRZBENCH_PRINT_PADDING();
+	CRZ_DEBUG("  min %llu ns, median %llu ns, p99 %llu ns, %.0f ops/s\n",
+		  min, median, p99, ops_per_sec);
+
+	if (crzbench_output) {
+		fprintf(crzbench_output,
+			"\"%s\",\"%s\",%llu,%llu,%llu,%llu,%.0f\n",
+			crzbench_group, header, ops, min, median, p99,
+			ops_per_sec);
+	}
+}
+
+#endif // CRZBENCH_H_
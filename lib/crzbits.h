@@ -0,0 +1,630 @@
+#ifndef CRZBITS_H_
+#define CRZBITS_H_
+
+#include "crzarr.h"
+#include "crzdef.h"
+#include <stdint.h>
+
+/// The amount of set bits in the 64-bit word `word`, as for `CRZ_POPCOUNT`.
+#ifndef CRZBITS_POPCOUNT
+#define CRZBITS_POPCOUNT(word) CRZ_POPCOUNT(word)
+#endif // CRZBITS_POPCOUNT
+
+/// The amount of trailing zero bits in the 64-bit word `word`, which must not be 0, as for `CRZ_CTZ`.
+#ifndef CRZBITS_CTZ
+#define CRZBITS_CTZ(word) CRZ_CTZ(word)
+#endif // CRZBITS_CTZ
+
+/// The amount of leading zero bits in the 64-bit word `word`, which must not be 0, as for `CRZ_CLZ`.
+#ifndef CRZBITS_CLZ
+#define CRZBITS_CLZ(word) CRZ_CLZ(word)
+#endif // CRZBITS_CLZ
+
+/// The value returned by `BITSET_NEXT` when there are no more set bits.
+#define CRZBITS_NONE ((CRZ_SIZE)-1)
+
+/// The largest amount of values a container of a `Roaring` bitmap stores as a sorted array, rather than as a bitmap.
+///
+/// At this amount, the array takes up as much memory as the bitmap would.
+#define CRZBITS_ARRAY_MAX 4096
+
+/// The amount of words in the bitmap of a container of a `Roaring` bitmap.
+#define CRZBITS_BITMAP_WORDS 1024
+
+/// A dynamic bitset, stored as a dynamic array of 64-bit words.
+///
+/// Bit `i` is bit `i % 64` of the word at index `i / 64`.
+/// Bits past the end of the array are treated as unset, and the array grows as bits are set.
+typedef ARRAY(uint64_t) Bitset;
+
+/// INTERNAL: you most likely don't want to use this.
+///           This is a container of a `Roaring` bitmap, holding all of the values whose upper 16 bits are `key`.
+///
+/// While `cardinality` is at most `CRZBITS_ARRAY_MAX`, the lower 16 bits of the values are kept in `values`, sorted, and `bitmap` is `CRZ_NULL`.
+/// Otherwise, they are kept as the bits of `bitmap`, which has `CRZBITS_BITMAP_WORDS` words, and `values` is empty.
+typedef struct {
+	uint16_t key;
+	CRZ_SIZE cardinality;
+	ARRAY(uint16_t) values;
+	uint64_t *bitmap;
+} Crzbits_Container;
+
+/// A compressed bitmap of 32-bit values, for sets which are too sparse for a `Bitset`.
+///
+/// The values are split by their upper 16 bits into containers, sorted by key, each of which stores the lower 16 bits as either a sorted array or a bitmap, whichever is smaller.
+typedef ARRAY(Crzbits_Container) Roaring;
+
+/// Zero-initialize a bitset.
+#define BITSET_NEW() ARRAY_NEW()
+
+/// Properly initialize a bitset.
+///
+/// This is not required, and does not perform any allocations.
+#define BITSET_INIT(selfp) ARRAY_INIT(selfp)
+
+/// Set the bit `bit` of the bitset `selfp` (passed by pointer).
+///
+/// Grows the bitset to include `bit`, if needed.
+#define BITSET_SET(selfp, bit) crzbits_set((selfp), (bit))
+
+/// Clear the bit `bit` of the bitset `selfp` (passed by pointer).
+#define BITSET_CLEAR(selfp, bit) crzbits_clear((selfp), (bit))
+
+/// Whether the bit `bit` of the bitset `self` is set.
+#define BITSET_TEST(self, bit) crzbits_test(&(self), (bit))
+
+/// Get the amount of set bits in the bitset `self`.
+#define BITSET_COUNT(self) crzbits_count(&(self))
+
+/// Get the index of the first set bit of the bitset `self` at or after `from`.
+///
+/// If there is no such bit, returns `CRZBITS_NONE`.
+#define BITSET_NEXT(self, from) crzbits_next(&(self), (from))
+
+/// Iterate over the indexes of the set bits of the bitset `self` in ascending order, naming the index variable `bit`.
+#define BITSET_FOR(self, bit)                                              \
+	for (CRZ_SIZE bit = crzbits_next(&(self), 0); bit != CRZBITS_NONE; \
+	     bit = crzbits_next(&(self), bit + 1))
+
+/// Set the bitset `selfp` (passed by pointer) to its intersection with the bitset `other`.
+#define BITSET_AND(selfp, other) crzbits_and((selfp), &(other))
+
+/// Set the bitset `selfp` (passed by pointer) to its union with the bitset `other`.
+#define BITSET_OR(selfp, other) crzbits_or((selfp), &(other))
+
+/// Set the bitset `selfp` (passed by pointer) to its symmetric difference with the bitset `other`.
+#define BITSET_XOR(selfp, other) crzbits_xor((selfp), &(other))
+
+/// Clear every bit of the bitset `selfp` (passed by pointer) which is set in the bitset `other`.
+#define BITSET_ANDNOT(selfp, other) crzbits_andnot((selfp), &(other))
+
+/// Print out the indexes of the set bits of the bitset `self`.
+#define BITSET_DEBUG(self)                                     \
+	do {                                                   \
+		CRZ_DEBUG("{");                                \
+		BITSET_FOR(self, crz__bit) {                   \
+			CRZ_DEBUG(" " CRZ_SIZE_FMT, crz__bit); \
+		}                                              \
+		CRZ_DEBUG(" }\n");                             \
+	} while (0)
+
+/// Free the space allocated for the bitset `selfp` (passed by pointer), and empty-out the fields of the struct.
+#define BITSET_FREE(selfp) ARRAY_FREE(selfp)
+
+/// Zero-initialize a compressed bitmap.
+#define ROARING_NEW() ARRAY_NEW()
+
+/// Properly initialize a compressed bitmap.
+///
+/// This is not required, and does not perform any allocations.
+#define ROARING_INIT(selfp) ARRAY_INIT(selfp)
+
+/// Add the 32-bit value `value` to the compressed bitmap `selfp` (passed by pointer).
+#define ROARING_ADD(selfp, value) crzbits_roaring_add((selfp), (value))
+
+/// Remove the 32-bit value `value` from the compressed bitmap `selfp` (passed by pointer).
+#define ROARING_REMOVE(selfp, value) crzbits_roaring_remove((selfp), (value))
+
+/// Whether the compressed bitmap `self` contains the 32-bit value `value`.
+#define ROARING_CONTAINS(self, value) \
+	crzbits_roaring_contains(&(self), (value))
+
+/// Get the amount of values in the compressed bitmap `self`.
+#define ROARING_COUNT(self) crzbits_roaring_count(&(self))
+
+/// Set the compressed bitmap `outp` (passed by pointer) to the intersection of the compressed bitmaps `self` and `other`.
+///
+/// `outp` must be empty, and must be freed independently of `self` and `other`.
+#define ROARING_AND(self, other, outp) \
+	crzbits_roaring_and(&(self), &(other), (outp))
+
+/// Set the compressed bitmap `outp` (passed by pointer) to the union of the compressed bitmaps `self` and `other`.
+///
+/// `outp` must be empty, and must be freed independently of `self` and `other`.
+#define ROARING_OR(self, other, outp) \
+	crzbits_roaring_or(&(self), &(other), (outp))
+
+/// Free the space allocated for the containers of the compressed bitmap `selfp` (passed by pointer), and empty-out the fields of the struct.
+#define ROARING_FREE(selfp)                                                \
+	do {                                                               \
+		ARRAY_FOR(*(selfp), crz__index) {                          \
+			crzbits_container_free(&(selfp)->ptr[crz__index]); \
+		}                                                          \
+		ARRAY_FREE(selfp);                                         \
+	} while (0)
+
+/// INTERNAL: this function grows the bitset `selfp` to `words` words, clearing the new ones.
+void crzbits_grow_to(Bitset *selfp, CRZ_SIZE words);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BITSET_SET(selfp, bit)` instead.
+void crzbits_set(Bitset *selfp, CRZ_SIZE bit);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BITSET_CLEAR(selfp, bit)` instead.
+void crzbits_clear(Bitset *selfp, CRZ_SIZE bit);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BITSET_TEST(self, bit)` instead.
+CRZ_BOOL crzbits_test(const Bitset *selfp, CRZ_SIZE bit);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BITSET_COUNT(self)` instead.
+CRZ_SIZE crzbits_count(const Bitset *selfp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BITSET_NEXT(self, from)` instead.
+CRZ_SIZE crzbits_next(const Bitset *selfp, CRZ_SIZE from);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BITSET_AND(selfp, other)` instead.
+void crzbits_and(Bitset *selfp, const Bitset *otherp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BITSET_OR(selfp, other)` instead.
+void crzbits_or(Bitset *selfp, const Bitset *otherp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BITSET_XOR(selfp, other)` instead.
+void crzbits_xor(Bitset *selfp, const Bitset *otherp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BITSET_ANDNOT(selfp, other)` instead.
+void crzbits_andnot(Bitset *selfp, const Bitset *otherp);
+
+/// INTERNAL: this function frees the space allocated for a container of a compressed bitmap.
+void crzbits_container_free(Crzbits_Container *containerp);
+
+/// INTERNAL: this function allocates a cleared bitmap for a container of a compressed bitmap.
+uint64_t *crzbits_bitmap_new(void);
+
+/// INTERNAL: this function checks whether a container of a compressed bitmap has the lower 16 bits `low`.
+CRZ_BOOL crzbits_container_contains(const Crzbits_Container *containerp,
+				    uint16_t low);
+
+/// INTERNAL: this function converts a container of a compressed bitmap to an array or to a bitmap, whichever is smaller for its cardinality.
+void crzbits_container_normalize(Crzbits_Container *containerp);
+
+/// INTERNAL: this function finds the index of the container with key `key` in a compressed bitmap.
+///           If there is no such container, returns `CRZ_FALSE`, and the index is where it would be inserted.
+CRZ_BOOL crzbits_roaring_find(const Roaring *selfp, uint16_t key,
+			      CRZ_SIZE *indexp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ROARING_ADD(selfp, value)` instead.
+void crzbits_roaring_add(Roaring *selfp, uint32_t value);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ROARING_REMOVE(selfp, value)` instead.
+void crzbits_roaring_remove(Roaring *selfp, uint32_t value);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ROARING_CONTAINS(self, value)` instead.
+CRZ_BOOL crzbits_roaring_contains(const Roaring *selfp, uint32_t value);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ROARING_COUNT(self)` instead.
+CRZ_SIZE crzbits_roaring_count(const Roaring *selfp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ROARING_AND(self, other, outp)` instead.
+void crzbits_roaring_and(const Roaring *selfp, const Roaring *otherp,
+			 Roaring *outp);
+
+/// INTERNAL: this function sets the empty container `resultp` to the union of the containers `a` and `b` of compressed bitmaps.
+void crzbits_container_union(const Crzbits_Container *a,
+			     const Crzbits_Container *b,
+			     Crzbits_Container *resultp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ROARING_OR(self, other, outp)` instead.
+void crzbits_roaring_or(const Roaring *selfp, const Roaring *otherp,
+			Roaring *outp);
+
+void crzbits_grow_to(Bitset *selfp, CRZ_SIZE words)
+{
+	if (selfp->len >= words)
+		return;
+
+	crzarr_grow_to((Crzarr_AnyArray *)selfp, words, sizeof(uint64_t));
+	for (CRZ_SIZE i = selfp->len; i < words; i++)
+		selfp->ptr[i] = 0;
+	selfp->len = words;
+}
+
+void crzbits_set(Bitset *selfp, CRZ_SIZE bit)
+{
+	crzbits_grow_to(selfp, bit / 64 + 1);
+	selfp->ptr[bit / 64] |= 1ull << (bit % 64);
+}
+
+void crzbits_clear(Bitset *selfp, CRZ_SIZE bit)
+{
+	if (bit / 64 < selfp->len)
+		selfp->ptr[bit / 64] &= ~(1ull << (bit % 64));
+}
+
+CRZ_BOOL crzbits_test(const Bitset *selfp, CRZ_SIZE bit)
+{
+	return bit / 64 < selfp->len &&
+	       (selfp->ptr[bit / 64] >> (bit % 64) & 1) != 0;
+}
+
+CRZ_SIZE crzbits_count(const Bitset *selfp)
+{
+	CRZ_SIZE count = 0;
+	for (CRZ_SIZE i = 0; i < selfp->len; i++)
+		count += CRZBITS_POPCOUNT(selfp->ptr[i]);
+	return count;
+}
+
+CRZ_SIZE crzbits_next(const Bitset *selfp, CRZ_SIZE from)
+{
+	CRZ_SIZE word = from / 64;
+	if (from == CRZBITS_NONE || word >= selfp->len)
+		return CRZBITS_NONE;
+
+	// Mask out the bits before `from` in its own word
+	uint64_t bits = selfp->ptr[word] & (~0ull << (from % 64));
+	while (bits == 0) {
+		word++;
+		if (word >= selfp->len)
+			return CRZBITS_NONE;
+		bits = selfp->ptr[word];
+	}
+	return word * 64 + CRZBITS_CTZ(bits);
+}
+
+// The word loops below have no dependencies between iterations,
+// so that the compiler is free to vectorize them
+void crzbits_and(Bitset *selfp, const Bitset *otherp)
+{
+	CRZ_SIZE shared = selfp->len < otherp->len ? selfp->len : otherp->len;
+	for (CRZ_SIZE i = 0; i < shared; i++)
+		selfp->ptr[i] &= otherp->ptr[i];
+	for (CRZ_SIZE i = shared; i < selfp->len; i++)
+		selfp->ptr[i] = 0;
+}
+
+void crzbits_or(Bitset *selfp, const Bitset *otherp)
+{
+	crzbits_grow_to(selfp, otherp->len);
+	for (CRZ_SIZE i = 0; i < otherp->len; i++)
+		selfp->ptr[i] |= otherp->ptr[i];
+}
+
+void crzbits_xor(Bitset *selfp, const Bitset *otherp)
+{
+	crzbits_grow_to(selfp, otherp->len);
+	for (CRZ_SIZE i = 0; i < otherp->len; i++)
+		selfp->ptr[i] ^= otherp->ptr[i];
+}
+
+void crzbits_andnot(Bitset *selfp, const Bitset *otherp)
+{
+	CRZ_SIZE shared = selfp->len < otherp->len ? selfp->len : otherp->len;
+	for (CRZ_SIZE i = 0; i < shared; i++)
+		selfp->ptr[i] &= ~otherp->ptr[i];
+}
+
+void crzbits_container_free(Crzbits_Container *containerp)
+{
+	ARRAY_FREE(&containerp->values);
+	CRZ_FREE(containerp->bitmap);
+	containerp->bitmap = CRZ_NULL;
+	containerp->cardinality = 0;
+}
+
+uint64_t *crzbits_bitmap_new(void)
+{
+	uint64_t *bitmap = CRZ_MALLOC(sizeof(uint64_t) * CRZBITS_BITMAP_WORDS);
+	CRZ_ASSERT(bitmap && "Out of memory when allocating bitmap container");
+	for (CRZ_SIZE i = 0; i < CRZBITS_BITMAP_WORDS; i++)
+		bitmap[i] = 0;
+	return bitmap;
+}
+
+CRZ_BOOL crzbits_container_contains(const Crzbits_Container *containerp,
+				    uint16_t low)
+{
+	if (containerp->bitmap)
+		return (containerp->bitmap[low / 64] >> (low % 64) & 1) != 0;
+
+	CRZ_SIZE start = 0;
+	CRZ_SIZE end = containerp->values.len;
+	while (start < end) {
+		CRZ_SIZE middle = start + (end - start) / 2;
+		if (containerp->values.ptr[middle] < low)
+			start = middle + 1;
+		else
+			end = middle;
+	}
+	return start < containerp->values.len &&
+	       containerp->values.ptr[start] == low;
+}
+
+void crzbits_container_normalize(Crzbits_Container *containerp)
+{
+	if (containerp->bitmap == CRZ_NULL &&
+	    containerp->cardinality > CRZBITS_ARRAY_MAX) {
+		containerp->bitmap = crzbits_bitmap_new();
+		ARRAY_FOR(containerp->values, i) {
+			uint16_t low = containerp->values.ptr[i];
+			containerp->bitmap[low / 64] |= 1ull << (low % 64);
+		}
+		ARRAY_FREE(&containerp->values);
+	} else if (containerp->bitmap != CRZ_NULL &&
+		   containerp->cardinality <= CRZBITS_ARRAY_MAX) {
+		crzarr_grow_to((Crzarr_AnyArray *)&containerp->values,
+			       containerp->cardinality, sizeof(uint16_t));
+		for (CRZ_SIZE i = 0; i < CRZBITS_BITMAP_WORDS; i++) {
+			uint64_t bits = containerp->bitmap[i];
+			while (bits != 0) {
+				CRZ_SIZE low = i * 64 + CRZBITS_CTZ(bits);
+				ARRAY_PUSH(&containerp->values, (uint16_t)low);
+				// Clear the lowest set bit
+				bits &= bits - 1;
+			}
+		}
+		CRZ_FREE(containerp->bitmap);
+		containerp->bitmap = CRZ_NULL;
+	}
+}
+
+CRZ_BOOL crzbits_roaring_find(const Roaring *selfp, uint16_t key,
+			      CRZ_SIZE *indexp)
+{
+	CRZ_SIZE start = 0;
+	CRZ_SIZE end = selfp->len;
+	while (start < end) {
+		CRZ_SIZE middle = start + (end - start) / 2;
+		if (selfp->ptr[middle].key < key)
+			start = middle + 1;
+		else
+			end = middle;
+	}
+	*indexp = start;
+	return start < selfp->len && selfp->ptr[start].key == key;
+}
+
+void crzbits_roaring_add(Roaring *selfp, uint32_t value)
+{
+	uint16_t key = (uint16_t)(value >> 16);
+	uint16_t low = (uint16_t)value;
+	CRZ_SIZE index;
+
+	if (!crzbits_roaring_find(selfp, key, &index)) {
+		Crzbits_Container container = {
+			.key = key,
+			.cardinality = 0,
+			.values = ARRAY_NEW(),
+			.bitmap = CRZ_NULL,
+		};
+		ARRAY_INSERT(selfp, index, &container, 1);
+	}
+
+	Crzbits_Container *containerp = &selfp->ptr[index];
+	if (crzbits_container_contains(containerp, low))
+		return;
+
+	if (containerp->bitmap) {
+		containerp->bitmap[low / 64] |= 1ull << (low % 64);
+	} else {
+		// Find the position which keeps the values sorted
+		CRZ_SIZE position = containerp->values.len;
+		while (position > 0 &&
+		       containerp->values.ptr[position - 1] > low)
+			position--;
+		ARRAY_INSERT(&containerp->values, position, &low, 1);
+	}
+	containerp->cardinality += 1;
+	crzbits_container_normalize(containerp);
+}
+
+void crzbits_roaring_remove(Roaring *selfp, uint32_t value)
+{
+	uint16_t key = (uint16_t)(value >> 16);
+	uint16_t low = (uint16_t)value;
+	CRZ_SIZE index;
+
+	if (!crzbits_roaring_find(selfp, key, &index))
+		return;
+
+	Crzbits_Container *containerp = &selfp->ptr[index];
+	if (!crzbits_container_contains(containerp, low))
+		return;
+
+	if (containerp->bitmap) {
+		containerp->bitmap[low / 64] &= ~(1ull << (low % 64));
+	} else {
+		CRZ_SIZE position = 0;
+		while (containerp->values.ptr[position] != low)
+			position++;
+		ARRAY_REMOVE(&containerp->values, position, 1);
+	}
+	containerp->cardinality -= 1;
+
+	if (containerp->cardinality == 0) {
+		crzbits_container_free(containerp);
+		ARRAY_REMOVE(selfp, index, 1);
+	} else {
+		crzbits_container_normalize(containerp);
+	}
+}
+
+CRZ_BOOL crzbits_roaring_contains(const Roaring *selfp, uint32_t value)
+{
+	CRZ_SIZE index;
+	return crzbits_roaring_find(selfp, (uint16_t)(value >> 16), &index) &&
+	       crzbits_container_contains(&selfp->ptr[index], (uint16_t)value);
+}
+
+CRZ_SIZE crzbits_roaring_count(const Roaring *selfp)
+{
+	CRZ_SIZE count = 0;
+	ARRAY_FOR(*selfp, i) {
+		count += selfp->ptr[i].cardinality;
+	}
+	return count;
+}
+
+void crzbits_roaring_and(const Roaring *selfp, const Roaring *otherp,
+			 Roaring *outp)
+{
+	CRZ_SIZE i = 0;
+	CRZ_SIZE j = 0;
+
+	while (i < selfp->len && j < otherp->len) {
+		const Crzbits_Container *a = &selfp->ptr[i];
+		const Crzbits_Container *b = &otherp->ptr[j];
+		if (a->key < b->key) {
+			i++;
+			continue;
+		}
+		if (b->key < a->key) {
+			j++;
+			continue;
+		}
+
+		Crzbits_Container result = {
+			.key = a->key,
+			.cardinality = 0,
+			.values = ARRAY_NEW(),
+			.bitmap = CRZ_NULL,
+		};
+
+		if (a->bitmap && b->bitmap) {
+			result.bitmap = crzbits_bitmap_new();
+			for (CRZ_SIZE k = 0; k < CRZBITS_BITMAP_WORDS; k++) {
+				result.bitmap[k] = a->bitmap[k] & b->bitmap[k];
+				result.cardinality +=
+					CRZBITS_POPCOUNT(result.bitmap[k]);
+			}
+		} else {
+			// Test each value of the array in the other container
+			const Crzbits_Container *array = a->bitmap ? b : a;
+			const Crzbits_Container *other = a->bitmap ? a : b;
+			ARRAY_FOR(array->values, k) {
+				uint16_t low = array->values.ptr[k];
+				if (crzbits_container_contains(other, low))
+					ARRAY_PUSH(&result.values, low);
+			}
+			result.cardinality = result.values.len;
+		}
+
+		if (result.cardinality == 0) {
+			crzbits_container_free(&result);
+		} else {
+			crzbits_container_normalize(&result);
+			ARRAY_PUSH(outp, result);
+		}
+		i++;
+		j++;
+	}
+}
+
+void crzbits_container_union(const Crzbits_Container *a,
+			     const Crzbits_Container *b,
+			     Crzbits_Container *resultp)
+{
+	CRZ_SIZE upper_bound = a->cardinality + b->cardinality;
+
+	if (a->bitmap || b->bitmap || upper_bound > CRZBITS_ARRAY_MAX) {
+		resultp->bitmap = crzbits_bitmap_new();
+		const Crzbits_Container *sides[2] = { a, b };
+		for (CRZ_SIZE side = 0; side < 2; side++) {
+			const Crzbits_Container *containerp = sides[side];
+			if (containerp->bitmap) {
+				for (CRZ_SIZE i = 0; i < CRZBITS_BITMAP_WORDS;
+				     i++)
+					resultp->bitmap[i] |=
+						containerp->bitmap[i];
+				continue;
+			}
+			ARRAY_FOR(containerp->values, i) {
+				uint16_t low = containerp->values.ptr[i];
+				resultp->bitmap[low / 64] |= 1ull << (low % 64);
+			}
+		}
+		for (CRZ_SIZE i = 0; i < CRZBITS_BITMAP_WORDS; i++)
+			resultp->cardinality +=
+				CRZBITS_POPCOUNT(resultp->bitmap[i]);
+		return;
+	}
+
+	// Merge the two sorted arrays
+	crzarr_grow_to((Crzarr_AnyArray *)&resultp->values, upper_bound,
+		       sizeof(uint16_t));
+	CRZ_SIZE i = 0;
+	CRZ_SIZE j = 0;
+	while (i < a->values.len || j < b->values.len) {
+		CRZ_BOOL has_left = i < a->values.len;
+		CRZ_BOOL has_right = j < b->values.len;
+		uint16_t left = has_left ? a->values.ptr[i] : 0;
+		uint16_t right = has_right ? b->values.ptr[j] : 0;
+		// Take from both sides when their values are equal
+		CRZ_BOOL take_left = !has_right || (has_left && left <= right);
+		CRZ_BOOL take_right = !has_left || (has_right && right <= left);
+
+		resultp->values.ptr[resultp->values.len++] =
+			take_left ? left : right;
+		i += take_left;
+		j += take_right;
+	}
+	resultp->cardinality = resultp->values.len;
+}
+
+void crzbits_roaring_or(const Roaring *selfp, const Roaring *otherp,
+			Roaring *outp)
+{
+	static const Crzbits_Container empty = { 0 };
+	CRZ_SIZE i = 0;
+	CRZ_SIZE j = 0;
+
+	while (i < selfp->len || j < otherp->len) {
+		const Crzbits_Container *a =
+			i < selfp->len ? &selfp->ptr[i] : &empty;
+		const Crzbits_Container *b =
+			j < otherp->len ? &otherp->ptr[j] : &empty;
+		// Take from the side with the smaller key, or both when equal
+		CRZ_BOOL take_a = j >= otherp->len ||
+				  (i < selfp->len && a->key <= b->key);
+		CRZ_BOOL take_b = i >= selfp->len ||
+				  (j < otherp->len && b->key <= a->key);
+
+		Crzbits_Container result = {
+			.key = take_a ? a->key : b->key,
+			.cardinality = 0,
+			.values = ARRAY_NEW(),
+			.bitmap = CRZ_NULL,
+		};
+		crzbits_container_union(take_a ? a : &empty,
+					take_b ? b : &empty, &result);
+		crzbits_container_normalize(&result);
+		ARRAY_PUSH(outp, result);
+		i += take_a;
+		j += take_b;
+	}
+}
+
+#endif // CRZBITS_H_
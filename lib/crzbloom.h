@@ -0,0 +1,573 @@
+#ifndef CRZBLOOM_H_
+#define CRZBLOOM_H_
+
+#include "crzdef.h"
+#include "crzhash.h"
+#include "crzstats.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__) && !defined(CRZBLOOM_NO_SIMD)
+#include <immintrin.h>
+#define CRZBLOOM_AVX2
+#endif
+
+/// The size in bytes of each block of a `BloomFilter`, which every key is confined to.
+///
+/// Blocks are aligned to their size, which divides a cache line, so adding or checking a key only ever touches one cache line.
+#define CRZBLOOM_BLOCK_SIZE 32
+
+/// The amount of 32-bit lanes in each block of a `BloomFilter`, which is also the amount of bits set for each key.
+#define CRZBLOOM_LANES (CRZBLOOM_BLOCK_SIZE / 4)
+
+/// The amount of fingerprints in each bucket of a `CuckooFilter`.
+#define CRZBLOOM_BUCKET_SIZE 4
+
+/// The amount of times `CUCKOO_FILTER_ADD` moves a fingerprint to its other bucket before giving up.
+#ifndef CRZBLOOM_MAX_KICKS
+#define CRZBLOOM_MAX_KICKS 500
+#endif // CRZBLOOM_MAX_KICKS
+
+/// A blocked Bloom filter, answering whether a key may have been added to it, or was definitely not.
+///
+/// Each key hashes to a single `CRZBLOOM_BLOCK_SIZE` block, and sets one bit in each of its `CRZBLOOM_LANES` 32-bit lanes, all at once using AVX2 where available.
+/// AVX2 is off by default, since the default flags only enable SSE2, so it must be enabled when compiling, such as with `-mavx2`, and defining `CRZBLOOM_NO_SIMD` turns it off again.
+/// This keeps every operation to one cache miss, at the cost of a few more bits per key than an unblocked filter needs for the same false positive rate.
+typedef struct {
+	uint32_t *blocks;
+	/// The allocation `blocks` was aligned within.
+	void *allocation;
+	CRZ_SIZE block_count;
+} BloomFilter;
+
+/// A cuckoo filter, which answers the same as a `BloomFilter`, but also supports removing keys.
+///
+/// It stores a 16-bit fingerprint of each key in one of two buckets of `CRZBLOOM_BUCKET_SIZE` slots, so removing a key removes one copy of its fingerprint.
+/// Only remove keys which were added, otherwise another key sharing its fingerprint may be removed instead.
+typedef struct {
+	/// The buckets, each as `CRZBLOOM_BUCKET_SIZE` fingerprints packed into 64 bits, where 0 is an empty slot.
+	uint64_t *buckets;
+	/// The amount of buckets, as a power of 2.
+	CRZ_SIZE bucket_count;
+	CRZ_SIZE len;
+	/// A fingerprint which could not be placed, along with one of its buckets.
+	uint16_t victim;
+	CRZ_SIZE victim_index;
+	/// The state of the random choices of which fingerprint to move.
+	uint64_t random;
+} CuckooFilter;
+
+/// Define a struct for a hash table with values of type `T`, which keeps a `BloomFilter` of its keys alongside itself.
+///
+/// Getting a key which was never inserted is then usually rejected by the filter, without probing the table or comparing any keys.
+/// The table itself is `table`, so any of the `HASH_TABLE_*` macros which do not insert may be used on it directly.
+#define FILTERED_HASH_TABLE(T)       \
+	struct {                     \
+		HASH_TABLE(T) table; \
+		BloomFilter filter;  \
+	}
+
+/// Zero-initialize a Bloom filter.
+///
+/// Requires calling `BLOOM_FILTER_INIT` afterwards.
+#define BLOOM_FILTER_NEW()                                                   \
+	{                                                                    \
+		.blocks = CRZ_NULL, .allocation = CRZ_NULL, .block_count = 0 \
+	}
+
+/// Properly initialize the Bloom filter `selfp` (passed by pointer), for `expected_keys` keys at a false positive rate of `false_positive_rate`.
+///
+/// Adding more keys than `expected_keys` keeps the filter correct, but raises its false positive rate.
+#define BLOOM_FILTER_INIT(selfp, expected_keys, false_positive_rate) \
+	crzbloom_init((selfp), (expected_keys), (false_positive_rate))
+
+/// Add the key `key` (a `CRZ_STRING`) to the Bloom filter `selfp` (passed by pointer).
+///
+/// Keys are hashed with `CRZHASH_HASH`, so they match under the same equality as the hash tables of `crzhash` initialized using `HASH_TABLE_INIT`.
+#define BLOOM_FILTER_ADD(selfp, key) \
+	crzbloom_add_hash((selfp), CRZHASH_HASH(key))
+
+/// Whether the key `key` (a `CRZ_STRING`) may have been added to the Bloom filter `self`.
+#define BLOOM_FILTER_HAS(self, key) \
+	crzbloom_has_hash(&(self), CRZHASH_HASH(key))
+
+/// Add the key with the hash `hash` to the Bloom filter `selfp` (passed by pointer), for keys which are not strings.
+#define BLOOM_FILTER_ADD_HASH(selfp, hash) crzbloom_add_hash((selfp), (hash))
+
+/// Whether the key with the hash `hash` may have been added to the Bloom filter `self`.
+#define BLOOM_FILTER_HAS_HASH(self, hash) crzbloom_has_hash(&(self), (hash))
+
+/// Free the space allocated for the Bloom filter `selfp` (passed by pointer), and empty-out the fields of the struct.
+#define BLOOM_FILTER_FREE(selfp)                \
+	do {                                    \
+		CRZ_FREE((selfp)->allocation);  \
+		(selfp)->blocks = CRZ_NULL;     \
+		(selfp)->allocation = CRZ_NULL; \
+		(selfp)->block_count = 0;       \
+	} while (0)
+
+/// Zero-initialize a cuckoo filter.
+///
+/// Requires calling `CUCKOO_FILTER_INIT` afterwards.
+#define CUCKOO_FILTER_NEW()                                       \
+	{                                                         \
+		.buckets = CRZ_NULL, .bucket_count = 0, .len = 0, \
+		.victim = 0, .victim_index = 0, .random = 0       \
+	}
+
+/// Properly initialize the cuckoo filter `selfp` (passed by pointer), with room for at least `capacity` keys.
+///
+/// The filter is sized to be at most 95% full at `capacity` keys, past which adding keys may fail.
+#define CUCKOO_FILTER_INIT(selfp, capacity) \
+	crzbloom_cuckoo_init((selfp), (capacity))
+
+/// Add the key `key` (a `CRZ_STRING`) to the cuckoo filter `selfp` (passed by pointer).
+///
+/// Returns `CRZ_FALSE` if the filter is too full to add it, in which case the key was not added.
+#define CUCKOO_FILTER_ADD(selfp, key) \
+	crzbloom_cuckoo_add((selfp), CRZHASH_HASH(key))
+
+/// Whether the key `key` (a `CRZ_STRING`) may have been added to the cuckoo filter `self`.
+#define CUCKOO_FILTER_HAS(self, key) \
+	crzbloom_cuckoo_has(&(self), CRZHASH_HASH(key))
+
+/// Remove the key `key` (a `CRZ_STRING`), which must have been added, from the cuckoo filter `selfp` (passed by pointer).
+///
+/// Returns whether a fingerprint of the key was found and removed.
+#define CUCKOO_FILTER_REMOVE(selfp, key) \
+	crzbloom_cuckoo_remove((selfp), CRZHASH_HASH(key))
+
+/// Free the space allocated for the cuckoo filter `selfp` (passed by pointer), and empty-out the fields of the struct.
+#define CUCKOO_FILTER_FREE(selfp)            \
+	do {                                 \
+		CRZ_FREE((selfp)->buckets);  \
+		(selfp)->buckets = CRZ_NULL; \
+		(selfp)->bucket_count = 0;   \
+		(selfp)->len = 0;            \
+		(selfp)->victim = 0;         \
+	} while (0)
+
+/// Zero-initialize a filtered hash table.
+///
+/// Requires calling `FILTERED_HASH_TABLE_INIT` afterwards.
+#define FILTERED_HASH_TABLE_NEW()                                       \
+	{                                                               \
+		.table = HASH_TABLE_NEW(), .filter = BLOOM_FILTER_NEW() \
+	}
+
+/// Properly initialize a filtered hash table.
+///
+/// Gives the table an initial size of `initial_size` pairs, and sizes its filter for `expected_keys` keys at a false positive rate of `false_positive_rate`.
+#define FILTERED_HASH_TABLE_INIT(selfp, initial_size, expected_keys, \
+				 false_positive_rate)                \
+	do {                                                         \
+		HASH_TABLE_INIT(&(selfp)->table, initial_size);      \
+		BLOOM_FILTER_INIT(&(selfp)->filter, expected_keys,   \
+				  false_positive_rate);              \
+	} while (0)
+
+/// Insert the value `insert_value` at the key `insert_key` for the filtered hash table `selfp` (passed by pointer).
+///
+/// See `HASH_TABLE_INSERT`.
+#define FILTERED_HASH_TABLE_INSERT(selfp, insert_key, insert_value) \
+	do {                                                        \
+		BLOOM_FILTER_ADD(&(selfp)->filter, insert_key);     \
+		HASH_TABLE_INSERT(&(selfp)->table, insert_key,      \
+				  insert_value);                    \
+	} while (0)
+
+/// Get a pointer to the pair with key `entry_key` in the filtered hash table `selfp` (passed by pointer), inserting it if it does not exist.
+///
+/// See `HASH_TABLE_ENTRY`.
+#define FILTERED_HASH_TABLE_ENTRY(selfp, entry_key, createdp) \
+	(BLOOM_FILTER_ADD(&(selfp)->filter, entry_key),       \
+	 HASH_TABLE_ENTRY(&(selfp)->table, entry_key, createdp))
+
+/// Get a pointer to the pair with key `get_key` in the filtered hash table `self`, or `CRZ_NULL` if it does not exist.
+///
+/// The key is hashed once, for both the filter and the table.
+#define FILTERED_HASH_TABLE_GET(self, get_key)                      \
+	crzbloom_table_get((Crzhash_AnyHashTable *)(&(self).table), \
+			   &(self).filter, (get_key))
+
+/// Free the filtered hash table `selfp` (passed by pointer), as `HASH_TABLE_FREE` and `BLOOM_FILTER_FREE` do.
+#define FILTERED_HASH_TABLE_FREE(selfp)              \
+	do {                                         \
+		HASH_TABLE_FREE(&(selfp)->table);    \
+		BLOOM_FILTER_FREE(&(selfp)->filter); \
+	} while (0)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BLOOM_FILTER_INIT(selfp, expected_keys, false_positive_rate)` instead.
+void crzbloom_init(BloomFilter *selfp, CRZ_SIZE expected_keys,
+		   double false_positive_rate);
+
+/// INTERNAL: this is the natural logarithm of `x`, which must be positive, without depending on libm.
+double crzbloom_log(double x);
+
+/// INTERNAL: this is the square root of `x`, which must be positive, without depending on libm.
+double crzbloom_sqrt(double x);
+
+/// INTERNAL: this function mixes the bits of `hash`, so that weak hashes such as `crzhash_djb2` spread over every bit.
+uint64_t crzbloom_mix(uint64_t hash);
+
+/// INTERNAL: this is the block of the Bloom filter `selfp` which the key with the mixed hash `mixed` belongs to.
+uint32_t *crzbloom_block(const BloomFilter *selfp, uint64_t mixed);
+
+/// INTERNAL: this function sets `mask` to the bit of each lane which the key with the mixed hash `mixed` sets.
+void crzbloom_mask_scalar(uint64_t mixed, uint32_t *mask);
+
+#ifdef CRZBLOOM_AVX2
+/// INTERNAL: this is `crzbloom_mask_scalar`, computing all of the lanes at once using AVX2.
+__m256i crzbloom_mask_avx2(uint64_t mixed);
+#endif // CRZBLOOM_AVX2
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BLOOM_FILTER_ADD_HASH(selfp, hash)` instead.
+void crzbloom_add_hash(BloomFilter *selfp, uint64_t hash);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `BLOOM_FILTER_HAS_HASH(self, hash)` instead.
+CRZ_BOOL crzbloom_has_hash(const BloomFilter *selfp, uint64_t hash);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `FILTERED_HASH_TABLE_GET(self, get_key)` instead.
+void *crzbloom_table_get(Crzhash_AnyHashTable *tablep,
+			 const BloomFilter *filterp, CRZ_STRING key);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CUCKOO_FILTER_INIT(selfp, capacity)` instead.
+void crzbloom_cuckoo_init(CuckooFilter *selfp, CRZ_SIZE capacity);
+
+/// INTERNAL: this is the non-zero 16-bit fingerprint of the key with the mixed hash `mixed`.
+uint16_t crzbloom_fingerprint(uint64_t mixed);
+
+/// INTERNAL: this is the other bucket of the fingerprint `fingerprint`, which is in the bucket `index`.
+CRZ_SIZE crzbloom_alternate(const CuckooFilter *selfp, CRZ_SIZE index,
+			    uint16_t fingerprint);
+
+/// INTERNAL: this function returns whether the bucket `bucket` holds the fingerprint `fingerprint`, comparing all of its slots at once.
+CRZ_BOOL crzbloom_bucket_has(uint64_t bucket, uint16_t fingerprint);
+
+/// INTERNAL: this function puts `fingerprint` in an empty slot of the bucket at `bucketp`, returning whether there was one.
+CRZ_BOOL crzbloom_bucket_put(uint64_t *bucketp, uint16_t fingerprint);
+
+/// INTERNAL: this function removes one copy of `fingerprint` from the bucket at `bucketp`, returning whether there was one.
+CRZ_BOOL crzbloom_bucket_take(uint64_t *bucketp, uint16_t fingerprint);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CUCKOO_FILTER_ADD(selfp, key)` instead.
+CRZ_BOOL crzbloom_cuckoo_add(CuckooFilter *selfp, uint64_t hash);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CUCKOO_FILTER_HAS(self, key)` instead.
+CRZ_BOOL crzbloom_cuckoo_has(const CuckooFilter *selfp, uint64_t hash);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CUCKOO_FILTER_REMOVE(selfp, key)` instead.
+CRZ_BOOL crzbloom_cuckoo_remove(CuckooFilter *selfp, uint64_t hash);
+
+/// INTERNAL: these are the odd multipliers which pick the bit of each lane.
+static const uint32_t crzbloom_salts[CRZBLOOM_LANES] = {
+	0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+	0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+};
+
+void crzbloom_init(BloomFilter *selfp, CRZ_SIZE expected_keys,
+		   double false_positive_rate)
+{
+	CRZ_ASSERT(false_positive_rate > 0 && false_positive_rate < 1 &&
+		   "False positive rate out of range");
+
+	// Each of the k lanes of a key must be set with a rate of p^(1 / k),
+	// which lanes are at b = k / -ln(1 - p^(1 / k)) bits per key
+	double lane_rate = false_positive_rate;
+	for (CRZ_SIZE k = 1; k < CRZBLOOM_LANES; k *= 2)
+		lane_rate = crzbloom_sqrt(lane_rate);
+	double bits_per_key = CRZBLOOM_LANES / -crzbloom_log(1 - lane_rate);
+	// Blocks fill unevenly, which this margin makes up for
+	bits_per_key *= 1.25;
+
+	double bits = (double)(expected_keys > 0 ? expected_keys : 1) *
+		      bits_per_key;
+	CRZ_SIZE block_bits = CRZBLOOM_BLOCK_SIZE * 8;
+	CRZ_SIZE block_count = (CRZ_SIZE)(bits / (double)block_bits) + 1;
+
+	CRZ_SIZE bytes = block_count * CRZBLOOM_BLOCK_SIZE;
+	char *allocation = CRZ_MALLOC(bytes + CRZBLOOM_BLOCK_SIZE - 1);
+	CRZ_ASSERT(allocation && "Out of memory when allocating Bloom filter");
+	CRZ_STATS_ADD(hash, allocations, 1);
+	CRZ_STATS_ADD(hash, bytes_allocated, bytes + CRZBLOOM_BLOCK_SIZE - 1);
+
+	uintptr_t misalignment = (uintptr_t)allocation % CRZBLOOM_BLOCK_SIZE;
+	CRZ_SIZE offset = misalignment ? CRZBLOOM_BLOCK_SIZE - misalignment : 0;
+	selfp->allocation = allocation;
+	selfp->blocks = (uint32_t *)(allocation + offset);
+	selfp->block_count = block_count;
+	memset(selfp->blocks, 0, bytes);
+}
+
+double crzbloom_log(double x)
+{
+	double result = 0;
+	while (x >= 2) {
+		x /= 2;
+		result += 1;
+	}
+	while (x < 1) {
+		x *= 2;
+		result -= 1;
+	}
+
+	// Squaring doubles the logarithm, so passing 2 gives its next bit
+	double bit = 0.5;
+	for (int i = 0; i < 24; i++) {
+		x *= x;
+		if (x >= 2) {
+			x /= 2;
+			result += bit;
+		}
+		bit /= 2;
+	}
+	return result * 0.6931471805599453;
+}
+
+double crzbloom_sqrt(double x)
+{
+	double root = x < 1 ? 1 : x;
+	for (int i = 0; i < 64; i++)
+		root = (root + x / root) / 2;
+	return root;
+}
+
+uint64_t crzbloom_mix(uint64_t hash)
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+uint32_t *crzbloom_block(const BloomFilter *selfp, uint64_t mixed)
+{
+	// Maps the high half of the hash onto the blocks without dividing
+	uint64_t index = ((mixed >> 32) * selfp->block_count) >> 32;
+	return selfp->blocks + index * CRZBLOOM_LANES;
+}
+
+void crzbloom_mask_scalar(uint64_t mixed, uint32_t *mask)
+{
+	uint32_t key = (uint32_t)mixed;
+	for (CRZ_SIZE i = 0; i < CRZBLOOM_LANES; i++)
+		mask[i] = 1U << ((key * crzbloom_salts[i]) >> 27);
+}
+
+#ifdef CRZBLOOM_AVX2
+__m256i crzbloom_mask_avx2(uint64_t mixed)
+{
+	__m256i key = _mm256_set1_epi32((int)(uint32_t)mixed);
+	__m256i salts = _mm256_loadu_si256((const __m256i *)crzbloom_salts);
+	__m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(key, salts), 27);
+	return _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+}
+#endif // CRZBLOOM_AVX2
+
+void crzbloom_add_hash(BloomFilter *selfp, uint64_t hash)
+{
+	uint64_t mixed = crzbloom_mix(hash);
+	uint32_t *block = crzbloom_block(selfp, mixed);
+
+#ifdef CRZBLOOM_AVX2
+	__m256i *lanes = (__m256i *)block;
+	_mm256_store_si256(lanes,
+			   _mm256_or_si256(*lanes, crzbloom_mask_avx2(mixed)));
+#else
+	uint32_t mask[CRZBLOOM_LANES];
+	crzbloom_mask_scalar(mixed, mask);
+	for (CRZ_SIZE i = 0; i < CRZBLOOM_LANES; i++)
+		block[i] |= mask[i];
+#endif // CRZBLOOM_AVX2
+}
+
+CRZ_BOOL crzbloom_has_hash(const BloomFilter *selfp, uint64_t hash)
+{
+	uint64_t mixed = crzbloom_mix(hash);
+	const uint32_t *block = crzbloom_block(selfp, mixed);
+
+#ifdef CRZBLOOM_AVX2
+	// testc is whether every bit of the mask is set in the block
+	return _mm256_testc_si256(*(const __m256i *)block,
+				  crzbloom_mask_avx2(mixed));
+#else
+	uint32_t mask[CRZBLOOM_LANES];
+	crzbloom_mask_scalar(mixed, mask);
+	uint32_t missing = 0;
+	for (CRZ_SIZE i = 0; i < CRZBLOOM_LANES; i++)
+		missing |= mask[i] & ~block[i];
+	return missing == 0;
+#endif // CRZBLOOM_AVX2
+}
+
+void *crzbloom_table_get(Crzhash_AnyHashTable *tablep,
+			 const BloomFilter *filterp, CRZ_STRING key)
+{
+	CRZ_SIZE hash = CRZHASH_HASH(key);
+	if (!crzbloom_has_hash(filterp, hash))
+		return CRZ_NULL;
+	return crzhash_get_from(tablep, key, hash % tablep->size);
+}
+
+void crzbloom_cuckoo_init(CuckooFilter *selfp, CRZ_SIZE capacity)
+{
+	CRZ_SIZE needed = capacity * 100 / 95 / CRZBLOOM_BUCKET_SIZE + 1;
+	CRZ_SIZE bucket_count = 1;
+	while (bucket_count < needed)
+		bucket_count *= 2;
+
+	selfp->buckets = CRZ_MALLOC(bucket_count * sizeof(uint64_t));
+	CRZ_ASSERT(selfp->buckets &&
+		   "Out of memory when allocating cuckoo filter");
+	CRZ_STATS_ADD(hash, allocations, 1);
+	CRZ_STATS_ADD(hash, bytes_allocated, bucket_count * sizeof(uint64_t));
+	memset(selfp->buckets, 0, bucket_count * sizeof(uint64_t));
+	selfp->bucket_count = bucket_count;
+	selfp->len = 0;
+	selfp->victim = 0;
+	selfp->victim_index = 0;
+	selfp->random = 0x9e3779b97f4a7c15ULL;
+}
+
+uint16_t crzbloom_fingerprint(uint64_t mixed)
+{
+	uint16_t fingerprint = (uint16_t)(mixed >> 16);
+	return fingerprint != 0 ? fingerprint : 1;
+}
+
+CRZ_SIZE crzbloom_alternate(const CuckooFilter *selfp, CRZ_SIZE index,
+			    uint16_t fingerprint)
+{
+	// XOR is its own inverse, so either bucket leads to the other
+	uint64_t offset = crzbloom_mix(fingerprint);
+	return (index ^ offset) & (selfp->bucket_count - 1);
+}
+
+CRZ_BOOL crzbloom_bucket_has(uint64_t bucket, uint16_t fingerprint)
+{
+	// A slot is zero after the XOR only if it held the fingerprint
+	uint64_t x = bucket ^ (fingerprint * 0x0001000100010001ULL);
+	return ((x - 0x0001000100010001ULL) & ~x & 0x8000800080008000ULL) !=
+	       0;
+}
+
+CRZ_BOOL crzbloom_bucket_put(uint64_t *bucketp, uint16_t fingerprint)
+{
+	for (CRZ_SIZE slot = 0; slot < CRZBLOOM_BUCKET_SIZE; slot++) {
+		CRZ_SIZE shift = slot * 16;
+		if (((*bucketp >> shift) & 0xffff) == 0) {
+			*bucketp |= (uint64_t)fingerprint << shift;
+			return CRZ_TRUE;
+		}
+	}
+	return CRZ_FALSE;
+}
+
+CRZ_BOOL crzbloom_bucket_take(uint64_t *bucketp, uint16_t fingerprint)
+{
+	for (CRZ_SIZE slot = 0; slot < CRZBLOOM_BUCKET_SIZE; slot++) {
+		CRZ_SIZE shift = slot * 16;
+		if (((*bucketp >> shift) & 0xffff) == fingerprint) {
+			*bucketp &= ~((uint64_t)0xffff << shift);
+			return CRZ_TRUE;
+		}
+	}
+	return CRZ_FALSE;
+}
+
+CRZ_BOOL crzbloom_cuckoo_add(CuckooFilter *selfp, uint64_t hash)
+{
+	if (selfp->victim != 0)
+		return CRZ_FALSE;
+
+	uint64_t mixed = crzbloom_mix(hash);
+	uint16_t fingerprint = crzbloom_fingerprint(mixed);
+	CRZ_SIZE index = (mixed >> 32) & (selfp->bucket_count - 1);
+	CRZ_SIZE other = crzbloom_alternate(selfp, index, fingerprint);
+	selfp->len++;
+	if (crzbloom_bucket_put(&selfp->buckets[index], fingerprint) ||
+	    crzbloom_bucket_put(&selfp->buckets[other], fingerprint))
+		return CRZ_TRUE;
+
+	// Both buckets are full, so move fingerprints to their other bucket
+	// until one of them has room
+	index = selfp->random & 1 ? other : index;
+	for (CRZ_SIZE kick = 0; kick < CRZBLOOM_MAX_KICKS; kick++) {
+		selfp->random ^= selfp->random << 13;
+		selfp->random ^= selfp->random >> 7;
+		selfp->random ^= selfp->random << 17;
+		CRZ_SIZE shift = (selfp->random % CRZBLOOM_BUCKET_SIZE) * 16;
+		uint64_t *bucketp = &selfp->buckets[index];
+		uint16_t evicted = (uint16_t)(*bucketp >> shift);
+		*bucketp &= ~((uint64_t)0xffff << shift);
+		*bucketp |= (uint64_t)fingerprint << shift;
+
+		fingerprint = evicted;
+		index = crzbloom_alternate(selfp, index, fingerprint);
+		if (crzbloom_bucket_put(&selfp->buckets[index], fingerprint))
+			return CRZ_TRUE;
+	}
+
+	// Keep the last fingerprint aside, so that no key added before is lost
+	selfp->victim = fingerprint;
+	selfp->victim_index = index;
+	return CRZ_TRUE;
+}
+
+CRZ_BOOL crzbloom_cuckoo_has(const CuckooFilter *selfp, uint64_t hash)
+{
+	uint64_t mixed = crzbloom_mix(hash);
+	uint16_t fingerprint = crzbloom_fingerprint(mixed);
+	CRZ_SIZE index = (mixed >> 32) & (selfp->bucket_count - 1);
+	CRZ_SIZE other = crzbloom_alternate(selfp, index, fingerprint);
+
+	if (selfp->victim == fingerprint &&
+	    (selfp->victim_index == index || selfp->victim_index == other))
+		return CRZ_TRUE;
+	return crzbloom_bucket_has(selfp->buckets[index], fingerprint) ||
+	       crzbloom_bucket_has(selfp->buckets[other], fingerprint);
+}
+
+CRZ_BOOL crzbloom_cuckoo_remove(CuckooFilter *selfp, uint64_t hash)
+{
+	uint64_t mixed = crzbloom_mix(hash);
+	uint16_t fingerprint = crzbloom_fingerprint(mixed);
+	CRZ_SIZE index = (mixed >> 32) & (selfp->bucket_count - 1);
+	CRZ_SIZE other = crzbloom_alternate(selfp, index, fingerprint);
+
+	CRZ_BOOL removed =
+		crzbloom_bucket_take(&selfp->buckets[index], fingerprint) ||
+		crzbloom_bucket_take(&selfp->buckets[other], fingerprint);
+	if (!removed && selfp->victim == fingerprint &&
+	    (selfp->victim_index == index || selfp->victim_index == other)) {
+		selfp->victim = 0;
+		removed = CRZ_TRUE;
+	}
+	if (!removed)
+		return CRZ_FALSE;
+	selfp->len--;
+
+	// Removing made room, so try to place the fingerprint kept aside
+	if (selfp->victim != 0) {
+		uint16_t victim = selfp->victim;
+		CRZ_SIZE victim_other =
+			crzbloom_alternate(selfp, selfp->victim_index, victim);
+		if (crzbloom_bucket_put(&selfp->buckets[selfp->victim_index],
+					victim) ||
+		    crzbloom_bucket_put(&selfp->buckets[victim_other], victim))
+			selfp->victim = 0;
+	}
+	return CRZ_TRUE;
+}
+
+#endif // CRZBLOOM_H_
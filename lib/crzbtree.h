@@ -0,0 +1,563 @@
+#ifndef CRZBTREE_H_
+#define CRZBTREE_H_
+
+#include "crzdef.h"
+#include "crzpool.h"
+#include <string.h>
+
+/// The size in bytes that the keys of each node of a B+ tree aim to fill.
+///
+/// This is a few cache lines, so that a binary search within a node only touches a handful of them, while keeping the tree shallow.
+#ifndef CRZBTREE_NODE_SIZE
+#define CRZBTREE_NODE_SIZE 256
+#endif // CRZBTREE_NODE_SIZE
+
+/// The amount of nodes allocated at once by the pools of a B+ tree.
+#ifndef CRZBTREE_POOL_CHUNK
+#define CRZBTREE_POOL_CHUNK CRZPOOL_CHUNK
+#endif // CRZBTREE_POOL_CHUNK
+
+/// The largest amount of keys in each node of a B+ tree with keys of type `K`.
+#define CRZBTREE_MAX_KEYS(K)                      \
+	(CRZBTREE_NODE_SIZE / sizeof(K) < 4 ? 4 : \
+					      CRZBTREE_NODE_SIZE / sizeof(K))
+
+/// Compare the numbers `a` and `b` for `DEFINE_BTREE`, as -1, 0 or 1.
+#define CRZBTREE_CMP_NUMBER(a, b) (((a) > (b)) - ((a) < (b)))
+
+/// Define an ordered map named `Name`, as a B+ tree with keys of type `K` and values of type `V`.
+///
+/// `CMP` is the name of a function-like macro (or function), where `CMP(a, b)` is negative, zero or positive when the key `a` is less than, equal to, or greater than the key `b`.
+/// Use `CRZBTREE_CMP_NUMBER` for integer keys, and `SV_CMP` for `StringView` keys.
+/// Keys are stored as they are, so the strings of `StringView` keys must outlive the tree.
+///
+/// This defines:
+///   - `Name`, the tree itself, zero-initialized with `BTREE_NEW()`
+///   - `Name##_Entry`, a key and its value, as taken by `Name##_bulk_load`
+///   - `Name##_Iter`, a position in the tree, as used by the `BTREE_ITER_*` macros
+///   - `Name##_get`, which returns a pointer to the value of a key, or `CRZ_NULL` if it does not exist
+///   - `Name##_insert`, which inserts a key, or overrides its value if it already exists
+///   - `Name##_remove`, which returns whether the key existed
+///   - `Name##_first` and `Name##_lower_bound`, which return an iterator at the first key, or at the first key not less than a given one
+///   - `Name##_bulk_load`, which fills an empty tree from entries sorted by strictly increasing key, in O(n)
+///   - `Name##_free`
+///
+/// Each node stores up to `CRZBTREE_MAX_KEYS(K)` keys in a sorted array, so that it spans `CRZBTREE_NODE_SIZE` bytes of keys.
+/// Values are only stored in the leaves, which are linked in order, so iterating over a range walks the leaves without going back up the tree.
+/// Nodes are allocated from pools of chunks, and released nodes are reused by later insertions.
+#define DEFINE_BTREE(Name, K, V, CMP)                                          \
+	enum {                                                                 \
+		Name##_MAX = CRZBTREE_MAX_KEYS(K),                             \
+		Name##_MIN = CRZBTREE_MAX_KEYS(K) / 2                          \
+	};                                                                     \
+                                                                               \
+	typedef struct Name##_Leaf {                                           \
+		CRZ_SIZE count;                                                \
+		struct Name##_Leaf *next;                                      \
+		K keys[CRZBTREE_MAX_KEYS(K) + 1];                              \
+		V values[CRZBTREE_MAX_KEYS(K) + 1];                            \
+	} Name##_Leaf;                                                         \
+                                                                               \
+	typedef struct {                                                       \
+		CRZ_SIZE count;                                                \
+		K keys[CRZBTREE_MAX_KEYS(K) + 1];                              \
+		void *children[CRZBTREE_MAX_KEYS(K) + 2];                      \
+	} Name##_Inner;                                                        \
+                                                                               \
+	typedef struct {                                                       \
+		K key;                                                         \
+		V value;                                                       \
+	} Name##_Entry;                                                        \
+                                                                               \
+	typedef struct {                                                       \
+		Name##_Leaf *leaf;                                             \
+		CRZ_SIZE index;                                                \
+	} Name##_Iter;                                                         \
+                                                                               \
+	typedef struct {                                                       \
+		void *root;                                                    \
+		CRZ_SIZE height;                                               \
+		CRZ_SIZE len;                                                  \
+		Pool leaves;                                                   \
+		Pool inners;                                                   \
+	} Name;                                                                \
+                                                                               \
+	static inline CRZ_SIZE Name##_lower_index(const K *keys,               \
+						  CRZ_SIZE count, K key)       \
+	{                                                                      \
+		CRZ_SIZE low = 0;                                              \
+		CRZ_SIZE high = count;                                         \
+		while (low < high) {                                           \
+			CRZ_SIZE mid = low + (high - low) / 2;                 \
+			if (CMP(keys[mid], key) < 0)                           \
+				low = mid + 1;                                 \
+			else                                                   \
+				high = mid;                                    \
+		}                                                              \
+		return low;                                                    \
+	}                                                                      \
+                                                                               \
+	static inline CRZ_SIZE Name##_child_index(const Name##_Inner *inner,   \
+						  K key)                       \
+	{                                                                      \
+		CRZ_SIZE index =                                               \
+			Name##_lower_index(inner->keys, inner->count, key);    \
+		if (index < inner->count && CMP(inner->keys[index], key) == 0) \
+			index++;                                               \
+		return index;                                                  \
+	}                                                                      \
+                                                                               \
+	static inline Name##_Leaf *Name##_find_leaf(const Name *selfp, K key)  \
+	{                                                                      \
+		void *node = selfp->root;                                      \
+		for (CRZ_SIZE level = selfp->height; level > 0; level--) {     \
+			Name##_Inner *inner = node;                            \
+			CRZ_SIZE index = Name##_child_index(inner, key);       \
+			node = inner->children[index];                         \
+		}                                                              \
+		return node;                                                   \
+	}                                                                      \
+                                                                               \
+	static inline V *Name##_get(const Name *selfp, K key)                  \
+	{                                                                      \
+		if (selfp->root == CRZ_NULL)                                   \
+			return CRZ_NULL;                                       \
+		Name##_Leaf *leaf = Name##_find_leaf(selfp, key);              \
+		CRZ_SIZE index =                                               \
+			Name##_lower_index(leaf->keys, leaf->count, key);      \
+		if (index < leaf->count && CMP(leaf->keys[index], key) == 0)   \
+			return &leaf->values[index];                           \
+		return CRZ_NULL;                                               \
+	}                                                                      \
+                                                                               \
+	static inline Name##_Iter Name##_lower_bound(const Name *selfp,        \
+						     K key)                    \
+	{                                                                      \
+		Name##_Iter iter = { CRZ_NULL, 0 };                            \
+		if (selfp->root == CRZ_NULL)                                   \
+			return iter;                                           \
+		Name##_Leaf *leaf = Name##_find_leaf(selfp, key);              \
+		iter.leaf = leaf;                                              \
+		iter.index = Name##_lower_index(leaf->keys, leaf->count, key); \
+		if (iter.index == leaf->count) {                               \
+			iter.leaf = leaf->next;                                \
+			iter.index = 0;                                        \
+		}                                                              \
+		return iter;                                                   \
+	}                                                                      \
+                                                                               \
+	static inline Name##_Iter Name##_first(const Name *selfp)              \
+	{                                                                      \
+		void *node = selfp->root;                                      \
+		for (CRZ_SIZE level = selfp->height; level > 0; level--)       \
+			node = ((Name##_Inner *)node)->children[0];            \
+		Name##_Iter iter = { node, 0 };                                \
+		return iter;                                                   \
+	}                                                                      \
+                                                                               \
+	static inline Name##_Leaf *Name##_new_leaf(Name *selfp)                \
+	{                                                                      \
+		Name##_Leaf *leaf =                                            \
+			POOL_ALLOC(&selfp->leaves, sizeof(*leaf));             \
+		leaf->count = 0;                                               \
+		leaf->next = CRZ_NULL;                                         \
+		return leaf;                                                   \
+	}                                                                      \
+                                                                               \
+	static inline Name##_Inner *Name##_new_inner(Name *selfp)              \
+	{                                                                      \
+		Name##_Inner *inner =                                          \
+			POOL_ALLOC(&selfp->inners, sizeof(*inner));            \
+		inner->count = 0;                                              \
+		return inner;                                                  \
+	}                                                                      \
+                                                                               \
+	static inline void *Name##_split_leaf(Name *selfp, Name##_Leaf *leaf,  \
+					      K *split_keyp)                   \
+	{                                                                      \
+		Name##_Leaf *right = Name##_new_leaf(selfp);                   \
+		CRZ_SIZE keep = leaf->count / 2;                               \
+		right->count = leaf->count - keep;                             \
+		CRZ_MEMCPY(right->keys, leaf->keys + keep,                     \
+			   right->count * sizeof(K));                          \
+		CRZ_MEMCPY(right->values, leaf->values + keep,                 \
+			   right->count * sizeof(V));                          \
+		leaf->count = keep;                                            \
+		right->next = leaf->next;                                      \
+		leaf->next = right;                                            \
+		*split_keyp = right->keys[0];                                  \
+		return right;                                                  \
+	}                                                                      \
+                                                                               \
+	static inline void *Name##_split_inner(Name *selfp,                    \
+					       Name##_Inner *inner,            \
+					       K *split_keyp)                  \
+	{                                                                      \
+		Name##_Inner *right = Name##_new_inner(selfp);                 \
+		CRZ_SIZE keep = inner->count / 2;                              \
+		*split_keyp = inner->keys[keep];                               \
+		right->count = inner->count - keep - 1;                        \
+		CRZ_MEMCPY(right->keys, inner->keys + keep + 1,                \
+			   right->count * sizeof(K));                          \
+		CRZ_MEMCPY(right->children, inner->children + keep + 1,        \
+			   (right->count + 1) * sizeof(void *));               \
+		inner->count = keep;                                           \
+		return right;                                                  \
+	}                                                                      \
+                                                                               \
+	static inline void *Name##_insert_into(Name *selfp, void *node,        \
+					       CRZ_SIZE level, K key,          \
+					       V value, K *split_keyp)         \
+	{                                                                      \
+		if (level == 0) {                                              \
+			Name##_Leaf *leaf = node;                              \
+			CRZ_SIZE index = Name##_lower_index(                   \
+				leaf->keys, leaf->count, key);                 \
+			if (index < leaf->count &&                             \
+			    CMP(leaf->keys[index], key) == 0) {                \
+				leaf->values[index] = value;                   \
+				return CRZ_NULL;                               \
+			}                                                      \
+			CRZ_SIZE after = leaf->count - index;                  \
+			memmove(leaf->keys + index + 1, leaf->keys + index,    \
+				after * sizeof(K));                            \
+			memmove(leaf->values + index + 1,                      \
+				leaf->values + index, after * sizeof(V));      \
+			leaf->keys[index] = key;                               \
+			leaf->values[index] = value;                           \
+			leaf->count++;                                         \
+			selfp->len++;                                          \
+			if (leaf->count <= Name##_MAX)                         \
+				return CRZ_NULL;                               \
+			return Name##_split_leaf(selfp, leaf, split_keyp);     \
+		}                                                              \
+                                                                               \
+		Name##_Inner *inner = node;                                    \
+		CRZ_SIZE index = Name##_child_index(inner, key);               \
+		K split_key = key;                                             \
+		void *child = inner->children[index];                          \
+		void *split = Name##_insert_into(selfp, child, level - 1, key, \
+						 value, &split_key);           \
+		if (split == CRZ_NULL)                                         \
+			return CRZ_NULL;                                       \
+		CRZ_SIZE after = inner->count - index;                         \
+		memmove(inner->keys + index + 1, inner->keys + index,          \
+			after * sizeof(K));                                    \
+		memmove(inner->children + index + 2,                           \
+			inner->children + index + 1, after * sizeof(void *));  \
+		inner->keys[index] = split_key;                                \
+		inner->children[index + 1] = split;                            \
+		inner->count++;                                                \
+		if (inner->count <= Name##_MAX)                                \
+			return CRZ_NULL;                                       \
+		return Name##_split_inner(selfp, inner, split_keyp);           \
+	}                                                                      \
+                                                                               \
+	static inline void Name##_insert(Name *selfp, K key, V value)          \
+	{                                                                      \
+		if (selfp->root == CRZ_NULL) {                                 \
+			selfp->root = Name##_new_leaf(selfp);                  \
+			selfp->height = 0;                                     \
+		}                                                              \
+		K split_key = key;                                             \
+		void *split = Name##_insert_into(selfp, selfp->root,           \
+						 selfp->height, key, value,    \
+						 &split_key);                  \
+		if (split == CRZ_NULL)                                         \
+			return;                                                \
+		Name##_Inner *root = Name##_new_inner(selfp);                  \
+		root->count = 1;                                               \
+		root->keys[0] = split_key;                                     \
+		root->children[0] = selfp->root;                               \
+		root->children[1] = split;                                     \
+		selfp->root = root;                                            \
+		selfp->height++;                                               \
+	}                                                                      \
+                                                                               \
+	static inline void Name##_borrow_left(Name##_Inner *inner,             \
+					      CRZ_SIZE index, CRZ_SIZE level)  \
+	{                                                                      \
+		if (level == 0) {                                              \
+			Name##_Leaf *left = inner->children[index - 1];        \
+			Name##_Leaf *child = inner->children[index];           \
+			memmove(child->keys + 1, child->keys,                  \
+				child->count * sizeof(K));                     \
+			memmove(child->values + 1, child->values,              \
+				child->count * sizeof(V));                     \
+			child->keys[0] = left->keys[left->count - 1];          \
+			child->values[0] = left->values[left->count - 1];      \
+			left->count--;                                         \
+			child->count++;                                        \
+			inner->keys[index - 1] = child->keys[0];               \
+			return;                                                \
+		}                                                              \
+                                                                               \
+		Name##_Inner *left = inner->children[index - 1];               \
+		Name##_Inner *child = inner->children[index];                  \
+		memmove(child->keys + 1, child->keys,                          \
+			child->count * sizeof(K));                             \
+		memmove(child->children + 1, child->children,                  \
+			(child->count + 1) * sizeof(void *));                  \
+		child->keys[0] = inner->keys[index - 1];                       \
+		child->children[0] = left->children[left->count];              \
+		inner->keys[index - 1] = left->keys[left->count - 1];          \
+		left->count--;                                                 \
+		child->count++;                                                \
+	}                                                                      \
+                                                                               \
+	static inline void Name##_borrow_right(Name##_Inner *inner,            \
+					       CRZ_SIZE index, CRZ_SIZE level) \
+	{                                                                      \
+		if (level == 0) {                                              \
+			Name##_Leaf *child = inner->children[index];           \
+			Name##_Leaf *right = inner->children[index + 1];       \
+			child->keys[child->count] = right->keys[0];            \
+			child->values[child->count] = right->values[0];        \
+			child->count++;                                        \
+			right->count--;                                        \
+			memmove(right->keys, right->keys + 1,                  \
+				right->count * sizeof(K));                     \
+			memmove(right->values, right->values + 1,              \
+				right->count * sizeof(V));                     \
+			inner->keys[index] = right->keys[0];                   \
+			return;                                                \
+		}                                                              \
+                                                                               \
+		Name##_Inner *child = inner->children[index];                  \
+		Name##_Inner *right = inner->children[index + 1];              \
+		child->keys[child->count] = inner->keys[index];                \
+		child->children[child->count + 1] = right->children[0];        \
+		child->count++;                                                \
+		inner->keys[index] = right->keys[0];                           \
+		right->count--;                                                \
+		memmove(right->keys, right->keys + 1,                          \
+			right->count * sizeof(K));                             \
+		memmove(right->children, right->children + 1,                  \
+			(right->count + 1) * sizeof(void *));                  \
+	}                                                                      \
+                                                                               \
+	static inline void Name##_merge(Name *selfp, Name##_Inner *inner,      \
+					CRZ_SIZE index, CRZ_SIZE level)        \
+	{                                                                      \
+		if (level == 0) {                                              \
+			Name##_Leaf *left = inner->children[index - 1];        \
+			Name##_Leaf *right = inner->children[index];           \
+			CRZ_MEMCPY(left->keys + left->count, right->keys,      \
+				   right->count * sizeof(K));                  \
+			CRZ_MEMCPY(left->values + left->count, right->values,  \
+				   right->count * sizeof(V));                  \
+			left->count += right->count;                           \
+			left->next = right->next;                              \
+			POOL_RELEASE(&selfp->leaves, right);                   \
+		} else {                                                       \
+			Name##_Inner *left = inner->children[index - 1];       \
+			Name##_Inner *right = inner->children[index];          \
+			left->keys[left->count] = inner->keys[index - 1];      \
+			CRZ_MEMCPY(left->keys + left->count + 1, right->keys,  \
+				   right->count * sizeof(K));                  \
+			CRZ_MEMCPY(left->children + left->count + 1,           \
+				   right->children,                            \
+				   (right->count + 1) * sizeof(void *));       \
+			left->count += right->count + 1;                       \
+			POOL_RELEASE(&selfp->inners, right);                   \
+		}                                                              \
+                                                                               \
+		CRZ_SIZE after = inner->count - index;                         \
+		memmove(inner->keys + index - 1, inner->keys + index,          \
+			after * sizeof(K));                                    \
+		memmove(inner->children + index, inner->children + index + 1,  \
+			after * sizeof(void *));                               \
+		inner->count--;                                                \
+	}                                                                      \
+                                                                               \
+	static inline void Name##_rebalance(Name *selfp, Name##_Inner *inner,  \
+					    CRZ_SIZE index, CRZ_SIZE level)    \
+	{                                                                      \
+		void **children = inner->children;                             \
+		if (crzbtree_count(children[index]) >= Name##_MIN)             \
+			return;                                                \
+		if (index > 0 &&                                               \
+		    crzbtree_count(children[index - 1]) > Name##_MIN)          \
+			Name##_borrow_left(inner, index, level);               \
+		else if (index < inner->count &&                               \
+			 crzbtree_count(children[index + 1]) > Name##_MIN)     \
+			Name##_borrow_right(inner, index, level);              \
+		else if (index > 0)                                            \
+			Name##_merge(selfp, inner, index, level);              \
+		else                                                           \
+			Name##_merge(selfp, inner, index + 1, level);          \
+	}                                                                      \
+                                                                               \
+	static inline CRZ_BOOL Name##_remove_from(Name *selfp, void *node,     \
+						  CRZ_SIZE level, K key)       \
+	{                                                                      \
+		if (level == 0) {                                              \
+			Name##_Leaf *leaf = node;                              \
+			CRZ_SIZE index = Name##_lower_index(                   \
+				leaf->keys, leaf->count, key);                 \
+			if (index == leaf->count ||                            \
+			    CMP(leaf->keys[index], key) != 0)                  \
+				return CRZ_FALSE;                              \
+			leaf->count--;                                         \
+			CRZ_SIZE after = leaf->count - index;                  \
+			memmove(leaf->keys + index, leaf->keys + index + 1,    \
+				after * sizeof(K));                            \
+			memmove(leaf->values + index,                          \
+				leaf->values + index + 1, after * sizeof(V));  \
+			selfp->len--;                                          \
+			return CRZ_TRUE;                                       \
+		}                                                              \
+                                                                               \
+		Name##_Inner *inner = node;                                    \
+		CRZ_SIZE index = Name##_child_index(inner, key);               \
+		if (!Name##_remove_from(selfp, inner->children[index],         \
+					level - 1, key))                       \
+			return CRZ_FALSE;                                      \
+		Name##_rebalance(selfp, inner, index, level - 1);              \
+		return CRZ_TRUE;                                               \
+	}                                                                      \
+                                                                               \
+	static inline CRZ_BOOL Name##_remove(Name *selfp, K key)               \
+	{                                                                      \
+		if (selfp->root == CRZ_NULL ||                                 \
+		    !Name##_remove_from(selfp, selfp->root, selfp->height,     \
+					key))                                  \
+			return CRZ_FALSE;                                      \
+		if (crzbtree_count(selfp->root) > 0)                           \
+			return CRZ_TRUE;                                       \
+                                                                               \
+		if (selfp->height > 0) {                                       \
+			Name##_Inner *root = selfp->root;                      \
+			selfp->root = root->children[0];                       \
+			selfp->height--;                                       \
+			POOL_RELEASE(&selfp->inners, root);                    \
+		} else {                                                       \
+			POOL_RELEASE(&selfp->leaves, selfp->root);             \
+			selfp->root = CRZ_NULL;                                \
+		}                                                              \
+		return CRZ_TRUE;                                               \
+	}                                                                      \
+                                                                               \
+	static inline void Name##_bulk_load(Name *selfp,                       \
+					    const Name##_Entry *entries,       \
+					    CRZ_SIZE count)                    \
+	{                                                                      \
+		CRZ_ASSERT(selfp->root == CRZ_NULL &&                          \
+			   "Bulk-loading into a non-empty tree");              \
+		if (count == 0)                                                \
+			return;                                                \
+                                                                               \
+		ARRAY(void *) nodes = ARRAY_NEW();                             \
+		ARRAY(K) mins = ARRAY_NEW();                                   \
+		Name##_Leaf *previous = CRZ_NULL;                              \
+		CRZ_SIZE leaf_count = (count + Name##_MAX - 1) / Name##_MAX;   \
+		for (CRZ_SIZE i = 0; i < leaf_count; i++) {                    \
+			Name##_Leaf *leaf = Name##_new_leaf(selfp);            \
+			CRZ_SIZE start = i * count / leaf_count;               \
+			CRZ_SIZE end = (i + 1) * count / leaf_count;           \
+			for (CRZ_SIZE j = start; j < end; j++) {               \
+				K key = entries[j].key;                        \
+				CRZ_ASSERT((j == 0 ||                          \
+					    CMP(entries[j - 1].key, key) <     \
+						    0) &&                      \
+					   "Bulk-loading unsorted keys");      \
+				leaf->keys[j - start] = key;                   \
+				leaf->values[j - start] = entries[j].value;    \
+			}                                                      \
+			leaf->count = end - start;                             \
+			if (previous)                                          \
+				previous->next = leaf;                         \
+			previous = leaf;                                       \
+			ARRAY_PUSH(&nodes, leaf);                              \
+			ARRAY_PUSH(&mins, leaf->keys[0]);                      \
+		}                                                              \
+		selfp->len = count;                                            \
+                                                                               \
+		CRZ_SIZE height = 0;                                           \
+		while (nodes.len > 1) {                                        \
+			CRZ_SIZE fanout = Name##_MAX + 1;                      \
+			CRZ_SIZE parents = (nodes.len + fanout - 1) / fanout;  \
+			for (CRZ_SIZE i = 0; i < parents; i++) {               \
+				Name##_Inner *inner = Name##_new_inner(selfp); \
+				CRZ_SIZE start = i * nodes.len / parents;      \
+				CRZ_SIZE end = (i + 1) * nodes.len / parents;  \
+				for (CRZ_SIZE j = start; j < end; j++) {       \
+					CRZ_SIZE child = j - start;            \
+					inner->children[child] = nodes.ptr[j]; \
+					if (child > 0)                         \
+						inner->keys[child - 1] =       \
+							mins.ptr[j];           \
+				}                                              \
+				inner->count = end - start - 1;                \
+				nodes.ptr[i] = inner;                          \
+				mins.ptr[i] = mins.ptr[start];                 \
+			}                                                      \
+			nodes.len = parents;                                   \
+			mins.len = parents;                                    \
+			height++;                                              \
+		}                                                              \
+                                                                               \
+		selfp->root = nodes.ptr[0];                                    \
+		selfp->height = height;                                        \
+		ARRAY_FREE(&nodes);                                            \
+		ARRAY_FREE(&mins);                                             \
+	}                                                                      \
+                                                                               \
+	static inline void Name##_free(Name *selfp)                            \
+	{                                                                      \
+		POOL_FREE(&selfp->leaves);                                     \
+		POOL_FREE(&selfp->inners);                                     \
+		selfp->root = CRZ_NULL;                                        \
+		selfp->height = 0;                                             \
+		selfp->len = 0;                                                \
+	}
+
+/// Zero-initialize a B+ tree defined with `DEFINE_BTREE`.
+#define BTREE_NEW()                                      \
+	{                                                \
+		.root = CRZ_NULL, .height = 0, .len = 0, \
+		.leaves = POOL_NEW(CRZBTREE_POOL_CHUNK), \
+		.inners = POOL_NEW(CRZBTREE_POOL_CHUNK)  \
+	}
+
+/// Iterate over the keys and values of the B+ tree `self`, of type `Name`, in order.
+///
+/// `iter` is declared as a `Name##_Iter` inside the loop.
+/// The tree must not be modified while iterating over it.
+#define BTREE_FOR(Name, self, iter)                    \
+	for (Name##_Iter iter = Name##_first(&(self)); \
+	     BTREE_ITER_VALID(iter); BTREE_ITER_NEXT(&(iter)))
+
+/// Iterate over the keys and values of the B+ tree `self`, of type `Name`, in order, starting from the first key not less than `from_key`.
+///
+/// Stop the loop with `break` to iterate over a range.
+#define BTREE_FOR_FROM(Name, self, from_key, iter)                       \
+	for (Name##_Iter iter = Name##_lower_bound(&(self), (from_key)); \
+	     BTREE_ITER_VALID(iter); BTREE_ITER_NEXT(&(iter)))
+
+/// Whether the iterator `iter` points at a key, rather than past the last one.
+#define BTREE_ITER_VALID(iter) ((iter).leaf != CRZ_NULL)
+
+/// Get the key that the iterator `iter` points at.
+#define BTREE_ITER_KEY(iter) ((iter).leaf->keys[(iter).index])
+
+/// Get the value that the iterator `iter` points at.
+#define BTREE_ITER_VALUE(iter) ((iter).leaf->values[(iter).index])
+
+/// Move the iterator `iterp` (passed by pointer) to the next key.
+#define BTREE_ITER_NEXT(iterp)                               \
+	((iterp)->index + 1 < (iterp)->leaf->count ?         \
+		 (void)((iterp)->index++) :                  \
+		 (void)((iterp)->leaf = (iterp)->leaf->next, \
+			(iterp)->index = 0))
+
+/// INTERNAL: this function returns the amount of keys in the node `node`, whether it is a leaf or not.
+CRZ_SIZE crzbtree_count(const void *node);
+
+CRZ_SIZE crzbtree_count(const void *node)
+{
+	// Both kinds of nodes start with their amount of keys
+	return *(const CRZ_SIZE *)node;
+}
+
+#endif // CRZBTREE_H_
@@ -0,0 +1,474 @@
+#ifndef CRZCACHE_H_
+#define CRZCACHE_H_
+
+#include "crzarr.h"
+#include "crzdef.h"
+#include "crzhash.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifdef CRZCACHE_SHARDED
+#include <pthread.h>
+#endif // CRZCACHE_SHARDED
+
+/// The amount of shards of a `SHARDED_CACHE`, each with its own lock.
+#ifndef CRZCACHE_SHARDS
+#define CRZCACHE_SHARDS 16
+#endif // CRZCACHE_SHARDS
+
+/// Statistics about the use of a cache, kept as its `stats` field.
+typedef struct {
+	CRZ_SIZE hits;
+	CRZ_SIZE misses;
+	CRZ_SIZE insertions;
+	CRZ_SIZE evictions;
+} CacheStats;
+
+/// The bookkeeping for one entry of a cache, kept apart from its value so that evicting only sweeps over these.
+typedef struct {
+	/// The key of the entry, owned by the cache's `index`, or `CRZ_NULL` if the slot is free.
+	CRZ_STRING key;
+	CRZ_SIZE cost;
+	/// Whether the entry was hit since the clock hand last passed it.
+	CRZ_BOOL referenced;
+} CacheSlot;
+
+/// Define a struct for a cache from string keys to values of type `T`, which stays within a budget of entries and of cost.
+///
+/// Entries are evicted using the CLOCK policy: a hit only marks its entry as referenced, and evicting sweeps a hand over the entries, sparing (and unmarking) the referenced ones until it finds one which is not.
+/// This approximates least-recently-used eviction in O(1) amortized time per insertion, without any list to update on hits.
+///
+/// `index` maps each key to the slot holding its bookkeeping in `slots` and its value at the same index in `values`.
+#define CACHE(T)                            \
+	struct {                            \
+		HASH_TABLE(CRZ_SIZE) index; \
+		ARRAY(CacheSlot) slots;     \
+		ARRAY(T) values;            \
+		ARRAY(CRZ_SIZE) free_slots; \
+		CRZ_SIZE hand;              \
+		CRZ_SIZE len;               \
+		CRZ_SIZE cost;              \
+		CRZ_SIZE max_len;           \
+		CRZ_SIZE max_cost;          \
+		void (*drop)(void *value);  \
+		CacheStats stats;           \
+	}
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CACHE(T)` instead.
+typedef CACHE(char) Crzcache_AnyCache;
+
+/// Get the size in bytes of each value of the cache `self`.
+#define CACHE_VALUE_SIZE(self) sizeof(*(self).values.ptr)
+
+/// Zero-initialize a cache.
+///
+/// Requires calling `CACHE_INIT` afterwards.
+#define CACHE_NEW()                                               \
+	{                                                         \
+		.index = HASH_TABLE_NEW(), .slots = ARRAY_NEW(),  \
+		.values = ARRAY_NEW(), .free_slots = ARRAY_NEW(), \
+		.hand = 0, .len = 0, .cost = 0, .max_len = 0,     \
+		.max_cost = 0, .drop = CRZ_NULL, .stats = { 0 }   \
+	}
+
+/// Properly initialize the cache `selfp` (passed by pointer), to hold at most `entry_budget` entries with a total cost of at most `cost_budget`.
+///
+/// Either budget may be 0 to leave it unlimited. The cost of each entry is given when putting it, e.g. as the amount of bytes its value holds onto.
+/// `drop_fn` is called with a pointer to each value the cache lets go of, whether evicted, replaced, removed or freed, so that it can free what the value owns.
+/// It may be `CRZ_NULL` if the values do not own anything.
+#define CACHE_INIT(selfp, entry_budget, cost_budget, drop_fn)       \
+	crzcache_init((Crzcache_AnyCache *)(selfp), (entry_budget), \
+		      (cost_budget), (drop_fn), CACHE_VALUE_SIZE(*(selfp)))
+
+/// Get a pointer to the value at the key `get_key` in the cache `selfp` (passed by pointer), or `CRZ_NULL` if it is not cached.
+///
+/// A hit marks the entry as referenced and counts towards `stats`, but never allocates.
+/// The pointer is valid until the next `CACHE_PUT` or `CACHE_REMOVE`, which may evict the value or move the values.
+#define CACHE_GET(selfp, get_key)                             \
+	crzcache_get((Crzcache_AnyCache *)(selfp), (get_key), \
+		     CACHE_VALUE_SIZE(*(selfp)))
+
+/// Put the value `put_value` at the key `put_key`, with a cost of `put_cost`, into the cache `selfp` (passed by pointer).
+///
+/// If the key is not cached, evicts entries until the new one fits the budgets, then inserts it with a duplicate of `put_key` (made using `CRZ_STRDUP`).
+/// If the key is cached, replaces its value and cost, evicting other entries if the cost grew past the budget.
+/// An entry costing more than the whole cost budget is still cached, by evicting every other entry.
+#define CACHE_PUT(selfp, put_key, put_value, put_cost)            \
+	do {                                                      \
+		CRZ_SIZE crzcache_slot = crzcache_put(            \
+			(Crzcache_AnyCache *)(selfp), (put_key),  \
+			(put_cost), CACHE_VALUE_SIZE(*(selfp)));  \
+		(selfp)->values.ptr[crzcache_slot] = (put_value); \
+	} while (0)
+
+/// Remove the entry at the key `remove_key` from the cache `selfp` (passed by pointer), returning whether it was cached.
+#define CACHE_REMOVE(selfp, remove_key)                             \
+	crzcache_remove((Crzcache_AnyCache *)(selfp), (remove_key), \
+			CACHE_VALUE_SIZE(*(selfp)))
+
+/// Free the space allocated for the cache `selfp` (passed by pointer), dropping each of its values, and empty-out the fields of the struct.
+#define CACHE_FREE(selfp)                           \
+	crzcache_free((Crzcache_AnyCache *)(selfp), \
+		      CACHE_VALUE_SIZE(*(selfp)))
+
+#ifdef CRZCACHE_SHARDED
+
+/// Define a struct for a cache from string keys to values of type `T`, split into `CRZCACHE_SHARDS` caches which each have their own lock, so that threads using different shards do not contend.
+///
+/// Only available when `CRZCACHE_SHARDED` is defined before including `crzcache.h`, since it requires pthreads.
+/// Each key belongs to one shard, picked from its hash, and each shard gets an even share of the budgets.
+/// Note that the global `CRZ_STATS` counters are not synchronized, so they are only approximate when shards are used from several threads.
+#define SHARDED_CACHE(T)                                \
+	struct {                                        \
+		CACHE(T) shards[CRZCACHE_SHARDS];       \
+		pthread_mutex_t locks[CRZCACHE_SHARDS]; \
+	}
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SHARDED_CACHE(T)` instead.
+typedef SHARDED_CACHE(char) Crzcache_AnyShardedCache;
+
+/// Properly initialize the sharded cache `selfp` (passed by pointer), as for `CACHE_INIT`.
+///
+/// There is no `SHARDED_CACHE_NEW`, since locks cannot be portably zero-initialized.
+#define SHARDED_CACHE_INIT(selfp, entry_budget, cost_budget, drop_fn)   \
+	crzcache_sharded_init((Crzcache_AnyShardedCache *)(selfp),      \
+			      (entry_budget), (cost_budget), (drop_fn), \
+			      CACHE_VALUE_SIZE((selfp)->shards[0]))
+
+/// Copy the value at the key `get_key` in the sharded cache `selfp` (passed by pointer) into `outp` (passed by pointer), returning whether it was cached.
+///
+/// The value is copied while its shard is locked, since another thread may evict it right after.
+/// This means values which own memory must outlive their copies, so `drop` should not free what they own while other threads may still use it.
+#define SHARDED_CACHE_GET(selfp, get_key, outp)                   \
+	crzcache_sharded_get((Crzcache_AnyShardedCache *)(selfp), \
+			     (get_key), (outp),                   \
+			     CACHE_VALUE_SIZE((selfp)->shards[0]))
+
+/// Put the value `put_value` at the key `put_key`, with a cost of `put_cost`, into the sharded cache `selfp` (passed by pointer), as for `CACHE_PUT`.
+#define SHARDED_CACHE_PUT(selfp, put_key, put_value, put_cost)         \
+	do {                                                           \
+		CRZ_SIZE crzcache_shard = crzcache_shard_of(put_key);  \
+		pthread_mutex_lock(&(selfp)->locks[crzcache_shard]);   \
+		CACHE_PUT(&(selfp)->shards[crzcache_shard], (put_key), \
+			  put_value, (put_cost));                      \
+		pthread_mutex_unlock(&(selfp)->locks[crzcache_shard]); \
+	} while (0)
+
+/// Remove the entry at the key `remove_key` from the sharded cache `selfp` (passed by pointer), returning whether it was cached.
+#define SHARDED_CACHE_REMOVE(selfp, remove_key)                      \
+	crzcache_sharded_remove((Crzcache_AnyShardedCache *)(selfp), \
+				(remove_key),                        \
+				CACHE_VALUE_SIZE((selfp)->shards[0]))
+
+/// Get the `CacheStats` of the sharded cache `selfp` (passed by pointer), summed over its shards.
+#define SHARDED_CACHE_STATS(selfp) \
+	crzcache_sharded_stats((Crzcache_AnyShardedCache *)(selfp))
+
+/// Free the space allocated for the sharded cache `selfp` (passed by pointer), as for `CACHE_FREE`, and destroy its locks.
+#define SHARDED_CACHE_FREE(selfp)                                  \
+	crzcache_sharded_free((Crzcache_AnyShardedCache *)(selfp), \
+			      CACHE_VALUE_SIZE((selfp)->shards[0]))
+
+#endif // CRZCACHE_SHARDED
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CACHE_INIT(selfp, entry_budget, cost_budget, drop_fn)` instead.
+void crzcache_init(Crzcache_AnyCache *selfp, CRZ_SIZE max_len,
+		   CRZ_SIZE max_cost, void (*drop)(void *value),
+		   CRZ_SIZE value_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CACHE_GET(selfp, get_key)` instead.
+void *crzcache_get(Crzcache_AnyCache *selfp, CRZ_STRING key,
+		   CRZ_SIZE value_size);
+
+/// INTERNAL: this function lets go of the entry in the slot `slot`, dropping its value and freeing the slot.
+void crzcache_release(Crzcache_AnyCache *selfp, CRZ_SIZE slot,
+		      CRZ_SIZE value_size);
+
+/// INTERNAL: this function evicts entries until `extra_len` more entries with `extra_cost` more cost fit the budgets, never evicting the slot `keep`.
+///           `keep` may be `selfp->slots.len` to allow evicting every entry.
+void crzcache_evict(Crzcache_AnyCache *selfp, CRZ_SIZE extra_len,
+		    CRZ_SIZE extra_cost, CRZ_SIZE keep, CRZ_SIZE value_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CACHE_PUT(selfp, put_key, put_value, put_cost)` instead.
+CRZ_SIZE crzcache_put(Crzcache_AnyCache *selfp, CRZ_STRING key,
+		      CRZ_SIZE cost, CRZ_SIZE value_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CACHE_REMOVE(selfp, remove_key)` instead.
+CRZ_BOOL crzcache_remove(Crzcache_AnyCache *selfp, CRZ_STRING key,
+			 CRZ_SIZE value_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CACHE_FREE(selfp)` instead.
+void crzcache_free(Crzcache_AnyCache *selfp, CRZ_SIZE value_size);
+
+#ifdef CRZCACHE_SHARDED
+
+/// INTERNAL: this is the shard of a `SHARDED_CACHE` that `key` belongs to.
+CRZ_SIZE crzcache_shard_of(CRZ_STRING key);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SHARDED_CACHE_INIT(selfp, entry_budget, cost_budget, drop_fn)` instead.
+void crzcache_sharded_init(Crzcache_AnyShardedCache *selfp, CRZ_SIZE max_len,
+			   CRZ_SIZE max_cost, void (*drop)(void *value),
+			   CRZ_SIZE value_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SHARDED_CACHE_GET(selfp, get_key, outp)` instead.
+CRZ_BOOL crzcache_sharded_get(Crzcache_AnyShardedCache *selfp,
+			      CRZ_STRING key, void *outp,
+			      CRZ_SIZE value_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SHARDED_CACHE_REMOVE(selfp, remove_key)` instead.
+CRZ_BOOL crzcache_sharded_remove(Crzcache_AnyShardedCache *selfp,
+				 CRZ_STRING key, CRZ_SIZE value_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SHARDED_CACHE_STATS(selfp)` instead.
+CacheStats crzcache_sharded_stats(Crzcache_AnyShardedCache *selfp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SHARDED_CACHE_FREE(selfp)` instead.
+void crzcache_sharded_free(Crzcache_AnyShardedCache *selfp,
+			   CRZ_SIZE value_size);
+
+#endif // CRZCACHE_SHARDED
+
+void crzcache_init(Crzcache_AnyCache *selfp, CRZ_SIZE max_len,
+		   CRZ_SIZE max_cost, void (*drop)(void *value),
+		   CRZ_SIZE value_size)
+{
+	selfp->max_len = max_len;
+	selfp->max_cost = max_cost;
+	selfp->drop = drop;
+	// The index never holds more than one pair past the entry budget,
+	// so size it up front
+	crzhash_reserve((Crzhash_AnyHashTable *)&selfp->index,
+			max_len > 0 ? max_len + 1 : CRZARR_MINIMUM_CAPACITY,
+			HASH_TABLE_PAIR_SIZE(selfp->index));
+	if (max_len > 0) {
+		crzarr_grow_to((Crzarr_AnyArray *)&selfp->slots, max_len,
+			       sizeof(CacheSlot));
+		crzarr_grow_to((Crzarr_AnyArray *)&selfp->values, max_len,
+			       value_size);
+	}
+}
+
+void *crzcache_get(Crzcache_AnyCache *selfp, CRZ_STRING key,
+		   CRZ_SIZE value_size)
+{
+	HASH_PAIR(CRZ_SIZE) *pair =
+		crzhash_get((Crzhash_AnyHashTable *)&selfp->index, key);
+	if (pair == CRZ_NULL) {
+		selfp->stats.misses += 1;
+		return CRZ_NULL;
+	}
+
+	selfp->stats.hits += 1;
+	selfp->slots.ptr[pair->value].referenced = CRZ_TRUE;
+	return selfp->values.ptr + pair->value * value_size;
+}
+
+void crzcache_release(Crzcache_AnyCache *selfp, CRZ_SIZE slot,
+		      CRZ_SIZE value_size)
+{
+	CacheSlot *released = &selfp->slots.ptr[slot];
+	if (selfp->drop)
+		selfp->drop(selfp->values.ptr + slot * value_size);
+	// Frees the key too, since the slot only borrows the index's copy
+	crzhash_remove((Crzhash_AnyHashTable *)&selfp->index, released->key);
+	released->key = CRZ_NULL;
+	selfp->len -= 1;
+	selfp->cost -= released->cost;
+	crzarr_grow_to((Crzarr_AnyArray *)&selfp->free_slots,
+		       selfp->free_slots.len + 1, sizeof(CRZ_SIZE));
+	selfp->free_slots.ptr[selfp->free_slots.len++] = slot;
+}
+
+void crzcache_evict(Crzcache_AnyCache *selfp, CRZ_SIZE extra_len,
+		    CRZ_SIZE extra_cost, CRZ_SIZE keep, CRZ_SIZE value_size)
+{
+	CRZ_SIZE kept = keep < selfp->slots.len;
+	while (selfp->len > kept &&
+	       ((selfp->max_len > 0 &&
+		 selfp->len + extra_len > selfp->max_len) ||
+		(selfp->max_cost > 0 &&
+		 selfp->cost + extra_cost > selfp->max_cost))) {
+		if (selfp->hand >= selfp->slots.len)
+			selfp->hand = 0;
+		CRZ_SIZE slot = selfp->hand++;
+		CacheSlot *candidate = &selfp->slots.ptr[slot];
+
+		if (candidate->key == CRZ_NULL || slot == keep)
+			continue;
+		if (candidate->referenced) {
+			candidate->referenced = CRZ_FALSE;
+			continue;
+		}
+
+		crzcache_release(selfp, slot, value_size);
+		selfp->stats.evictions += 1;
+	}
+}
+
+CRZ_SIZE crzcache_put(Crzcache_AnyCache *selfp, CRZ_STRING key,
+		      CRZ_SIZE cost, CRZ_SIZE value_size)
+{
+	CRZ_BOOL created;
+	// Pairs are never moved by removing others, so evicting keeps it valid
+	HASH_PAIR(CRZ_SIZE) *pair =
+		crzhash_entry((Crzhash_AnyHashTable *)&selfp->index, key,
+			      HASH_TABLE_PAIR_SIZE(selfp->index), &created);
+
+	if (!created) {
+		CRZ_SIZE slot = pair->value;
+		CacheSlot *existing = &selfp->slots.ptr[slot];
+		if (selfp->drop)
+			selfp->drop(selfp->values.ptr + slot * value_size);
+		selfp->cost = selfp->cost - existing->cost + cost;
+		existing->cost = cost;
+		existing->referenced = CRZ_TRUE;
+		crzcache_evict(selfp, 0, 0, slot, value_size);
+		return slot;
+	}
+
+	crzcache_evict(selfp, 1, cost, selfp->slots.len, value_size);
+
+	CRZ_SIZE slot;
+	if (selfp->free_slots.len > 0) {
+		slot = selfp->free_slots.ptr[--selfp->free_slots.len];
+	} else {
+		slot = selfp->slots.len;
+		crzarr_grow_to((Crzarr_AnyArray *)&selfp->slots, slot + 1,
+			       sizeof(CacheSlot));
+		crzarr_grow_to((Crzarr_AnyArray *)&selfp->values, slot + 1,
+			       value_size);
+		selfp->slots.len += 1;
+		selfp->values.len += 1;
+	}
+
+	pair->value = slot;
+	selfp->slots.ptr[slot].key = pair->key;
+	selfp->slots.ptr[slot].cost = cost;
+	// New entries must be hit once before the hand spares them
+	selfp->slots.ptr[slot].referenced = CRZ_FALSE;
+	selfp->len += 1;
+	selfp->cost += cost;
+	selfp->stats.insertions += 1;
+	return slot;
+}
+
+CRZ_BOOL crzcache_remove(Crzcache_AnyCache *selfp, CRZ_STRING key,
+			 CRZ_SIZE value_size)
+{
+	HASH_PAIR(CRZ_SIZE) *pair =
+		crzhash_get((Crzhash_AnyHashTable *)&selfp->index, key);
+	if (pair == CRZ_NULL)
+		return CRZ_FALSE;
+
+	crzcache_release(selfp, pair->value, value_size);
+	return CRZ_TRUE;
+}
+
+void crzcache_free(Crzcache_AnyCache *selfp, CRZ_SIZE value_size)
+{
+	if (selfp->drop) {
+		for (CRZ_SIZE i = 0; i < selfp->slots.len; i++) {
+			if (selfp->slots.ptr[i].key)
+				selfp->drop(selfp->values.ptr + i * value_size);
+		}
+	}
+	HASH_TABLE_FREE(&selfp->index);
+	ARRAY_FREE(&selfp->slots);
+	ARRAY_FREE(&selfp->values);
+	ARRAY_FREE(&selfp->free_slots);
+	selfp->hand = 0;
+	selfp->len = 0;
+	selfp->cost = 0;
+	memset(&selfp->stats, 0, sizeof(selfp->stats));
+}
+
+#ifdef CRZCACHE_SHARDED
+
+CRZ_SIZE crzcache_shard_of(CRZ_STRING key)
+{
+	// Take the high bits of a multiplicative hash, since the index of each
+	// shard already uses the low bits of `CRZHASH_HASH`
+	uint64_t mixed = (uint64_t)CRZHASH_HASH(key) * 0x9e3779b97f4a7c15ull;
+	return (CRZ_SIZE)(mixed >> 40) % CRZCACHE_SHARDS;
+}
+
+void crzcache_sharded_init(Crzcache_AnyShardedCache *selfp, CRZ_SIZE max_len,
+			   CRZ_SIZE max_cost, void (*drop)(void *value),
+			   CRZ_SIZE value_size)
+{
+	for (CRZ_SIZE i = 0; i < CRZCACHE_SHARDS; i++) {
+		memset(&selfp->shards[i], 0, sizeof(selfp->shards[i]));
+		crzcache_init((Crzcache_AnyCache *)&selfp->shards[i],
+			      (max_len + CRZCACHE_SHARDS - 1) / CRZCACHE_SHARDS,
+			      (max_cost + CRZCACHE_SHARDS - 1) /
+				      CRZCACHE_SHARDS,
+			      drop, value_size);
+		pthread_mutex_init(&selfp->locks[i], CRZ_NULL);
+	}
+}
+
+CRZ_BOOL crzcache_sharded_get(Crzcache_AnyShardedCache *selfp,
+			      CRZ_STRING key, void *outp,
+			      CRZ_SIZE value_size)
+{
+	CRZ_SIZE shard = crzcache_shard_of(key);
+	pthread_mutex_lock(&selfp->locks[shard]);
+	void *value = crzcache_get((Crzcache_AnyCache *)&selfp->shards[shard],
+				   key, value_size);
+	if (value)
+		memcpy(outp, value, value_size);
+	pthread_mutex_unlock(&selfp->locks[shard]);
+	return value != CRZ_NULL;
+}
+
+CRZ_BOOL crzcache_sharded_remove(Crzcache_AnyShardedCache *selfp,
+				 CRZ_STRING key, CRZ_SIZE value_size)
+{
+	CRZ_SIZE shard = crzcache_shard_of(key);
+	pthread_mutex_lock(&selfp->locks[shard]);
+	CRZ_BOOL removed =
+		crzcache_remove((Crzcache_AnyCache *)&selfp->shards[shard], key,
+				value_size);
+	pthread_mutex_unlock(&selfp->locks[shard]);
+	return removed;
+}
+
+CacheStats crzcache_sharded_stats(Crzcache_AnyShardedCache *selfp)
+{
+	CacheStats stats = { 0 };
+	for (CRZ_SIZE i = 0; i < CRZCACHE_SHARDS; i++) {
+		pthread_mutex_lock(&selfp->locks[i]);
+		stats.hits += selfp->shards[i].stats.hits;
+		stats.misses += selfp->shards[i].stats.misses;
+		stats.insertions += selfp->shards[i].stats.insertions;
+		stats.evictions += selfp->shards[i].stats.evictions;
+		pthread_mutex_unlock(&selfp->locks[i]);
+	}
+	return stats;
+}
+
+void crzcache_sharded_free(Crzcache_AnyShardedCache *selfp,
+			   CRZ_SIZE value_size)
+{
+	for (CRZ_SIZE i = 0; i < CRZCACHE_SHARDS; i++) {
+		crzcache_free((Crzcache_AnyCache *)&selfp->shards[i],
+			      value_size);
+		pthread_mutex_destroy(&selfp->locks[i]);
+	}
+}
+
+#endif // CRZCACHE_SHARDED
+
+#endif // CRZCACHE_H_
@@ -0,0 +1,685 @@
+#ifndef CRZCODEC_H_
+#define CRZCODEC_H_
+
+#include "crzarr.h"
+#include "crzdef.h"
+#include "crzsb.h"
+#include "crzsv.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) && !defined(CRZCODEC_NO_SIMD)
+#include <emmintrin.h>
+#define CRZCODEC_SSE2
+#endif
+
+#if defined(__SSSE3__) && !defined(CRZCODEC_NO_SIMD)
+#include <tmmintrin.h>
+#define CRZCODEC_SSSE3
+#endif
+
+#if defined(__AVX2__) && !defined(CRZCODEC_NO_SIMD)
+#include <immintrin.h>
+#define CRZCODEC_AVX2
+#endif
+
+/// The length of the hex encoding of `count_chars` bytes.
+#define CRZCODEC_HEX_SIZE(count_chars) ((count_chars) * 2)
+
+/// The length of the padded base64 encoding of `count_chars` bytes.
+#define CRZCODEC_BASE64_SIZE(count_chars) (((count_chars) + 2) / 3 * 4)
+
+/// Append the lowercase hex encoding of the `count_chars` bytes at `buf` to the string builder `selfp` (passed by pointer).
+///
+/// The string builder is grown only once, to fit the whole encoding.
+#define SB_PUSH_HEX(selfp, buf, count_chars) \
+	crzcodec_push_hex((selfp), (const unsigned char *)(buf), (count_chars))
+
+/// Append the padded base64 encoding of the `count_chars` bytes at `buf` to the string builder `selfp` (passed by pointer), using the standard alphabet.
+///
+/// The string builder is grown only once, to fit the whole encoding.
+#define SB_PUSH_BASE64(selfp, buf, count_chars)                     \
+	crzcodec_push_base64((selfp), (const unsigned char *)(buf), \
+			     (count_chars))
+
+/// Append the `count_chars` bytes at `buf` to the string builder `selfp` (passed by pointer), escaped for the inside of a JSON string.
+///
+/// Quotes, backslashes and control characters are escaped, with the short escapes such as `\n` where JSON has them.
+/// Other bytes, including UTF-8 sequences, are appended as they are.
+/// The string builder is grown only once, to fit the whole encoding.
+#define SB_PUSH_JSON_ESCAPED(selfp, buf, count_chars)                     \
+	crzcodec_push_json_escaped((selfp), (const unsigned char *)(buf), \
+				   (count_chars))
+
+/// Append the bytes hex encoded in the `StringView` `self` to the string builder `sbp` (passed by pointer).
+///
+/// Both lowercase and uppercase digits are accepted.
+/// Returns whether `self` was valid hex, otherwise `sbp` is left as it was.
+#define SV_DECODE_HEX(self, sbp) \
+	crzcodec_decode_hex((self).ptr, (self).len, (sbp))
+
+/// Append the bytes base64 encoded in the `StringView` `self` to the string builder `sbp` (passed by pointer).
+///
+/// `self` must use the standard alphabet, and be padded to a multiple of 4 characters.
+/// Returns whether `self` was valid base64, otherwise `sbp` is left as it was.
+#define SV_DECODE_BASE64(self, sbp) \
+	crzcodec_decode_base64((self).ptr, (self).len, (sbp))
+
+/// Append the bytes escaped as the inside of a JSON string in the `StringView` `self` to the string builder `sbp` (passed by pointer).
+///
+/// `\u` escapes are appended as UTF-8, joining surrogate pairs.
+/// Returns whether `self` was validly escaped, without unescaped quotes or control characters, otherwise `sbp` is left as it was.
+#define SV_DECODE_JSON_ESCAPED(self, sbp) \
+	crzcodec_decode_json_escaped((self).ptr, (self).len, (sbp))
+
+/// INTERNAL: this function grows `sbp` to fit `count_chars` more characters, returning where they go.
+///           The caller adds them to the length of `sbp` once it has written them.
+char *crzcodec_reserve(StringBuilder *sbp, CRZ_SIZE count_chars);
+
+/// INTERNAL: this is the value of the hex digit `c`, or -1 if it is not one.
+int crzcodec_hex_value(unsigned char c);
+
+/// INTERNAL: this is the value of the base64 character `c`, or -1 if it is not one.
+int crzcodec_base64_value(unsigned char c);
+
+/// INTERNAL: this is the length of `c` escaped for the inside of a JSON string.
+CRZ_SIZE crzcodec_json_escaped_size(unsigned char c);
+
+/// INTERNAL: this function writes `c` escaped for the inside of a JSON string to `out`, returning the end of what it wrote.
+char *crzcodec_json_escape(char *out, unsigned char c);
+
+/// INTERNAL: this is the amount of bytes at the start of `ptr` which need no JSON escaping.
+CRZ_SIZE crzcodec_json_plain(const unsigned char *ptr, CRZ_SIZE len);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SB_PUSH_HEX(selfp, buf, count_chars)` instead.
+void crzcodec_push_hex(StringBuilder *sbp, const unsigned char *ptr,
+		       CRZ_SIZE len);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SB_PUSH_BASE64(selfp, buf, count_chars)` instead.
+void crzcodec_push_base64(StringBuilder *sbp, const unsigned char *ptr,
+			  CRZ_SIZE len);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SB_PUSH_JSON_ESCAPED(selfp, buf, count_chars)` instead.
+void crzcodec_push_json_escaped(StringBuilder *sbp, const unsigned char *ptr,
+				CRZ_SIZE len);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SV_DECODE_HEX(self, sbp)` instead.
+CRZ_BOOL crzcodec_decode_hex(const char *ptr, CRZ_SIZE len, StringBuilder *sbp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SV_DECODE_BASE64(self, sbp)` instead.
+CRZ_BOOL crzcodec_decode_base64(const char *ptr, CRZ_SIZE len,
+				StringBuilder *sbp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SV_DECODE_JSON_ESCAPED(self, sbp)` instead.
+CRZ_BOOL crzcodec_decode_json_escaped(const char *ptr, CRZ_SIZE len,
+				      StringBuilder *sbp);
+
+#ifdef CRZCODEC_SSE2
+/// INTERNAL: this is whether each of the 16 bytes in `chars` is between `first` and `last`, both ASCII, using SSE2.
+__m128i crzcodec_in_range_sse2(__m128i chars, char first, char last);
+
+/// INTERNAL: this is the hex digit of each of the 16 nibbles in `nibbles`, using SSE2.
+__m128i crzcodec_hex_digits_sse2(__m128i nibbles);
+
+/// INTERNAL: this function hex encodes the 16 bytes at `ptr` into the 32 characters at `out` using SSE2.
+void crzcodec_hex16_sse2(const unsigned char *ptr, char *out);
+
+/// INTERNAL: this function hex decodes the 32 characters at `ptr` into the 16 bytes at `out` using SSE2.
+///           Returns `CRZ_FALSE` if any of them is not a hex digit.
+CRZ_BOOL crzcodec_unhex32_sse2(const char *ptr, unsigned char *out);
+#endif // CRZCODEC_SSE2
+
+#ifdef CRZCODEC_SSSE3
+/// INTERNAL: this function base64 encodes the first 12 of the 16 bytes at `ptr` into the 16 characters at `out` using SSSE3.
+void crzcodec_base64_12_ssse3(const unsigned char *ptr, char *out);
+
+/// INTERNAL: this function base64 decodes the 16 characters at `ptr` into the 12 bytes at `out` using SSSE3.
+///           Returns `CRZ_FALSE` if any of them is not a base64 character.
+CRZ_BOOL crzcodec_unbase64_16_ssse3(const char *ptr, unsigned char *out);
+#endif // CRZCODEC_SSSE3
+
+#ifdef CRZCODEC_AVX2
+/// INTERNAL: this function hex encodes the 32 bytes at `ptr` into the 64 characters at `out` using AVX2.
+void crzcodec_hex32_avx2(const unsigned char *ptr, char *out);
+#endif // CRZCODEC_AVX2
+
+/// INTERNAL: this is the lowercase hex digit of each nibble.
+static const char crzcodec_hex_digits[16] = "0123456789abcdef";
+
+/// INTERNAL: this is the base64 character of each 6-bit value.
+static const char crzcodec_base64_chars[64] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+char *crzcodec_reserve(StringBuilder *sbp, CRZ_SIZE count_chars)
+{
+	crzarr_grow_to((Crzarr_AnyArray *)sbp, sbp->len + count_chars, 1);
+	return sbp->ptr + sbp->len;
+}
+
+int crzcodec_hex_value(unsigned char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	c |= 0x20;
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	return -1;
+}
+
+int crzcodec_base64_value(unsigned char c)
+{
+	if (c >= 'A' && c <= 'Z')
+		return c - 'A';
+	if (c >= 'a' && c <= 'z')
+		return c - 'a' + 26;
+	if (c >= '0' && c <= '9')
+		return c - '0' + 52;
+	if (c == '+')
+		return 62;
+	if (c == '/')
+		return 63;
+	return -1;
+}
+
+CRZ_SIZE crzcodec_json_escaped_size(unsigned char c)
+{
+	switch (c) {
+	case '"':
+	case '\\':
+	case '\b':
+	case '\f':
+	case '\n':
+	case '\r':
+	case '\t':
+		return 2;
+	default:
+		return c < 0x20 ? 6 : 1;
+	}
+}
+
+char *crzcodec_json_escape(char *out, unsigned char c)
+{
+	char short_escape = 0;
+	switch (c) {
+	case '"':
+	case '\\':
+		short_escape = (char)c;
+		break;
+	case '\b':
+		short_escape = 'b';
+		break;
+	case '\f':
+		short_escape = 'f';
+		break;
+	case '\n':
+		short_escape = 'n';
+		break;
+	case '\r':
+		short_escape = 'r';
+		break;
+	case '\t':
+		short_escape = 't';
+		break;
+	default:
+		if (c >= 0x20) {
+			*out++ = (char)c;
+			return out;
+		}
+	}
+
+	*out++ = '\\';
+	if (short_escape) {
+		*out++ = short_escape;
+		return out;
+	}
+	CRZ_MEMCPY(out, "u00", 3);
+	out[3] = crzcodec_hex_digits[c >> 4];
+	out[4] = crzcodec_hex_digits[c & 15];
+	return out + 5;
+}
+
+CRZ_SIZE crzcodec_json_plain(const unsigned char *ptr, CRZ_SIZE len)
+{
+	CRZ_SIZE i = 0;
+#ifdef CRZCODEC_AVX2
+	const __m256i quote32 = _mm256_set1_epi8('"');
+	const __m256i backslash32 = _mm256_set1_epi8('\\');
+	const __m256i last_control32 = _mm256_set1_epi8(0x1F);
+	for (; i + 32 <= len; i += 32) {
+		__m256i bytes = _mm256_loadu_si256((const __m256i *)(ptr + i));
+		__m256i special = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(bytes, quote32),
+					_mm256_cmpeq_epi8(bytes, backslash32)),
+			_mm256_cmpeq_epi8(
+				_mm256_min_epu8(bytes, last_control32), bytes));
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(special);
+		if (mask)
+			return i + CRZ_CTZ(mask);
+	}
+#endif // CRZCODEC_AVX2
+#ifdef CRZCODEC_SSE2
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i last_control = _mm_set1_epi8(0x1F);
+	for (; i + 16 <= len; i += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i *)(ptr + i));
+		// Control characters are the bytes which are at most 0x1F
+		__m128i special = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(bytes, quote),
+				     _mm_cmpeq_epi8(bytes, backslash)),
+			_mm_cmpeq_epi8(_mm_min_epu8(bytes, last_control),
+				       bytes));
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(special);
+		if (mask)
+			return i + CRZ_CTZ(mask);
+	}
+#endif // CRZCODEC_SSE2
+	for (; i < len; i++) {
+		if (ptr[i] == '"' || ptr[i] == '\\' || ptr[i] < 0x20)
+			return i;
+	}
+	return len;
+}
+
+void crzcodec_push_hex(StringBuilder *sbp, const unsigned char *ptr,
+		       CRZ_SIZE len)
+{
+	char *out = crzcodec_reserve(sbp, CRZCODEC_HEX_SIZE(len));
+	CRZ_SIZE i = 0;
+#ifdef CRZCODEC_AVX2
+	for (; i + 32 <= len; i += 32)
+		crzcodec_hex32_avx2(ptr + i, out + i * 2);
+#endif // CRZCODEC_AVX2
+#ifdef CRZCODEC_SSE2
+	for (; i + 16 <= len; i += 16)
+		crzcodec_hex16_sse2(ptr + i, out + i * 2);
+#endif // CRZCODEC_SSE2
+	for (; i < len; i++) {
+		out[i * 2] = crzcodec_hex_digits[ptr[i] >> 4];
+		out[i * 2 + 1] = crzcodec_hex_digits[ptr[i] & 15];
+	}
+	sbp->len += CRZCODEC_HEX_SIZE(len);
+}
+
+void crzcodec_push_base64(StringBuilder *sbp, const unsigned char *ptr,
+			  CRZ_SIZE len)
+{
+	char *out = crzcodec_reserve(sbp, CRZCODEC_BASE64_SIZE(len));
+	CRZ_SIZE i = 0;
+#ifdef CRZCODEC_SSSE3
+	// Each step reads 16 bytes to encode 12 of them
+	for (; i + 16 <= len; i += 12, out += 16)
+		crzcodec_base64_12_ssse3(ptr + i, out);
+#endif // CRZCODEC_SSSE3
+	for (; i + 3 <= len; i += 3, out += 4) {
+		uint32_t triple = (uint32_t)ptr[i] << 16 |
+				  (uint32_t)ptr[i + 1] << 8 | ptr[i + 2];
+		out[0] = crzcodec_base64_chars[triple >> 18];
+		out[1] = crzcodec_base64_chars[(triple >> 12) & 63];
+		out[2] = crzcodec_base64_chars[(triple >> 6) & 63];
+		out[3] = crzcodec_base64_chars[triple & 63];
+	}
+	if (i < len) {
+		uint32_t triple = (uint32_t)ptr[i] << 16;
+		if (i + 1 < len)
+			triple |= (uint32_t)ptr[i + 1] << 8;
+		out[0] = crzcodec_base64_chars[triple >> 18];
+		out[1] = crzcodec_base64_chars[(triple >> 12) & 63];
+		out[2] = '=';
+		if (i + 1 < len)
+			out[2] = crzcodec_base64_chars[(triple >> 6) & 63];
+		out[3] = '=';
+	}
+	sbp->len += CRZCODEC_BASE64_SIZE(len);
+}
+
+void crzcodec_push_json_escaped(StringBuilder *sbp, const unsigned char *ptr,
+				CRZ_SIZE len)
+{
+	// Escapes are rare, so finding them twice beats growing as they come
+	CRZ_SIZE size = len;
+	for (CRZ_SIZE i = 0; i < len; i++) {
+		i += crzcodec_json_plain(ptr + i, len - i);
+		if (i < len)
+			size += crzcodec_json_escaped_size(ptr[i]) - 1;
+	}
+
+	char *out = crzcodec_reserve(sbp, size);
+	for (CRZ_SIZE i = 0; i < len; i++) {
+		CRZ_SIZE plain = crzcodec_json_plain(ptr + i, len - i);
+		CRZ_MEMCPY(out, ptr + i, plain);
+		out += plain;
+		i += plain;
+		if (i < len)
+			out = crzcodec_json_escape(out, ptr[i]);
+	}
+	sbp->len += size;
+}
+
+CRZ_BOOL crzcodec_decode_hex(const char *ptr, CRZ_SIZE len, StringBuilder *sbp)
+{
+	if (len % 2 != 0)
+		return CRZ_FALSE;
+
+	unsigned char *out = (unsigned char *)crzcodec_reserve(sbp, len / 2);
+	CRZ_SIZE i = 0;
+#ifdef CRZCODEC_SSE2
+	for (; i + 32 <= len; i += 32) {
+		if (!crzcodec_unhex32_sse2(ptr + i, out + i / 2))
+			return CRZ_FALSE;
+	}
+#endif // CRZCODEC_SSE2
+	for (; i < len; i += 2) {
+		int high = crzcodec_hex_value((unsigned char)ptr[i]);
+		int low = crzcodec_hex_value((unsigned char)ptr[i + 1]);
+		if (high < 0 || low < 0)
+			return CRZ_FALSE;
+		out[i / 2] = (unsigned char)(high << 4 | low);
+	}
+	sbp->len += len / 2;
+	return CRZ_TRUE;
+}
+
+CRZ_BOOL crzcodec_decode_base64(const char *ptr, CRZ_SIZE len,
+				StringBuilder *sbp)
+{
+	if (len % 4 != 0)
+		return CRZ_FALSE;
+	CRZ_SIZE padding = 0;
+	if (len > 0 && ptr[len - 1] == '=')
+		padding = ptr[len - 2] == '=' ? 2 : 1;
+	CRZ_SIZE size = len / 4 * 3 - padding;
+
+	unsigned char *out = (unsigned char *)crzcodec_reserve(sbp, size);
+	CRZ_SIZE i = 0;
+#ifdef CRZCODEC_SSSE3
+	// The last 4 characters may be padded, so the loop below decodes them
+	for (; i + 20 <= len; i += 16, out += 12) {
+		if (!crzcodec_unbase64_16_ssse3(ptr + i, out))
+			return CRZ_FALSE;
+	}
+#endif // CRZCODEC_SSSE3
+	for (; i < len; i += 4) {
+		CRZ_SIZE chars = i + 4 == len ? 4 - padding : 4;
+		uint32_t triple = 0;
+		for (CRZ_SIZE j = 0; j < 4; j++) {
+			int value = j < chars ?
+					    crzcodec_base64_value(
+						    (unsigned char)ptr[i + j]) :
+					    0;
+			if (value < 0)
+				return CRZ_FALSE;
+			triple = triple << 6 | (uint32_t)value;
+		}
+		for (CRZ_SIZE j = 0; j + 1 < chars; j++)
+			*out++ = (unsigned char)(triple >> (16 - j * 8));
+	}
+	sbp->len += size;
+	return CRZ_TRUE;
+}
+
+CRZ_BOOL crzcodec_decode_json_escaped(const char *ptr, CRZ_SIZE len,
+				      StringBuilder *sbp)
+{
+	// Every escape is longer than what it decodes to
+	const unsigned char *bytes = (const unsigned char *)ptr;
+	char *start = crzcodec_reserve(sbp, len);
+	char *out = start;
+	CRZ_SIZE i = 0;
+	while (i < len) {
+		CRZ_SIZE plain = crzcodec_json_plain(bytes + i, len - i);
+		CRZ_MEMCPY(out, bytes + i, plain);
+		out += plain;
+		i += plain;
+		if (i == len)
+			break;
+		if (bytes[i] != '\\' || i + 1 == len)
+			return CRZ_FALSE;
+
+		char escaped = (char)bytes[i + 1];
+		i += 2;
+		switch (escaped) {
+		case '"':
+		case '\\':
+		case '/':
+			*out++ = escaped;
+			continue;
+		case 'b':
+			*out++ = '\b';
+			continue;
+		case 'f':
+			*out++ = '\f';
+			continue;
+		case 'n':
+			*out++ = '\n';
+			continue;
+		case 'r':
+			*out++ = '\r';
+			continue;
+		case 't':
+			*out++ = '\t';
+			continue;
+		case 'u':
+			break;
+		default:
+			return CRZ_FALSE;
+		}
+
+		uint32_t codepoint = 0;
+		for (int unit = 0; unit < 2; unit++) {
+			if (len - i < 4)
+				return CRZ_FALSE;
+			uint32_t value = 0;
+			for (CRZ_SIZE j = 0; j < 4; j++) {
+				int digit = crzcodec_hex_value(bytes[i + j]);
+				if (digit < 0)
+					return CRZ_FALSE;
+				value = value << 4 | (uint32_t)digit;
+			}
+			i += 4;
+
+			if (unit == 1) {
+				if (value < 0xDC00 || value > 0xDFFF)
+					return CRZ_FALSE;
+				codepoint = 0x10000 + (value - 0xDC00) +
+					    ((codepoint - 0xD800) << 10);
+			} else if (value >= 0xD800 && value <= 0xDBFF) {
+				// A low surrogate must follow a high one
+				if (len - i < 2 || bytes[i] != '\\' ||
+				    bytes[i + 1] != 'u')
+					return CRZ_FALSE;
+				codepoint = value;
+				i += 2;
+				continue;
+			} else if (value >= 0xDC00 && value <= 0xDFFF) {
+				return CRZ_FALSE;
+			} else {
+				codepoint = value;
+			}
+			break;
+		}
+
+		if (codepoint < 0x80) {
+			*out++ = (char)codepoint;
+		} else if (codepoint < 0x800) {
+			*out++ = (char)(0xC0 | codepoint >> 6);
+			*out++ = (char)(0x80 | (codepoint & 0x3F));
+		} else if (codepoint < 0x10000) {
+			*out++ = (char)(0xE0 | codepoint >> 12);
+			*out++ = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+			*out++ = (char)(0x80 | (codepoint & 0x3F));
+		} else {
+			*out++ = (char)(0xF0 | codepoint >> 18);
+			*out++ = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+			*out++ = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+			*out++ = (char)(0x80 | (codepoint & 0x3F));
+		}
+	}
+	sbp->len += (CRZ_SIZE)(out - start);
+	return CRZ_TRUE;
+}
+
+#ifdef CRZCODEC_SSE2
+__m128i crzcodec_in_range_sse2(__m128i chars, char first, char last)
+{
+	// Bytes past 0x7F are negative, so they are never in the range
+	return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(first - 1)),
+			     _mm_cmplt_epi8(chars, _mm_set1_epi8(last + 1)));
+}
+
+__m128i crzcodec_hex_digits_sse2(__m128i nibbles)
+{
+	// Nibbles past 9 skip the 39 characters between '9' and 'a'
+	__m128i letters =
+		_mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+			      _mm_set1_epi8('a' - '9' - 1));
+	return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+}
+
+void crzcodec_hex16_sse2(const unsigned char *ptr, char *out)
+{
+	const __m128i low_nibble = _mm_set1_epi8(0x0F);
+	__m128i bytes = _mm_loadu_si128((const __m128i *)ptr);
+	__m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibble);
+	__m128i low = _mm_and_si128(bytes, low_nibble);
+	__m128i first = _mm_unpacklo_epi8(high, low);
+	__m128i second = _mm_unpackhi_epi8(high, low);
+	_mm_storeu_si128((__m128i *)out, crzcodec_hex_digits_sse2(first));
+	_mm_storeu_si128((__m128i *)(out + 16),
+			 crzcodec_hex_digits_sse2(second));
+}
+
+CRZ_BOOL crzcodec_unhex32_sse2(const char *ptr, unsigned char *out)
+{
+	__m128i halves[2];
+	for (int half = 0; half < 2; half++) {
+		__m128i chars =
+			_mm_loadu_si128((const __m128i *)(ptr + half * 16));
+		__m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+		__m128i is_digit = crzcodec_in_range_sse2(chars, '0', '9');
+		__m128i is_letter = crzcodec_in_range_sse2(lower, 'a', 'f');
+		if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) !=
+		    0xFFFF)
+			return CRZ_FALSE;
+
+		__m128i values = _mm_or_si128(
+			_mm_and_si128(is_digit,
+				      _mm_sub_epi8(chars, _mm_set1_epi8('0'))),
+			_mm_and_si128(is_letter,
+				      _mm_sub_epi8(lower,
+						   _mm_set1_epi8('a' - 10))));
+		// Each 16-bit lane holds the high nibble then the low one
+		halves[half] = _mm_or_si128(
+			_mm_and_si128(_mm_slli_epi16(values, 4),
+				      _mm_set1_epi16(0x00F0)),
+			_mm_srli_epi16(values, 8));
+	}
+	__m128i bytes = _mm_packus_epi16(halves[0], halves[1]);
+	_mm_storeu_si128((__m128i *)out, bytes);
+	return CRZ_TRUE;
+}
+#endif // CRZCODEC_SSE2
+
+#ifdef CRZCODEC_SSSE3
+// Following Muła and Lemire's "Faster Base64 Encoding and Decoding Using
+// AVX2 Instructions", with 128-bit vectors
+void crzcodec_base64_12_ssse3(const unsigned char *ptr, char *out)
+{
+	__m128i bytes = _mm_loadu_si128((const __m128i *)ptr);
+	// Spread each 3 bytes over a 32-bit lane as [1, 0, 2, 1]
+	bytes = _mm_shuffle_epi8(bytes, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7,
+						      6, 8, 7, 10, 9, 11, 10));
+	// Move each 6-bit value to the bottom of its own byte
+	__m128i first_third = _mm_mulhi_epu16(
+		_mm_and_si128(bytes, _mm_set1_epi32(0x0FC0FC00)),
+		_mm_set1_epi32(0x04000040));
+	__m128i second_fourth = _mm_mullo_epi16(
+		_mm_and_si128(bytes, _mm_set1_epi32(0x003F03F0)),
+		_mm_set1_epi32(0x01000010));
+	__m128i values = _mm_or_si128(first_third, second_fourth);
+
+	// Find the offset from each value to its character by its range
+	__m128i range = _mm_subs_epu8(values, _mm_set1_epi8(51));
+	__m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), values);
+	range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+	const __m128i offsets = _mm_setr_epi8(
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+		'/' - 63, 'A', 0, 0);
+	__m128i chars =
+		_mm_add_epi8(values, _mm_shuffle_epi8(offsets, range));
+	_mm_storeu_si128((__m128i *)out, chars);
+}
+
+CRZ_BOOL crzcodec_unbase64_16_ssse3(const char *ptr, unsigned char *out)
+{
+	__m128i chars = _mm_loadu_si128((const __m128i *)ptr);
+	__m128i upper = crzcodec_in_range_sse2(chars, 'A', 'Z');
+	__m128i lower = crzcodec_in_range_sse2(chars, 'a', 'z');
+	__m128i digit = crzcodec_in_range_sse2(chars, '0', '9');
+	__m128i plus = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+'));
+	__m128i slash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+	__m128i valid = _mm_or_si128(_mm_or_si128(upper, lower),
+				     _mm_or_si128(_mm_or_si128(digit, plus),
+						  slash));
+	if (_mm_movemask_epi8(valid) != 0xFFFF)
+		return CRZ_FALSE;
+
+	__m128i offset = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+	offset = _mm_or_si128(offset,
+			      _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+	offset = _mm_or_si128(offset,
+			      _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+	offset = _mm_or_si128(offset,
+			      _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+	offset = _mm_or_si128(offset,
+			      _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+	__m128i values = _mm_add_epi8(chars, offset);
+
+	// Join each 4 6-bit values into 3 bytes, then drop the spare 4th bytes
+	__m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+	__m128i triples = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+	__m128i bytes = _mm_shuffle_epi8(
+		triples, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+				       -1, -1, -1, -1));
+	_mm_storel_epi64((__m128i *)out, bytes);
+	uint32_t last = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(bytes, 8));
+	CRZ_MEMCPY(out + 8, &last, sizeof(last));
+	return CRZ_TRUE;
+}
+#endif // CRZCODEC_SSSE3
+
+#ifdef CRZCODEC_AVX2
+void crzcodec_hex32_avx2(const unsigned char *ptr, char *out)
+{
+	const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+	__m256i bytes = _mm256_loadu_si256((const __m256i *)ptr);
+	__m256i high =
+		_mm256_and_si256(_mm256_srli_epi16(bytes, 4), low_nibble);
+	__m256i low = _mm256_and_si256(bytes, low_nibble);
+	// Interleaving stays within 128-bit lanes, so put them back in order
+	__m256i first = _mm256_unpacklo_epi8(high, low);
+	__m256i second = _mm256_unpackhi_epi8(high, low);
+	__m256i nibbles[2] = {
+		_mm256_permute2x128_si256(first, second, 0x20),
+		_mm256_permute2x128_si256(first, second, 0x31),
+	};
+	for (int i = 0; i < 2; i++) {
+		__m256i letters = _mm256_and_si256(
+			_mm256_cmpgt_epi8(nibbles[i], _mm256_set1_epi8(9)),
+			_mm256_set1_epi8('a' - '9' - 1));
+		__m256i digits = _mm256_add_epi8(
+			_mm256_add_epi8(nibbles[i], _mm256_set1_epi8('0')),
+			letters);
+		_mm256_storeu_si256((__m256i *)(out + i * 32), digits);
+	}
+}
+#endif // CRZCODEC_AVX2
+
+#endif // CRZCODEC_H_
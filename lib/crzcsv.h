@@ -0,0 +1,252 @@
+#ifndef CRZCSV_H_
+#define CRZCSV_H_
+
+#include "crzdef.h"
+#include "crzsb.h"
+#include "crzsv.h"
+#include <stdint.h>
+
+#if defined(__SSE2__) && !defined(CRZCSV_NO_SIMD)
+#include <emmintrin.h>
+#define CRZCSV_SSE2
+#endif
+
+/// The amount of bytes classified at once when looking for delimiters, quotes and newlines.
+#define CRZCSV_BLOCK_SIZE 64
+
+/// A reader which splits delimited text, such as CSV or TSV, into fields.
+///
+/// The fields are `StringView`s into the input, so reading never allocates.
+/// The input is classified `CRZCSV_BLOCK_SIZE` bytes at a time into bitmasks of delimiters, quotes and newlines (using SSE2 where available).
+/// A prefix-XOR of the quote mask then finds which bytes are inside quotes, so every separator outside of quotes is found without branching on each byte.
+typedef struct {
+	StringView input;
+	char delimiter;
+	/// The offset of the start of the next field.
+	CRZ_SIZE pos;
+	/// The offset of the block whose separators are in `separators`.
+	CRZ_SIZE block;
+	/// The offset of the next block to classify.
+	CRZ_SIZE next_block;
+	/// The separators of the current block which were not read yet, as a bitmask.
+	uint64_t separators;
+	/// All ones if the previous block ended inside quotes, and all zeros otherwise.
+	uint64_t in_quotes;
+	/// Whether the last field read was followed by a delimiter, rather than a newline.
+	CRZ_BOOL after_delimiter;
+	CRZ_BOOL done;
+} CsvReader;
+
+/// INTERNAL: you most likely don't want to use this.
+///           These are the bitmasks of the bytes of a block that match each character.
+typedef struct {
+	uint64_t delimiters;
+	uint64_t quotes;
+	uint64_t newlines;
+} Crzcsv_Masks;
+
+/// Create a reader over the `StringView` `sv`, whose fields are separated by the character `delim`.
+///
+/// Records are separated by `\n`, and a `\r` right before it is dropped from the last field.
+/// Fields may be quoted with `"`, in which case they may contain the delimiter, newlines, and quotes escaped as `""`.
+#define CSV_READER_NEW(sv, delim)                   \
+	((CsvReader){ .input = (sv),                \
+		      .delimiter = (delim),         \
+		      .pos = 0,                     \
+		      .block = 0,                   \
+		      .next_block = 0,              \
+		      .separators = 0,              \
+		      .in_quotes = 0,               \
+		      .after_delimiter = CRZ_FALSE, \
+		      .done = CRZ_FALSE })
+
+/// Read the next field from the reader `selfp` (passed by pointer) into the `StringView` `fieldp` (passed by pointer).
+///
+/// Sets `end_of_recordp` (passed by pointer) to whether the field is the last one of its record.
+/// Returns `CRZ_FALSE` once there are no more fields.
+///
+/// Quoted fields are returned as they appear in the input, including their quotes; use `CSV_UNESCAPE` to get their contents.
+#define CSV_NEXT_FIELD(selfp, fieldp, end_of_recordp) \
+	crzcsv_next_field((selfp), (fieldp), (end_of_recordp))
+
+/// Whether the field `field`, as returned by `CSV_NEXT_FIELD`, is quoted.
+#define CSV_IS_QUOTED(field) ((field).len > 0 && (field).ptr[0] == '"')
+
+/// Push the contents of the field `field`, as returned by `CSV_NEXT_FIELD`, into the string builder `sbp` (passed by pointer).
+///
+/// If the field is quoted, its quotes are removed and its escaped quotes are unescaped.
+/// Otherwise, it is pushed as it is.
+#define CSV_UNESCAPE(sbp, field) crzcsv_unescape((sbp), (field))
+
+/// INTERNAL: this function classifies the `CRZCSV_BLOCK_SIZE` bytes at `block` one at a time.
+Crzcsv_Masks crzcsv_masks_scalar(const char *block, char delimiter);
+
+#ifdef CRZCSV_SSE2
+/// INTERNAL: this function classifies the `CRZCSV_BLOCK_SIZE` bytes at `block` 16 at a time using SSE2.
+Crzcsv_Masks crzcsv_masks_sse2(const char *block, char delimiter);
+#endif // CRZCSV_SSE2
+
+/// INTERNAL: this is the prefix-XOR of `bits`, where each bit is the XOR of itself and every bit below it.
+uint64_t crzcsv_prefix_xor(uint64_t bits);
+
+/// INTERNAL: this function classifies the next block of the reader `selfp` into its separators.
+void crzcsv_load_block(CsvReader *selfp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CSV_NEXT_FIELD(selfp, fieldp, end_of_recordp)` instead.
+CRZ_BOOL crzcsv_next_field(CsvReader *selfp, StringView *fieldp,
+			   CRZ_BOOL *end_of_recordp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CSV_UNESCAPE(sbp, field)` instead.
+void crzcsv_unescape(StringBuilder *sbp, StringView field);
+
+Crzcsv_Masks crzcsv_masks_scalar(const char *block, char delimiter)
+{
+	Crzcsv_Masks masks = { 0 };
+	for (CRZ_SIZE i = 0; i < CRZCSV_BLOCK_SIZE; i++) {
+		uint64_t bit = 1ull << i;
+		if (block[i] == delimiter)
+			masks.delimiters |= bit;
+		if (block[i] == '"')
+			masks.quotes |= bit;
+		if (block[i] == '\n')
+			masks.newlines |= bit;
+	}
+	return masks;
+}
+
+#ifdef CRZCSV_SSE2
+Crzcsv_Masks crzcsv_masks_sse2(const char *block, char delimiter)
+{
+	Crzcsv_Masks masks = { 0 };
+	__m128i delimiters = _mm_set1_epi8(delimiter);
+	__m128i quotes = _mm_set1_epi8('"');
+	__m128i newlines = _mm_set1_epi8('\n');
+
+	for (CRZ_SIZE i = 0; i < CRZCSV_BLOCK_SIZE; i += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i *)(block + i));
+		uint64_t d = (uint32_t)_mm_movemask_epi8(
+			_mm_cmpeq_epi8(bytes, delimiters));
+		uint64_t q = (uint32_t)_mm_movemask_epi8(
+			_mm_cmpeq_epi8(bytes, quotes));
+		uint64_t n = (uint32_t)_mm_movemask_epi8(
+			_mm_cmpeq_epi8(bytes, newlines));
+		masks.delimiters |= d << i;
+		masks.quotes |= q << i;
+		masks.newlines |= n << i;
+	}
+	return masks;
+}
+#endif // CRZCSV_SSE2
+
+uint64_t crzcsv_prefix_xor(uint64_t bits)
+{
+	bits ^= bits << 1;
+	bits ^= bits << 2;
+	bits ^= bits << 4;
+	bits ^= bits << 8;
+	bits ^= bits << 16;
+	bits ^= bits << 32;
+	return bits;
+}
+
+void crzcsv_load_block(CsvReader *selfp)
+{
+	const char *block = selfp->input.ptr + selfp->next_block;
+	char padded[CRZCSV_BLOCK_SIZE];
+
+	// Pad the last block with bytes which match none of the characters
+	CRZ_SIZE remaining = selfp->input.len - selfp->next_block;
+	if (remaining < CRZCSV_BLOCK_SIZE) {
+		char filler = selfp->delimiter == ' ' ? 'x' : ' ';
+		for (CRZ_SIZE i = 0; i < CRZCSV_BLOCK_SIZE; i++)
+			padded[i] = i < remaining ? block[i] : filler;
+		block = padded;
+	}
+
+#ifdef CRZCSV_SSE2
+	Crzcsv_Masks masks = crzcsv_masks_sse2(block, selfp->delimiter);
+#else
+	Crzcsv_Masks masks = crzcsv_masks_scalar(block, selfp->delimiter);
+#endif // CRZCSV_SSE2
+
+	// Escaped quotes toggle twice, so they leave the bytes after them as is
+	uint64_t inside = crzcsv_prefix_xor(masks.quotes) ^ selfp->in_quotes;
+	selfp->in_quotes = (uint64_t)0 - (inside >> 63);
+	selfp->separators = (masks.delimiters | masks.newlines) & ~inside;
+	selfp->block = selfp->next_block;
+	selfp->next_block += CRZCSV_BLOCK_SIZE;
+}
+
+CRZ_BOOL crzcsv_next_field(CsvReader *selfp, StringView *fieldp,
+			   CRZ_BOOL *end_of_recordp)
+{
+	if (selfp->done)
+		return CRZ_FALSE;
+
+	// Only a trailing delimiter leaves a field at the end of the input
+	if (selfp->pos >= selfp->input.len && !selfp->after_delimiter &&
+	    selfp->pos > 0) {
+		selfp->done = CRZ_TRUE;
+		return CRZ_FALSE;
+	}
+
+	while (selfp->separators == 0) {
+		if (selfp->next_block >= selfp->input.len) {
+			selfp->done = CRZ_TRUE;
+			if (selfp->input.len == 0)
+				return CRZ_FALSE;
+			*fieldp = SV_FROM_BUF(selfp->input.ptr + selfp->pos,
+					      selfp->input.len - selfp->pos);
+			*end_of_recordp = CRZ_TRUE;
+			// The last record may end in a CRLF without its LF
+			if (fieldp->len > 0 &&
+			    fieldp->ptr[fieldp->len - 1] == '\r')
+				fieldp->len -= 1;
+			selfp->pos = selfp->input.len;
+			return CRZ_TRUE;
+		}
+		crzcsv_load_block(selfp);
+	}
+
+	CRZ_SIZE end = selfp->block + CRZ_CTZ(selfp->separators);
+	// Clear the lowest set bit
+	selfp->separators &= selfp->separators - 1;
+
+	*fieldp = SV_FROM_BUF(selfp->input.ptr + selfp->pos, end - selfp->pos);
+	*end_of_recordp = selfp->input.ptr[end] == '\n';
+	if (*end_of_recordp && fieldp->len > 0 &&
+	    fieldp->ptr[fieldp->len - 1] == '\r')
+		fieldp->len -= 1;
+
+	selfp->after_delimiter = !*end_of_recordp;
+	selfp->pos = end + 1;
+	return CRZ_TRUE;
+}
+
+void crzcsv_unescape(StringBuilder *sbp, StringView field)
+{
+	if (!CSV_IS_QUOTED(field)) {
+		SB_PUSH_BUF(sbp, field.ptr, field.len);
+		return;
+	}
+
+	CRZ_SIZE end = field.len;
+	if (end > 1 && field.ptr[end - 1] == '"')
+		end--;
+
+	// Push runs between escaped quotes in one go
+	CRZ_SIZE start = 1;
+	for (CRZ_SIZE i = 1; i < end; i++) {
+		if (field.ptr[i] == '"' && i + 1 < end &&
+		    field.ptr[i + 1] == '"') {
+			SB_PUSH_BUF(sbp, field.ptr + start, i + 1 - start);
+			i++;
+			start = i + 1;
+		}
+	}
+	SB_PUSH_BUF(sbp, field.ptr + start, end - start);
+}
+
+#endif // CRZCSV_H_
@@ -107,4 +107,90 @@
 #define CRZ_ISSPACE isspace
 #endif // CRZ_ISSPACE
 
+#ifndef CRZ_ASCII_LOWER
+#define CRZ_ASCII_LOWER(c) ((c) >= 'A' && (c) <= 'Z' ? (c) - 'A' + 'a' : (c))
+#endif // CRZ_ASCII_LOWER
+
+#ifndef CRZ_PREFETCH
+#if defined(__GNUC__)
+#define CRZ_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define CRZ_PREFETCH(addr) ((void)(addr))
+#endif
+#endif // CRZ_PREFETCH
+
+#ifndef CRZ_POPCOUNT
+#if defined(__GNUC__)
+#define CRZ_POPCOUNT(word) ((CRZ_SIZE)__builtin_popcountll(word))
+#else
+#define CRZ_POPCOUNT(word) crzdef_popcount_fallback(word)
+#endif
+#endif // CRZ_POPCOUNT
+
+#ifndef CRZ_CTZ
+#if defined(__GNUC__)
+#define CRZ_CTZ(word) ((CRZ_SIZE)__builtin_ctzll(word))
+#else
+#define CRZ_CTZ(word) crzdef_ctz_fallback(word)
+#endif
+#endif // CRZ_CTZ
+
+#ifndef CRZ_CLZ
+#if defined(__GNUC__)
+#define CRZ_CLZ(word) ((CRZ_SIZE)__builtin_clzll(word))
+#else
+#define CRZ_CLZ(word) crzdef_clz_fallback(word)
+#endif
+#endif // CRZ_CLZ
+
+#ifndef CRZ_PAUSE
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRZ_PAUSE() __builtin_ia32_pause()
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define CRZ_PAUSE() __asm__ __volatile__("yield")
+#else
+#define CRZ_PAUSE() ((void)0)
+#endif
+#endif // CRZ_PAUSE
+
+#include <stdint.h>
+
+/// INTERNAL: this is the default for `CRZ_POPCOUNT` on compilers without the builtin.
+CRZ_SIZE crzdef_popcount_fallback(uint64_t word);
+
+/// INTERNAL: this is the default for `CRZ_CTZ` on compilers without the builtin.
+CRZ_SIZE crzdef_ctz_fallback(uint64_t word);
+
+/// INTERNAL: this is the default for `CRZ_CLZ` on compilers without the builtin.
+CRZ_SIZE crzdef_clz_fallback(uint64_t word);
+
+CRZ_SIZE crzdef_popcount_fallback(uint64_t word)
+{
+	word = word - ((word >> 1) & 0x5555555555555555ull);
+	word = (word & 0x3333333333333333ull) +
+	       ((word >> 2) & 0x3333333333333333ull);
+	word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+	return (CRZ_SIZE)((word * 0x0101010101010101ull) >> 56);
+}
+
+CRZ_SIZE crzdef_ctz_fallback(uint64_t word)
+{
+	CRZ_SIZE count = 0;
+	while ((word & 1) == 0) {
+		word >>= 1;
+		count++;
+	}
+	return count;
+}
+
+CRZ_SIZE crzdef_clz_fallback(uint64_t word)
+{
+	CRZ_SIZE count = 0;
+	while ((word & (1ull << 63)) == 0) {
+		word <<= 1;
+		count++;
+	}
+	return count;
+}
+
 #endif // CRZDEF_H_
@@ -0,0 +1,180 @@
+#ifndef CRZDEQUE_H_
+#define CRZDEQUE_H_
+
+#include "crzarr.h"
+#include "crzdef.h"
+#include "crzstats.h"
+
+/// Define a struct for a double-ended queue with elements of type `T`.
+///
+/// The elements are stored in a circular buffer, starting at the index `head` and wrapping around to the start of `ptr`.
+/// Pushing and popping at either end is O(1), and never moves any other elements.
+#define DEQUE(T)               \
+	struct {               \
+		T *ptr;        \
+		CRZ_SIZE len;  \
+		CRZ_SIZE cap;  \
+		CRZ_SIZE head; \
+	}
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEQUE(T)` instead.
+typedef DEQUE(void) Crzdeque_AnyDeque;
+
+/// Get the size in bytes of each element of the deque `self`.
+/// Uses `sizeof` internally.
+#define DEQUE_ELEMENT_SIZE(self) (sizeof(*(self).ptr))
+
+/// Zero-initialize a deque.
+#define DEQUE_NEW()                                            \
+	{                                                      \
+		.ptr = CRZ_NULL, .len = 0, .cap = 0, .head = 0 \
+	}
+
+/// Properly initialize a deque.
+///
+/// This is not required, and does not perform any allocations.
+#define DEQUE_INIT(selfp)                                             \
+	((selfp)->ptr = CRZ_NULL, (selfp)->len = 0, (selfp)->cap = 0, \
+	 (selfp)->head = 0)
+
+/// Reserve space for `amount_elements` more elements in the deque `selfp` (passed by pointer).
+/// Reallocates the deque to add the additional space.
+#define DEQUE_GROW_BY(selfp, amount_elements)              \
+	crzdeque_grow_to((Crzdeque_AnyDeque *)(selfp),     \
+			 (selfp)->cap + (amount_elements), \
+			 DEQUE_ELEMENT_SIZE(*(selfp)))
+
+/// Push the element `element` to the back of the deque `selfp` (passed by pointer).
+///
+/// Reallocates the deque to create the necessary additional space, if needed.
+#define DEQUE_PUSH_BACK(selfp, element)                                   \
+	do {                                                              \
+		crzdeque_grow_to((Crzdeque_AnyDeque *)(selfp),            \
+				 (selfp)->len + 1,                        \
+				 DEQUE_ELEMENT_SIZE(*(selfp)));           \
+		(selfp)->ptr[crzdeque_index((Crzdeque_AnyDeque *)(selfp), \
+					    (selfp)->len)] = (element);   \
+		(selfp)->len += 1;                                        \
+	} while (0)
+
+/// Push the element `element` to the front of the deque `selfp` (passed by pointer).
+///
+/// Reallocates the deque to create the necessary additional space, if needed.
+#define DEQUE_PUSH_FRONT(selfp, element)                                \
+	do {                                                            \
+		crzdeque_grow_to((Crzdeque_AnyDeque *)(selfp),          \
+				 (selfp)->len + 1,                      \
+				 DEQUE_ELEMENT_SIZE(*(selfp)));         \
+		(selfp)->head = (selfp)->head == 0 ? (selfp)->cap - 1 : \
+						     (selfp)->head - 1; \
+		(selfp)->ptr[(selfp)->head] = (element);                \
+		(selfp)->len += 1;                                      \
+	} while (0)
+
+/// Remove and return the first element of the deque `selfp` (passed by pointer).
+///
+/// Asserts that the deque is not empty.
+#define DEQUE_POP_FRONT(selfp) \
+	((selfp)->ptr[crzdeque_pop_front((Crzdeque_AnyDeque *)(selfp))])
+
+/// Remove and return the last element of the deque `selfp` (passed by pointer).
+///
+/// Asserts that the deque is not empty.
+#define DEQUE_POP_BACK(selfp) \
+	((selfp)->ptr[crzdeque_pop_back((Crzdeque_AnyDeque *)(selfp))])
+
+/// Get the element at `index` within the deque `self`, where index 0 is the front of the deque.
+///
+/// Asserts that the index is not out of the bounds of the deque.
+#define DEQUE_GET(self, index)                                      \
+	(CRZ_ASSERT((index) < (self).len && "Index out of bounds"), \
+	 (self).ptr[crzdeque_index((Crzdeque_AnyDeque *)(&(self)), (index))])
+
+/// Iterate over the indexes of the deque `self` from front to back, naming the index variable `index`.
+#define DEQUE_FOR(self, index) \
+	for (CRZ_SIZE index = 0; index < (self).len; index++)
+
+/// Print out the elements of deque `self` from front to back. `fmt` is the format specifier for the element type, as for `printf`.
+#define DEQUE_DEBUG(self, fmt)                                           \
+	do {                                                             \
+		CRZ_DEBUG("[");                                          \
+		DEQUE_FOR(self, crz__index) {                            \
+			CRZ_DEBUG((fmt), DEQUE_GET((self), crz__index)); \
+			if (crz__index + 1 != (self).len) {              \
+				CRZ_DEBUG(", ");                         \
+			}                                                \
+		}                                                        \
+		CRZ_DEBUG("]\n");                                        \
+	} while (0)
+
+/// Free the space allocated for the elements of the deque `selfp` (passed by pointer), and empty-out the fields of the struct.
+///
+/// This **does not** free any of the elements of `selfp` - if they are dynamically allocated, you must do this yourself before calling `DEQUE_FREE`.
+#define DEQUE_FREE(selfp)               \
+	do {                            \
+		CRZ_FREE((selfp)->ptr); \
+		DEQUE_INIT((selfp));    \
+	} while (0)
+
+/// INTERNAL: this is the index in `ptr` of the element at `index` from the front of the deque.
+CRZ_SIZE crzdeque_index(Crzdeque_AnyDeque *selfp, CRZ_SIZE index);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEQUE_GROW_BY(selfp, amount_elements)` instead.
+void crzdeque_grow_to(Crzdeque_AnyDeque *selfp, CRZ_SIZE new_cap,
+		      CRZ_SIZE element_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEQUE_POP_FRONT(selfp)` instead.
+CRZ_SIZE crzdeque_pop_front(Crzdeque_AnyDeque *selfp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEQUE_POP_BACK(selfp)` instead.
+CRZ_SIZE crzdeque_pop_back(Crzdeque_AnyDeque *selfp);
+
+CRZ_SIZE crzdeque_index(Crzdeque_AnyDeque *selfp, CRZ_SIZE index)
+{
+	CRZ_SIZE physical = selfp->head + index;
+	return physical >= selfp->cap ? physical - selfp->cap : physical;
+}
+
+void crzdeque_grow_to(Crzdeque_AnyDeque *selfp, CRZ_SIZE new_cap,
+		      CRZ_SIZE element_size)
+{
+	CRZ_SIZE old_cap = selfp->cap;
+	if (old_cap >= new_cap)
+		return;
+
+	// The deque starts with the same fields as an array,
+	// and `crzarr_grow_to` keeps the buffer as it was
+	crzarr_grow_to((Crzarr_AnyArray *)selfp, new_cap, element_size);
+
+	// Unwrap the elements which wrapped around the old buffer,
+	// moving them to right after the old end of the buffer
+	if (selfp->head + selfp->len > old_cap) {
+		CRZ_SIZE wrapped = selfp->head + selfp->len - old_cap;
+		char *ptr = (char *)selfp->ptr;
+		CRZ_MEMCPY(ptr + old_cap * element_size, ptr,
+			   wrapped * element_size);
+		CRZ_STATS_ADD(arr, bytes_copied, wrapped * element_size);
+	}
+}
+
+CRZ_SIZE crzdeque_pop_front(Crzdeque_AnyDeque *selfp)
+{
+	CRZ_ASSERT(selfp->len > 0 && "Popping from an empty deque");
+	CRZ_SIZE index = selfp->head;
+	selfp->head = crzdeque_index(selfp, 1);
+	selfp->len -= 1;
+	return index;
+}
+
+CRZ_SIZE crzdeque_pop_back(Crzdeque_AnyDeque *selfp)
+{
+	CRZ_ASSERT(selfp->len > 0 && "Popping from an empty deque");
+	selfp->len -= 1;
+	return crzdeque_index(selfp, selfp->len);
+}
+
+#endif // CRZDEQUE_H_
@@ -0,0 +1,450 @@
+#ifndef CRZFROZEN_H_
+#define CRZFROZEN_H_
+
+#include "crzdef.h"
+#include "crzhash.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/// The average amount of keys that share a displacement when freezing a hash table.
+/// Larger values make frozen tables smaller, but slower to build.
+#ifndef CRZFROZEN_BUCKET_SIZE
+#define CRZFROZEN_BUCKET_SIZE 4
+#endif // CRZFROZEN_BUCKET_SIZE
+
+/// The maximum amount of seeds to try before giving up on freezing a hash table.
+#ifndef CRZFROZEN_MAX_ATTEMPTS
+#define CRZFROZEN_MAX_ATTEMPTS 64
+#endif // CRZFROZEN_MAX_ATTEMPTS
+
+/// Define a struct for a frozen (read-only) hash table with values of type `T`.
+///
+/// A frozen table uses a minimal perfect hash function (CHD-style), so every lookup reads exactly one index.
+/// Its values are stored in `values`, and its keys are stored one after another (each terminated) in the single `keys` buffer.
+#define FROZEN_TABLE(T)                  \
+	struct {                         \
+		T *values;               \
+		CRZ_SIZE *key_offsets;   \
+		char *keys;              \
+		CRZ_SIZE *displacements; \
+		CRZ_SIZE size;           \
+		CRZ_SIZE bucket_count;   \
+		CRZ_SIZE seed;           \
+	}
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `FROZEN_TABLE(T)` instead.
+typedef FROZEN_TABLE(void) Crzfrozen_AnyFrozenTable;
+
+/// Zero-initialize a frozen table.
+#define FROZEN_TABLE_NEW()                                                     \
+	{                                                                      \
+		.values = CRZ_NULL, .key_offsets = CRZ_NULL, .keys = CRZ_NULL, \
+		.displacements = CRZ_NULL, .size = 0, .bucket_count = 0,       \
+		.seed = 0                                                      \
+	}
+
+/// Freeze the hash table `self` into the frozen table `frozenp` (passed by pointer).
+///
+/// The keys and values of `self` are copied, so `self` may be freed independently of the frozen table.
+/// The frozen table has exactly as many indexes as `self` has pairs.
+///
+/// Asserts that a perfect hash function could be found within `CRZFROZEN_MAX_ATTEMPTS` seeds.
+#define HASH_TABLE_FREEZE(self, frozenp)                       \
+	crzfrozen_build((Crzhash_AnyHashTable *)(&(self)),     \
+			(Crzfrozen_AnyFrozenTable *)(frozenp), \
+			sizeof(*(frozenp)->values))
+
+/// Get a pointer to the value with key `get_key` in the frozen table `self`.
+///
+/// If the key does not exist in the table, returns `CRZ_NULL`.
+#define FROZEN_TABLE_GET(self, get_key)                                 \
+	crzfrozen_get((Crzfrozen_AnyFrozenTable *)(&(self)), (get_key), \
+		      sizeof(*(self).values))
+
+/// Get the key at `index` within the frozen table `self`.
+#define FROZEN_TABLE_KEY(self, index) \
+	((self).keys + (self).key_offsets[index])
+
+/// Iterate over all indexes in the frozen table `self`, naming the index variable `index`.
+///
+/// Unlike `HASH_TABLE_FOR`, every index has a key and a value associated with it.
+#define FROZEN_TABLE_FOR(self, index) \
+	for (CRZ_SIZE index = 0; index < (self).size; index++)
+
+/// Write C source which defines the frozen table `self` as a static variable `name`, to the file `file`.
+///
+/// `T` is the value type of the table, and `fmt` is the format specifier which prints a value as a C initializer, as for `printf`.
+/// The generated source requires `crzfrozen.h` to be included before it, and the table it defines must not be passed to `FROZEN_TABLE_FREE`.
+///
+/// This allows generating frozen tables at build time, e.g.:
+///   FROZEN_TABLE_EMIT(frozen, stdout, mime_types, size_t, "%zu");
+#define FROZEN_TABLE_EMIT(self, file, name, T, fmt)                         \
+	do {                                                                \
+		crzfrozen_emit_begin((Crzfrozen_AnyFrozenTable *)(&(self)), \
+				     (file), #name, #T);                    \
+		FROZEN_TABLE_FOR(self, crz__index) {                        \
+			fprintf((file), "\t" fmt ",\n",                     \
+				(self).values[crz__index]);                 \
+		}                                                           \
+		crzfrozen_emit_end((Crzfrozen_AnyFrozenTable *)(&(self)),   \
+				   (file), #name, #T);                      \
+	} while (0)
+
+/// Print out the key-value pairs of the frozen table `self`. `fmt` is the format specifier for the value type, as for `printf`.
+#define FROZEN_TABLE_DEBUG(self, fmt)                                 \
+	do {                                                          \
+		CRZ_DEBUG("{");                                       \
+		FROZEN_TABLE_FOR(self, crz__index) {                  \
+			CRZ_DEBUG(" \"%s\" = " fmt ";",               \
+				  FROZEN_TABLE_KEY(self, crz__index), \
+				  (self).values[crz__index]);         \
+		}                                                     \
+		CRZ_DEBUG(" }\n");                                    \
+	} while (0)
+
+/// Free the space allocated for the frozen table `selfp` (passed by pointer), and empty-out the fields of the struct.
+///
+/// This **does not** free any of the values - if they are dynamically allocated, you must do this yourself before calling `FROZEN_TABLE_FREE`.
+#define FROZEN_TABLE_FREE(selfp)                   \
+	do {                                       \
+		CRZ_FREE((selfp)->values);         \
+		CRZ_FREE((selfp)->key_offsets);    \
+		CRZ_FREE((selfp)->keys);           \
+		CRZ_FREE((selfp)->displacements);  \
+		(selfp)->values = CRZ_NULL;        \
+		(selfp)->key_offsets = CRZ_NULL;   \
+		(selfp)->keys = CRZ_NULL;          \
+		(selfp)->displacements = CRZ_NULL; \
+		(selfp)->size = 0;                 \
+		(selfp)->bucket_count = 0;         \
+		(selfp)->seed = 0;                 \
+	} while (0)
+
+/// INTERNAL: this is the seeded hashing function used by frozen tables.
+uint64_t crzfrozen_hash(CRZ_STRING key, CRZ_SIZE seed);
+
+/// INTERNAL: this finds the bucket, and so the displacement, for a key with hash `hash` in a frozen table.
+CRZ_SIZE crzfrozen_bucket(uint64_t hash, CRZ_SIZE bucket_count);
+
+/// INTERNAL: this finds the index for a key with hash `hash` in a frozen table, given its displacements.
+CRZ_SIZE crzfrozen_index(uint64_t hash, CRZ_SIZE displacement, CRZ_SIZE size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HASH_TABLE_FREEZE(self, frozenp)` instead.
+void crzfrozen_build(Crzhash_AnyHashTable *sourcep,
+		     Crzfrozen_AnyFrozenTable *selfp, CRZ_SIZE value_size);
+
+/// INTERNAL: this tries to find displacements for every bucket of a frozen table with the given seed.
+CRZ_BOOL crzfrozen_try_seed(Crzfrozen_AnyFrozenTable *selfp,
+			    Crzhash_AnyHashPair **pairs, uint64_t *hashes,
+			    CRZ_SIZE *order, CRZ_SIZE *bucket_starts,
+			    CRZ_SIZE *slots, CRZ_BOOL *taken);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `FROZEN_TABLE_GET(self, key)` instead.
+void *crzfrozen_get(Crzfrozen_AnyFrozenTable *selfp, CRZ_STRING key,
+		    CRZ_SIZE value_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `FROZEN_TABLE_EMIT(self, file, name, T, fmt)` instead.
+void crzfrozen_emit_begin(Crzfrozen_AnyFrozenTable *selfp, FILE *file,
+			  const char *name, const char *type);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `FROZEN_TABLE_EMIT(self, file, name, T, fmt)` instead.
+void crzfrozen_emit_end(Crzfrozen_AnyFrozenTable *selfp, FILE *file,
+			const char *name, const char *type);
+
+uint64_t crzfrozen_hash(CRZ_STRING key, CRZ_SIZE seed)
+{
+	// FNV-1a, followed by the MurmurHash3 finalizer to spread the bits
+	uint64_t hash = 0xcbf29ce484222325ull ^ (uint64_t)seed;
+	CRZ_STRING_FOR(key, i) {
+		hash ^= (unsigned char)CRZ_STRING_GET(key, i);
+		hash *= 0x100000001b3ull;
+	}
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+CRZ_SIZE crzfrozen_bucket(uint64_t hash, CRZ_SIZE bucket_count)
+{
+	// Use bits unrelated to the ones `crzfrozen_index` uses
+	return (CRZ_SIZE)(((hash * 0x9e3779b97f4a7c15ull) >> 40) %
+			  bucket_count);
+}
+
+CRZ_SIZE crzfrozen_index(uint64_t hash, CRZ_SIZE displacement, CRZ_SIZE size)
+{
+	// The low half of the hash picks the first index and the high half
+	// picks the step; the displacement `d1 * size + d0` moves along it,
+	// taking `d0` steps and then `d1` more indexes
+	uint64_t first = (hash & 0xffffffffull) % size;
+	uint64_t step = (hash >> 32) % size;
+	uint64_t d0 = displacement % size;
+	uint64_t d1 = displacement / size;
+	return (CRZ_SIZE)((first + d0 * step + d1) % size);
+}
+
+void crzfrozen_build(Crzhash_AnyHashTable *sourcep,
+		     Crzfrozen_AnyFrozenTable *selfp, CRZ_SIZE value_size)
+{
+	CRZ_SIZE count = 0;
+	for (CRZ_SIZE i = 0; i < sourcep->size; i++) {
+		if (sourcep->ptr[i])
+			count++;
+	}
+
+	selfp->size = count;
+	selfp->bucket_count =
+		(count + CRZFROZEN_BUCKET_SIZE - 1) / CRZFROZEN_BUCKET_SIZE;
+	if (selfp->bucket_count == 0)
+		selfp->bucket_count = 1;
+	selfp->displacements =
+		CRZ_MALLOC(sizeof(CRZ_SIZE) * selfp->bucket_count);
+	CRZ_ASSERT(selfp->displacements &&
+		   "Out of memory when allocating frozen table");
+
+	// Scratch space, only needed while looking for a seed
+	Crzhash_AnyHashPair **pairs = CRZ_MALLOC(sizeof(*pairs) * (count + 1));
+	uint64_t *hashes = CRZ_MALLOC(sizeof(*hashes) * (count + 1));
+	CRZ_SIZE *order = CRZ_MALLOC(sizeof(*order) * (count + 1));
+	CRZ_SIZE *bucket_starts =
+		CRZ_MALLOC(sizeof(*bucket_starts) * (selfp->bucket_count + 1));
+	CRZ_SIZE *slots = CRZ_MALLOC(sizeof(*slots) * (count + 1));
+	CRZ_BOOL *taken = CRZ_MALLOC(sizeof(*taken) * (count + 1));
+	CRZ_ASSERT(pairs && hashes && order && bucket_starts && slots &&
+		   taken && "Out of memory when freezing hash table");
+
+	count = 0;
+	for (CRZ_SIZE i = 0; i < sourcep->size; i++) {
+		if (sourcep->ptr[i])
+			pairs[count++] = sourcep->ptr[i];
+	}
+
+	CRZ_BOOL found = CRZ_FALSE;
+	for (CRZ_SIZE attempt = 0; attempt < CRZFROZEN_MAX_ATTEMPTS && !found;
+	     attempt++) {
+		selfp->seed = attempt;
+		found = crzfrozen_try_seed(selfp, pairs, hashes, order,
+					   bucket_starts, slots, taken);
+	}
+	CRZ_ASSERT(found && "Could not find a perfect hash for hash table");
+
+	// Lay out the keys in a single buffer, in index order
+	CRZ_SIZE keys_len = 0;
+	for (CRZ_SIZE i = 0; i < count; i++)
+		keys_len += CRZ_STRLEN(pairs[i]->key) + 1;
+
+	selfp->values = CRZ_MALLOC(value_size * (count + 1));
+	selfp->key_offsets = CRZ_MALLOC(sizeof(CRZ_SIZE) * (count + 1));
+	selfp->keys = CRZ_MALLOC(keys_len + 1);
+	CRZ_ASSERT(selfp->values && selfp->key_offsets && selfp->keys &&
+		   "Out of memory when allocating frozen table");
+
+	CRZ_SIZE offset = 0;
+	for (CRZ_SIZE i = 0; i < count; i++) {
+		CRZ_SIZE len = CRZ_STRLEN(pairs[i]->key) + 1;
+		CRZ_MEMCPY(selfp->keys + offset, pairs[i]->key, len);
+		selfp->key_offsets[slots[i]] = offset;
+		offset += len;
+
+		// The value is the first field of the pair
+		CRZ_MEMCPY((char *)selfp->values + slots[i] * value_size,
+			   pairs[i], value_size);
+	}
+
+	CRZ_FREE(pairs);
+	CRZ_FREE(hashes);
+	CRZ_FREE(order);
+	CRZ_FREE(bucket_starts);
+	CRZ_FREE(slots);
+	CRZ_FREE(taken);
+}
+
+CRZ_BOOL crzfrozen_try_seed(Crzfrozen_AnyFrozenTable *selfp,
+			    Crzhash_AnyHashPair **pairs, uint64_t *hashes,
+			    CRZ_SIZE *order, CRZ_SIZE *bucket_starts,
+			    CRZ_SIZE *slots, CRZ_BOOL *taken)
+{
+	CRZ_SIZE size = selfp->size;
+	CRZ_SIZE bucket_count = selfp->bucket_count;
+
+	// Counting sort the pairs by bucket
+	for (CRZ_SIZE b = 0; b <= bucket_count; b++)
+		bucket_starts[b] = 0;
+	for (CRZ_SIZE i = 0; i < size; i++) {
+		hashes[i] = crzfrozen_hash(pairs[i]->key, selfp->seed);
+		bucket_starts[crzfrozen_bucket(hashes[i], bucket_count)]++;
+		taken[i] = CRZ_FALSE;
+	}
+	for (CRZ_SIZE b = 1; b < bucket_count; b++)
+		bucket_starts[b] += bucket_starts[b - 1];
+	bucket_starts[bucket_count] = size;
+	for (CRZ_SIZE i = 0; i < size; i++) {
+		CRZ_SIZE bucket = crzfrozen_bucket(hashes[i], bucket_count);
+		order[--bucket_starts[bucket]] = i;
+	}
+
+	CRZ_SIZE max_bucket_size = 0;
+	for (CRZ_SIZE b = 0; b < bucket_count; b++) {
+		CRZ_SIZE start = bucket_starts[b];
+		CRZ_SIZE bucket_size = bucket_starts[b + 1] - start;
+		if (bucket_size > max_bucket_size)
+			max_bucket_size = bucket_size;
+		selfp->displacements[b] = 0;
+
+		// Keys that agree on both the first index and the step
+		// can never be told apart, no matter the displacement
+		for (CRZ_SIZE k = 0; k < bucket_size; k++) {
+			for (CRZ_SIZE j = k + 1; j < bucket_size; j++) {
+				uint64_t left = hashes[order[start + k]];
+				uint64_t right = hashes[order[start + j]];
+				if ((left & 0xffffffffull) % size ==
+					    (right & 0xffffffffull) % size &&
+				    (left >> 32) % size == (right >> 32) % size)
+					return CRZ_FALSE;
+			}
+		}
+	}
+
+	// Place the largest buckets first, since they are the hardest to place
+	uint64_t max_displacement = (uint64_t)size * size;
+	for (CRZ_SIZE bucket_size = max_bucket_size; bucket_size > 1;
+	     bucket_size--) {
+		for (CRZ_SIZE b = 0; b < bucket_count; b++) {
+			CRZ_SIZE start = bucket_starts[b];
+			if (bucket_starts[b + 1] - start != bucket_size)
+				continue;
+
+			CRZ_BOOL placed = CRZ_FALSE;
+			for (uint64_t d = 0; d < max_displacement && !placed;
+			     d++) {
+				CRZ_SIZE k = 0;
+				while (k < bucket_size) {
+					CRZ_SIZE i = order[start + k];
+					slots[i] = crzfrozen_index(hashes[i], d,
+								   size);
+					if (taken[slots[i]])
+						break;
+					taken[slots[i]] = CRZ_TRUE;
+					k++;
+				}
+
+				if (k == bucket_size) {
+					selfp->displacements[b] = d;
+					placed = CRZ_TRUE;
+					continue;
+				}
+
+				// Undo this displacement's placements
+				while (k > 0) {
+					k--;
+					taken[slots[order[start + k]]] =
+						CRZ_FALSE;
+				}
+			}
+
+			if (!placed)
+				return CRZ_FALSE;
+		}
+	}
+
+	// Buckets with a single key can go straight into any free index,
+	// using only the `d1` part of the displacement
+	CRZ_SIZE free_index = 0;
+	for (CRZ_SIZE b = 0; b < bucket_count; b++) {
+		if (bucket_starts[b + 1] - bucket_starts[b] != 1)
+			continue;
+
+		while (taken[free_index])
+			free_index++;
+		CRZ_SIZE i = order[bucket_starts[b]];
+		CRZ_SIZE first = crzfrozen_index(hashes[i], 0, size);
+		selfp->displacements[b] =
+			(uint64_t)((free_index + size - first) % size) * size;
+		slots[i] = free_index;
+		taken[free_index] = CRZ_TRUE;
+	}
+
+	return CRZ_TRUE;
+}
+
+void *crzfrozen_get(Crzfrozen_AnyFrozenTable *selfp, CRZ_STRING key,
+		    CRZ_SIZE value_size)
+{
+	if (selfp->size == 0)
+		return CRZ_NULL;
+
+	uint64_t hash = crzfrozen_hash(key, selfp->seed);
+	CRZ_SIZE bucket = crzfrozen_bucket(hash, selfp->bucket_count);
+	CRZ_SIZE index = crzfrozen_index(hash, selfp->displacements[bucket],
+					 selfp->size);
+
+	if (!CRZ_STRING_EQ(selfp->keys + selfp->key_offsets[index], key))
+		return CRZ_NULL;
+	return (char *)selfp->values + index * value_size;
+}
+
+void crzfrozen_emit_begin(Crzfrozen_AnyFrozenTable *selfp, FILE *file,
+			  const char *name, const char *type)
+{
+	// Written as bytes rather than as a string literal,
+	// since compilers only need to support short literals, and as unsigned
+	// bytes since non-ASCII ones overflow a `char`
+	CRZ_SIZE keys_len = 0;
+	for (CRZ_SIZE i = 0; i < selfp->size; i++)
+		keys_len += CRZ_STRLEN(selfp->keys + selfp->key_offsets[i]) + 1;
+	fprintf(file, "static const unsigned char %s_keys[] = {", name);
+	for (CRZ_SIZE i = 0; i < keys_len; i++) {
+		fprintf(file, "%s%d,", i % 16 == 0 ? "\n\t" : " ",
+			(unsigned char)selfp->keys[i]);
+	}
+	if (keys_len == 0)
+		fprintf(file, "\n\t0,");
+	fprintf(file, "\n};\n\n");
+
+	fprintf(file, "static CRZ_SIZE %s_key_offsets[] = {\n", name);
+	for (CRZ_SIZE i = 0; i < selfp->size; i++)
+		fprintf(file, "\t" CRZ_SIZE_FMT ",\n", selfp->key_offsets[i]);
+	if (selfp->size == 0)
+		fprintf(file, "\t0,\n");
+	fprintf(file, "};\n\n");
+
+	fprintf(file, "static CRZ_SIZE %s_displacements[] = {\n", name);
+	for (CRZ_SIZE b = 0; b < selfp->bucket_count; b++)
+		fprintf(file, "\t" CRZ_SIZE_FMT ",\n", selfp->displacements[b]);
+	if (selfp->bucket_count == 0)
+		fprintf(file, "\t0,\n");
+	fprintf(file, "};\n\n");
+
+	if (selfp->size == 0)
+		fprintf(file, "static %s %s_values[1];\n\n", type, name);
+	else
+		fprintf(file, "static %s %s_values[] = {\n", type, name);
+}
+
+void crzfrozen_emit_end(Crzfrozen_AnyFrozenTable *selfp, FILE *file,
+			const char *name, const char *type)
+{
+	if (selfp->size != 0)
+		fprintf(file, "};\n\n");
+
+	fprintf(file, "static FROZEN_TABLE(%s) %s = {\n", type, name);
+	fprintf(file, "\t.values = %s_values,\n", name);
+	fprintf(file, "\t.key_offsets = %s_key_offsets,\n", name);
+	fprintf(file, "\t.keys = (char *)%s_keys,\n", name);
+	fprintf(file, "\t.displacements = %s_displacements,\n", name);
+	fprintf(file, "\t.size = " CRZ_SIZE_FMT ",\n", selfp->size);
+	fprintf(file, "\t.bucket_count = " CRZ_SIZE_FMT ",\n",
+		selfp->bucket_count);
+	fprintf(file, "\t.seed = " CRZ_SIZE_FMT ",\n", selfp->seed);
+	fprintf(file, "};\n");
+}
+
+#endif // CRZFROZEN_H_
@@ -0,0 +1,598 @@
+#ifndef CRZHAMT_H_
+#define CRZHAMT_H_
+
+#include "crzdef.h"
+#include "crzhash.h"
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+/// The amount of hash bits consumed by each level of a `Hamt`, so that each inner node has up to 32 children.
+#define CRZHAMT_BITS 5
+
+/// The amount of times publishing to a `HamtCell` spins on the CPU while waiting, before yielding to other threads instead.
+#ifndef CRZHAMT_SPINS
+#define CRZHAMT_SPINS 64
+#endif // CRZHAMT_SPINS
+
+/// INTERNAL: this is the kind of a `Crzhamt_Node`.
+enum {
+	CRZHAMT_LEAF,
+	CRZHAMT_INNER,
+	CRZHAMT_COLLISION,
+};
+
+/// INTERNAL: this is the header shared by every node of a `Hamt`.
+///
+/// Nodes are immutable once built, and shared between every version which reaches them, so they are reference counted.
+typedef struct {
+	atomic_size_t refs;
+	uint32_t kind;
+	/// For inner nodes, which of the 32 children are present. For collision nodes, the amount of leaves.
+	uint32_t bitmap;
+} Crzhamt_Node;
+
+/// INTERNAL: this is a node holding one key-value pair, with the value stored at `CRZHAMT_VALUE_OFFSET` from its start.
+typedef struct {
+	Crzhamt_Node node;
+	uint64_t hash;
+	CRZ_STRING key;
+} Crzhamt_Leaf;
+
+/// INTERNAL: this is an inner node, whose children are sorted by their index in `bitmap`, or a collision node, whose children are leaves which share a hash.
+typedef struct {
+	Crzhamt_Node node;
+	Crzhamt_Node *children[];
+} Crzhamt_Inner;
+
+/// INTERNAL: this is where the value of a `Crzhamt_Leaf` starts, aligned to 16 bytes.
+#define CRZHAMT_VALUE_OFFSET ((sizeof(Crzhamt_Leaf) + 15) & ~(CRZ_SIZE)15)
+
+/// A persistent hash array mapped trie from string keys to values, which is never modified once built.
+///
+/// Setting or removing a key copies only the path from the root to its leaf, and returns a new version sharing every other node with the old one, in O(log n) time.
+/// Both versions stay valid and each must be freed using `HAMT_FREE`, so any version may be read from any thread without locking.
+/// Keys are hashed with `CRZHASH_HASH` and compared with `CRZHASH_KEY_EQ`, so they match under the same equality as the hash tables of `crzhash` initialized using `HASH_TABLE_INIT`.
+typedef struct {
+	Crzhamt_Node *root;
+	CRZ_SIZE len;
+	CRZ_SIZE value_size;
+} Hamt;
+
+/// A shared slot holding the current version of a `Hamt`, which readers load without blocking while a writer publishes new versions.
+///
+/// Readers register in the current epoch while they take a reference to the current version.
+/// Publishing swaps in the new version, flips the epoch, and waits for the readers registered in the previous epoch before releasing the old version, so it is never freed while a reader is still taking a reference to it.
+typedef struct {
+	_Atomic(Hamt *) current;
+	atomic_size_t epoch;
+	atomic_size_t readers[2];
+	atomic_flag publishing;
+} HamtCell;
+
+/// Create an empty `Hamt` with values of type `T`.
+///
+/// This does not perform any allocations.
+#define HAMT_NEW(T) \
+	((Hamt){ .root = CRZ_NULL, .len = 0, .value_size = sizeof(T) })
+
+/// Get a pointer to the value at the key `get_key` in the `Hamt` `self`, or `CRZ_NULL` if it does not exist.
+///
+/// The value is shared by every version which has it, so it must not be modified, and is only valid until `self` is freed.
+#define HAMT_GET(self, get_key) crzhamt_get(&(self), (get_key))
+
+/// Get a new version of the `Hamt` `self` with the value pointed to by `valuep` at the key `set_key`.
+///
+/// The value is copied, and a new key is made using `CRZ_STRDUP` if the key did not exist. `self` itself is left as it is.
+#define HAMT_SET(self, set_key, valuep) \
+	crzhamt_set(&(self), (set_key), (valuep))
+
+/// Get a new version of the `Hamt` `self` without the key `remove_key`.
+///
+/// If the key does not exist, the new version shares everything with `self`. `self` itself is left as it is.
+#define HAMT_REMOVE(self, remove_key) crzhamt_remove(&(self), (remove_key))
+
+/// Get another reference to the `Hamt` `self`, which must be freed separately.
+#define HAMT_CLONE(self) crzhamt_clone(&(self))
+
+/// Release the `Hamt` `selfp` (passed by pointer), freeing the nodes which no other version shares, and empty-out the fields of the struct.
+#define HAMT_FREE(selfp) crzhamt_free(selfp)
+
+/// Properly initialize the cell `selfp` (passed by pointer), holding an empty `Hamt` with values of type `T`.
+#define HAMT_CELL_INIT(selfp, T) crzhamt_cell_init((selfp), sizeof(T))
+
+/// Get a reference to the current version in the cell `selfp` (passed by pointer), which must be freed using `HAMT_FREE`.
+///
+/// This never waits for writers, so readers are never blocked by a version being published.
+#define HAMT_CELL_LOAD(selfp) crzhamt_cell_load(selfp)
+
+/// Publish the `Hamt` `version` as the current version of the cell `selfp` (passed by pointer), releasing the previous one.
+///
+/// The cell takes its own reference, so `version` must still be freed by the caller.
+/// Publishing waits for the readers which may still be taking a reference to the previous version, and for any other publisher.
+/// Note that a load, update and publish from several writers may still lose updates, so updates should be made by one writer at a time.
+#define HAMT_CELL_PUBLISH(selfp, version) \
+	crzhamt_cell_publish((selfp), &(version))
+
+/// Free the cell `selfp` (passed by pointer), releasing its current version.
+///
+/// No other thread may be using the cell.
+#define HAMT_CELL_FREE(selfp) crzhamt_cell_free(selfp)
+
+/// INTERNAL: this function spreads out the bits of `CRZHASH_HASH`, which each level of the trie consumes a few of.
+uint64_t crzhamt_mix(uint64_t hash);
+
+/// INTERNAL: this function takes another reference to `node`, which may be `CRZ_NULL`.
+Crzhamt_Node *crzhamt_retain(Crzhamt_Node *node);
+
+/// INTERNAL: this function releases a reference to `node`, which may be `CRZ_NULL`, freeing it along with its children once unreferenced.
+void crzhamt_release(Crzhamt_Node *node);
+
+/// INTERNAL: this function allocates a leaf with a copy of `key` and of the value at `valuep`.
+Crzhamt_Leaf *crzhamt_new_leaf(uint64_t hash, CRZ_STRING key,
+			       const void *valuep, CRZ_SIZE value_size);
+
+/// INTERNAL: this function allocates an inner or collision node of the kind `kind` with room for `count` children.
+Crzhamt_Inner *crzhamt_new_inner(uint32_t kind, uint32_t bitmap,
+				 CRZ_SIZE count);
+
+/// INTERNAL: this is the amount of children of the inner or collision node `inner`.
+CRZ_SIZE crzhamt_count(const Crzhamt_Inner *inner);
+
+/// INTERNAL: this function copies `inner` with the child at `position` replaced by `child`, which the copy takes over.
+///           The other children are shared with `inner`.
+Crzhamt_Node *crzhamt_replace(const Crzhamt_Inner *inner, CRZ_SIZE position,
+			      Crzhamt_Node *child);
+
+/// INTERNAL: this function copies `inner` with `child` inserted at `position`, or with the child at `position` left out if `child` is `CRZ_NULL`.
+///           For inner nodes, `bitmap` is the bitmap of the copy.
+Crzhamt_Node *crzhamt_splice(const Crzhamt_Inner *inner, uint32_t bitmap,
+			     CRZ_SIZE position, Crzhamt_Node *child);
+
+/// INTERNAL: this function builds the subtrie at `shift` holding the two leaves `a` and `b`, which have different hashes.
+Crzhamt_Node *crzhamt_merge(Crzhamt_Node *a, uint64_t a_hash,
+			    Crzhamt_Node *b, uint64_t b_hash, CRZ_SIZE shift);
+
+/// INTERNAL: this function returns a copy of the subtrie `node` at `shift` with `leaf` set in it, setting `addedp` to whether its key is new.
+Crzhamt_Node *crzhamt_set_in(Crzhamt_Node *node, Crzhamt_Leaf *leaf,
+			     CRZ_SIZE shift, CRZ_BOOL *addedp);
+
+/// INTERNAL: this function returns a copy of the subtrie `node` at `shift` without `key`, or another reference to `node` if `key` is not in it.
+Crzhamt_Node *crzhamt_remove_in(Crzhamt_Node *node, uint64_t hash,
+				CRZ_STRING key, CRZ_SIZE shift);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HAMT_GET(self, get_key)` instead.
+const void *crzhamt_get(const Hamt *selfp, CRZ_STRING key);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HAMT_SET(self, set_key, valuep)` instead.
+Hamt crzhamt_set(const Hamt *selfp, CRZ_STRING key, const void *valuep);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HAMT_REMOVE(self, remove_key)` instead.
+Hamt crzhamt_remove(const Hamt *selfp, CRZ_STRING key);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HAMT_CLONE(self)` instead.
+Hamt crzhamt_clone(const Hamt *selfp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HAMT_FREE(selfp)` instead.
+void crzhamt_free(Hamt *selfp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HAMT_CELL_INIT(selfp, T)` instead.
+void crzhamt_cell_init(HamtCell *selfp, CRZ_SIZE value_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HAMT_CELL_LOAD(selfp)` instead.
+Hamt crzhamt_cell_load(HamtCell *selfp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HAMT_CELL_PUBLISH(selfp, version)` instead.
+void crzhamt_cell_publish(HamtCell *selfp, const Hamt *versionp);
+
+/// INTERNAL: this function waits a little before checking again, counting the waits in `spinsp`.
+void crzhamt_backoff(CRZ_SIZE *spinsp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HAMT_CELL_FREE(selfp)` instead.
+void crzhamt_cell_free(HamtCell *selfp);
+
+uint64_t crzhamt_mix(uint64_t hash)
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+Crzhamt_Node *crzhamt_retain(Crzhamt_Node *node)
+{
+	if (node)
+		atomic_fetch_add_explicit(&node->refs, 1, memory_order_relaxed);
+	return node;
+}
+
+void crzhamt_release(Crzhamt_Node *node)
+{
+	if (node == CRZ_NULL)
+		return;
+	if (atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) > 1)
+		return;
+
+	if (node->kind == CRZHAMT_LEAF) {
+		CRZ_FREE(((Crzhamt_Leaf *)node)->key);
+	} else {
+		Crzhamt_Inner *inner = (Crzhamt_Inner *)node;
+		CRZ_SIZE count = crzhamt_count(inner);
+		for (CRZ_SIZE i = 0; i < count; i++)
+			crzhamt_release(inner->children[i]);
+	}
+	CRZ_FREE(node);
+}
+
+Crzhamt_Leaf *crzhamt_new_leaf(uint64_t hash, CRZ_STRING key,
+			       const void *valuep, CRZ_SIZE value_size)
+{
+	Crzhamt_Leaf *leaf = CRZ_MALLOC(CRZHAMT_VALUE_OFFSET + value_size);
+	CRZ_ASSERT(leaf && "Out of memory when allocating leaf for HAMT");
+	atomic_init(&leaf->node.refs, 1);
+	leaf->node.kind = CRZHAMT_LEAF;
+	leaf->node.bitmap = 0;
+	leaf->hash = hash;
+	leaf->key = CRZ_STRDUP(key);
+	CRZ_MEMCPY((char *)leaf + CRZHAMT_VALUE_OFFSET, valuep, value_size);
+	return leaf;
+}
+
+Crzhamt_Inner *crzhamt_new_inner(uint32_t kind, uint32_t bitmap,
+				 CRZ_SIZE count)
+{
+	Crzhamt_Inner *inner = CRZ_MALLOC(sizeof(Crzhamt_Inner) +
+					  count * sizeof(Crzhamt_Node *));
+	CRZ_ASSERT(inner && "Out of memory when allocating node for HAMT");
+	atomic_init(&inner->node.refs, 1);
+	inner->node.kind = kind;
+	inner->node.bitmap = bitmap;
+	return inner;
+}
+
+CRZ_SIZE crzhamt_count(const Crzhamt_Inner *inner)
+{
+	if (inner->node.kind == CRZHAMT_COLLISION)
+		return inner->node.bitmap;
+	return CRZ_POPCOUNT(inner->node.bitmap);
+}
+
+Crzhamt_Node *crzhamt_replace(const Crzhamt_Inner *inner, CRZ_SIZE position,
+			      Crzhamt_Node *child)
+{
+	CRZ_SIZE count = crzhamt_count(inner);
+	Crzhamt_Inner *copy =
+		crzhamt_new_inner(inner->node.kind, inner->node.bitmap, count);
+	for (CRZ_SIZE i = 0; i < count; i++) {
+		copy->children[i] = i == position ?
+					    child :
+					    crzhamt_retain(inner->children[i]);
+	}
+	return &copy->node;
+}
+
+Crzhamt_Node *crzhamt_splice(const Crzhamt_Inner *inner, uint32_t bitmap,
+			     CRZ_SIZE position, Crzhamt_Node *child)
+{
+	CRZ_SIZE count = crzhamt_count(inner);
+	CRZ_SIZE new_count = child ? count + 1 : count - 1;
+	if (inner->node.kind == CRZHAMT_COLLISION)
+		bitmap = (uint32_t)new_count;
+	Crzhamt_Inner *copy =
+		crzhamt_new_inner(inner->node.kind, bitmap, new_count);
+
+	CRZ_SIZE from = 0;
+	for (CRZ_SIZE i = 0; i < new_count; i++) {
+		if (i == position) {
+			if (child) {
+				copy->children[i] = child;
+				continue;
+			}
+			from++;
+		}
+		copy->children[i] = crzhamt_retain(inner->children[from++]);
+	}
+	return &copy->node;
+}
+
+Crzhamt_Node *crzhamt_merge(Crzhamt_Node *a, uint64_t a_hash,
+			    Crzhamt_Node *b, uint64_t b_hash, CRZ_SIZE shift)
+{
+	uint32_t a_index = (a_hash >> shift) & 31;
+	uint32_t b_index = (b_hash >> shift) & 31;
+
+	if (a_index == b_index) {
+		Crzhamt_Inner *inner =
+			crzhamt_new_inner(CRZHAMT_INNER, 1u << a_index, 1);
+		inner->children[0] = crzhamt_merge(a, a_hash, b, b_hash,
+						   shift + CRZHAMT_BITS);
+		return &inner->node;
+	}
+
+	Crzhamt_Inner *inner = crzhamt_new_inner(
+		CRZHAMT_INNER, (1u << a_index) | (1u << b_index), 2);
+	inner->children[a_index < b_index ? 0 : 1] = a;
+	inner->children[a_index < b_index ? 1 : 0] = b;
+	return &inner->node;
+}
+
+Crzhamt_Node *crzhamt_set_in(Crzhamt_Node *node, Crzhamt_Leaf *leaf,
+			     CRZ_SIZE shift, CRZ_BOOL *addedp)
+{
+	if (node == CRZ_NULL) {
+		*addedp = CRZ_TRUE;
+		return &leaf->node;
+	}
+
+	if (node->kind == CRZHAMT_LEAF) {
+		Crzhamt_Leaf *existing = (Crzhamt_Leaf *)node;
+		if (existing->hash != leaf->hash) {
+			*addedp = CRZ_TRUE;
+			return crzhamt_merge(crzhamt_retain(node),
+					     existing->hash, &leaf->node,
+					     leaf->hash, shift);
+		}
+		if (CRZHASH_KEY_EQ(existing->key, leaf->key)) {
+			*addedp = CRZ_FALSE;
+			return &leaf->node;
+		}
+		// Different keys with the same hash share a collision node
+		*addedp = CRZ_TRUE;
+		Crzhamt_Inner *collision =
+			crzhamt_new_inner(CRZHAMT_COLLISION, 2, 2);
+		collision->children[0] = crzhamt_retain(node);
+		collision->children[1] = &leaf->node;
+		return &collision->node;
+	}
+
+	Crzhamt_Inner *inner = (Crzhamt_Inner *)node;
+	if (node->kind == CRZHAMT_COLLISION) {
+		Crzhamt_Leaf *first = (Crzhamt_Leaf *)inner->children[0];
+		if (first->hash != leaf->hash) {
+			*addedp = CRZ_TRUE;
+			return crzhamt_merge(crzhamt_retain(node), first->hash,
+					     &leaf->node, leaf->hash, shift);
+		}
+		for (CRZ_SIZE i = 0; i < node->bitmap; i++) {
+			Crzhamt_Leaf *existing =
+				(Crzhamt_Leaf *)inner->children[i];
+			if (CRZHASH_KEY_EQ(existing->key, leaf->key)) {
+				*addedp = CRZ_FALSE;
+				return crzhamt_replace(inner, i, &leaf->node);
+			}
+		}
+		*addedp = CRZ_TRUE;
+		return crzhamt_splice(inner, 0, node->bitmap, &leaf->node);
+	}
+
+	uint32_t bit = 1u << ((leaf->hash >> shift) & 31);
+	CRZ_SIZE position = CRZ_POPCOUNT(node->bitmap & (bit - 1));
+	if (node->bitmap & bit) {
+		Crzhamt_Node *child =
+			crzhamt_set_in(inner->children[position], leaf,
+				       shift + CRZHAMT_BITS, addedp);
+		return crzhamt_replace(inner, position, child);
+	}
+	*addedp = CRZ_TRUE;
+	return crzhamt_splice(inner, node->bitmap | bit, position, &leaf->node);
+}
+
+Crzhamt_Node *crzhamt_remove_in(Crzhamt_Node *node, uint64_t hash,
+				CRZ_STRING key, CRZ_SIZE shift)
+{
+	if (node->kind == CRZHAMT_LEAF) {
+		Crzhamt_Leaf *existing = (Crzhamt_Leaf *)node;
+		if (existing->hash == hash &&
+		    CRZHASH_KEY_EQ(existing->key, key))
+			return CRZ_NULL;
+		return crzhamt_retain(node);
+	}
+
+	Crzhamt_Inner *inner = (Crzhamt_Inner *)node;
+	if (node->kind == CRZHAMT_COLLISION) {
+		for (CRZ_SIZE i = 0; i < node->bitmap; i++) {
+			Crzhamt_Leaf *existing =
+				(Crzhamt_Leaf *)inner->children[i];
+			if (existing->hash != hash ||
+			    !CRZHASH_KEY_EQ(existing->key, key))
+				continue;
+			// A single remaining leaf needs no collision node
+			if (node->bitmap == 2)
+				return crzhamt_retain(inner->children[1 - i]);
+			return crzhamt_splice(inner, 0, i, CRZ_NULL);
+		}
+		return crzhamt_retain(node);
+	}
+
+	uint32_t bit = 1u << ((hash >> shift) & 31);
+	if (!(node->bitmap & bit))
+		return crzhamt_retain(node);
+
+	CRZ_SIZE position = CRZ_POPCOUNT(node->bitmap & (bit - 1));
+	Crzhamt_Node *old_child = inner->children[position];
+	Crzhamt_Node *child =
+		crzhamt_remove_in(old_child, hash, key, shift + CRZHAMT_BITS);
+	if (child == old_child) {
+		crzhamt_release(child);
+		return crzhamt_retain(node);
+	}
+
+	CRZ_SIZE count = CRZ_POPCOUNT(node->bitmap);
+	if (child == CRZ_NULL) {
+		if (count == 1)
+			return CRZ_NULL;
+		// Pull a lone remaining leaf up, so that tries stay as shallow
+		// as if the key had never been set
+		if (count == 2 &&
+		    inner->children[1 - position]->kind != CRZHAMT_INNER)
+			return crzhamt_retain(inner->children[1 - position]);
+		return crzhamt_splice(inner, node->bitmap & ~bit, position,
+				      CRZ_NULL);
+	}
+	if (count == 1 && child->kind != CRZHAMT_INNER)
+		return child;
+	return crzhamt_replace(inner, position, child);
+}
+
+const void *crzhamt_get(const Hamt *selfp, CRZ_STRING key)
+{
+	uint64_t hash = crzhamt_mix(CRZHASH_HASH(key));
+	const Crzhamt_Node *node = selfp->root;
+
+	for (CRZ_SIZE shift = 0; node; shift += CRZHAMT_BITS) {
+		const Crzhamt_Inner *inner = (const Crzhamt_Inner *)node;
+
+		if (node->kind == CRZHAMT_LEAF) {
+			const Crzhamt_Leaf *leaf = (const Crzhamt_Leaf *)node;
+			if (leaf->hash != hash ||
+			    !CRZHASH_KEY_EQ(leaf->key, key))
+				return CRZ_NULL;
+			return (const char *)leaf + CRZHAMT_VALUE_OFFSET;
+		}
+
+		if (node->kind == CRZHAMT_COLLISION) {
+			for (CRZ_SIZE i = 0; i < node->bitmap; i++) {
+				const Crzhamt_Node *child = inner->children[i];
+				const Crzhamt_Leaf *leaf =
+					(const Crzhamt_Leaf *)child;
+				if (leaf->hash == hash &&
+				    CRZHASH_KEY_EQ(leaf->key, key))
+					return (const char *)leaf +
+					       CRZHAMT_VALUE_OFFSET;
+			}
+			return CRZ_NULL;
+		}
+
+		uint32_t bit = 1u << ((hash >> shift) & 31);
+		if (!(node->bitmap & bit))
+			return CRZ_NULL;
+		node = inner->children[CRZ_POPCOUNT(node->bitmap & (bit - 1))];
+	}
+	return CRZ_NULL;
+}
+
+Hamt crzhamt_set(const Hamt *selfp, CRZ_STRING key, const void *valuep)
+{
+	uint64_t hash = crzhamt_mix(CRZHASH_HASH(key));
+	Crzhamt_Leaf *leaf =
+		crzhamt_new_leaf(hash, key, valuep, selfp->value_size);
+	CRZ_BOOL added = CRZ_FALSE;
+
+	Hamt result = *selfp;
+	result.root = crzhamt_set_in(selfp->root, leaf, 0, &added);
+	result.len += added;
+	return result;
+}
+
+Hamt crzhamt_remove(const Hamt *selfp, CRZ_STRING key)
+{
+	if (selfp->root == CRZ_NULL)
+		return *selfp;
+
+	uint64_t hash = crzhamt_mix(CRZHASH_HASH(key));
+	Hamt result = *selfp;
+	result.root = crzhamt_remove_in(selfp->root, hash, key, 0);
+	if (result.root != selfp->root)
+		result.len -= 1;
+	return result;
+}
+
+Hamt crzhamt_clone(const Hamt *selfp)
+{
+	crzhamt_retain(selfp->root);
+	return *selfp;
+}
+
+void crzhamt_free(Hamt *selfp)
+{
+	crzhamt_release(selfp->root);
+	selfp->root = CRZ_NULL;
+	selfp->len = 0;
+}
+
+void crzhamt_cell_init(HamtCell *selfp, CRZ_SIZE value_size)
+{
+	Hamt *empty = CRZ_MALLOC(sizeof(Hamt));
+	CRZ_ASSERT(empty && "Out of memory when allocating HAMT cell");
+	empty->root = CRZ_NULL;
+	empty->len = 0;
+	empty->value_size = value_size;
+	atomic_init(&selfp->current, empty);
+	atomic_init(&selfp->epoch, 0);
+	atomic_init(&selfp->readers[0], 0);
+	atomic_init(&selfp->readers[1], 0);
+	atomic_flag_clear(&selfp->publishing);
+}
+
+Hamt crzhamt_cell_load(HamtCell *selfp)
+{
+	CRZ_SIZE epoch;
+	while (CRZ_TRUE) {
+		epoch = atomic_load(&selfp->epoch);
+		atomic_fetch_add(&selfp->readers[epoch], 1);
+		// Only counts if the epoch was not flipped before registering,
+		// otherwise the publisher may already be done waiting for it
+		if (atomic_load(&selfp->epoch) == epoch)
+			break;
+		atomic_fetch_sub(&selfp->readers[epoch], 1);
+	}
+
+	Hamt result = crzhamt_clone(atomic_load(&selfp->current));
+	atomic_fetch_sub(&selfp->readers[epoch], 1);
+	return result;
+}
+
+void crzhamt_backoff(CRZ_SIZE *spinsp)
+{
+	// Waits are usually short, as readers only clone a version, but a
+	// descheduled thread can hold them up, so stop burning its time slice
+	if (*spinsp < CRZHAMT_SPINS) {
+		(*spinsp)++;
+		CRZ_PAUSE();
+	} else {
+		sched_yield();
+	}
+}
+
+void crzhamt_cell_publish(HamtCell *selfp, const Hamt *versionp)
+{
+	Hamt *next = CRZ_MALLOC(sizeof(Hamt));
+	CRZ_ASSERT(next && "Out of memory when allocating HAMT cell");
+	*next = crzhamt_clone(versionp);
+
+	CRZ_SIZE spins = 0;
+	while (atomic_flag_test_and_set(&selfp->publishing))
+		crzhamt_backoff(&spins);
+	Hamt *previous = atomic_exchange(&selfp->current, next);
+	CRZ_SIZE epoch = atomic_load(&selfp->epoch);
+	atomic_store(&selfp->epoch, 1 - epoch);
+	spins = 0;
+	while (atomic_load(&selfp->readers[epoch]) > 0)
+		crzhamt_backoff(&spins);
+	atomic_flag_clear(&selfp->publishing);
+
+	crzhamt_free(previous);
+	CRZ_FREE(previous);
+}
+
+void crzhamt_cell_free(HamtCell *selfp)
+{
+	Hamt *current = atomic_load(&selfp->current);
+	crzhamt_free(current);
+	CRZ_FREE(current);
+	atomic_store(&selfp->current, CRZ_NULL);
+}
+
+#endif // CRZHAMT_H_
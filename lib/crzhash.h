@@ -2,6 +2,31 @@
 #define CRZHASH_H_
 
 #include "crzdef.h"
+#include "crzstats.h"
+#include <string.h>
+
+/// The load factor, as a percentage, that `HASH_TABLE_RESERVE` and `HASH_TABLE_SHRINK` size hash tables for.
+#ifndef CRZHASH_TARGET_LOAD_PERCENT
+#define CRZHASH_TARGET_LOAD_PERCENT 75
+#endif // CRZHASH_TARGET_LOAD_PERCENT
+
+/// The amount of keys that `HASH_TABLE_GET_BATCH` has in flight at once.
+#ifndef CRZHASH_BATCH_SIZE
+#define CRZHASH_BATCH_SIZE 16
+#endif // CRZHASH_BATCH_SIZE
+
+/// The hashing function applied to keys as `CRZHASH_HASH(key)` by the hash tables of `crzhash`, `crzomap` and `crzsnap`.
+///
+/// Keys which are equal under `CRZHASH_KEY_EQ` must hash the same.
+/// Tables initialized using `HASH_TABLE_INIT_ICASE` or `ORDERED_TABLE_NEW_ICASE` ignore the case of ASCII letters instead, without copying the keys, so both kinds of table may be used in the same program.
+#ifndef CRZHASH_HASH
+#define CRZHASH_HASH(key) crzhash_djb2(key)
+#endif // CRZHASH_HASH
+
+/// The equality applied to keys as `CRZHASH_KEY_EQ(a, b)` by the hash tables of `crzhash`, `crzomap` and `crzsnap`.
+#ifndef CRZHASH_KEY_EQ
+#define CRZHASH_KEY_EQ(a, b) CRZ_STRING_EQ(a, b)
+#endif // CRZHASH_KEY_EQ
 
 /// Define a struct for a key-value pair retrieved from a hash table, with value of type `T`.
 #define HASH_PAIR(T)            \
@@ -11,10 +36,13 @@
 	}
 
 /// Define a struct for a hash table with values of type `T`.
+///
+/// `icase` is whether the table ignores the case of ASCII letters in its keys, as set by `HASH_TABLE_INIT_ICASE`.
 #define HASH_TABLE(T)                \
 	struct {                     \
 		HASH_PAIR(T) * *ptr; \
 		CRZ_SIZE size;       \
+		CRZ_BOOL icase;      \
 	}
 
 /// INTERNAL: you most likely don't want to use this.
@@ -26,17 +54,41 @@ typedef HASH_PAIR(char) Crzhash_AnyHashPair;
 typedef struct {
 	void **ptr;
 	CRZ_SIZE size;
+	CRZ_BOOL icase;
 } Crzhash_AnyHashTable;
 
+/// Statistics about the layout of a hash table, as returned by `HASH_TABLE_STATS`.
+///
+/// The probe length of a pair is its distance from the index its key hashes to, so a pair at its ideal index has a probe length of 0.
+/// A cluster is a run of consecutive indexes which all have pairs associated with them.
+typedef struct {
+	CRZ_SIZE size;
+	CRZ_SIZE count;
+	double load_factor;
+	double average_probe_length;
+	CRZ_SIZE max_probe_length;
+	CRZ_SIZE cluster_count;
+	double average_cluster_size;
+	CRZ_SIZE max_cluster_size;
+} HashTableStats;
+
 /// Get the size in bytes of each key-value pair of the hash table `self`.
 #define HASH_TABLE_PAIR_SIZE(self) sizeof(**(self).ptr)
 
 /// Zero-initialize a hash table.
 ///
 /// Requires calling `HASH_TABLE_INIT` afterwards.
-#define HASH_TABLE_NEW()               \
-	{                              \
-		.ptr = NULL, .size = 0 \
+#define HASH_TABLE_NEW()                                   \
+	{                                                  \
+		.ptr = NULL, .size = 0, .icase = CRZ_FALSE \
+	}
+
+/// Zero-initialize a hash table which ignores the case of ASCII letters in its keys.
+///
+/// Requires calling `HASH_TABLE_RESERVE` afterwards, which keeps the table ignoring case, unlike `HASH_TABLE_INIT`.
+#define HASH_TABLE_NEW_ICASE()                            \
+	{                                                 \
+		.ptr = NULL, .size = 0, .icase = CRZ_TRUE \
 	}
 
 /// Properly initialize a hash table.
@@ -45,7 +97,15 @@ typedef struct {
 /// Note that using too small a size here can cause collisions and overflows, which will significantly decrease the performance of the hash table.
 #define HASH_TABLE_INIT(selfp, initial_size)                          \
 	crzhash_init((Crzhash_AnyHashTable *)(selfp), (initial_size), \
-		     HASH_TABLE_PAIR_SIZE(*(selfp)))
+		     HASH_TABLE_PAIR_SIZE(*(selfp)), CRZ_FALSE)
+
+/// Properly initialize a hash table which ignores the case of ASCII letters in its keys, as for HTTP header names.
+///
+/// Keys are hashed with `crzhash_djb2_icase` and compared with `crzhash_key_eq_icase` rather than `CRZHASH_HASH` and `CRZHASH_KEY_EQ`, so the first key inserted keeps its case.
+/// Otherwise, this is the same as `HASH_TABLE_INIT`.
+#define HASH_TABLE_INIT_ICASE(selfp, initial_size)                    \
+	crzhash_init((Crzhash_AnyHashTable *)(selfp), (initial_size), \
+		     HASH_TABLE_PAIR_SIZE(*(selfp)), CRZ_TRUE)
 
 /// Insert the value `insert_value` at the key `insert_key` for the hash table `selfp` (passed by pointer).
 ///
@@ -71,11 +131,30 @@ typedef struct {
 			CRZ_ASSERT(                                                             \
 				(selfp)->ptr[index] &&                                          \
 				"Out of memory when allocating key-value pair for hash table"); \
+			CRZ_STATS_ADD(hash, allocations, 1);                                    \
+			CRZ_STATS_ADD(hash, bytes_allocated,                                    \
+				      HASH_TABLE_PAIR_SIZE(*(selfp)));                          \
 			(selfp)->ptr[index]->key = CRZ_STRDUP(insert_key);                      \
+			CRZ_STATS_ADD(hash, allocations, 1);                                    \
 			(selfp)->ptr[index]->value = insert_value;                              \
 		}                                                                               \
 	} while (0)
 
+/// Get a pointer to the pair with key `entry_key` in the hash table `selfp` (passed by pointer), inserting it if it does not exist.
+///
+/// Sets `createdp` (passed by pointer) to whether the pair was just inserted; it may be `CRZ_NULL` if this is not needed.
+/// An inserted pair has a duplicate of `entry_key` (made using `CRZ_STRDUP`) as its key, and a zeroed value.
+/// An existing pair is returned as it is, without duplicating `entry_key`.
+///
+/// The key is hashed and probed for only once, so this is the way to get-or-insert, update a value in place, or construct a value only when it is missing:
+///   HASH_PAIR(int) *count = HASH_TABLE_ENTRY(&ht, word, CRZ_NULL);
+///   count->value += 1;
+///
+/// Like `HASH_TABLE_INSERT`, this may resize the table, which invalidates pointers to its pairs' slots (but not to the pairs themselves).
+#define HASH_TABLE_ENTRY(selfp, entry_key, createdp)                \
+	crzhash_entry((Crzhash_AnyHashTable *)(selfp), (entry_key), \
+		      HASH_TABLE_PAIR_SIZE(*(selfp)), (createdp))
+
 /// Get a pointer to the pair with key `get_key` in the hash table `self`.
 ///
 /// If the key does not exist in the table, returns `CRZ_NULL`.
@@ -84,6 +163,45 @@ typedef struct {
 #define HASH_TABLE_GET(self, get_key) \
 	crzhash_get((Crzhash_AnyHashTable *)(&(self)), get_key)
 
+/// Get pointers to the pairs with each of the `count` keys in `keys` in the hash table `self`, writing them to `results`.
+///
+/// `results` must have room for `count` pointers to the table's pairs, and each result is as it would be for `HASH_TABLE_GET`.
+///
+/// The keys are looked up `CRZHASH_BATCH_SIZE` at a time, by first hashing all of them and prefetching their indexes, then prefetching their pairs, then their keys, and only then comparing them.
+/// This overlaps the cache misses of many lookups, which is much faster than calling `HASH_TABLE_GET` in a loop for tables which do not fit in the cache.
+#define HASH_TABLE_GET_BATCH(self, keys, count, results)                      \
+	crzhash_get_batch((Crzhash_AnyHashTable *)(&(self)), (keys), (count), \
+			  (void **)(results))
+
+/// Remove the pair with key `remove_key` from the hash table `selfp` (passed by pointer), returning whether it existed.
+///
+/// Frees the pair and its (duplicated) key, but like `HASH_TABLE_FREE`, **does not** free its value.
+/// The pairs probed past it are shifted back into the freed index where their keys allow, so lookups still stop at the first empty index, without leaving tombstones behind.
+/// This moves pairs between indexes, which invalidates pointers to the table's slots (but not to the pairs themselves).
+#define HASH_TABLE_REMOVE(selfp, remove_key) \
+	crzhash_remove((Crzhash_AnyHashTable *)(selfp), (remove_key))
+
+/// Get the `HashTableStats` for the hash table `self`.
+///
+/// This walks the entire table, so it is meant for diagnostics and tuning rather than for hot paths.
+#define HASH_TABLE_STATS(self) crzhash_stats((Crzhash_AnyHashTable *)(&(self)))
+
+/// Make sure the hash table `selfp` (passed by pointer) can hold `amount_pairs` pairs at `CRZHASH_TARGET_LOAD_PERCENT`.
+///
+/// If the table is too small for that, a new table is created at the needed size, and all of the pairs are re-inserted into it.
+/// This may also be used instead of `HASH_TABLE_INIT`, if the table was zero-initialized using `HASH_TABLE_NEW`.
+#define HASH_TABLE_RESERVE(selfp, amount_pairs)                          \
+	crzhash_reserve((Crzhash_AnyHashTable *)(selfp), (amount_pairs), \
+			HASH_TABLE_PAIR_SIZE(*(selfp)))
+
+/// Shrink the hash table `selfp` (passed by pointer) to the smallest size that holds its pairs at `CRZHASH_TARGET_LOAD_PERCENT`.
+///
+/// If the table is larger than that, a new table is created at the smaller size, and all of the pairs are re-inserted into it.
+/// This is useful once the set of keys is known to be fixed.
+#define HASH_TABLE_SHRINK(selfp)                        \
+	crzhash_shrink((Crzhash_AnyHashTable *)(selfp), \
+		       HASH_TABLE_PAIR_SIZE(*(selfp)))
+
 /// Iterate over all indexes in the hash table `self`, naming the index variable `index`.
 ///
 /// Note that not every index has a pair associated with it, so you must check that `self.ptr[index]` is not `CRZ_NULL` before acting on it.
@@ -127,16 +245,34 @@ typedef struct {
 /// INTERNAL: you most likely don't want to use this.
 ///           Try `HASH_TABLE_INIT(selfp, initial_size)` instead.
 void crzhash_init(Crzhash_AnyHashTable *selfp, CRZ_SIZE initial_size,
-		  CRZ_SIZE pair_size);
+		  CRZ_SIZE pair_size, CRZ_BOOL icase);
 
 /// INTERNAL: this is the hashing function used by the `crzhash` hash table internally.
-CRZ_SIZE crzhash_djb2(CRZ_STRING str);
+CRZ_SIZE crzhash_djb2(const CRZ_STRING str);
+
+/// INTERNAL: this is `crzhash_djb2` of `str` with its ASCII letters lowercased.
+CRZ_SIZE crzhash_djb2_icase(const CRZ_STRING str);
+
+/// INTERNAL: this is whether `a` and `b` are equal, ignoring the case of ASCII letters.
+CRZ_BOOL crzhash_key_eq_icase(const CRZ_STRING a, const CRZ_STRING b);
+
+/// INTERNAL: this is the hash of `key` for a table which ignores case if `icase` is set.
+CRZ_SIZE crzhash_key_hash(CRZ_BOOL icase, const CRZ_STRING key);
+
+/// INTERNAL: this is whether the keys `a` and `b` are equal for a table which ignores case if `icase` is set.
+CRZ_BOOL crzhash_key_eq(CRZ_BOOL icase, const CRZ_STRING a,
+			const CRZ_STRING b);
 
 /// INTERNAL: you most likely don't want to use this.
 ///           Try `HASH_TABLE_INSERT(selfp, insert_key, insert_value)` instead.
 CRZ_SIZE crzhash_insert_index(Crzhash_AnyHashTable *selfp, CRZ_STRING key,
 			      CRZ_SIZE pair_size);
 
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HASH_TABLE_ENTRY(selfp, entry_key, createdp)` instead.
+void *crzhash_entry(Crzhash_AnyHashTable *selfp, CRZ_STRING key,
+		    CRZ_SIZE pair_size, CRZ_BOOL *createdp);
+
 /// INTERNAL: this function copies one hash table's key-value pairs into another.
 ///           This is used when a hash table overflows, to re-insert it into a larger one.
 void crzhash_clone(Crzhash_AnyHashTable self, Crzhash_AnyHashTable *other,
@@ -146,19 +282,55 @@ void crzhash_clone(Crzhash_AnyHashTable self, Crzhash_AnyHashTable *other,
 ///           Try `HASH_TABLE_GET(self, key)` instead.
 void *crzhash_get(Crzhash_AnyHashTable *selfp, CRZ_STRING key);
 
+/// INTERNAL: this function looks up `key` in a hash table, starting at the index `index` its key hashes to.
+void *crzhash_get_from(Crzhash_AnyHashTable *selfp, CRZ_STRING key,
+		       CRZ_SIZE index);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HASH_TABLE_GET_BATCH(self, keys, count, results)` instead.
+void crzhash_get_batch(Crzhash_AnyHashTable *selfp, CRZ_STRING *keys,
+		       CRZ_SIZE count, void **results);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HASH_TABLE_REMOVE(selfp, remove_key)` instead.
+CRZ_BOOL crzhash_remove(Crzhash_AnyHashTable *selfp, CRZ_STRING key);
+
+/// INTERNAL: this function re-inserts a hash table's key-value pairs into a new table of size `new_size`.
+void crzhash_resize(Crzhash_AnyHashTable *selfp, CRZ_SIZE new_size,
+		    CRZ_SIZE pair_size);
+
+/// INTERNAL: this is the size needed to hold `amount_pairs` pairs at `CRZHASH_TARGET_LOAD_PERCENT`.
+CRZ_SIZE crzhash_size_for(CRZ_SIZE amount_pairs);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HASH_TABLE_STATS(self)` instead.
+HashTableStats crzhash_stats(Crzhash_AnyHashTable *selfp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HASH_TABLE_RESERVE(selfp, amount_pairs)` instead.
+void crzhash_reserve(Crzhash_AnyHashTable *selfp, CRZ_SIZE amount_pairs,
+		     CRZ_SIZE pair_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HASH_TABLE_SHRINK(selfp)` instead.
+void crzhash_shrink(Crzhash_AnyHashTable *selfp, CRZ_SIZE pair_size);
+
 /// INTERNAL: you most likely don't want to use this.
 ///           Try `HASH_TABLE_INIT(selfp, initial_size)` instead.
 void crzhash_init(Crzhash_AnyHashTable *selfp, CRZ_SIZE initial_size,
-		  CRZ_SIZE pair_size)
+		  CRZ_SIZE pair_size, CRZ_BOOL icase)
 {
 	(selfp)->size = initial_size;
+	(selfp)->icase = icase;
 	(selfp)->ptr = CRZ_MALLOC(pair_size * initial_size);
 	CRZ_ASSERT((selfp)->ptr && "Out of memory when allocating hash table");
+	CRZ_STATS_ADD(hash, allocations, 1);
+	CRZ_STATS_ADD(hash, bytes_allocated, pair_size * initial_size);
 	for (CRZ_SIZE i = 0; i < initial_size; i++)
 		(selfp)->ptr[i] = CRZ_NULL;
 }
 
-CRZ_SIZE crzhash_djb2(CRZ_STRING str)
+CRZ_SIZE crzhash_djb2(const CRZ_STRING str)
 {
 	CRZ_SIZE hash = 5381;
 	CRZ_STRING_FOR(str, i) {
@@ -167,20 +339,56 @@ CRZ_SIZE crzhash_djb2(CRZ_STRING str)
 	return hash;
 }
 
+CRZ_SIZE crzhash_djb2_icase(const CRZ_STRING str)
+{
+	CRZ_SIZE hash = 5381;
+	CRZ_STRING_FOR(str, i) {
+		hash = ((hash << 5) + hash) +
+		       CRZ_ASCII_LOWER(CRZ_STRING_GET(str, i));
+	}
+	return hash;
+}
+
+CRZ_BOOL crzhash_key_eq_icase(const CRZ_STRING a, const CRZ_STRING b)
+{
+	CRZ_SIZE i = 0;
+	for (; !CRZ_STRING_IS_END(a, i); i++) {
+		if (CRZ_ASCII_LOWER(CRZ_STRING_GET(a, i)) !=
+		    CRZ_ASCII_LOWER(CRZ_STRING_GET(b, i)))
+			return CRZ_FALSE;
+	}
+	return CRZ_STRING_IS_END(b, i);
+}
+
+CRZ_SIZE crzhash_key_hash(CRZ_BOOL icase, const CRZ_STRING key)
+{
+	return icase ? crzhash_djb2_icase(key) : CRZHASH_HASH(key);
+}
+
+CRZ_BOOL crzhash_key_eq(CRZ_BOOL icase, const CRZ_STRING a,
+			const CRZ_STRING b)
+{
+	return icase ? crzhash_key_eq_icase(a, b) : CRZHASH_KEY_EQ(a, b);
+}
+
 CRZ_SIZE crzhash_insert_index(Crzhash_AnyHashTable *selfp, CRZ_STRING key,
 			      CRZ_SIZE pair_size)
 {
-	CRZ_SIZE index = crzhash_djb2(key) % (selfp)->size;
+	CRZ_SIZE index = crzhash_key_hash(selfp->icase, key) % (selfp)->size;
 	CRZ_BOOL wrapped = CRZ_FALSE;
 	CRZ_SIZE original = index;
 
 	while (CRZ_TRUE) {
 		Crzhash_AnyHashPair *existing = selfp->ptr[index];
 
-		if (existing == CRZ_NULL || CRZ_STRING_EQ(existing->key, key)) {
+		if (existing == CRZ_NULL ||
+		    crzhash_key_eq(selfp->icase, existing->key, key)) {
+			CRZ_STATS_PROBE(hash, (index + selfp->size - original) %
+						      selfp->size);
 			return index;
 		}
 
+		CRZ_STATS_ADD(hash, collisions, 1);
 		index += 1;
 
 		if (index >= selfp->size && !wrapped) {
@@ -190,20 +398,34 @@ CRZ_SIZE crzhash_insert_index(Crzhash_AnyHashTable *selfp, CRZ_STRING key,
 		}
 
 		if (index >= original && wrapped) {
-			Crzhash_AnyHashTable new = HASH_TABLE_NEW();
-			crzhash_init(&new, (selfp->size * 2), pair_size);
-			crzhash_clone(*selfp, &new, pair_size);
-
-			// Free pointer itself, but not the pairs
-			// since they've been copied over to the new table
-			CRZ_FREE((selfp)->ptr);
-			(*selfp) = new;
-
-			return crzhash_insert_index(&new, key, pair_size);
+			crzhash_resize(selfp, selfp->size * 2, pair_size);
+			return crzhash_insert_index(selfp, key, pair_size);
 		}
 	}
 }
 
+void *crzhash_entry(Crzhash_AnyHashTable *selfp, CRZ_STRING key,
+		    CRZ_SIZE pair_size, CRZ_BOOL *createdp)
+{
+	CRZ_SIZE index = crzhash_insert_index(selfp, key, pair_size);
+	CRZ_BOOL created = selfp->ptr[index] == CRZ_NULL;
+	if (createdp)
+		*createdp = created;
+	if (!created)
+		return selfp->ptr[index];
+
+	Crzhash_AnyHashPair *pair = CRZ_MALLOC(pair_size);
+	CRZ_ASSERT(pair && "Out of memory when allocating key-value pair "
+			  "for hash table");
+	CRZ_STATS_ADD(hash, allocations, 1);
+	CRZ_STATS_ADD(hash, bytes_allocated, pair_size);
+	memset(pair, 0, pair_size);
+	pair->key = CRZ_STRDUP(key);
+	CRZ_STATS_ADD(hash, allocations, 1);
+	selfp->ptr[index] = pair;
+	return pair;
+}
+
 void crzhash_clone(Crzhash_AnyHashTable self, Crzhash_AnyHashTable *other,
 		   CRZ_SIZE pair_size)
 {
@@ -219,17 +441,34 @@ void crzhash_clone(Crzhash_AnyHashTable self, Crzhash_AnyHashTable *other,
 
 void *crzhash_get(Crzhash_AnyHashTable *selfp, CRZ_STRING key)
 {
-	CRZ_SIZE index = crzhash_djb2(key) % selfp->size;
+	CRZ_SIZE hash = crzhash_key_hash(selfp->icase, key);
+	return crzhash_get_from(selfp, key, hash % selfp->size);
+}
+
+void *crzhash_get_from(Crzhash_AnyHashTable *selfp, CRZ_STRING key,
+		       CRZ_SIZE index)
+{
 	CRZ_BOOL wrapped = CRZ_FALSE;
 	CRZ_SIZE original = index;
 
 	while (CRZ_TRUE) {
 		Crzhash_AnyHashPair *existing = selfp->ptr[index];
 
-		if (existing != CRZ_NULL && CRZ_STRING_EQ(existing->key, key)) {
+		// Removing pairs shifts back the ones after them,
+		// so no key is past an empty index
+		if (existing == CRZ_NULL) {
+			CRZ_STATS_PROBE(hash, (index + selfp->size - original) %
+						      selfp->size);
+			return CRZ_NULL;
+		}
+
+		if (crzhash_key_eq(selfp->icase, existing->key, key)) {
+			CRZ_STATS_PROBE(hash, (index + selfp->size - original) %
+						      selfp->size);
 			return existing;
 		}
 
+		CRZ_STATS_ADD(hash, collisions, 1);
 		index += 1;
 
 		if (index >= selfp->size && !wrapped) {
@@ -239,9 +478,190 @@ void *crzhash_get(Crzhash_AnyHashTable *selfp, CRZ_STRING key)
 		}
 
 		if (index >= original && wrapped) {
+			CRZ_STATS_PROBE(hash, selfp->size);
 			return CRZ_NULL;
 		}
 	}
 }
 
+void crzhash_get_batch(Crzhash_AnyHashTable *selfp, CRZ_STRING *keys,
+		       CRZ_SIZE count, void **results)
+{
+	CRZ_SIZE indexes[CRZHASH_BATCH_SIZE];
+
+	for (CRZ_SIZE start = 0; start < count; start += CRZHASH_BATCH_SIZE) {
+		CRZ_SIZE batch = count - start < CRZHASH_BATCH_SIZE ?
+					 count - start :
+					 CRZHASH_BATCH_SIZE;
+
+		for (CRZ_SIZE i = 0; i < batch; i++) {
+			CRZ_SIZE hash =
+				crzhash_key_hash(selfp->icase, keys[start + i]);
+			indexes[i] = hash % selfp->size;
+			CRZ_PREFETCH(&selfp->ptr[indexes[i]]);
+		}
+
+		for (CRZ_SIZE i = 0; i < batch; i++) {
+			Crzhash_AnyHashPair *existing =
+				selfp->ptr[indexes[i]];
+			if (existing)
+				CRZ_PREFETCH(existing);
+		}
+
+		for (CRZ_SIZE i = 0; i < batch; i++) {
+			Crzhash_AnyHashPair *existing =
+				selfp->ptr[indexes[i]];
+			if (existing)
+				CRZ_PREFETCH(existing->key);
+		}
+
+		for (CRZ_SIZE i = 0; i < batch; i++) {
+			results[start + i] = crzhash_get_from(
+				selfp, keys[start + i], indexes[i]);
+		}
+	}
+}
+
+CRZ_BOOL crzhash_remove(Crzhash_AnyHashTable *selfp, CRZ_STRING key)
+{
+	if (selfp->size == 0)
+		return CRZ_FALSE;
+
+	CRZ_SIZE index = crzhash_key_hash(selfp->icase, key) % selfp->size;
+	for (CRZ_SIZE probes = 0;; probes++) {
+		Crzhash_AnyHashPair *existing = selfp->ptr[index];
+		if (existing == CRZ_NULL || probes == selfp->size)
+			return CRZ_FALSE;
+		if (crzhash_key_eq(selfp->icase, existing->key, key)) {
+			CRZ_FREE(existing->key);
+			CRZ_FREE(existing);
+			break;
+		}
+		index = (index + 1) % selfp->size;
+	}
+
+	// Shift back each following pair of the cluster whose ideal index is
+	// not between the hole and itself, so no key is past an empty index
+	CRZ_SIZE hole = index;
+	for (CRZ_SIZE next = (index + 1) % selfp->size; next != index;
+	     next = (next + 1) % selfp->size) {
+		Crzhash_AnyHashPair *existing = selfp->ptr[next];
+		if (existing == CRZ_NULL)
+			break;
+		CRZ_SIZE ideal = crzhash_key_hash(selfp->icase, existing->key) %
+				 selfp->size;
+		CRZ_SIZE distance = (next + selfp->size - ideal) % selfp->size;
+		if (distance >= (next + selfp->size - hole) % selfp->size) {
+			selfp->ptr[hole] = existing;
+			hole = next;
+		}
+	}
+	selfp->ptr[hole] = CRZ_NULL;
+	return CRZ_TRUE;
+}
+
+void crzhash_resize(Crzhash_AnyHashTable *selfp, CRZ_SIZE new_size,
+		    CRZ_SIZE pair_size)
+{
+	CRZ_STATS_ADD(hash, resizes, 1);
+	CRZ_STATS_ADD(hash, bytes_copied, selfp->size * sizeof(*selfp->ptr));
+
+	Crzhash_AnyHashTable new = HASH_TABLE_NEW();
+	crzhash_init(&new, new_size, pair_size, selfp->icase);
+	crzhash_clone(*selfp, &new, pair_size);
+
+	// Free pointer itself, but not the pairs
+	// since they've been copied over to the new table
+	CRZ_FREE((selfp)->ptr);
+	(*selfp) = new;
+}
+
+CRZ_SIZE crzhash_size_for(CRZ_SIZE amount_pairs)
+{
+	CRZ_SIZE size =
+		(amount_pairs * 100 + CRZHASH_TARGET_LOAD_PERCENT - 1) /
+		CRZHASH_TARGET_LOAD_PERCENT;
+	return size > amount_pairs ? size : amount_pairs + 1;
+}
+
+HashTableStats crzhash_stats(Crzhash_AnyHashTable *selfp)
+{
+	HashTableStats stats = { 0 };
+	stats.size = selfp->size;
+	if (selfp->size == 0)
+		return stats;
+
+	CRZ_SIZE total_probe_length = 0;
+	// Start counting clusters right after an empty index,
+	// so that no cluster is split by wrapping around
+	CRZ_SIZE start = 0;
+	while (start < selfp->size && selfp->ptr[start] != CRZ_NULL)
+		start++;
+	CRZ_SIZE cluster_size = 0;
+
+	for (CRZ_SIZE i = 1; i <= selfp->size; i++) {
+		CRZ_SIZE index = (start + i) % selfp->size;
+		Crzhash_AnyHashPair *existing = selfp->ptr[index];
+
+		if (existing == CRZ_NULL) {
+			if (cluster_size > 0)
+				stats.cluster_count += 1;
+			cluster_size = 0;
+			continue;
+		}
+
+		CRZ_SIZE ideal = crzhash_key_hash(selfp->icase, existing->key) %
+				 selfp->size;
+		CRZ_SIZE probe_length =
+			(index + selfp->size - ideal) % selfp->size;
+		total_probe_length += probe_length;
+		if (probe_length > stats.max_probe_length)
+			stats.max_probe_length = probe_length;
+
+		stats.count += 1;
+		cluster_size += 1;
+		if (cluster_size > stats.max_cluster_size)
+			stats.max_cluster_size = cluster_size;
+	}
+	// Only happens when the table is completely full
+	if (cluster_size > 0)
+		stats.cluster_count += 1;
+
+	stats.load_factor = (double)stats.count / (double)stats.size;
+	if (stats.count > 0) {
+		stats.average_probe_length =
+			(double)total_probe_length / (double)stats.count;
+		stats.average_cluster_size =
+			(double)stats.count / (double)stats.cluster_count;
+	}
+	return stats;
+}
+
+void crzhash_reserve(Crzhash_AnyHashTable *selfp, CRZ_SIZE amount_pairs,
+		     CRZ_SIZE pair_size)
+{
+	CRZ_SIZE needed = crzhash_size_for(amount_pairs);
+
+	if (selfp->ptr == CRZ_NULL)
+		crzhash_init(selfp, needed, pair_size, selfp->icase);
+	else if (selfp->size < needed)
+		crzhash_resize(selfp, needed, pair_size);
+}
+
+void crzhash_shrink(Crzhash_AnyHashTable *selfp, CRZ_SIZE pair_size)
+{
+	if (selfp->ptr == CRZ_NULL)
+		return;
+
+	CRZ_SIZE count = 0;
+	for (CRZ_SIZE i = 0; i < selfp->size; i++) {
+		if (selfp->ptr[i] != CRZ_NULL)
+			count++;
+	}
+
+	CRZ_SIZE needed = crzhash_size_for(count);
+	if (needed < selfp->size)
+		crzhash_resize(selfp, needed, pair_size);
+}
+
 #endif // CRZHASH_H_
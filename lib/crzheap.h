@@ -0,0 +1,176 @@
+#ifndef CRZHEAP_H_
+#define CRZHEAP_H_
+
+#include "crzarr.h"
+#include "crzdef.h"
+
+/// The amount of children of each element in the heaps used by the `DARY_HEAP_*` macros.
+///
+/// A higher arity makes the heap shallower, and keeps the children of each element in the same cache line, at the cost of more comparisons per level.
+#ifndef CRZHEAP_ARITY
+#define CRZHEAP_ARITY 4
+#endif // CRZHEAP_ARITY
+
+/// Get the element which would be popped next from the heap `self`, without removing it.
+#define HEAP_PEEK(self) ARRAY_GET(self, 0)
+
+/// Push the element `element` into the binary heap `selfp` (passed by pointer), ordered by `LESS`.
+///
+/// A heap is a dynamic array, `ARRAY(T)`, ordered such that no element is `LESS` than its parent.
+/// `LESS` is the name of a function-like macro (or function), where `LESS(a, b)` is whether the element `a` should be popped before the element `b`.
+/// Since it is expanded in place, the comparison is inlined into each operation.
+/// For example, `#define LESS(a, b) ((a) < (b))` makes a min-heap.
+///
+/// Elements are moved into place with plain assignments, holding the one being sifted in the slot past the end of the array, so the array keeps room for one more element than it holds.
+/// `element` is evaluated once.
+#define HEAP_PUSH(selfp, element, LESS) \
+	CRZHEAP_PUSH(selfp, element, LESS, 2)
+
+/// Remove the element which would be popped next from the binary heap `selfp` (passed by pointer), ordered by `LESS`, and store it in `outp` (passed by pointer).
+///
+/// Asserts that the heap is not empty.
+#define HEAP_POP(selfp, outp, LESS) CRZHEAP_POP(selfp, outp, LESS, 2)
+
+/// Reorder the elements of the dynamic array `selfp` (passed by pointer) into a binary heap, ordered by `LESS`, in O(n).
+#define HEAPIFY(selfp, LESS) CRZHEAP_HEAPIFY(selfp, LESS, 2)
+
+/// Push the element `element` into the binary heap `selfp` (passed by pointer), ordered by `LESS`, keeping at most `k` elements.
+///
+/// Once the heap holds `k` elements, `element` replaces the next element to be popped, only if that element is `LESS` than `element`.
+/// The heap therefore holds the `k` elements which would be popped last, so a min-heap keeps the `k` largest elements pushed into it.
+/// `element` is evaluated once, but `k` may be evaluated more than once.
+#define HEAP_PUSH_BOUNDED(selfp, element, k, LESS) \
+	CRZHEAP_PUSH_BOUNDED(selfp, element, k, LESS, 2)
+
+/// Push the element `element` into the `CRZHEAP_ARITY`-ary heap `selfp` (passed by pointer), ordered by `LESS`.
+#define DARY_HEAP_PUSH(selfp, element, LESS) \
+	CRZHEAP_PUSH(selfp, element, LESS, CRZHEAP_ARITY)
+
+/// Remove the element which would be popped next from the `CRZHEAP_ARITY`-ary heap `selfp` (passed by pointer), ordered by `LESS`, and store it in `outp` (passed by pointer).
+///
+/// Asserts that the heap is not empty.
+#define DARY_HEAP_POP(selfp, outp, LESS) \
+	CRZHEAP_POP(selfp, outp, LESS, CRZHEAP_ARITY)
+
+/// Reorder the elements of the dynamic array `selfp` (passed by pointer) into a `CRZHEAP_ARITY`-ary heap, ordered by `LESS`, in O(n).
+#define DARY_HEAPIFY(selfp, LESS) CRZHEAP_HEAPIFY(selfp, LESS, CRZHEAP_ARITY)
+
+/// Push the element `element` into the `CRZHEAP_ARITY`-ary heap `selfp` (passed by pointer), ordered by `LESS`, keeping at most `k` elements.
+///
+/// See `HEAP_PUSH_BOUNDED`.
+#define DARY_HEAP_PUSH_BOUNDED(selfp, element, k, LESS) \
+	CRZHEAP_PUSH_BOUNDED(selfp, element, k, LESS, CRZHEAP_ARITY)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Reserve room for `extra` elements past the end of the heap `selfp`, the last of which the sifting macros use as scratch.
+#define CRZHEAP_RESERVE_SCRATCH(selfp, extra)                         \
+	do {                                                          \
+		if ((selfp)->cap < (selfp)->len + (extra))            \
+			crzarr_grow_to((Crzarr_AnyArray *)(selfp),    \
+				       (selfp)->len + (extra),        \
+				       ARRAY_ELEMENT_SIZE(*(selfp))); \
+	} while (0)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HEAP_PUSH(selfp, element, LESS)` instead.
+#define CRZHEAP_PUSH(selfp, element, LESS, arity)              \
+	do {                                                   \
+		CRZHEAP_RESERVE_SCRATCH(selfp, 2);             \
+		(selfp)->ptr[(selfp)->len + 1] = (element);    \
+		(selfp)->len += 1;                             \
+		CRZHEAP_SIFT_UP(selfp, (selfp)->len - 1, LESS, \
+				arity);                        \
+	} while (0)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HEAP_POP(selfp, outp, LESS)` instead.
+#define CRZHEAP_POP(selfp, outp, LESS, arity)                                 \
+	do {                                                                  \
+		CRZ_ASSERT((selfp)->len > 0 && "Popping from an empty heap"); \
+		*(outp) = (selfp)->ptr[0];                                    \
+		(selfp)->len -= 1;                                            \
+		if ((selfp)->len > 0)                                         \
+			CRZHEAP_SIFT_DOWN(selfp, 0, LESS, arity);             \
+	} while (0)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HEAPIFY(selfp, LESS)` instead.
+#define CRZHEAP_HEAPIFY(selfp, LESS, arity)                                    \
+	do {                                                                   \
+		if ((selfp)->len > 1) {                                        \
+			CRZHEAP_RESERVE_SCRATCH(selfp, 1);                     \
+			for (CRZ_SIZE crz__start = (selfp)->len / (arity) + 1; \
+			     crz__start-- > 0;) {                              \
+				(selfp)->ptr[(selfp)->len] =                   \
+					(selfp)->ptr[crz__start];              \
+				CRZHEAP_SIFT_DOWN(selfp, crz__start, LESS,     \
+						  arity);                      \
+			}                                                      \
+		}                                                              \
+	} while (0)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HEAP_PUSH_BOUNDED(selfp, element, k, LESS)` instead.
+#define CRZHEAP_PUSH_BOUNDED(selfp, element, k, LESS, arity)              \
+	do {                                                              \
+		CRZHEAP_RESERVE_SCRATCH(selfp, 2);                        \
+		(selfp)->ptr[(selfp)->len] = (element);                   \
+		if ((selfp)->len < (k)) {                                 \
+			(selfp)->ptr[(selfp)->len + 1] =                  \
+				(selfp)->ptr[(selfp)->len];               \
+			(selfp)->len += 1;                                \
+			CRZHEAP_SIFT_UP(selfp, (selfp)->len - 1, LESS,    \
+					arity);                           \
+		} else if ((k) > 0 && LESS((selfp)->ptr[0],               \
+					   (selfp)->ptr[(selfp)->len])) { \
+			CRZHEAP_SIFT_DOWN(selfp, 0, LESS, arity);         \
+		}                                                         \
+	} while (0)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Fill the hole at `start` of the heap `selfp` with the element at `ptr[len]`, moving its parents down into it while they are not `LESS` than the element.
+#define CRZHEAP_SIFT_UP(selfp, start, LESS, arity)                        \
+	do {                                                              \
+		CRZ_SIZE crz__hole = (start);                             \
+		while (crz__hole > 0) {                                   \
+			CRZ_SIZE crz__parent = (crz__hole - 1) / (arity); \
+			if (!LESS((selfp)->ptr[(selfp)->len],             \
+				  (selfp)->ptr[crz__parent]))             \
+				break;                                    \
+			(selfp)->ptr[crz__hole] =                         \
+				(selfp)->ptr[crz__parent];                \
+			crz__hole = crz__parent;                          \
+		}                                                         \
+		(selfp)->ptr[crz__hole] = (selfp)->ptr[(selfp)->len];     \
+	} while (0)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Fill the hole at `start` of the heap `selfp` with the element at `ptr[len]`, moving its children up into it while any of them is `LESS` than the element.
+#define CRZHEAP_SIFT_DOWN(selfp, start, LESS, arity)                   \
+	do {                                                           \
+		CRZ_SIZE crz__hole = (start);                          \
+		while (CRZ_TRUE) {                                     \
+			CRZ_SIZE crz__first = crz__hole * (arity) + 1; \
+			if (crz__first >= (selfp)->len)                \
+				break;                                 \
+			CRZ_SIZE crz__end = crz__first + (arity);      \
+			if (crz__end > (selfp)->len)                   \
+				crz__end = (selfp)->len;               \
+			CRZ_SIZE crz__best = crz__first;               \
+			for (CRZ_SIZE crz__child = crz__first + 1;     \
+			     crz__child < crz__end; crz__child++) {    \
+				if (LESS((selfp)->ptr[crz__child],     \
+					 (selfp)->ptr[crz__best]))     \
+					crz__best = crz__child;        \
+			}                                              \
+			if (!LESS((selfp)->ptr[crz__best],             \
+				  (selfp)->ptr[(selfp)->len]))         \
+				break;                                 \
+			(selfp)->ptr[crz__hole] =                      \
+				(selfp)->ptr[crz__best];               \
+			crz__hole = crz__best;                         \
+		}                                                      \
+		(selfp)->ptr[crz__hole] = (selfp)->ptr[(selfp)->len];  \
+	} while (0)
+
+#endif // CRZHEAP_H_
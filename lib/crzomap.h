@@ -0,0 +1,269 @@
+#ifndef CRZOMAP_H_
+#define CRZOMAP_H_
+
+#include "crzarr.h"
+#include "crzdef.h"
+#include "crzhash.h"
+
+/// The integer type stored in the index of an ordered hash table.
+/// Its largest value is reserved to mark empty slots, so a table can hold one pair less than that.
+#ifndef CRZOMAP_INDEX
+#include <stdint.h>
+#define CRZOMAP_INDEX uint32_t
+#endif // CRZOMAP_INDEX
+
+/// INTERNAL: the value marking an empty slot in the index of an ordered hash table.
+#define CRZOMAP_EMPTY ((CRZOMAP_INDEX)-1)
+
+/// Define a struct for a key-value pair stored in an ordered hash table, with value of type `T`.
+///
+/// Unlike `HASH_PAIR(T)`, the pair also stores the hash of its key, so that the table can be re-indexed without hashing any keys.
+#define ORDERED_PAIR(T)         \
+	struct {                \
+		CRZ_SIZE hash;  \
+		CRZ_STRING key; \
+		T value;        \
+	}
+
+/// Define a struct for an ordered hash table with values of type `T`.
+///
+/// The pairs are stored in `pairs`, a dynamic array, in the order they were first inserted.
+/// The hash index only stores indexes into `pairs`, so iterating over the table is a linear sweep over `pairs`.
+/// `icase` is whether the table ignores the case of ASCII letters in its keys, as set by `ORDERED_TABLE_NEW_ICASE`.
+#define ORDERED_TABLE(T)                      \
+	struct {                              \
+		ARRAY(ORDERED_PAIR(T)) pairs; \
+		CRZOMAP_INDEX *index;         \
+		CRZ_SIZE size;                \
+		CRZ_BOOL icase;               \
+	}
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ORDERED_PAIR(T)` instead.
+typedef ORDERED_PAIR(char) Crzomap_AnyOrderedPair;
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ORDERED_TABLE(T)` instead.
+typedef struct {
+	Crzarr_AnyArray pairs;
+	CRZOMAP_INDEX *index;
+	CRZ_SIZE size;
+	CRZ_BOOL icase;
+} Crzomap_AnyOrderedTable;
+
+/// Get the size in bytes of each key-value pair of the ordered hash table `self`.
+#define ORDERED_TABLE_PAIR_SIZE(self) ARRAY_ELEMENT_SIZE((self).pairs)
+
+/// Zero-initialize an ordered hash table.
+///
+/// The table is initialized on its first insertion, so calling `ORDERED_TABLE_INIT` afterwards is not required.
+#define ORDERED_TABLE_NEW()                                         \
+	{                                                           \
+		.pairs = ARRAY_NEW(), .index = CRZ_NULL, .size = 0, \
+		.icase = CRZ_FALSE                                  \
+	}
+
+/// Zero-initialize an ordered hash table which ignores the case of ASCII letters in its keys, as `HASH_TABLE_INIT_ICASE` does for hash tables.
+///
+/// As for `ORDERED_TABLE_NEW`, the table is initialized on its first insertion, and keeps ignoring case.
+#define ORDERED_TABLE_NEW_ICASE()                                   \
+	{                                                           \
+		.pairs = ARRAY_NEW(), .index = CRZ_NULL, .size = 0, \
+		.icase = CRZ_TRUE                                   \
+	}
+
+/// Properly initialize an ordered hash table.
+///
+/// Gives the index of the table an initial size of `initial_size` slots.
+/// The index is grown whenever the table is loaded past `CRZHASH_TARGET_LOAD_PERCENT`.
+#define ORDERED_TABLE_INIT(selfp, initial_size)                          \
+	crzomap_init((Crzomap_AnyOrderedTable *)(selfp), (initial_size), \
+		     CRZ_FALSE)
+
+/// Properly initialize an ordered hash table which ignores the case of ASCII letters in its keys.
+///
+/// Otherwise, this is the same as `ORDERED_TABLE_INIT`.
+#define ORDERED_TABLE_INIT_ICASE(selfp, initial_size)                    \
+	crzomap_init((Crzomap_AnyOrderedTable *)(selfp), (initial_size), \
+		     CRZ_TRUE)
+
+/// Insert the value `insert_value` at the key `insert_key` for the ordered hash table `selfp` (passed by pointer).
+///
+/// If the key does not exist in the table, appends a new pair for it.
+/// The inserted key is a duplicate of `insert_key` (made using `CRZ_STRDUP`), so `insert_key` itself may be freed independently of the table.
+///
+/// If the key already exists in the table, overrides the existing value, and keeps the pair in its original position.
+#define ORDERED_TABLE_INSERT(selfp, insert_key, insert_value)             \
+	do {                                                              \
+		CRZ_SIZE crz__index = crzomap_insert_index(               \
+			(Crzomap_AnyOrderedTable *)(selfp), (insert_key), \
+			ORDERED_TABLE_PAIR_SIZE(*(selfp)));               \
+		(selfp)->pairs.ptr[crz__index].value = (insert_value);    \
+	} while (0)
+
+/// Get a pointer to the pair with key `get_key` in the ordered hash table `self`.
+///
+/// If the key does not exist in the table, returns `CRZ_NULL`.
+#define ORDERED_TABLE_GET(self, get_key)                             \
+	crzomap_get((Crzomap_AnyOrderedTable *)(&(self)), (get_key), \
+		    ORDERED_TABLE_PAIR_SIZE(self))
+
+/// Iterate over the pairs of the ordered hash table `self` in insertion order, naming the index variable `index`.
+///
+/// Every index has a pair associated with it, which is `self.pairs.ptr[index]`.
+#define ORDERED_TABLE_FOR(self, index) ARRAY_FOR((self).pairs, index)
+
+/// Print out the key-value pairs of the ordered hash table `self` in insertion order. `fmt` is the format specifier for the value type, as for `printf`.
+#define ORDERED_TABLE_DEBUG(self, fmt)                                 \
+	do {                                                           \
+		CRZ_DEBUG("{");                                        \
+		ORDERED_TABLE_FOR(self, crz__index) {                  \
+			CRZ_DEBUG(" \"%s\" = " fmt ";",                \
+				  (self).pairs.ptr[crz__index].key,    \
+				  (self).pairs.ptr[crz__index].value); \
+		}                                                      \
+		CRZ_DEBUG(" }\n");                                     \
+	} while (0)
+
+/// Free the space allocated for:
+///   - the (duplicated) keys of each of the table's pairs
+///   - the array of pairs
+///   - the index
+/// for the ordered hash table `selfp` (passed by pointer), and empty-out the fields of the struct.
+///
+/// This **does not** free any of the values for the table's pairs - if they are dynamically allocated, you must do this yourself before calling `ORDERED_TABLE_FREE`.
+#define ORDERED_TABLE_FREE(selfp)                                     \
+	do {                                                          \
+		ORDERED_TABLE_FOR(*(selfp), crz__index) {             \
+			CRZ_FREE((selfp)->pairs.ptr[crz__index].key); \
+		}                                                     \
+		ARRAY_FREE(&(selfp)->pairs);                          \
+		CRZ_FREE((selfp)->index);                             \
+		(selfp)->index = CRZ_NULL;                            \
+		(selfp)->size = 0;                                    \
+	} while (0)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ORDERED_TABLE_INIT(selfp, initial_size)` instead.
+void crzomap_init(Crzomap_AnyOrderedTable *selfp, CRZ_SIZE initial_size,
+		  CRZ_BOOL icase);
+
+/// INTERNAL: this function rebuilds the index of an ordered hash table at size `new_size`, using the hashes stored in its pairs.
+void crzomap_reindex(Crzomap_AnyOrderedTable *selfp, CRZ_SIZE new_size,
+		     CRZ_SIZE pair_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ORDERED_TABLE_INSERT(selfp, insert_key, insert_value)` instead.
+CRZ_SIZE crzomap_insert_index(Crzomap_AnyOrderedTable *selfp, CRZ_STRING key,
+			      CRZ_SIZE pair_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `ORDERED_TABLE_GET(self, key)` instead.
+void *crzomap_get(Crzomap_AnyOrderedTable *selfp, CRZ_STRING key,
+		  CRZ_SIZE pair_size);
+
+void crzomap_init(Crzomap_AnyOrderedTable *selfp, CRZ_SIZE initial_size,
+		  CRZ_BOOL icase)
+{
+	ARRAY_INIT(&selfp->pairs);
+	if (initial_size == 0)
+		initial_size = 1;
+	selfp->size = initial_size;
+	selfp->icase = icase;
+	selfp->index = CRZ_MALLOC(sizeof(*selfp->index) * initial_size);
+	CRZ_ASSERT(selfp->index &&
+		   "Out of memory when allocating ordered hash table");
+	for (CRZ_SIZE i = 0; i < initial_size; i++)
+		selfp->index[i] = CRZOMAP_EMPTY;
+}
+
+void crzomap_reindex(Crzomap_AnyOrderedTable *selfp, CRZ_SIZE new_size,
+		     CRZ_SIZE pair_size)
+{
+	CRZ_STATS_ADD(hash, resizes, 1);
+
+	CRZ_FREE(selfp->index);
+	selfp->size = new_size;
+	selfp->index = CRZ_MALLOC(sizeof(*selfp->index) * new_size);
+	CRZ_ASSERT(selfp->index &&
+		   "Out of memory when allocating ordered hash table");
+	for (CRZ_SIZE i = 0; i < new_size; i++)
+		selfp->index[i] = CRZOMAP_EMPTY;
+
+	char *pairs = selfp->pairs.ptr;
+	for (CRZ_SIZE i = 0; i < selfp->pairs.len; i++) {
+		Crzomap_AnyOrderedPair *pair =
+			(Crzomap_AnyOrderedPair *)(pairs + i * pair_size);
+		CRZ_SIZE slot = pair->hash % new_size;
+		while (selfp->index[slot] != CRZOMAP_EMPTY)
+			slot = slot + 1 == new_size ? 0 : slot + 1;
+		selfp->index[slot] = (CRZOMAP_INDEX)i;
+	}
+}
+
+CRZ_SIZE crzomap_insert_index(Crzomap_AnyOrderedTable *selfp, CRZ_STRING key,
+			      CRZ_SIZE pair_size)
+{
+	if (selfp->index == CRZ_NULL)
+		crzomap_init(selfp, CRZARR_MINIMUM_CAPACITY, selfp->icase);
+	if ((selfp->pairs.len + 1) * 100 >
+	    selfp->size * CRZHASH_TARGET_LOAD_PERCENT)
+		crzomap_reindex(selfp, selfp->size * 2, pair_size);
+
+	CRZ_SIZE hash = crzhash_key_hash(selfp->icase, key);
+	CRZ_SIZE slot = hash % selfp->size;
+	char *pairs = selfp->pairs.ptr;
+
+	while (selfp->index[slot] != CRZOMAP_EMPTY) {
+		CRZ_SIZE i = selfp->index[slot];
+		Crzomap_AnyOrderedPair *pair =
+			(Crzomap_AnyOrderedPair *)(pairs + i * pair_size);
+		if (pair->hash == hash &&
+		    crzhash_key_eq(selfp->icase, pair->key, key))
+			return i;
+
+		CRZ_STATS_ADD(hash, collisions, 1);
+		slot = slot + 1 == selfp->size ? 0 : slot + 1;
+	}
+
+	CRZ_SIZE i = selfp->pairs.len;
+	CRZ_ASSERT(i < CRZOMAP_EMPTY &&
+		   "Too many pairs for ordered hash table");
+	crzarr_grow_to(&selfp->pairs, i + 1, pair_size);
+	selfp->pairs.len += 1;
+	selfp->index[slot] = (CRZOMAP_INDEX)i;
+
+	Crzomap_AnyOrderedPair *pair =
+		(Crzomap_AnyOrderedPair *)((char *)selfp->pairs.ptr +
+					   i * pair_size);
+	pair->hash = hash;
+	pair->key = CRZ_STRDUP(key);
+	return i;
+}
+
+void *crzomap_get(Crzomap_AnyOrderedTable *selfp, CRZ_STRING key,
+		  CRZ_SIZE pair_size)
+{
+	if (selfp->index == CRZ_NULL)
+		return CRZ_NULL;
+
+	CRZ_SIZE hash = crzhash_key_hash(selfp->icase, key);
+	CRZ_SIZE slot = hash % selfp->size;
+	char *pairs = selfp->pairs.ptr;
+
+	while (selfp->index[slot] != CRZOMAP_EMPTY) {
+		CRZ_SIZE i = selfp->index[slot];
+		Crzomap_AnyOrderedPair *pair =
+			(Crzomap_AnyOrderedPair *)(pairs + i * pair_size);
+		if (pair->hash == hash &&
+		    crzhash_key_eq(selfp->icase, pair->key, key))
+			return pair;
+
+		CRZ_STATS_ADD(hash, collisions, 1);
+		slot = slot + 1 == selfp->size ? 0 : slot + 1;
+	}
+
+	return CRZ_NULL;
+}
+
+#endif // CRZOMAP_H_
@@ -0,0 +1,699 @@
+#ifndef CRZPACK_H_
+#define CRZPACK_H_
+
+#include "crzarr.h"
+#include "crzdef.h"
+#include "crzsb.h"
+#include "crzsv.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSSE3__) && !defined(CRZPACK_NO_SIMD)
+#include <tmmintrin.h>
+#define CRZPACK_SSSE3
+#endif
+
+/// The amount of values in each block of `PACK_FOR`, which all share a base and a bit width.
+#define CRZPACK_BLOCK 128
+
+/// The format of a packed array, written as its first byte so that unpacking it as another format fails.
+///
+/// Every format then has the amount of values as a LEB128 varint, followed by:
+///   - `PACK_VARINT`: each value as a LEB128 varint
+///   - `PACK_ZIGZAG`: each signed value as a LEB128 varint of its zigzag encoding, so that small negative values stay small
+///   - `PACK_DELTA`: each value as a LEB128 varint of its difference from the previous one, wrapping around, so sorted values stay small
+///   - `PACK_FOR`: blocks of `CRZPACK_BLOCK` values, each as a LEB128 varint of its smallest value, a byte of the bit width of the differences from it, and those differences bit-packed into 64-bit little-endian words
+///   - `PACK_STREAMVBYTE`: a byte for every 4 32-bit values, holding 2 bits of each one's byte length minus 1, followed by each value's little-endian bytes
+///   - `PACK_STREAMVBYTE_DELTA`: as `PACK_STREAMVBYTE`, of each value's wrapping difference from the previous one
+typedef enum {
+	PACK_VARINT = 1,
+	PACK_ZIGZAG,
+	PACK_DELTA,
+	PACK_FOR,
+	PACK_STREAMVBYTE,
+	PACK_STREAMVBYTE_DELTA,
+} PackFormat;
+
+/// An iterator decoding a packed array of any format one value at a time, without allocating.
+typedef struct {
+	PackFormat format;
+	const unsigned char *ptr;
+	const unsigned char *end;
+	CRZ_SIZE remaining;
+	CRZ_SIZE index;
+	uint64_t previous;
+	/// For `PACK_FOR`, the current block, as its base, bit width and packed words.
+	uint64_t base;
+	CRZ_SIZE bits;
+	const unsigned char *words;
+	/// For Stream VByte formats, the control bytes.
+	const unsigned char *controls;
+} PackIter;
+
+/// Append the `ARRAY(uint64_t)` `array` to the string builder `sbp` (passed by pointer) as `PACK_VARINT`.
+#define PACK_VARINTS(sbp, array) \
+	crzpack_varints((sbp), (array).ptr, (array).len, PACK_VARINT)
+
+/// Append the `ARRAY(int64_t)` `array` to the string builder `sbp` (passed by pointer) as `PACK_ZIGZAG`.
+#define PACK_ZIGZAGS(sbp, array) \
+	crzpack_zigzags((sbp), (array).ptr, (array).len)
+
+/// Append the `ARRAY(uint64_t)` `array` to the string builder `sbp` (passed by pointer) as `PACK_DELTA`.
+///
+/// Any values may be packed, but sorted ones with small gaps pack the smallest.
+#define PACK_DELTAS(sbp, array) \
+	crzpack_varints((sbp), (array).ptr, (array).len, PACK_DELTA)
+
+/// Append the `ARRAY(uint64_t)` `array` to the string builder `sbp` (passed by pointer) as `PACK_FOR`.
+///
+/// This packs values which are close to each other within each block, such as IDs from a narrow range, without needing them sorted.
+#define PACK_FOR(sbp, array) crzpack_for((sbp), (array).ptr, (array).len)
+
+/// Append the `ARRAY(uint32_t)` `array` to the string builder `sbp` (passed by pointer) as `PACK_STREAMVBYTE`.
+///
+/// This packs slightly larger than `PACK_VARINT`, but unpacks 4 values at a time using SSSE3 where available.
+/// SSSE3 must be enabled when compiling, such as with `-mssse3`, since the default flags only enable SSE2, and defining `CRZPACK_NO_SIMD` forces the scalar decoder.
+#define PACK_STREAMVBYTE(sbp, array) \
+	crzpack_streamvbyte((sbp), (array).ptr, (array).len, CRZ_FALSE)
+
+/// Append the `ARRAY(uint32_t)` `array` to the string builder `sbp` (passed by pointer) as `PACK_STREAMVBYTE_DELTA`.
+#define PACK_STREAMVBYTE_DELTAS(sbp, array) \
+	crzpack_streamvbyte((sbp), (array).ptr, (array).len, CRZ_TRUE)
+
+/// Append the values packed as `PACK_VARINT` in the `StringView` `packed` to the `ARRAY(uint64_t)` `arrayp` (passed by pointer).
+///
+/// Returns whether `packed` was a complete array of that format, otherwise `arrayp` may have some of the values appended.
+/// The array is grown only once, to fit all of the values.
+#define UNPACK_VARINTS(packed, arrayp)                                \
+	crzpack_unpack_varints((packed), (Crzarr_AnyArray *)(arrayp), \
+			       PACK_VARINT)
+
+/// Append the values packed as `PACK_ZIGZAG` in the `StringView` `packed` to the `ARRAY(int64_t)` `arrayp` (passed by pointer), as for `UNPACK_VARINTS`.
+#define UNPACK_ZIGZAGS(packed, arrayp)                                \
+	crzpack_unpack_varints((packed), (Crzarr_AnyArray *)(arrayp), \
+			       PACK_ZIGZAG)
+
+/// Append the values packed as `PACK_DELTA` in the `StringView` `packed` to the `ARRAY(uint64_t)` `arrayp` (passed by pointer), as for `UNPACK_VARINTS`.
+#define UNPACK_DELTAS(packed, arrayp)                                 \
+	crzpack_unpack_varints((packed), (Crzarr_AnyArray *)(arrayp), \
+			       PACK_DELTA)
+
+/// Append the values packed as `PACK_FOR` in the `StringView` `packed` to the `ARRAY(uint64_t)` `arrayp` (passed by pointer), as for `UNPACK_VARINTS`.
+#define UNPACK_FOR(packed, arrayp) \
+	crzpack_unpack_for((packed), (Crzarr_AnyArray *)(arrayp))
+
+/// Append the values packed as `PACK_STREAMVBYTE` in the `StringView` `packed` to the `ARRAY(uint32_t)` `arrayp` (passed by pointer), as for `UNPACK_VARINTS`.
+#define UNPACK_STREAMVBYTE(packed, arrayp)                                \
+	crzpack_unpack_streamvbyte((packed), (Crzarr_AnyArray *)(arrayp), \
+				   CRZ_FALSE)
+
+/// Append the values packed as `PACK_STREAMVBYTE_DELTA` in the `StringView` `packed` to the `ARRAY(uint32_t)` `arrayp` (passed by pointer), as for `UNPACK_VARINTS`.
+#define UNPACK_STREAMVBYTE_DELTAS(packed, arrayp)                         \
+	crzpack_unpack_streamvbyte((packed), (Crzarr_AnyArray *)(arrayp), \
+				   CRZ_TRUE)
+
+/// Initialize the iterator `iterp` (passed by pointer) over the packed array in the `StringView` `packed`, of any format.
+///
+/// Returns whether `packed` starts like a packed array. `packed` must outlive the iterator.
+#define PACK_ITER_INIT(iterp, packed) crzpack_iter_init((iterp), (packed))
+
+/// Decode the next value of the iterator `iterp` (passed by pointer) into `valuep` (a `uint64_t`, passed by pointer).
+///
+/// Values packed as `PACK_ZIGZAG` must be cast back to `int64_t`.
+/// Returns `CRZ_FALSE` once every value was decoded, or if the packed array is cut short.
+#define PACK_ITER_NEXT(iterp, valuep) crzpack_iter_next((iterp), (valuep))
+
+/// INTERNAL: this is the zigzag encoding of `value`, which interleaves negative and positive values so that small ones of either sign are small.
+uint64_t crzpack_zigzag(int64_t value);
+
+/// INTERNAL: this is the signed value with the zigzag encoding `value`.
+int64_t crzpack_unzigzag(uint64_t value);
+
+/// INTERNAL: this function writes `value` as a LEB128 varint to `out`, which must have room for 10 bytes, returning the amount of bytes written.
+CRZ_SIZE crzpack_put_varint(unsigned char *out, uint64_t value);
+
+/// INTERNAL: this function reads a LEB128 varint from `*ptrp` into `valuep`, advancing `*ptrp` past it.
+///           Returns `CRZ_FALSE` if the varint does not end before `end`, or is longer than 10 bytes.
+CRZ_BOOL crzpack_get_varint(const unsigned char **ptrp,
+			    const unsigned char *end, uint64_t *valuep);
+
+/// INTERNAL: this function reserves room in `sbp` for `max_size` more bytes, and writes the format and amount header of a packed array.
+unsigned char *crzpack_begin(StringBuilder *sbp, PackFormat format,
+			     CRZ_SIZE count, CRZ_SIZE max_size);
+
+/// INTERNAL: this function reads the format and amount header of a packed array from `packed`.
+///           Returns `CRZ_NULL` if it is not there, otherwise a pointer to the rest of the packed array.
+const unsigned char *crzpack_header(StringView packed, PackFormat *formatp,
+				    CRZ_SIZE *countp);
+
+/// INTERNAL: this is the little-endian 64-bit word at `ptr`.
+uint64_t crzpack_load64(const unsigned char *ptr);
+
+/// INTERNAL: this function stores `word` as a little-endian 64-bit word at `ptr`.
+void crzpack_store64(unsigned char *ptr, uint64_t word);
+
+/// INTERNAL: this is the `bits`-bit value at `index` among the packed little-endian 64-bit words at `words`.
+uint64_t crzpack_extract(const unsigned char *words, CRZ_SIZE index,
+			 CRZ_SIZE bits);
+
+/// INTERNAL: this function unpacks the `count` values of `bits` bits each among the packed little-endian 64-bit words at `words` into `out`, adding `base` to each.
+void crzpack_unpack_block(const unsigned char *words, CRZ_SIZE count,
+			 CRZ_SIZE bits, uint64_t base, uint64_t *out);
+
+/// INTERNAL: this is the size in bytes of the packed words of `count` values of `bits` bits each.
+CRZ_SIZE crzpack_words_size(CRZ_SIZE count, CRZ_SIZE bits);
+
+/// INTERNAL: this is the total byte length of the 4 values a Stream VByte control byte `control` describes.
+CRZ_SIZE crzpack_control_length(unsigned char control);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `PACK_VARINTS(sbp, array)` or `PACK_DELTAS(sbp, array)` instead.
+void crzpack_varints(StringBuilder *sbp, const uint64_t *values,
+		     CRZ_SIZE count, PackFormat format);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `PACK_ZIGZAGS(sbp, array)` instead.
+void crzpack_zigzags(StringBuilder *sbp, const int64_t *values,
+		     CRZ_SIZE count);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `PACK_FOR(sbp, array)` instead.
+void crzpack_for(StringBuilder *sbp, const uint64_t *values, CRZ_SIZE count);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `PACK_STREAMVBYTE(sbp, array)` instead.
+void crzpack_streamvbyte(StringBuilder *sbp, const uint32_t *values,
+			 CRZ_SIZE count, CRZ_BOOL delta);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `UNPACK_VARINTS(packed, arrayp)` instead.
+CRZ_BOOL crzpack_unpack_varints(StringView packed, Crzarr_AnyArray *arrayp,
+				PackFormat format);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `UNPACK_FOR(packed, arrayp)` instead.
+CRZ_BOOL crzpack_unpack_for(StringView packed, Crzarr_AnyArray *arrayp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `UNPACK_STREAMVBYTE(packed, arrayp)` instead.
+CRZ_BOOL crzpack_unpack_streamvbyte(StringView packed, Crzarr_AnyArray *arrayp,
+				    CRZ_BOOL delta);
+
+#ifdef CRZPACK_SSSE3
+/// INTERNAL: this function decodes the 4 values described by `control` from `data` into `out` using SSSE3, returning the amount of bytes read.
+///           `data` must have 16 readable bytes.
+CRZ_SIZE crzpack_decode4_ssse3(unsigned char control, const unsigned char *data,
+			       uint32_t *out, CRZ_BOOL delta,
+			       uint32_t *previousp);
+#endif // CRZPACK_SSSE3
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `PACK_ITER_INIT(iterp, packed)` instead.
+CRZ_BOOL crzpack_iter_init(PackIter *iterp, StringView packed);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `PACK_ITER_NEXT(iterp, valuep)` instead.
+CRZ_BOOL crzpack_iter_next(PackIter *iterp, uint64_t *valuep);
+
+/// INTERNAL: this is the `pshufb` mask moving two values of the byte lengths in a Stream VByte control nibble into two 32-bit lanes, where 0x80 zeroes a byte.
+static const uint8_t crzpack_pair_shuffles[16][8] = {
+	{ 0x00, 0x80, 0x80, 0x80, 0x01, 0x80, 0x80, 0x80 },
+	{ 0x00, 0x01, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80 },
+	{ 0x00, 0x01, 0x02, 0x80, 0x03, 0x80, 0x80, 0x80 },
+	{ 0x00, 0x01, 0x02, 0x03, 0x04, 0x80, 0x80, 0x80 },
+	{ 0x00, 0x80, 0x80, 0x80, 0x01, 0x02, 0x80, 0x80 },
+	{ 0x00, 0x01, 0x80, 0x80, 0x02, 0x03, 0x80, 0x80 },
+	{ 0x00, 0x01, 0x02, 0x80, 0x03, 0x04, 0x80, 0x80 },
+	{ 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x80, 0x80 },
+	{ 0x00, 0x80, 0x80, 0x80, 0x01, 0x02, 0x03, 0x80 },
+	{ 0x00, 0x01, 0x80, 0x80, 0x02, 0x03, 0x04, 0x80 },
+	{ 0x00, 0x01, 0x02, 0x80, 0x03, 0x04, 0x05, 0x80 },
+	{ 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x80 },
+	{ 0x00, 0x80, 0x80, 0x80, 0x01, 0x02, 0x03, 0x04 },
+	{ 0x00, 0x01, 0x80, 0x80, 0x02, 0x03, 0x04, 0x05 },
+	{ 0x00, 0x01, 0x02, 0x80, 0x03, 0x04, 0x05, 0x06 },
+	{ 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 },
+};
+
+uint64_t crzpack_zigzag(int64_t value)
+{
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+int64_t crzpack_unzigzag(uint64_t value)
+{
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+CRZ_SIZE crzpack_put_varint(unsigned char *out, uint64_t value)
+{
+	CRZ_SIZE size = 0;
+	while (value >= 0x80) {
+		out[size++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	out[size++] = (unsigned char)value;
+	return size;
+}
+
+CRZ_BOOL crzpack_get_varint(const unsigned char **ptrp,
+			    const unsigned char *end, uint64_t *valuep)
+{
+	const unsigned char *ptr = *ptrp;
+	uint64_t value = 0;
+	for (CRZ_SIZE shift = 0; shift < 70 && ptr < end; shift += 7) {
+		unsigned char byte = *ptr++;
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		if (byte < 0x80) {
+			*ptrp = ptr;
+			*valuep = value;
+			return CRZ_TRUE;
+		}
+	}
+	return CRZ_FALSE;
+}
+
+unsigned char *crzpack_begin(StringBuilder *sbp, PackFormat format,
+			     CRZ_SIZE count, CRZ_SIZE max_size)
+{
+	crzarr_grow_to((Crzarr_AnyArray *)sbp, sbp->len + 11 + max_size, 1);
+	unsigned char *out = (unsigned char *)sbp->ptr + sbp->len;
+	*out++ = (unsigned char)format;
+	out += crzpack_put_varint(out, count);
+	return out;
+}
+
+const unsigned char *crzpack_header(StringView packed, PackFormat *formatp,
+				    CRZ_SIZE *countp)
+{
+	const unsigned char *ptr = (const unsigned char *)packed.ptr;
+	const unsigned char *end = ptr + packed.len;
+	uint64_t count;
+	if (ptr == end)
+		return CRZ_NULL;
+	*formatp = (PackFormat)*ptr++;
+	if (!crzpack_get_varint(&ptr, end, &count))
+		return CRZ_NULL;
+	*countp = (CRZ_SIZE)count;
+	return ptr;
+}
+
+uint64_t crzpack_load64(const unsigned char *ptr)
+{
+	uint64_t word = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	CRZ_MEMCPY(&word, ptr, sizeof(word));
+#else
+	for (int i = 7; i >= 0; i--)
+		word = (word << 8) | ptr[i];
+#endif // __BYTE_ORDER__
+	return word;
+}
+
+void crzpack_store64(unsigned char *ptr, uint64_t word)
+{
+	for (int i = 0; i < 8; i++)
+		ptr[i] = (unsigned char)(word >> (i * 8));
+}
+
+uint64_t crzpack_extract(const unsigned char *words, CRZ_SIZE index,
+			 CRZ_SIZE bits)
+{
+	if (bits == 0)
+		return 0;
+	CRZ_SIZE offset = index * bits;
+	CRZ_SIZE shift = offset % 64;
+	const unsigned char *word = words + offset / 64 * 8;
+	uint64_t value = crzpack_load64(word) >> shift;
+	// `shift` is never 0 here, since `bits` is at most 64
+	if (shift + bits > 64)
+		value |= crzpack_load64(word + 8) << (64 - shift);
+	return bits == 64 ? value : value & ((1ull << bits) - 1);
+}
+
+void crzpack_unpack_block(const unsigned char *words, CRZ_SIZE count,
+			 CRZ_SIZE bits, uint64_t base, uint64_t *out)
+{
+	if (bits == 0) {
+		for (CRZ_SIZE i = 0; i < count; i++)
+			out[i] = base;
+		return;
+	}
+
+	uint64_t mask = bits == 64 ? ~(uint64_t)0 : ((uint64_t)1 << bits) - 1;
+	uint64_t word = crzpack_load64(words);
+	CRZ_SIZE shift = 0;
+	for (CRZ_SIZE i = 0; i < count; i++) {
+		uint64_t value = word >> shift;
+		shift += bits;
+		if (shift > 64 || (shift == 64 && i + 1 < count)) {
+			words += 8;
+			word = crzpack_load64(words);
+			shift -= 64;
+			// The bits of the value which are in the next word
+			if (shift > 0)
+				value |= word << (bits - shift);
+		}
+		out[i] = base + (value & mask);
+	}
+}
+
+CRZ_SIZE crzpack_words_size(CRZ_SIZE count, CRZ_SIZE bits)
+{
+	return (count * bits + 63) / 64 * 8;
+}
+
+CRZ_SIZE crzpack_control_length(unsigned char control)
+{
+	return 4 + (control & 3) + ((control >> 2) & 3) + ((control >> 4) & 3) +
+	       (control >> 6);
+}
+
+void crzpack_varints(StringBuilder *sbp, const uint64_t *values,
+		     CRZ_SIZE count, PackFormat format)
+{
+	unsigned char *start = crzpack_begin(sbp, format, count, count * 10);
+	unsigned char *out = start;
+	uint64_t previous = 0;
+	for (CRZ_SIZE i = 0; i < count; i++) {
+		uint64_t value = values[i];
+		if (format == PACK_DELTA) {
+			value -= previous;
+			previous = values[i];
+		}
+		out += crzpack_put_varint(out, value);
+	}
+	sbp->len = (CRZ_SIZE)((char *)out - sbp->ptr);
+}
+
+void crzpack_zigzags(StringBuilder *sbp, const int64_t *values,
+		     CRZ_SIZE count)
+{
+	unsigned char *out = crzpack_begin(sbp, PACK_ZIGZAG, count, count * 10);
+	for (CRZ_SIZE i = 0; i < count; i++)
+		out += crzpack_put_varint(out, crzpack_zigzag(values[i]));
+	sbp->len = (CRZ_SIZE)((char *)out - sbp->ptr);
+}
+
+void crzpack_for(StringBuilder *sbp, const uint64_t *values, CRZ_SIZE count)
+{
+	CRZ_SIZE blocks = (count + CRZPACK_BLOCK - 1) / CRZPACK_BLOCK;
+	unsigned char *out = crzpack_begin(sbp, PACK_FOR, count,
+					   blocks * 11 + count * 8 + 8);
+
+	for (CRZ_SIZE start = 0; start < count; start += CRZPACK_BLOCK) {
+		CRZ_SIZE len = count - start < CRZPACK_BLOCK ? count - start :
+							       CRZPACK_BLOCK;
+		uint64_t min = values[start];
+		uint64_t max = values[start];
+		for (CRZ_SIZE i = 1; i < len; i++) {
+			if (values[start + i] < min)
+				min = values[start + i];
+			if (values[start + i] > max)
+				max = values[start + i];
+		}
+		CRZ_SIZE bits = max == min ? 0 : 64 - CRZ_CLZ(max - min);
+		out += crzpack_put_varint(out, min);
+		*out++ = (unsigned char)bits;
+
+		uint64_t word = 0;
+		CRZ_SIZE used = 0;
+		for (CRZ_SIZE i = 0; i < len && bits > 0; i++) {
+			uint64_t delta = values[start + i] - min;
+			word |= delta << used;
+			used += bits;
+			if (used >= 64) {
+				crzpack_store64(out, word);
+				out += 8;
+				used -= 64;
+				// The bits of `delta` which did not fit
+				word = used > 0 ? delta >> (bits - used) : 0;
+			}
+		}
+		if (used > 0) {
+			crzpack_store64(out, word);
+			out += 8;
+		}
+	}
+	sbp->len = (CRZ_SIZE)((char *)out - sbp->ptr);
+}
+
+void crzpack_streamvbyte(StringBuilder *sbp, const uint32_t *values,
+			 CRZ_SIZE count, CRZ_BOOL delta)
+{
+	CRZ_SIZE control_size = (count + 3) / 4;
+	unsigned char *controls = crzpack_begin(
+		sbp, delta ? PACK_STREAMVBYTE_DELTA : PACK_STREAMVBYTE, count,
+		control_size + count * 4);
+	unsigned char *out = controls + control_size;
+	memset(controls, 0, control_size);
+
+	uint32_t previous = 0;
+	for (CRZ_SIZE i = 0; i < count; i++) {
+		uint32_t value = values[i];
+		if (delta) {
+			value -= previous;
+			previous = values[i];
+		}
+		CRZ_SIZE code = (value > 0xFF) + (value > 0xFFFF) +
+				(value > 0xFFFFFF);
+		controls[i / 4] |= (unsigned char)(code << (i % 4 * 2));
+		for (CRZ_SIZE byte = 0; byte <= code; byte++)
+			*out++ = (unsigned char)(value >> (byte * 8));
+	}
+	sbp->len = (CRZ_SIZE)((char *)out - sbp->ptr);
+}
+
+CRZ_BOOL crzpack_unpack_varints(StringView packed, Crzarr_AnyArray *arrayp,
+				PackFormat format)
+{
+	PackFormat actual;
+	CRZ_SIZE count;
+	const unsigned char *ptr = crzpack_header(packed, &actual, &count);
+	const unsigned char *end =
+		(const unsigned char *)packed.ptr + packed.len;
+	// Every value takes at least a byte, which bounds a corrupt amount
+	if (ptr == CRZ_NULL || actual != format ||
+	    count > (CRZ_SIZE)(end - ptr))
+		return CRZ_FALSE;
+
+	crzarr_grow_to(arrayp, arrayp->len + count, sizeof(uint64_t));
+	uint64_t *out = (uint64_t *)arrayp->ptr + arrayp->len;
+	uint64_t previous = 0;
+	for (CRZ_SIZE i = 0; i < count; i++) {
+		uint64_t value;
+		if (!crzpack_get_varint(&ptr, end, &value)) {
+			arrayp->len += i;
+			return CRZ_FALSE;
+		}
+		if (format == PACK_DELTA)
+			value = previous += value;
+		else if (format == PACK_ZIGZAG)
+			value = (uint64_t)crzpack_unzigzag(value);
+		out[i] = value;
+	}
+	arrayp->len += count;
+	return ptr == end;
+}
+
+CRZ_BOOL crzpack_unpack_for(StringView packed, Crzarr_AnyArray *arrayp)
+{
+	PackFormat format;
+	CRZ_SIZE count;
+	const unsigned char *ptr = crzpack_header(packed, &format, &count);
+	const unsigned char *end =
+		(const unsigned char *)packed.ptr + packed.len;
+	// Every block takes at least two bytes, which bounds a corrupt amount
+	if (ptr == CRZ_NULL || format != PACK_FOR ||
+	    count / CRZPACK_BLOCK > (CRZ_SIZE)(end - ptr))
+		return CRZ_FALSE;
+
+	crzarr_grow_to(arrayp, arrayp->len + count, sizeof(uint64_t));
+	uint64_t *out = (uint64_t *)arrayp->ptr + arrayp->len;
+	for (CRZ_SIZE start = 0; start < count; start += CRZPACK_BLOCK) {
+		CRZ_SIZE len = count - start < CRZPACK_BLOCK ? count - start :
+							       CRZPACK_BLOCK;
+		uint64_t base;
+		if (!crzpack_get_varint(&ptr, end, &base) || ptr == end)
+			return CRZ_FALSE;
+		CRZ_SIZE bits = *ptr++;
+		CRZ_SIZE size = crzpack_words_size(len, bits);
+		if (bits > 64 || size > (CRZ_SIZE)(end - ptr))
+			return CRZ_FALSE;
+
+		crzpack_unpack_block(ptr, len, bits, base, out + start);
+		ptr += size;
+		arrayp->len += len;
+	}
+	return ptr == end;
+}
+
+#ifdef CRZPACK_SSSE3
+CRZ_SIZE crzpack_decode4_ssse3(unsigned char control, const unsigned char *data,
+			       uint32_t *out, CRZ_BOOL delta,
+			       uint32_t *previousp)
+{
+	CRZ_SIZE first = (control & 3) + ((control >> 2) & 3) + 2;
+	__m128i low = _mm_loadl_epi64(
+		(const __m128i *)crzpack_pair_shuffles[control & 15]);
+	__m128i high = _mm_loadl_epi64(
+		(const __m128i *)crzpack_pair_shuffles[control >> 4]);
+	// The second pair starts after the first, and 0x80 stays negative
+	high = _mm_add_epi8(high, _mm_set1_epi8((char)first));
+	__m128i mask = _mm_unpacklo_epi64(low, high);
+
+	__m128i values = _mm_shuffle_epi8(
+		_mm_loadu_si128((const __m128i *)data), mask);
+	if (delta) {
+		values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+		values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+		values = _mm_add_epi32(values,
+				       _mm_set1_epi32((int)*previousp));
+		*previousp = (uint32_t)_mm_cvtsi128_si32(
+			_mm_shuffle_epi32(values, 0xFF));
+	}
+	_mm_storeu_si128((__m128i *)out, values);
+	return crzpack_control_length(control);
+}
+#endif // CRZPACK_SSSE3
+
+CRZ_BOOL crzpack_unpack_streamvbyte(StringView packed, Crzarr_AnyArray *arrayp,
+				    CRZ_BOOL delta)
+{
+	PackFormat format;
+	CRZ_SIZE count;
+	const unsigned char *controls = crzpack_header(packed, &format, &count);
+	const unsigned char *end =
+		(const unsigned char *)packed.ptr + packed.len;
+	PackFormat expected = delta ? PACK_STREAMVBYTE_DELTA : PACK_STREAMVBYTE;
+	CRZ_SIZE control_size = (count + 3) / 4;
+	if (controls == CRZ_NULL || format != expected ||
+	    count > (CRZ_SIZE)(end - controls) ||
+	    control_size > (CRZ_SIZE)(end - controls))
+		return CRZ_FALSE;
+
+	// Check the length of the data up front, so decoding never overruns
+	const unsigned char *data = controls + control_size;
+	CRZ_SIZE full = count / 4;
+	CRZ_SIZE data_size = 0;
+	for (CRZ_SIZE i = 0; i < full; i++)
+		data_size += crzpack_control_length(controls[i]);
+	for (CRZ_SIZE i = full * 4; i < count; i++)
+		data_size += ((controls[full] >> (i % 4 * 2)) & 3) + 1;
+	if (data_size != (CRZ_SIZE)(end - data))
+		return CRZ_FALSE;
+
+	crzarr_grow_to(arrayp, arrayp->len + count, sizeof(uint32_t));
+	uint32_t *out = (uint32_t *)arrayp->ptr + arrayp->len;
+	uint32_t previous = 0;
+	CRZ_SIZE i = 0;
+#ifdef CRZPACK_SSSE3
+	for (; i + 4 <= count && data + 16 <= end; i += 4) {
+		data += crzpack_decode4_ssse3(controls[i / 4], data, out + i,
+					      delta, &previous);
+	}
+#endif // CRZPACK_SSSE3
+	for (; i < count; i++) {
+		CRZ_SIZE code = (controls[i / 4] >> (i % 4 * 2)) & 3;
+		uint32_t value = 0;
+		for (CRZ_SIZE byte = 0; byte <= code; byte++)
+			value |= (uint32_t)*data++ << (byte * 8);
+		if (delta)
+			value = previous += value;
+		out[i] = value;
+	}
+	arrayp->len += count;
+	return CRZ_TRUE;
+}
+
+CRZ_BOOL crzpack_iter_init(PackIter *iterp, StringView packed)
+{
+	memset(iterp, 0, sizeof(*iterp));
+	iterp->end = (const unsigned char *)packed.ptr + packed.len;
+	iterp->ptr = crzpack_header(packed, &iterp->format, &iterp->remaining);
+	if (iterp->ptr == CRZ_NULL || iterp->format < PACK_VARINT ||
+	    iterp->format > PACK_STREAMVBYTE_DELTA) {
+		iterp->remaining = 0;
+		return CRZ_FALSE;
+	}
+
+	if (iterp->format == PACK_STREAMVBYTE ||
+	    iterp->format == PACK_STREAMVBYTE_DELTA) {
+		CRZ_SIZE control_size = (iterp->remaining + 3) / 4;
+		if (control_size > (CRZ_SIZE)(iterp->end - iterp->ptr)) {
+			iterp->remaining = 0;
+			return CRZ_FALSE;
+		}
+		iterp->controls = iterp->ptr;
+		iterp->ptr += control_size;
+	}
+	return CRZ_TRUE;
+}
+
+CRZ_BOOL crzpack_iter_next(PackIter *iterp, uint64_t *valuep)
+{
+	if (iterp->remaining == 0)
+		return CRZ_FALSE;
+
+	uint64_t value;
+	CRZ_SIZE index = iterp->index;
+	switch (iterp->format) {
+	case PACK_VARINT:
+	case PACK_ZIGZAG:
+	case PACK_DELTA:
+		if (!crzpack_get_varint(&iterp->ptr, iterp->end, &value))
+			goto cut_short;
+		if (iterp->format == PACK_DELTA)
+			value = iterp->previous += value;
+		else if (iterp->format == PACK_ZIGZAG)
+			value = (uint64_t)crzpack_unzigzag(value);
+		break;
+	case PACK_FOR: {
+		CRZ_SIZE in_block = index % CRZPACK_BLOCK;
+		if (in_block == 0) {
+			CRZ_SIZE len = iterp->remaining < CRZPACK_BLOCK ?
+					       iterp->remaining :
+					       CRZPACK_BLOCK;
+			if (!crzpack_get_varint(&iterp->ptr, iterp->end,
+						&iterp->base) ||
+			    iterp->ptr == iterp->end)
+				goto cut_short;
+			iterp->bits = *iterp->ptr++;
+			CRZ_SIZE size = crzpack_words_size(len, iterp->bits);
+			if (iterp->bits > 64 ||
+			    size > (CRZ_SIZE)(iterp->end - iterp->ptr))
+				goto cut_short;
+			iterp->words = iterp->ptr;
+			iterp->ptr += size;
+		}
+		value = iterp->base +
+			crzpack_extract(iterp->words, in_block, iterp->bits);
+		break;
+	}
+	default: {
+		unsigned char control = iterp->controls[index / 4];
+		CRZ_SIZE code = (control >> (index % 4 * 2)) & 3;
+		if (code + 1 > (CRZ_SIZE)(iterp->end - iterp->ptr))
+			goto cut_short;
+		uint32_t word = 0;
+		for (CRZ_SIZE byte = 0; byte <= code; byte++)
+			word |= (uint32_t)*iterp->ptr++ << (byte * 8);
+		if (iterp->format == PACK_STREAMVBYTE_DELTA)
+			word += (uint32_t)iterp->previous;
+		iterp->previous = word;
+		value = word;
+		break;
+	}
+	}
+
+	iterp->index += 1;
+	iterp->remaining -= 1;
+	*valuep = value;
+	return CRZ_TRUE;
+
+cut_short:
+	iterp->remaining = 0;
+	return CRZ_FALSE;
+}
+
+#endif // CRZPACK_H_
@@ -0,0 +1,94 @@
+#ifndef CRZPOOL_H_
+#define CRZPOOL_H_
+
+#include "crzarr.h"
+#include "crzdef.h"
+
+/// The amount of nodes allocated at once by a pool created without a chunk length.
+#ifndef CRZPOOL_CHUNK
+#define CRZPOOL_CHUNK 64
+#endif // CRZPOOL_CHUNK
+
+/// A pool of nodes of a single size, allocated in chunks of `chunk_len` nodes, with a free list of released nodes.
+///
+/// Nodes are never given back to the allocator one at a time, but all at once with `POOL_FREE`.
+/// A `chunk_len` of 0 uses `CRZPOOL_CHUNK`, so a zero-initialized pool is valid.
+typedef struct {
+	ARRAY(void *) chunks;
+	void *free_list;
+	/// The amount of nodes in each chunk.
+	CRZ_SIZE chunk_len;
+	/// The amount of nodes handed out from the last chunk.
+	CRZ_SIZE used;
+} Pool;
+
+/// Initialize a pool allocating `node_count` nodes at once.
+///
+/// This does not perform any allocations.
+#define POOL_NEW(node_count)                                  \
+	{                                                     \
+		.chunks = ARRAY_NEW(), .free_list = CRZ_NULL, \
+		.chunk_len = (node_count), .used = 0          \
+	}
+
+/// Take a node of `node_size` bytes from the pool `selfp` (passed by pointer).
+///
+/// Every node taken from a pool must have the same size, of at least `sizeof(void *)`.
+/// The node is not zeroed.
+#define POOL_ALLOC(selfp, node_size) crzpool_alloc((selfp), (node_size))
+
+/// Give the node `node` back to the pool `selfp` (passed by pointer), to be reused by a later `POOL_ALLOC`.
+#define POOL_RELEASE(selfp, node) crzpool_release((selfp), (node))
+
+/// Free every node of the pool `selfp` (passed by pointer) at once.
+#define POOL_FREE(selfp) crzpool_free((selfp))
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `POOL_ALLOC` instead.
+void *crzpool_alloc(Pool *selfp, CRZ_SIZE node_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `POOL_RELEASE` instead.
+void crzpool_release(Pool *selfp, void *node);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `POOL_FREE` instead.
+void crzpool_free(Pool *selfp);
+
+void *crzpool_alloc(Pool *selfp, CRZ_SIZE node_size)
+{
+	if (selfp->free_list != CRZ_NULL) {
+		void *node = selfp->free_list;
+		selfp->free_list = *(void **)node;
+		return node;
+	}
+
+	CRZ_SIZE chunk_len = selfp->chunk_len ? selfp->chunk_len :
+						CRZPOOL_CHUNK;
+	if (selfp->chunks.len == 0 || selfp->used == chunk_len) {
+		void *chunk = CRZ_MALLOC(node_size * chunk_len);
+		CRZ_ASSERT(chunk && "Out of memory when allocating nodes");
+		ARRAY_PUSH(&selfp->chunks, chunk);
+		selfp->used = 0;
+	}
+
+	char *chunk = selfp->chunks.ptr[selfp->chunks.len - 1];
+	return chunk + node_size * selfp->used++;
+}
+
+void crzpool_release(Pool *selfp, void *node)
+{
+	*(void **)node = selfp->free_list;
+	selfp->free_list = node;
+}
+
+void crzpool_free(Pool *selfp)
+{
+	for (CRZ_SIZE i = 0; i < selfp->chunks.len; i++)
+		CRZ_FREE(selfp->chunks.ptr[i]);
+	ARRAY_FREE(&selfp->chunks);
+	selfp->free_list = CRZ_NULL;
+	selfp->used = 0;
+}
+
+#endif // CRZPOOL_H_
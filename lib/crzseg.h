@@ -0,0 +1,173 @@
+#ifndef CRZSEG_H_
+#define CRZSEG_H_
+
+#include "crzdef.h"
+#include "crzstats.h"
+#include <stdint.h>
+
+/// The base-2 logarithm of the amount of elements in the first segment of a segmented array.
+///
+/// Every segment after the first is twice as large as the one before it.
+#ifndef CRZSEG_FIRST_SHIFT
+#define CRZSEG_FIRST_SHIFT 3
+#endif // CRZSEG_FIRST_SHIFT
+
+/// The amount of elements in the first segment of a segmented array.
+#define CRZSEG_FIRST_SIZE ((CRZ_SIZE)1 << CRZSEG_FIRST_SHIFT)
+
+/// The largest amount of segments a segmented array can have, which is enough for any 64-bit length.
+#define CRZSEG_MAX_SEGMENTS (64 - CRZSEG_FIRST_SHIFT)
+
+/// Define a struct for a segmented array with elements of type `T`.
+///
+/// The elements are stored in segments of doubling size, which are never moved once allocated.
+/// Growing the array never copies any elements, and pointers to elements stay valid until the array is freed.
+///
+/// Segment `k` holds `CRZSEG_FIRST_SIZE << k` elements, so the segment and offset of an index are found with a count-leading-zeros.
+#define SEGMENTED_ARRAY(T)                        \
+	struct {                                  \
+		T *segments[CRZSEG_MAX_SEGMENTS]; \
+		CRZ_SIZE segment_count;           \
+		CRZ_SIZE len;                     \
+	}
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SEGMENTED_ARRAY(T)` instead.
+typedef SEGMENTED_ARRAY(void) Crzseg_AnySegmentedArray;
+
+/// Get the size in bytes of each element of the segmented array `self`.
+/// Uses `sizeof` internally.
+#define SEGMENTED_ARRAY_ELEMENT_SIZE(self) (sizeof(**(self).segments))
+
+/// Zero-initialize a segmented array.
+#define SEGMENTED_ARRAY_NEW()                                   \
+	{                                                       \
+		.segments = { 0 }, .segment_count = 0, .len = 0 \
+	}
+
+/// Make sure the segmented array `selfp` (passed by pointer) has room for `amount_elements` elements in total.
+///
+/// Allocates new segments as needed, without moving any of the existing ones.
+#define SEGMENTED_ARRAY_RESERVE(selfp, amount_elements)                        \
+	crzseg_grow_to((Crzseg_AnySegmentedArray *)(selfp), (amount_elements), \
+		       SEGMENTED_ARRAY_ELEMENT_SIZE(*(selfp)))
+
+/// Get a pointer to the element at `index` within the segmented array `self`.
+///
+/// The pointer stays valid as the array grows, until it is freed.
+#define SEGMENTED_ARRAY_AT(self, index) \
+	(&(self).segments[crzseg_segment(index)][crzseg_offset(index)])
+
+/// Get the element at `index` within the segmented array `self`.
+///
+/// Asserts that the index is not out of the bounds of the array.
+#define SEGMENTED_ARRAY_GET(self, index)                            \
+	(CRZ_ASSERT((index) < (self).len && "Index out of bounds"), \
+	 *SEGMENTED_ARRAY_AT(self, index))
+
+/// Push the element `element` into the segmented array `selfp` (passed by pointer).
+///
+/// Allocates a new segment if needed, without moving any of the existing elements.
+#define SEGMENTED_ARRAY_PUSH(selfp, element)                             \
+	do {                                                             \
+		crzseg_grow_to((Crzseg_AnySegmentedArray *)(selfp),      \
+			       (selfp)->len + 1,                         \
+			       SEGMENTED_ARRAY_ELEMENT_SIZE(*(selfp)));  \
+		*SEGMENTED_ARRAY_AT(*(selfp), (selfp)->len) = (element); \
+		(selfp)->len += 1;                                       \
+	} while (0)
+
+/// Remove and return the last element of the segmented array `selfp` (passed by pointer).
+///
+/// This does not free any segments.
+#define SEGMENTED_ARRAY_POP(selfp) \
+	((selfp)->len -= 1, *SEGMENTED_ARRAY_AT(*(selfp), (selfp)->len))
+
+/// Iterate over the indexes of the segmented array `self`, naming the index variable `index`.
+#define SEGMENTED_ARRAY_FOR(self, index) \
+	for (CRZ_SIZE index = 0; index < (self).len; index++)
+
+/// Print out the elements of segmented array `self`. `fmt` is the format specifier for the element type, as for `printf`.
+#define SEGMENTED_ARRAY_DEBUG(self, fmt)                                    \
+	do {                                                                \
+		CRZ_DEBUG("[");                                             \
+		SEGMENTED_ARRAY_FOR(self, crz__index) {                     \
+			CRZ_DEBUG((fmt),                                    \
+				  SEGMENTED_ARRAY_GET((self), crz__index)); \
+			if (crz__index + 1 != (self).len) {                 \
+				CRZ_DEBUG(", ");                            \
+			}                                                   \
+		}                                                           \
+		CRZ_DEBUG("]\n");                                           \
+	} while (0)
+
+/// Free the space allocated for the segments of the segmented array `selfp` (passed by pointer), and empty-out the fields of the struct.
+///
+/// This **does not** free any of the elements of `selfp` - if they are dynamically allocated, you must do this yourself before calling `SEGMENTED_ARRAY_FREE`.
+#define SEGMENTED_ARRAY_FREE(selfp) \
+	crzseg_free((Crzseg_AnySegmentedArray *)(selfp))
+
+/// INTERNAL: this is the segment which holds the element at `index`.
+CRZ_SIZE crzseg_segment(CRZ_SIZE index);
+
+/// INTERNAL: this is the offset of the element at `index` within its segment.
+CRZ_SIZE crzseg_offset(CRZ_SIZE index);
+
+/// INTERNAL: this is the amount of elements held by the first `segment_count` segments.
+CRZ_SIZE crzseg_capacity(CRZ_SIZE segment_count);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SEGMENTED_ARRAY_RESERVE(selfp, amount_elements)` instead.
+void crzseg_grow_to(Crzseg_AnySegmentedArray *selfp, CRZ_SIZE new_cap,
+		    CRZ_SIZE element_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SEGMENTED_ARRAY_FREE(selfp)` instead.
+void crzseg_free(Crzseg_AnySegmentedArray *selfp);
+
+CRZ_SIZE crzseg_segment(CRZ_SIZE index)
+{
+	// Segment `k` holds the indexes whose shifted top bit is `k + shift`
+	uint64_t shifted = (uint64_t)index + CRZSEG_FIRST_SIZE;
+	return 63 - CRZ_CLZ(shifted) - CRZSEG_FIRST_SHIFT;
+}
+
+CRZ_SIZE crzseg_offset(CRZ_SIZE index)
+{
+	return index + CRZSEG_FIRST_SIZE -
+	       (CRZSEG_FIRST_SIZE << crzseg_segment(index));
+}
+
+CRZ_SIZE crzseg_capacity(CRZ_SIZE segment_count)
+{
+	return (CRZSEG_FIRST_SIZE << segment_count) - CRZSEG_FIRST_SIZE;
+}
+
+void crzseg_grow_to(Crzseg_AnySegmentedArray *selfp, CRZ_SIZE new_cap,
+		    CRZ_SIZE element_size)
+{
+	while (crzseg_capacity(selfp->segment_count) < new_cap) {
+		CRZ_ASSERT(selfp->segment_count < CRZSEG_MAX_SEGMENTS &&
+			   "Too many elements for segmented array");
+		CRZ_SIZE size = element_size
+				<< (CRZSEG_FIRST_SHIFT + selfp->segment_count);
+		void *segment = CRZ_MALLOC(size);
+		CRZ_ASSERT(segment &&
+			   "Out of memory when allocating segmented array");
+		CRZ_STATS_ADD(arr, allocations, 1);
+		CRZ_STATS_ADD(arr, bytes_allocated, size);
+		selfp->segments[selfp->segment_count++] = segment;
+	}
+}
+
+void crzseg_free(Crzseg_AnySegmentedArray *selfp)
+{
+	for (CRZ_SIZE i = 0; i < selfp->segment_count; i++) {
+		CRZ_FREE(selfp->segments[i]);
+		selfp->segments[i] = CRZ_NULL;
+	}
+	selfp->segment_count = 0;
+	selfp->len = 0;
+}
+
+#endif // CRZSEG_H_
@@ -0,0 +1,293 @@
+#ifndef CRZSNAP_H_
+#define CRZSNAP_H_
+
+#include "crzdef.h"
+#include "crzhash.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// The magic bytes at the start of every snapshot file, which also encode the format version.
+#define CRZSNAP_MAGIC "CRZSNAP2"
+
+/// INTERNAL: the flag set in the header of a snapshot of a table which ignores the case of ASCII letters in its keys.
+#define CRZSNAP_ICASE 1
+
+/// A read-only hash table snapshot, mapped into memory from a file written by `HASH_TABLE_WRITE_SNAPSHOT`.
+///
+/// The snapshot is queried in place, without any deserialization, and its pages may be shared by every process which maps the same file.
+typedef struct {
+	const unsigned char *base;
+	CRZ_SIZE len;
+} TableSnapshot;
+
+/// INTERNAL: you most likely don't want to use this.
+///           This is the header at the start of every snapshot file.
+///
+/// The file is laid out as:
+///   - this header
+///   - `slot_count` offsets of entries, or 0 for empty slots, as for linear probing
+///   - the entries, each made up of the key's hash, the value and the terminated key, each padded to 8 bytes
+/// All of the numbers are 64-bit and in the native byte order, and all of the offsets are from the start of the file.
+/// `flags` records how the keys were hashed, such as `CRZSNAP_ICASE`, since the slots are only valid for that.
+typedef struct {
+	char magic[8];
+	uint64_t value_size;
+	uint64_t count;
+	uint64_t slot_count;
+	uint64_t file_size;
+	uint64_t flags;
+} Crzsnap_Header;
+
+/// Zero-initialize a table snapshot.
+#define TABLE_SNAPSHOT_NEW()               \
+	{                                  \
+		.base = CRZ_NULL, .len = 0 \
+	}
+
+/// Write the hash table `self` to the file at `path`, so that it may be loaded using `TABLE_SNAPSHOT_OPEN`.
+///
+/// A table initialized using `HASH_TABLE_INIT_ICASE` must be loaded using `TABLE_SNAPSHOT_OPEN_ICASE` instead, since its keys hash differently.
+///
+/// The snapshot is written to `path` followed by `.tmp`, and then renamed over `path`, so processes which still map the previous snapshot keep reading it, and a crash while writing leaves the previous snapshot in place.
+/// The values are written as raw bytes, so they must not contain pointers, and must not require an alignment of more than 8 bytes.
+///
+/// Returns whether the snapshot was written successfully.
+#define HASH_TABLE_WRITE_SNAPSHOT(self, path)                    \
+	crzsnap_write((Crzhash_AnyHashTable *)(&(self)), (path), \
+		      sizeof((self).ptr[0]->value))
+
+/// Map the snapshot file at `path` into the table snapshot `selfp` (passed by pointer), where `T` is the value type of the snapshotted table.
+///
+/// Returns whether the file could be mapped, and is a valid snapshot of a table with values of type `T`, whose keys are case-sensitive.
+#define TABLE_SNAPSHOT_OPEN(selfp, path, T) \
+	crzsnap_open((selfp), (path), sizeof(T), CRZ_FALSE)
+
+/// Map the snapshot file at `path` into the table snapshot `selfp` (passed by pointer), where `T` is the value type of the snapshotted table.
+///
+/// Returns whether the file could be mapped, and is a valid snapshot of a table with values of type `T`, which was initialized using `HASH_TABLE_INIT_ICASE`.
+#define TABLE_SNAPSHOT_OPEN_ICASE(selfp, path, T) \
+	crzsnap_open((selfp), (path), sizeof(T), CRZ_TRUE)
+
+/// Get a pointer to the value with key `get_key` in the table snapshot `self`.
+///
+/// If the key does not exist in the snapshot, returns `CRZ_NULL`, as it does for entries which point outside of a corrupt file.
+/// The value points into the mapped file, so it is read-only and is only valid until `TABLE_SNAPSHOT_CLOSE` is called.
+#define TABLE_SNAPSHOT_GET(self, get_key) crzsnap_get(&(self), (get_key))
+
+/// Get the amount of key-value pairs in the table snapshot `self`.
+#define TABLE_SNAPSHOT_COUNT(self) \
+	((CRZ_SIZE)((const Crzsnap_Header *)(self).base)->count)
+
+/// Unmap the table snapshot `selfp` (passed by pointer), and empty-out the fields of the struct.
+#define TABLE_SNAPSHOT_CLOSE(selfp)                                  \
+	do {                                                         \
+		if ((selfp)->base)                                   \
+			munmap((void *)(selfp)->base, (selfp)->len); \
+		(selfp)->base = CRZ_NULL;                            \
+		(selfp)->len = 0;                                    \
+	} while (0)
+
+/// INTERNAL: this is the amount of bytes needed to pad `size` bytes to 8 bytes.
+CRZ_SIZE crzsnap_padding(CRZ_SIZE size);
+
+/// INTERNAL: this is the size of the entry for a key of length `key_len`, padded to 8 bytes.
+CRZ_SIZE crzsnap_entry_size(CRZ_SIZE value_size, CRZ_SIZE key_len);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `HASH_TABLE_WRITE_SNAPSHOT(self, path)` instead.
+CRZ_BOOL crzsnap_write(Crzhash_AnyHashTable *selfp, const char *path,
+		       CRZ_SIZE value_size);
+
+/// INTERNAL: this writes every byte of the snapshot of `selfp` to `file`, returning whether it succeeded.
+CRZ_BOOL crzsnap_write_file(Crzhash_AnyHashTable *selfp, FILE *file,
+			    const Crzsnap_Header *header,
+			    const uint64_t *slots);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `TABLE_SNAPSHOT_OPEN(selfp, path, T)` instead.
+CRZ_BOOL crzsnap_open(TableSnapshot *selfp, const char *path,
+		      CRZ_SIZE value_size, CRZ_BOOL icase);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `TABLE_SNAPSHOT_GET(self, key)` instead.
+const void *crzsnap_get(TableSnapshot *selfp, CRZ_STRING key);
+
+CRZ_SIZE crzsnap_padding(CRZ_SIZE size)
+{
+	return (8 - size % 8) % 8;
+}
+
+CRZ_SIZE crzsnap_entry_size(CRZ_SIZE value_size, CRZ_SIZE key_len)
+{
+	return sizeof(uint64_t) + value_size + crzsnap_padding(value_size) +
+	       key_len + 1 + crzsnap_padding(key_len + 1);
+}
+
+CRZ_BOOL crzsnap_write(Crzhash_AnyHashTable *selfp, const char *path,
+		       CRZ_SIZE value_size)
+{
+	Crzsnap_Header header = { 0 };
+	CRZ_MEMCPY(header.magic, CRZSNAP_MAGIC, sizeof(header.magic));
+	header.value_size = value_size;
+	header.flags = selfp->icase ? CRZSNAP_ICASE : 0;
+	for (CRZ_SIZE i = 0; i < selfp->size; i++) {
+		if (selfp->ptr[i])
+			header.count++;
+	}
+	header.slot_count = crzhash_size_for(header.count);
+
+	uint64_t *slots = CRZ_MALLOC(sizeof(*slots) * header.slot_count);
+	CRZ_ASSERT(slots && "Out of memory when writing snapshot");
+	for (CRZ_SIZE i = 0; i < header.slot_count; i++)
+		slots[i] = 0;
+
+	// Lay out the entries in table order, right after the slots
+	uint64_t offset =
+		sizeof(header) + sizeof(*slots) * header.slot_count;
+	for (CRZ_SIZE i = 0; i < selfp->size; i++) {
+		Crzhash_AnyHashPair *existing = selfp->ptr[i];
+		if (existing == CRZ_NULL)
+			continue;
+
+		CRZ_SIZE index = crzhash_key_hash(selfp->icase, existing->key) %
+				 header.slot_count;
+		while (slots[index] != 0)
+			index = (index + 1) % header.slot_count;
+		slots[index] = offset;
+		offset += crzsnap_entry_size(value_size,
+					     CRZ_STRLEN(existing->key));
+	}
+	header.file_size = offset;
+
+	// Replace the file rather than truncating it, since truncating pages
+	// which other processes map makes them fault on their next read
+	CRZ_SIZE path_len = CRZ_STRLEN(path);
+	char *tmp_path = CRZ_MALLOC(path_len + sizeof(".tmp"));
+	CRZ_ASSERT(tmp_path && "Out of memory when writing snapshot");
+	CRZ_MEMCPY(tmp_path, path, path_len);
+	CRZ_MEMCPY(tmp_path + path_len, ".tmp", sizeof(".tmp"));
+
+	CRZ_BOOL ok = CRZ_FALSE;
+	FILE *file = fopen(tmp_path, "wb");
+	if (file != CRZ_NULL) {
+		ok = crzsnap_write_file(selfp, file, &header, slots);
+		ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+		if (fclose(file) != 0)
+			ok = CRZ_FALSE;
+		ok = ok && rename(tmp_path, path) == 0;
+		if (!ok)
+			unlink(tmp_path);
+	}
+
+	CRZ_FREE(tmp_path);
+	CRZ_FREE(slots);
+	return ok;
+}
+
+CRZ_BOOL crzsnap_write_file(Crzhash_AnyHashTable *selfp, FILE *file,
+			    const Crzsnap_Header *header,
+			    const uint64_t *slots)
+{
+	static const char padding[8] = { 0 };
+	CRZ_SIZE value_size = header->value_size;
+	CRZ_BOOL ok = fwrite(header, sizeof(*header), 1, file) == 1;
+	ok = ok && fwrite(slots, sizeof(*slots), header->slot_count, file) ==
+			   header->slot_count;
+
+	for (CRZ_SIZE i = 0; ok && i < selfp->size; i++) {
+		Crzhash_AnyHashPair *existing = selfp->ptr[i];
+		if (existing == CRZ_NULL)
+			continue;
+
+		uint64_t hash = crzhash_key_hash(selfp->icase, existing->key);
+		CRZ_SIZE key_len = CRZ_STRLEN(existing->key) + 1;
+		CRZ_SIZE value_padding = crzsnap_padding(value_size);
+		CRZ_SIZE key_padding = crzsnap_padding(key_len);
+
+		// The value is the first field of the pair
+		ok = fwrite(&hash, sizeof(hash), 1, file) == 1;
+		ok = ok && fwrite(existing, 1, value_size, file) == value_size;
+		ok = ok && fwrite(padding, 1, value_padding, file) ==
+				   value_padding;
+		ok = ok && fwrite(existing->key, 1, key_len, file) == key_len;
+		ok = ok && fwrite(padding, 1, key_padding, file) == key_padding;
+	}
+	return ok;
+}
+
+CRZ_BOOL crzsnap_open(TableSnapshot *selfp, const char *path,
+		      CRZ_SIZE value_size, CRZ_BOOL icase)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return CRZ_FALSE;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 ||
+	    (CRZ_SIZE)st.st_size < sizeof(Crzsnap_Header)) {
+		close(fd);
+		return CRZ_FALSE;
+	}
+
+	CRZ_SIZE len = (CRZ_SIZE)st.st_size;
+	void *base = mmap(CRZ_NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping stays valid after the file is closed
+	close(fd);
+	if (base == MAP_FAILED)
+		return CRZ_FALSE;
+
+	const Crzsnap_Header *header = base;
+	CRZ_SIZE max_slot_count = (len - sizeof(*header)) / sizeof(uint64_t);
+	uint64_t flags = icase ? CRZSNAP_ICASE : 0;
+	if (CRZ_MEMCMP(header->magic, CRZSNAP_MAGIC, 8) != 0 ||
+	    header->value_size != value_size || header->flags != flags ||
+	    header->file_size != len || header->slot_count == 0 ||
+	    header->slot_count > max_slot_count) {
+		munmap(base, len);
+		return CRZ_FALSE;
+	}
+
+	selfp->base = base;
+	selfp->len = len;
+	return CRZ_TRUE;
+}
+
+const void *crzsnap_get(TableSnapshot *selfp, CRZ_STRING key)
+{
+	const Crzsnap_Header *header = (const Crzsnap_Header *)selfp->base;
+	const uint64_t *slots = (const uint64_t *)(header + 1);
+	CRZ_BOOL icase = (header->flags & CRZSNAP_ICASE) != 0;
+	uint64_t hash = crzhash_key_hash(icase, key);
+	CRZ_SIZE index = hash % header->slot_count;
+	CRZ_SIZE key_start = sizeof(uint64_t) + header->value_size +
+			     crzsnap_padding(header->value_size);
+	if (key_start >= selfp->len)
+		return CRZ_NULL;
+
+	// There is always an empty slot in a valid snapshot, but the probes
+	// are still bounded, as are the entries, since the file may be corrupt
+	for (CRZ_SIZE probes = 0;
+	     probes < header->slot_count && slots[index] != 0; probes++) {
+		uint64_t offset = slots[index];
+		index = (index + 1) % header->slot_count;
+		if (offset >= selfp->len - key_start)
+			continue;
+
+		const unsigned char *entry = selfp->base + offset;
+		const char *existing_key = (const char *)entry + key_start;
+		CRZ_SIZE key_room = selfp->len - offset - key_start;
+		if (*(const uint64_t *)entry == hash &&
+		    memchr(existing_key, '\0', key_room) != CRZ_NULL &&
+		    crzhash_key_eq(icase, existing_key, key))
+			return entry + sizeof(uint64_t);
+	}
+
+	return CRZ_NULL;
+}
+
+#endif // CRZSNAP_H_
@@ -0,0 +1,197 @@
+#ifndef CRZSOA_H_
+#define CRZSOA_H_
+
+#include "crzarr.h"
+#include "crzdef.h"
+#include "crzstats.h"
+#include <stdint.h>
+#include <string.h>
+
+/// The alignment in bytes of each field's array within the allocation of a structure-of-arrays.
+///
+/// This is a cache line, so that no two fields share one.
+#ifndef CRZSOA_ALIGNMENT
+#define CRZSOA_ALIGNMENT 64
+#endif // CRZSOA_ALIGNMENT
+
+/// Define a structure-of-arrays container named `Name`, with fields given by the X-macro `FIELDS`.
+///
+/// `FIELDS` must take a single macro argument, and apply it as `X(T, name)` to each field:
+///   #define POINT_FIELDS(X) X(float, x) X(float, y) X(int, id)
+///   DEFINE_SOA(Points, POINT_FIELDS)
+///
+/// This defines:
+///   - `Name`, a struct with a `T *name` array for each field, along with a shared `len` and `cap`
+///   - `Name##_Record`, a struct with a `T name` member for each field, as a single element of the container
+///   - `Name##_grow_to`, `Name##_grow_by`, `Name##_push`, `Name##_get`, `Name##_set`, `Name##_pop`, `Name##_remove` and `Name##_free`, which mirror the `ARRAY_*` macros
+///
+/// All of the fields are stored in a single allocation, which is grown in a single step, with each field's array aligned to `CRZSOA_ALIGNMENT`.
+/// Loops over a single field are therefore contiguous, and only load the cache lines of that field.
+#define DEFINE_SOA(Name, FIELDS)                                              \
+	typedef struct {                                                      \
+		FIELDS(CRZSOA_FIELD_ARRAY)                                    \
+		void *block;                                                  \
+		CRZ_SIZE len;                                                 \
+		CRZ_SIZE cap;                                                 \
+	} Name;                                                               \
+                                                                              \
+	typedef struct {                                                      \
+		FIELDS(CRZSOA_FIELD_MEMBER)                                   \
+	} Name##_Record;                                                      \
+                                                                              \
+	static inline void Name##_grow_to(Name *selfp, CRZ_SIZE new_cap)      \
+	{                                                                     \
+		if (selfp->cap >= new_cap)                                    \
+			return;                                               \
+		CRZ_SIZE cap = crzsoa_next_cap(selfp->cap, new_cap);          \
+		CRZ_SIZE bytes = 0;                                           \
+		FIELDS(CRZSOA_FIELD_BYTES)                                    \
+		bytes += CRZSOA_ALIGNMENT - 1;                                \
+		char *block = CRZ_MALLOC(bytes);                              \
+		CRZ_ASSERT(block &&                                           \
+			   "Out of memory when growing structure-of-arrays"); \
+		CRZ_STATS_ADD(arr, allocations, 1);                           \
+		CRZ_STATS_ADD(arr, bytes_allocated, bytes);                   \
+		char *start = crzsoa_align(block);                            \
+		CRZ_SIZE offset = 0;                                          \
+		FIELDS(CRZSOA_FIELD_MOVE)                                     \
+		CRZ_FREE(selfp->block);                                       \
+		selfp->block = block;                                         \
+		selfp->cap = cap;                                             \
+	}                                                                     \
+                                                                              \
+	static inline void Name##_grow_by(Name *selfp,                        \
+					  CRZ_SIZE amount_elements)           \
+	{                                                                     \
+		Name##_grow_to(selfp, selfp->cap + amount_elements);          \
+	}                                                                     \
+                                                                              \
+	static inline void Name##_set(Name *selfp, CRZ_SIZE index,            \
+				      Name##_Record record)                   \
+	{                                                                     \
+		CRZ_ASSERT(index < selfp->len && "Index out of bounds");      \
+		FIELDS(CRZSOA_FIELD_SET)                                      \
+	}                                                                     \
+                                                                              \
+	static inline void Name##_push(Name *selfp, Name##_Record record)     \
+	{                                                                     \
+		Name##_grow_to(selfp, selfp->len + 1);                        \
+		selfp->len += 1;                                              \
+		Name##_set(selfp, selfp->len - 1, record);                    \
+	}                                                                     \
+                                                                              \
+	static inline Name##_Record Name##_get(const Name *selfp,             \
+					       CRZ_SIZE index)                \
+	{                                                                     \
+		CRZ_ASSERT(index < selfp->len && "Index out of bounds");      \
+		Name##_Record record;                                         \
+		FIELDS(CRZSOA_FIELD_GET)                                      \
+		return record;                                                \
+	}                                                                     \
+                                                                              \
+	static inline Name##_Record Name##_pop(Name *selfp)                   \
+	{                                                                     \
+		Name##_Record record = Name##_get(selfp, selfp->len - 1);     \
+		selfp->len -= 1;                                              \
+		return record;                                                \
+	}                                                                     \
+                                                                              \
+	static inline void Name##_remove(Name *selfp, CRZ_SIZE index,         \
+					 CRZ_SIZE amount_elements)            \
+	{                                                                     \
+		CRZ_ASSERT(index + amount_elements <= selfp->len &&           \
+			   "Index out of bounds");                            \
+		CRZ_SIZE after = selfp->len - index - amount_elements;        \
+		FIELDS(CRZSOA_FIELD_REMOVE)                                   \
+		selfp->len -= amount_elements;                                \
+	}                                                                     \
+                                                                              \
+	static inline void Name##_free(Name *selfp)                           \
+	{                                                                     \
+		CRZ_FREE(selfp->block);                                       \
+		*selfp = (Name){ .block = CRZ_NULL, .len = 0, .cap = 0 };     \
+	}
+
+/// Zero-initialize a structure-of-arrays container.
+#define SOA_NEW()                                     \
+	{                                             \
+		.block = CRZ_NULL, .len = 0, .cap = 0 \
+	}
+
+/// Iterate over the indexes of the structure-of-arrays container `self`, naming the index variable `index`.
+#define SOA_FOR(self, index) \
+	for (CRZ_SIZE index = 0; index < (self).len; index++)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEFINE_SOA(Name, FIELDS)` instead.
+#define CRZSOA_FIELD_ARRAY(T, name) T *name;
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEFINE_SOA(Name, FIELDS)` instead.
+#define CRZSOA_FIELD_MEMBER(T, name) T name;
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEFINE_SOA(Name, FIELDS)` instead.
+#define CRZSOA_FIELD_BYTES(T, name) bytes += crzsoa_aligned(cap * sizeof(T));
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEFINE_SOA(Name, FIELDS)` instead.
+#define CRZSOA_FIELD_MOVE(T, name)                          \
+	{                                                   \
+		T *crz__moved = (T *)(start + offset);      \
+		if (selfp->len > 0)                         \
+			CRZ_MEMCPY(crz__moved, selfp->name, \
+				   selfp->len * sizeof(T)); \
+		CRZ_STATS_ADD(arr, bytes_copied,            \
+			      selfp->len * sizeof(T));      \
+		selfp->name = crz__moved;                   \
+		offset += crzsoa_aligned(cap * sizeof(T));  \
+	}
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEFINE_SOA(Name, FIELDS)` instead.
+#define CRZSOA_FIELD_SET(T, name) selfp->name[index] = record.name;
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEFINE_SOA(Name, FIELDS)` instead.
+#define CRZSOA_FIELD_GET(T, name) record.name = selfp->name[index];
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `DEFINE_SOA(Name, FIELDS)` instead.
+#define CRZSOA_FIELD_REMOVE(T, name)                                        \
+	memmove(selfp->name + index, selfp->name + index + amount_elements, \
+		after * sizeof(T));
+
+/// INTERNAL: this is the capacity a structure-of-arrays grows to from `cap` to hold `new_cap` elements, following `crzarr_grow_to`.
+CRZ_SIZE crzsoa_next_cap(CRZ_SIZE cap, CRZ_SIZE new_cap);
+
+/// INTERNAL: this is `size` rounded up to `CRZSOA_ALIGNMENT`.
+CRZ_SIZE crzsoa_aligned(CRZ_SIZE size);
+
+/// INTERNAL: this is `ptr` rounded up to an address aligned to `CRZSOA_ALIGNMENT`.
+char *crzsoa_align(char *ptr);
+
+CRZ_SIZE crzsoa_next_cap(CRZ_SIZE cap, CRZ_SIZE new_cap)
+{
+	cap *= 2;
+	if (cap < CRZARR_MINIMUM_CAPACITY)
+		cap = CRZARR_MINIMUM_CAPACITY;
+	if (cap < new_cap)
+		cap = new_cap;
+	return cap;
+}
+
+CRZ_SIZE crzsoa_aligned(CRZ_SIZE size)
+{
+	return (size + CRZSOA_ALIGNMENT - 1) / CRZSOA_ALIGNMENT *
+	       CRZSOA_ALIGNMENT;
+}
+
+char *crzsoa_align(char *ptr)
+{
+	uintptr_t address = (uintptr_t)ptr;
+	return ptr + (CRZSOA_ALIGNMENT - address % CRZSOA_ALIGNMENT) %
+			     CRZSOA_ALIGNMENT;
+}
+
+#endif // CRZSOA_H_
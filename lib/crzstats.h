@@ -0,0 +1,108 @@
+#ifndef CRZSTATS_H_
+#define CRZSTATS_H_
+
+#include "crzdef.h"
+
+/// The amount of buckets in the probe length histogram.
+/// The last bucket counts every probe at least that long.
+#ifndef CRZSTATS_PROBE_BUCKETS
+#define CRZSTATS_PROBE_BUCKETS 16
+#endif // CRZSTATS_PROBE_BUCKETS
+
+/// The counters kept for a single container type when `CRZ_STATS` is defined.
+typedef struct {
+	CRZ_SIZE allocations;
+	CRZ_SIZE reallocations;
+	CRZ_SIZE bytes_allocated;
+	CRZ_SIZE bytes_copied;
+	CRZ_SIZE resizes;
+	CRZ_SIZE collisions;
+	/// The amount of probes by length, where a length of 0 means the first slot probed was the final one.
+	CRZ_SIZE probe_lengths[CRZSTATS_PROBE_BUCKETS];
+} Crzstats_Counters;
+
+/// The counters kept for each container type when `CRZ_STATS` is defined.
+typedef struct {
+	Crzstats_Counters arr;
+	Crzstats_Counters hash;
+} Crzstats;
+
+#ifdef CRZ_STATS
+
+/// The global statistics, only available when `CRZ_STATS` is defined.
+static Crzstats crzstats = { 0 };
+
+/// INTERNAL: you most likely don't want to use this.
+///           Add `amount` to the counter `counter` of the container type `container`.
+#define CRZ_STATS_ADD(container, counter, amount) \
+	((void)(crzstats.container.counter += (amount)))
+
+/// INTERNAL: you most likely don't want to use this.
+///           Record a probe of length `length` for the container type `container`.
+#define CRZ_STATS_PROBE(container, length) \
+	crzstats_probe(&crzstats.container, (length))
+
+/// Print out all of the statistics gathered so far.
+#define CRZ_STATS_DUMP() crzstats_dump()
+
+/// Reset all of the statistics gathered so far.
+#define CRZ_STATS_RESET() ((void)(crzstats = (Crzstats){ 0 }))
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CRZ_STATS_PROBE(container, length)` instead.
+void crzstats_probe(Crzstats_Counters *countersp, CRZ_SIZE length);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CRZ_STATS_DUMP()` instead.
+void crzstats_dump_counters(const char *name, Crzstats_Counters counters);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `CRZ_STATS_DUMP()` instead.
+void crzstats_dump(void);
+
+void crzstats_probe(Crzstats_Counters *countersp, CRZ_SIZE length)
+{
+	if (length >= CRZSTATS_PROBE_BUCKETS)
+		length = CRZSTATS_PROBE_BUCKETS - 1;
+	countersp->probe_lengths[length] += 1;
+}
+
+void crzstats_dump_counters(const char *name, Crzstats_Counters counters)
+{
+	CRZ_DEBUG("%s:\n", name);
+	CRZ_DEBUG("  allocations: " CRZ_SIZE_FMT "\n", counters.allocations);
+	CRZ_DEBUG("  reallocations: " CRZ_SIZE_FMT "\n",
+		  counters.reallocations);
+	CRZ_DEBUG("  bytes allocated: " CRZ_SIZE_FMT "\n",
+		  counters.bytes_allocated);
+	CRZ_DEBUG("  bytes copied: " CRZ_SIZE_FMT "\n", counters.bytes_copied);
+	CRZ_DEBUG("  resizes: " CRZ_SIZE_FMT "\n", counters.resizes);
+	CRZ_DEBUG("  collisions: " CRZ_SIZE_FMT "\n", counters.collisions);
+	CRZ_DEBUG("  probe lengths:");
+	for (CRZ_SIZE i = 0; i < CRZSTATS_PROBE_BUCKETS; i++) {
+		CRZ_DEBUG(" " CRZ_SIZE_FMT "%s=" CRZ_SIZE_FMT, i,
+			  i + 1 == CRZSTATS_PROBE_BUCKETS ? "+" : "",
+			  counters.probe_lengths[i]);
+	}
+	CRZ_DEBUG("\n");
+}
+
+void crzstats_dump(void)
+{
+	crzstats_dump_counters("crzarr", crzstats.arr);
+	crzstats_dump_counters("crzhash", crzstats.hash);
+}
+
+#else
+
+#define CRZ_STATS_ADD(container, counter, amount) ((void)0)
+
+#define CRZ_STATS_PROBE(container, length) ((void)0)
+
+#define CRZ_STATS_DUMP() ((void)0)
+
+#define CRZ_STATS_RESET() ((void)0)
+
+#endif // CRZ_STATS
+
+#endif // CRZSTATS_H_
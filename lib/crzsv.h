@@ -2,6 +2,17 @@
 #define CRZSV_H_
 
 #include "crzdef.h"
+#include <stdint.h>
+
+#if defined(__SSE2__) && !defined(CRZSV_NO_SIMD)
+#include <emmintrin.h>
+#define CRZSV_SSE2
+#endif
+
+#if defined(__SSSE3__) && !defined(CRZSV_NO_SIMD)
+#include <tmmintrin.h>
+#define CRZSV_SSSE3
+#endif
 
 typedef struct {
 	const char *ptr;
@@ -83,8 +94,363 @@ typedef struct {
 	(((a).len != (b).len) ? (CRZ_FALSE) : \
 				(CRZ_MEMCMP((a).ptr, (b).ptr, (a).len) == 0))
 
+#define SV_CMP(a, b) crzsv_cmp((a), (b))
+
+#define SV_EQ_ICASE(a, b)                     \
+	(((a).len != (b).len) ? (CRZ_FALSE) : \
+				crzsv_eq_icase((a).ptr, (b).ptr, (a).len))
+
+#define SV_HAS_PREFIX(self, prefix)    \
+	((self).len >= (prefix).len && \
+	 CRZ_MEMCMP((self).ptr, (prefix).ptr, (prefix).len) == 0)
+
+#define SV_HAS_SUFFIX(self, suffix)                                       \
+	((self).len >= (suffix).len &&                                    \
+	 CRZ_MEMCMP((self).ptr + (self).len - (suffix).len, (suffix).ptr, \
+		    (suffix).len) == 0)
+
+#define SV_HAS_PREFIX_ICASE(self, prefix) \
+	((self).len >= (prefix).len &&    \
+	 crzsv_eq_icase((self).ptr, (prefix).ptr, (prefix).len))
+
+#define SV_HAS_SUFFIX_ICASE(self, suffix)                                     \
+	((self).len >= (suffix).len &&                                        \
+	 crzsv_eq_icase((self).ptr + (self).len - (suffix).len, (suffix).ptr, \
+			(suffix).len))
+
 #define SV_FMT "%.*s"
 
 #define SV_ARG(self) (int)((self).len), ((self).ptr)
 
+#define CRZSV_UTF8_REPLACEMENT 0xFFFD
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SV_CMP(a, b)` instead.
+int crzsv_cmp(StringView a, StringView b);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SV_EQ_ICASE(a, b)` instead.
+CRZ_BOOL crzsv_eq_icase(const char *a, const char *b, CRZ_SIZE len);
+
+/// INTERNAL: this function lowercases the ASCII letters among the 8 bytes of `word`.
+uint64_t crzsv_lower64(uint64_t word);
+
+#define SV_UTF8_VALID(self) crzsv_utf8_valid((self).ptr, (self).len)
+
+#define SV_UTF8_NEXT(selfp, codepointp) crzsv_utf8_next((selfp), (codepointp))
+
+#define SV_UTF8_COUNT(self) crzsv_utf8_count((self).ptr, (self).len)
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SV_UTF8_VALID(self)` instead.
+CRZ_BOOL crzsv_utf8_valid(const char *ptr, CRZ_SIZE len);
+
+/// INTERNAL: this function validates `ptr` one code point at a time.
+CRZ_BOOL crzsv_utf8_valid_scalar(const char *ptr, CRZ_SIZE len);
+
+#ifdef CRZSV_SSSE3
+/// INTERNAL: this function validates `ptr` 16 bytes at a time using SSSE3.
+CRZ_BOOL crzsv_utf8_valid_ssse3(const char *ptr, CRZ_SIZE len);
+#endif // CRZSV_SSSE3
+
+/// INTERNAL: this is whether the 32 bytes at `ptr` are all ASCII.
+CRZ_BOOL crzsv_is_ascii32(const char *ptr);
+
+/// INTERNAL: this function decodes the code point at the start of `ptr` into `codepointp`.
+///           Returns the length of its encoding, or 0 if it is not valid UTF-8.
+CRZ_SIZE crzsv_utf8_decode(const unsigned char *ptr, CRZ_SIZE len,
+			   uint32_t *codepointp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SV_UTF8_NEXT(selfp, codepointp)` instead.
+CRZ_BOOL crzsv_utf8_next(StringView *selfp, uint32_t *codepointp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `SV_UTF8_COUNT(self)` instead.
+CRZ_SIZE crzsv_utf8_count(const char *ptr, CRZ_SIZE len);
+
+int crzsv_cmp(StringView a, StringView b)
+{
+	CRZ_SIZE len = a.len < b.len ? a.len : b.len;
+	int cmp = CRZ_MEMCMP(a.ptr, b.ptr, len);
+	if (cmp != 0)
+		return cmp;
+	return (a.len > b.len) - (a.len < b.len);
+}
+
+CRZ_BOOL crzsv_eq_icase(const char *a, const char *b, CRZ_SIZE len)
+{
+	CRZ_SIZE i = 0;
+#ifdef CRZSV_SSE2
+	const __m128i before_a = _mm_set1_epi8('A' - 1);
+	const __m128i after_z = _mm_set1_epi8('Z' + 1);
+	const __m128i case_bit = _mm_set1_epi8(0x20);
+	for (; i + 16 <= len; i += 16) {
+		__m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+		__m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+		// Bytes past 0x7F are negative, so they are never letters
+		__m128i x_upper = _mm_and_si128(_mm_cmpgt_epi8(x, before_a),
+						_mm_cmplt_epi8(x, after_z));
+		__m128i y_upper = _mm_and_si128(_mm_cmpgt_epi8(y, before_a),
+						_mm_cmplt_epi8(y, after_z));
+		x = _mm_or_si128(x, _mm_and_si128(x_upper, case_bit));
+		y = _mm_or_si128(y, _mm_and_si128(y_upper, case_bit));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF)
+			return CRZ_FALSE;
+	}
+#endif // CRZSV_SSE2
+	for (; i + 8 <= len; i += 8) {
+		uint64_t x, y;
+		CRZ_MEMCPY(&x, a + i, sizeof(x));
+		CRZ_MEMCPY(&y, b + i, sizeof(y));
+		if (crzsv_lower64(x) != crzsv_lower64(y))
+			return CRZ_FALSE;
+	}
+	for (; i < len; i++) {
+		if (CRZ_ASCII_LOWER(a[i]) != CRZ_ASCII_LOWER(b[i]))
+			return CRZ_FALSE;
+	}
+	return CRZ_TRUE;
+}
+
+uint64_t crzsv_lower64(uint64_t word)
+{
+	const uint64_t high = 0x8080808080808080ull;
+	const uint64_t ones = 0x0101010101010101ull;
+	uint64_t low = word & ~high;
+
+	// The high bit of each byte is set when its low 7 bits are past 'A'-1,
+	// and when they are past 'Z', without carrying into the next byte
+	uint64_t from_a = low + ones * (0x80 - 'A');
+	uint64_t past_z = low + ones * (0x80 - 'Z' - 1);
+	uint64_t upper = from_a & ~past_z & ~word & high;
+	return word | (upper >> 2);
+}
+
+CRZ_BOOL crzsv_utf8_valid(const char *ptr, CRZ_SIZE len)
+{
+	// Skip leading ASCII, where no code point can start or end
+	CRZ_SIZE i = 0;
+	while (i + 32 <= len && crzsv_is_ascii32(ptr + i))
+		i += 32;
+
+#ifdef CRZSV_SSSE3
+	return crzsv_utf8_valid_ssse3(ptr + i, len - i);
+#else
+	return crzsv_utf8_valid_scalar(ptr + i, len - i);
+#endif // CRZSV_SSSE3
+}
+
+CRZ_BOOL crzsv_utf8_valid_scalar(const char *ptr, CRZ_SIZE len)
+{
+	const unsigned char *bytes = (const unsigned char *)ptr;
+	CRZ_SIZE i = 0;
+	while (i < len) {
+		if (bytes[i] < 0x80) {
+			i++;
+			continue;
+		}
+		uint32_t codepoint;
+		CRZ_SIZE size =
+			crzsv_utf8_decode(bytes + i, len - i, &codepoint);
+		if (size == 0)
+			return CRZ_FALSE;
+		i += size;
+	}
+	return CRZ_TRUE;
+}
+
+#ifdef CRZSV_SSSE3
+// The errors found by looking up the high and low nibbles of each byte
+// and the high nibble of the byte after it, following Keiser and Lemire's
+// "Validating UTF-8 In Less Than One Instruction Per Byte"
+#define CRZSV_TOO_SHORT (1 << 0)
+#define CRZSV_TOO_LONG (1 << 1)
+#define CRZSV_OVERLONG_3 (1 << 2)
+#define CRZSV_TOO_LARGE (1 << 3)
+#define CRZSV_SURROGATE (1 << 4)
+#define CRZSV_OVERLONG_2 (1 << 5)
+#define CRZSV_TOO_LARGE_1000 (1 << 6)
+#define CRZSV_OVERLONG_4 (1 << 6)
+#define CRZSV_TWO_CONTS ((char)(1 << 7))
+#define CRZSV_CARRY (CRZSV_TOO_SHORT | CRZSV_TOO_LONG | CRZSV_TWO_CONTS)
+
+CRZ_BOOL crzsv_utf8_valid_ssse3(const char *ptr, CRZ_SIZE len)
+{
+	const __m128i byte_1_high = _mm_setr_epi8(
+		CRZSV_TOO_LONG, CRZSV_TOO_LONG, CRZSV_TOO_LONG, CRZSV_TOO_LONG,
+		CRZSV_TOO_LONG, CRZSV_TOO_LONG, CRZSV_TOO_LONG, CRZSV_TOO_LONG,
+		CRZSV_TWO_CONTS, CRZSV_TWO_CONTS, CRZSV_TWO_CONTS,
+		CRZSV_TWO_CONTS, CRZSV_TOO_SHORT | CRZSV_OVERLONG_2,
+		CRZSV_TOO_SHORT,
+		CRZSV_TOO_SHORT | CRZSV_OVERLONG_3 | CRZSV_SURROGATE,
+		(char)(CRZSV_TOO_SHORT | CRZSV_TOO_LARGE |
+		       CRZSV_TOO_LARGE_1000 | CRZSV_OVERLONG_4));
+	const char large = CRZSV_CARRY | CRZSV_TOO_LARGE;
+	const char larger = (char)(large | CRZSV_TOO_LARGE_1000);
+	const __m128i byte_1_low = _mm_setr_epi8(
+		(char)(CRZSV_CARRY | CRZSV_OVERLONG_3 | CRZSV_OVERLONG_2 |
+		       CRZSV_OVERLONG_4),
+		(char)(CRZSV_CARRY | CRZSV_OVERLONG_2), (char)CRZSV_CARRY,
+		(char)CRZSV_CARRY, large, larger, larger, larger, larger,
+		larger, larger, larger, larger,
+		(char)(larger | CRZSV_SURROGATE), larger, larger);
+	const char continuation = (char)(CRZSV_TOO_LONG | CRZSV_OVERLONG_2 |
+					 CRZSV_TWO_CONTS);
+	const __m128i byte_2_high = _mm_setr_epi8(
+		CRZSV_TOO_SHORT, CRZSV_TOO_SHORT, CRZSV_TOO_SHORT,
+		CRZSV_TOO_SHORT, CRZSV_TOO_SHORT, CRZSV_TOO_SHORT,
+		CRZSV_TOO_SHORT, CRZSV_TOO_SHORT,
+		(char)(continuation | CRZSV_OVERLONG_3 | CRZSV_TOO_LARGE_1000 |
+		       CRZSV_OVERLONG_4),
+		(char)(continuation | CRZSV_OVERLONG_3 | CRZSV_TOO_LARGE),
+		(char)(continuation | CRZSV_SURROGATE | CRZSV_TOO_LARGE),
+		(char)(continuation | CRZSV_SURROGATE | CRZSV_TOO_LARGE),
+		CRZSV_TOO_SHORT, CRZSV_TOO_SHORT, CRZSV_TOO_SHORT,
+		CRZSV_TOO_SHORT);
+	// The last three bytes of a block may not start a longer sequence
+	const __m128i incomplete_max = _mm_setr_epi8(
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		(char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	const __m128i third_min = _mm_set1_epi8(0xE0 - 0x80);
+	const __m128i fourth_min = _mm_set1_epi8((char)(0xF0 - 0x80));
+
+	__m128i error = _mm_setzero_si128();
+	__m128i previous = _mm_setzero_si128();
+	__m128i incomplete = _mm_setzero_si128();
+
+	// The input is padded with a block of zeros,
+	// which fails any sequence left incomplete at its end
+	for (CRZ_SIZE i = 0; i <= len; i += 16) {
+		__m128i input;
+		if (i + 16 <= len) {
+			input = _mm_loadu_si128((const __m128i *)(ptr + i));
+		} else {
+			char padded[16] = { 0 };
+			CRZ_MEMCPY(padded, ptr + i, len - i);
+			input = _mm_loadu_si128((const __m128i *)padded);
+		}
+
+		if (_mm_movemask_epi8(input) == 0) {
+			error = _mm_or_si128(error, incomplete);
+			incomplete = _mm_setzero_si128();
+			previous = input;
+			continue;
+		}
+
+		__m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+		__m128i high = _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble);
+		__m128i low = _mm_and_si128(prev1, nibble);
+		__m128i next = _mm_and_si128(_mm_srli_epi16(input, 4), nibble);
+		__m128i special =
+			_mm_and_si128(_mm_shuffle_epi8(byte_1_high, high),
+				      _mm_shuffle_epi8(byte_1_low, low));
+		special = _mm_and_si128(special,
+					_mm_shuffle_epi8(byte_2_high, next));
+
+		// The third and fourth bytes of sequences must be
+		// continuations, which the lookups only mark as TWO_CONTS
+		__m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+		__m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+		__m128i third = _mm_subs_epu8(prev2, third_min);
+		__m128i fourth = _mm_subs_epu8(prev3, fourth_min);
+		__m128i must_continue = _mm_and_si128(
+			_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+		error = _mm_or_si128(error,
+				     _mm_xor_si128(must_continue, special));
+
+		incomplete = _mm_subs_epu8(input, incomplete_max);
+		previous = input;
+	}
+
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) ==
+	       0xFFFF;
+}
+#endif // CRZSV_SSSE3
+
+CRZ_BOOL crzsv_is_ascii32(const char *ptr)
+{
+	uint64_t words[4];
+	CRZ_MEMCPY(words, ptr, sizeof(words));
+	return ((words[0] | words[1] | words[2] | words[3]) &
+		0x8080808080808080ull) == 0;
+}
+
+CRZ_SIZE crzsv_utf8_decode(const unsigned char *ptr, CRZ_SIZE len,
+			   uint32_t *codepointp)
+{
+	CRZ_SIZE size;
+	uint32_t codepoint;
+	uint32_t minimum;
+	if (ptr[0] < 0x80) {
+		*codepointp = ptr[0];
+		return 1;
+	} else if ((ptr[0] & 0xE0) == 0xC0) {
+		size = 2;
+		codepoint = ptr[0] & 0x1F;
+		minimum = 0x80;
+	} else if ((ptr[0] & 0xF0) == 0xE0) {
+		size = 3;
+		codepoint = ptr[0] & 0x0F;
+		minimum = 0x800;
+	} else if ((ptr[0] & 0xF8) == 0xF0) {
+		size = 4;
+		codepoint = ptr[0] & 0x07;
+		minimum = 0x10000;
+	} else {
+		return 0;
+	}
+
+	if (len < size)
+		return 0;
+	for (CRZ_SIZE i = 1; i < size; i++) {
+		if ((ptr[i] & 0xC0) != 0x80)
+			return 0;
+		codepoint = (codepoint << 6) | (ptr[i] & 0x3F);
+	}
+
+	// Reject overlong encodings, surrogates, and code points past U+10FFFF
+	if (codepoint < minimum || codepoint > 0x10FFFF ||
+	    (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+		return 0;
+	*codepointp = codepoint;
+	return size;
+}
+
+CRZ_BOOL crzsv_utf8_next(StringView *selfp, uint32_t *codepointp)
+{
+	if (selfp->len == 0)
+		return CRZ_FALSE;
+
+	CRZ_SIZE size = crzsv_utf8_decode((const unsigned char *)selfp->ptr,
+					  selfp->len, codepointp);
+	// Replace each invalid byte on its own
+	if (size == 0) {
+		*codepointp = CRZSV_UTF8_REPLACEMENT;
+		size = 1;
+	}
+	selfp->ptr += size;
+	selfp->len -= size;
+	return CRZ_TRUE;
+}
+
+CRZ_SIZE crzsv_utf8_count(const char *ptr, CRZ_SIZE len)
+{
+	// Every byte but a continuation byte, 10xxxxxx, starts a code point
+	CRZ_SIZE continuations = 0;
+	CRZ_SIZE i = 0;
+	for (; i + 8 <= len; i += 8) {
+		uint64_t word;
+		CRZ_MEMCPY(&word, ptr + i, sizeof(word));
+		continuations += CRZ_POPCOUNT(word & ~(word << 1) &
+					      0x8080808080808080ull);
+	}
+	for (; i < len; i++) {
+		if ((ptr[i] & 0xC0) == 0x80)
+			continuations++;
+	}
+	return len - continuations;
+}
+
 #endif // CRZSV_H_
@@ -0,0 +1,487 @@
+#ifndef CRZWRITER_H_
+#define CRZWRITER_H_
+
+#include "crzarr.h"
+#include "crzdef.h"
+#include "crzsb.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include) && \
+	!defined(CRZWRITER_NO_IO_URING)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define CRZWRITER_IO_URING
+#endif
+#endif
+
+/// INTERNAL: this is one of the buffers of a `Writer`, which is either being filled, written or free.
+///
+/// Once submitted, `sb` is written at `offset` of the file, of which `written` bytes are done.
+typedef struct {
+	StringBuilder sb;
+	int64_t offset;
+	CRZ_SIZE written;
+	CRZ_BOOL in_flight;
+} Crzwriter_Buffer;
+
+#ifdef CRZWRITER_IO_URING
+
+/// INTERNAL: this is the io_uring instance of a `Writer`, with its mapped submission and completion queues.
+typedef struct {
+	int fd;
+	void *rings;
+	CRZ_SIZE rings_size;
+	struct io_uring_sqe *sqes;
+	CRZ_SIZE sqes_size;
+	unsigned *sq_tail;
+	unsigned *sq_array;
+	unsigned sq_mask;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	struct io_uring_cqe *cqes;
+	unsigned cq_mask;
+} Crzwriter_Ring;
+
+#endif // CRZWRITER_IO_URING
+
+/// A writer to a file descriptor which fills one of several `StringBuilder` buffers while the others are written in the background.
+///
+/// Pushing data only copies it into the active buffer; once it is full, the buffer is submitted and the next one becomes active.
+/// If every buffer is still being written, pushing waits for the oldest one, so a slow file holds producers back instead of buffering without bound, and `stalls` counts these waits.
+///
+/// Buffers are written through io_uring when the kernel supports it and the file is seekable and not opened with `O_APPEND`, since they are then written at known offsets, which may complete in any order.
+/// Otherwise, such as for pipes, sockets and append-only logs, a flush thread writes them one after the other.
+/// Define `CRZWRITER_NO_IO_URING` before including `crzwriter.h` to always use the flush thread.
+///
+/// A writer is not thread-safe, so threads sharing one must lock around pushing to it.
+/// It must not be moved once initialized, since its flush thread refers to it.
+typedef struct {
+	int fd;
+	CRZ_SIZE buffer_size;
+	ARRAY(Crzwriter_Buffer) buffers;
+	CRZ_SIZE active;
+	CRZ_SIZE pending;
+	int64_t offset;
+	int error;
+	CRZ_SIZE stalls;
+	CRZ_BOOL uses_ring;
+	CRZ_BOOL closing;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t submitted;
+	pthread_cond_t flushed;
+#ifdef CRZWRITER_IO_URING
+	Crzwriter_Ring ring;
+#endif // CRZWRITER_IO_URING
+} Writer;
+
+/// Properly initialize the writer `selfp` (passed by pointer) to write to the file descriptor `fd`, through `buffer_count` buffers (at least 2) of `buffer_size` bytes each.
+///
+/// There is no `WRITER_NEW`, since the writer may start a flush thread.
+#define WRITER_INIT(selfp, fd, buffer_count, buffer_size) \
+	crzwriter_init((selfp), (fd), (buffer_count), (buffer_size))
+
+/// Push `count_chars` bytes from the buffer `buf` to the writer `selfp` (passed by pointer).
+///
+/// Data larger than a buffer is split over several of them.
+#define WRITER_PUSH_BUF(selfp, buf, count_chars) \
+	crzwriter_push((selfp), (buf), (count_chars))
+
+/// Push the C string `cstr` to the writer `selfp` (passed by pointer).
+#define WRITER_PUSH_CSTR(selfp, cstr) \
+	WRITER_PUSH_BUF(selfp, cstr, CRZ_STRLEN(cstr))
+
+/// Push the contents of the `StringBuilder` `sb` to the writer `selfp` (passed by pointer).
+#define WRITER_PUSH_SB(selfp, sb) WRITER_PUSH_BUF(selfp, (sb).ptr, (sb).len)
+
+/// Submit the active buffer of the writer `selfp` (passed by pointer), and wait until every buffer has been written.
+///
+/// Returns whether every write so far succeeded.
+#define WRITER_FLUSH(selfp) crzwriter_flush(selfp)
+
+/// The `errno` of the first write of the writer `self` which failed, or 0 if none did.
+///
+/// The data of a buffer whose write failed is dropped.
+#define WRITER_ERROR(self) ((self).error)
+
+/// Flush the writer `selfp` (passed by pointer), stop writing in the background, and free its buffers.
+///
+/// The file descriptor is left open, positioned after the written data.
+#define WRITER_FREE(selfp) crzwriter_free(selfp)
+
+/// INTERNAL: this function writes all of `len` bytes from `buf` to `fd`, returning 0 or the `errno` of the failed write.
+int crzwriter_write_all(int fd, const char *buf, CRZ_SIZE len);
+
+/// INTERNAL: this is the body of the flush thread of the writer `arg`.
+void *crzwriter_flush_thread(void *arg);
+
+/// INTERNAL: this function submits the active buffer of `selfp`, and makes the next one active once it is free.
+void crzwriter_submit(Writer *selfp);
+
+/// INTERNAL: this function marks the buffer at `index` of `selfp` as written, keeping `error` if it is the first.
+///           The flush thread calls it with `lock` held.
+void crzwriter_done(Writer *selfp, CRZ_SIZE index, int error);
+
+#ifdef CRZWRITER_IO_URING
+
+/// INTERNAL: this function sets up the io_uring instance `ringp` with room for `entries` writes, returning whether the kernel allows it.
+CRZ_BOOL crzwriter_ring_init(Crzwriter_Ring *ringp, unsigned entries);
+
+/// INTERNAL: this function submits a write of the rest of the buffer at `index` of `selfp` to its ring.
+///           If the ring does not take the write, the buffer is marked as written with the `errno` of the failed submission.
+void crzwriter_ring_write(Writer *selfp, CRZ_SIZE index);
+
+/// INTERNAL: this function handles the completed writes of the ring of `selfp`, waiting for at least one if `wait` is true.
+void crzwriter_ring_reap(Writer *selfp, CRZ_BOOL wait);
+
+/// INTERNAL: this function unmaps and closes the ring `ringp`.
+void crzwriter_ring_free(Crzwriter_Ring *ringp);
+
+#endif // CRZWRITER_IO_URING
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `WRITER_INIT(selfp, fd, buffer_count, buffer_size)` instead.
+void crzwriter_init(Writer *selfp, int fd, CRZ_SIZE buffer_count,
+		    CRZ_SIZE buffer_size);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `WRITER_PUSH_BUF(selfp, buf, count_chars)` instead.
+void crzwriter_push(Writer *selfp, const void *buf, CRZ_SIZE len);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `WRITER_FLUSH(selfp)` instead.
+CRZ_BOOL crzwriter_flush(Writer *selfp);
+
+/// INTERNAL: you most likely don't want to use this.
+///           Try `WRITER_FREE(selfp)` instead.
+void crzwriter_free(Writer *selfp);
+
+int crzwriter_write_all(int fd, const char *buf, CRZ_SIZE len)
+{
+	CRZ_SIZE written = 0;
+	while (written < len) {
+		ssize_t result = write(fd, buf + written, len - written);
+		if (result < 0 && errno == EINTR)
+			continue;
+		if (result < 0)
+			return errno;
+		written += (CRZ_SIZE)result;
+	}
+	return 0;
+}
+
+void *crzwriter_flush_thread(void *arg)
+{
+	Writer *selfp = arg;
+	CRZ_SIZE next = 0;
+	pthread_mutex_lock(&selfp->lock);
+	for (;;) {
+		// Buffers are submitted in turn, so they are written in turn
+		Crzwriter_Buffer *buffer = &selfp->buffers.ptr[next];
+		while (!buffer->in_flight && !selfp->closing)
+			pthread_cond_wait(&selfp->submitted, &selfp->lock);
+		if (!buffer->in_flight)
+			break;
+
+		pthread_mutex_unlock(&selfp->lock);
+		int error = crzwriter_write_all(selfp->fd, buffer->sb.ptr,
+						buffer->sb.len);
+		pthread_mutex_lock(&selfp->lock);
+		crzwriter_done(selfp, next, error);
+		pthread_cond_broadcast(&selfp->flushed);
+		next = (next + 1) % selfp->buffers.len;
+	}
+	pthread_mutex_unlock(&selfp->lock);
+	return CRZ_NULL;
+}
+
+void crzwriter_done(Writer *selfp, CRZ_SIZE index, int error)
+{
+	Crzwriter_Buffer *buffer = &selfp->buffers.ptr[index];
+	if (error && !selfp->error)
+		selfp->error = error;
+	buffer->sb.len = 0;
+	buffer->in_flight = CRZ_FALSE;
+	selfp->pending--;
+}
+
+void crzwriter_submit(Writer *selfp)
+{
+	Crzwriter_Buffer *buffer = &selfp->buffers.ptr[selfp->active];
+	buffer->offset = selfp->offset;
+	buffer->written = 0;
+	selfp->offset += (int64_t)buffer->sb.len;
+	selfp->active = (selfp->active + 1) % selfp->buffers.len;
+	Crzwriter_Buffer *next = &selfp->buffers.ptr[selfp->active];
+
+#ifdef CRZWRITER_IO_URING
+	if (selfp->uses_ring) {
+		buffer->in_flight = CRZ_TRUE;
+		selfp->pending++;
+		crzwriter_ring_write(selfp,
+				     (CRZ_SIZE)(buffer - selfp->buffers.ptr));
+		crzwriter_ring_reap(selfp, CRZ_FALSE);
+		selfp->stalls += next->in_flight;
+		while (next->in_flight)
+			crzwriter_ring_reap(selfp, CRZ_TRUE);
+		return;
+	}
+#endif // CRZWRITER_IO_URING
+
+	pthread_mutex_lock(&selfp->lock);
+	buffer->in_flight = CRZ_TRUE;
+	selfp->pending++;
+	pthread_cond_signal(&selfp->submitted);
+	selfp->stalls += next->in_flight;
+	while (next->in_flight)
+		pthread_cond_wait(&selfp->flushed, &selfp->lock);
+	pthread_mutex_unlock(&selfp->lock);
+}
+
+#ifdef CRZWRITER_IO_URING
+
+CRZ_BOOL crzwriter_ring_init(Crzwriter_Ring *ringp, unsigned entries)
+{
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	ringp->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+	if (ringp->fd < 0)
+		return CRZ_FALSE;
+	// `IORING_OP_WRITE` came along with `IORING_FEAT_RW_CUR_POS`, so older
+	// kernels are left to the flush thread
+	unsigned needed = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_RW_CUR_POS;
+	if ((params.features & needed) != needed) {
+		close(ringp->fd);
+		return CRZ_FALSE;
+	}
+
+	CRZ_SIZE sq_size = params.sq_off.array +
+			   params.sq_entries * sizeof(unsigned);
+	CRZ_SIZE cq_size = params.cq_off.cqes +
+			   params.cq_entries * sizeof(struct io_uring_cqe);
+	ringp->rings_size = sq_size > cq_size ? sq_size : cq_size;
+	ringp->rings = mmap(CRZ_NULL, ringp->rings_size,
+			    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			    ringp->fd, IORING_OFF_SQ_RING);
+	if (ringp->rings == MAP_FAILED) {
+		close(ringp->fd);
+		return CRZ_FALSE;
+	}
+	ringp->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ringp->sqes = mmap(CRZ_NULL, ringp->sqes_size, PROT_READ | PROT_WRITE,
+			   MAP_SHARED | MAP_POPULATE, ringp->fd,
+			   IORING_OFF_SQES);
+	if (ringp->sqes == MAP_FAILED) {
+		munmap(ringp->rings, ringp->rings_size);
+		close(ringp->fd);
+		return CRZ_FALSE;
+	}
+
+	char *rings = ringp->rings;
+	ringp->sq_tail = (unsigned *)(rings + params.sq_off.tail);
+	ringp->sq_array = (unsigned *)(rings + params.sq_off.array);
+	ringp->sq_mask = *(unsigned *)(rings + params.sq_off.ring_mask);
+	ringp->cq_head = (unsigned *)(rings + params.cq_off.head);
+	ringp->cq_tail = (unsigned *)(rings + params.cq_off.tail);
+	ringp->cqes = (struct io_uring_cqe *)(rings + params.cq_off.cqes);
+	ringp->cq_mask = *(unsigned *)(rings + params.cq_off.ring_mask);
+	return CRZ_TRUE;
+}
+
+void crzwriter_ring_write(Writer *selfp, CRZ_SIZE index)
+{
+	Crzwriter_Ring *ringp = &selfp->ring;
+	Crzwriter_Buffer *buffer = &selfp->buffers.ptr[index];
+
+	// There are at most as many writes as buffers, and the ring has room
+	// for all of them
+	unsigned tail = *ringp->sq_tail;
+	unsigned slot = tail & ringp->sq_mask;
+	struct io_uring_sqe *sqe = &ringp->sqes[slot];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_WRITE;
+	sqe->fd = selfp->fd;
+	sqe->addr = (uint64_t)(uintptr_t)(buffer->sb.ptr + buffer->written);
+	sqe->len = (uint32_t)(buffer->sb.len - buffer->written);
+	sqe->off = (uint64_t)(buffer->offset + (int64_t)buffer->written);
+	sqe->user_data = index;
+	ringp->sq_array[slot] = slot;
+	atomic_store_explicit((_Atomic unsigned *)ringp->sq_tail, tail + 1,
+			      memory_order_release);
+
+	long submitted;
+	do {
+		submitted = syscall(__NR_io_uring_enter, ringp->fd, 1, 0, 0,
+				    CRZ_NULL, 0);
+	} while (submitted < 0 && (errno == EINTR || errno == EAGAIN));
+	if (submitted != 1) {
+		// The kernel did not take the write, so take it back rather
+		// than leaving it to be submitted along with a later one, and
+		// report it as failed, as for a failed completion
+		int error = submitted < 0 ? errno : EIO;
+		atomic_store_explicit((_Atomic unsigned *)ringp->sq_tail, tail,
+				      memory_order_release);
+		crzwriter_done(selfp, index, error);
+	}
+}
+
+void crzwriter_ring_reap(Writer *selfp, CRZ_BOOL wait)
+{
+	Crzwriter_Ring *ringp = &selfp->ring;
+	if (wait) {
+		while (syscall(__NR_io_uring_enter, ringp->fd, 0, 1,
+			       IORING_ENTER_GETEVENTS, CRZ_NULL, 0) < 0 &&
+		       errno == EINTR)
+			;
+	}
+
+	unsigned head = *ringp->cq_head;
+	unsigned tail = atomic_load_explicit((_Atomic unsigned *)ringp->cq_tail,
+					     memory_order_acquire);
+	for (; head != tail; head++) {
+		struct io_uring_cqe *cqe = &ringp->cqes[head & ringp->cq_mask];
+		CRZ_SIZE index = (CRZ_SIZE)cqe->user_data;
+		Crzwriter_Buffer *buffer = &selfp->buffers.ptr[index];
+		int result = cqe->res;
+
+		if (result == -EINTR || result == -EAGAIN) {
+			crzwriter_ring_write(selfp, index);
+			continue;
+		}
+		if (result <= 0) {
+			// Writing nothing at all would retry forever
+			int error = result < 0 ? -result : EIO;
+			crzwriter_done(selfp, index, error);
+			continue;
+		}
+		buffer->written += (CRZ_SIZE)result;
+		if (buffer->written < buffer->sb.len)
+			crzwriter_ring_write(selfp, index);
+		else
+			crzwriter_done(selfp, index, 0);
+	}
+	atomic_store_explicit((_Atomic unsigned *)ringp->cq_head, head,
+			      memory_order_release);
+}
+
+void crzwriter_ring_free(Crzwriter_Ring *ringp)
+{
+	munmap(ringp->sqes, ringp->sqes_size);
+	munmap(ringp->rings, ringp->rings_size);
+	close(ringp->fd);
+}
+
+#endif // CRZWRITER_IO_URING
+
+void crzwriter_init(Writer *selfp, int fd, CRZ_SIZE buffer_count,
+		    CRZ_SIZE buffer_size)
+{
+	CRZ_ASSERT(buffer_count >= 2 && "A writer needs at least 2 buffers");
+	CRZ_ASSERT(buffer_size > 0 && buffer_size <= UINT32_MAX &&
+		   "Invalid buffer size for writer");
+	memset(selfp, 0, sizeof(*selfp));
+	selfp->fd = fd;
+	selfp->buffer_size = buffer_size;
+	for (CRZ_SIZE i = 0; i < buffer_count; i++) {
+		// Each buffer is allocated once, so pushing never grows it
+		Crzwriter_Buffer buffer = { .sb = SB_NEW() };
+		crzarr_grow_to((Crzarr_AnyArray *)&buffer.sb, buffer_size, 1);
+		ARRAY_PUSH(&selfp->buffers, buffer);
+	}
+
+#ifdef CRZWRITER_IO_URING
+	off_t offset = lseek(fd, 0, SEEK_CUR);
+	int flags = fcntl(fd, F_GETFL);
+	if (offset >= 0 && flags >= 0 && !(flags & O_APPEND) &&
+	    crzwriter_ring_init(&selfp->ring, (unsigned)buffer_count)) {
+		selfp->uses_ring = CRZ_TRUE;
+		selfp->offset = offset;
+		return;
+	}
+#endif // CRZWRITER_IO_URING
+
+	pthread_mutex_init(&selfp->lock, CRZ_NULL);
+	pthread_cond_init(&selfp->submitted, CRZ_NULL);
+	pthread_cond_init(&selfp->flushed, CRZ_NULL);
+	int created = pthread_create(&selfp->thread, CRZ_NULL,
+				     crzwriter_flush_thread, selfp);
+	CRZ_ASSERT(created == 0 && "Could not create flush thread for writer");
+	(void)created;
+}
+
+void crzwriter_push(Writer *selfp, const void *buf, CRZ_SIZE len)
+{
+	const char *bytes = buf;
+	while (len > 0) {
+		StringBuilder *sb = &selfp->buffers.ptr[selfp->active].sb;
+		CRZ_SIZE room = selfp->buffer_size - sb->len;
+		CRZ_SIZE amount = len < room ? len : room;
+		CRZ_MEMCPY(sb->ptr + sb->len, bytes, amount);
+		sb->len += amount;
+		bytes += amount;
+		len -= amount;
+		if (sb->len == selfp->buffer_size)
+			crzwriter_submit(selfp);
+	}
+}
+
+CRZ_BOOL crzwriter_flush(Writer *selfp)
+{
+	if (selfp->buffers.ptr[selfp->active].sb.len > 0)
+		crzwriter_submit(selfp);
+
+#ifdef CRZWRITER_IO_URING
+	if (selfp->uses_ring) {
+		while (selfp->pending > 0)
+			crzwriter_ring_reap(selfp, CRZ_TRUE);
+		return selfp->error == 0;
+	}
+#endif // CRZWRITER_IO_URING
+
+	pthread_mutex_lock(&selfp->lock);
+	while (selfp->pending > 0)
+		pthread_cond_wait(&selfp->flushed, &selfp->lock);
+	CRZ_BOOL ok = selfp->error == 0;
+	pthread_mutex_unlock(&selfp->lock);
+	return ok;
+}
+
+void crzwriter_free(Writer *selfp)
+{
+	crzwriter_flush(selfp);
+
+#ifdef CRZWRITER_IO_URING
+	if (selfp->uses_ring) {
+		// Writes at offsets leave the position of the file alone
+		lseek(selfp->fd, (off_t)selfp->offset, SEEK_SET);
+		crzwriter_ring_free(&selfp->ring);
+	}
+#endif // CRZWRITER_IO_URING
+
+	if (!selfp->uses_ring) {
+		pthread_mutex_lock(&selfp->lock);
+		selfp->closing = CRZ_TRUE;
+		pthread_cond_signal(&selfp->submitted);
+		pthread_mutex_unlock(&selfp->lock);
+		pthread_join(selfp->thread, CRZ_NULL);
+		pthread_mutex_destroy(&selfp->lock);
+		pthread_cond_destroy(&selfp->submitted);
+		pthread_cond_destroy(&selfp->flushed);
+	}
+
+	for (CRZ_SIZE i = 0; i < selfp->buffers.len; i++)
+		SB_FREE(&selfp->buffers.ptr[i].sb);
+	ARRAY_FREE(&selfp->buffers);
+	selfp->active = 0;
+	selfp->pending = 0;
+}
+
+#endif // CRZWRITER_H_
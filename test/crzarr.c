@@ -10,13 +10,17 @@
 #define SIZEOF_CONTENTSP 3
 static int contentsp[SIZEOF_CONTENTSP] = { 1, 2, 3 };
 
+DEFINE_ARRAY(IntArray, int)
+
 static ARRAY(int) a = ARRAY_NEW();
 static ARRAY(int) b = ARRAY_NEW();
+static IntArray typed = ARRAY_NEW();
 
 void cleanup(void)
 {
 	ARRAY_FREE(&a);
 	ARRAY_FREE(&b);
+	IntArray_free(&typed);
 }
 
 TEST_MAIN({
@@ -190,4 +194,63 @@ TEST_MAIN({
 			}
 		});
 	});
+
+	DESCRIBE("DEFINE_ARRAY", {
+		TEST("Pushing, getting and popping", {
+			// Act
+			for (int i = 0; i < 20; i++)
+				IntArray_push(&typed, i);
+			int popped = IntArray_pop(&typed);
+
+			// Assert
+			EXPECT(popped == 19);
+			EXPECT(typed.len == 19 && typed.cap >= 19);
+			EXPECT(IntArray_get(&typed, 7) == 7);
+		});
+
+		TEST("Reserving capacity", {
+			// Act
+			IntArray_reserve(&typed, 100);
+
+			// Assert
+			EXPECT(typed.len == 0 && typed.cap >= 100);
+		});
+
+		TEST("Splicing as adding and removing", {
+			// Arrange
+			IntArray_insert(&typed, 0, contentsp, SIZEOF_CONTENTSP);
+
+			// Act
+			IntArray_splice(&typed, 1, 1, contentsp,
+					SIZEOF_CONTENTSP);
+
+			// Assert
+			int *target = ((int[]){ 1, 1, 2, 3, 3 });
+			EXPECT(typed.len == 5);
+			ARRAY_FOR(typed, i) {
+				EXPECT(IntArray_get(&typed, i) == target[i]);
+			}
+		});
+
+		TEST("Removing elements", {
+			// Arrange
+			IntArray_insert(&typed, 0, contentsp, SIZEOF_CONTENTSP);
+
+			// Act
+			IntArray_remove(&typed, 0, 2);
+
+			// Assert
+			EXPECT(typed.len == 1 && IntArray_get(&typed, 0) == 3);
+		});
+
+		TEST("Mixing with the ARRAY_* macros", {
+			// Act
+			ARRAY_PUSH_MANY(&typed, contentsp, SIZEOF_CONTENTSP);
+			IntArray_push(&typed, 4);
+
+			// Assert
+			EXPECT(typed.len == 4);
+			EXPECT(ARRAY_GET(typed, 3) == 4);
+		});
+	});
 })
@@ -0,0 +1,350 @@
+#include "crzart.h"
+#include "crztest.h"
+
+#define COUNT 3000
+#define KEY_SIZE 32
+
+static Art tree;
+static char keys[COUNT][KEY_SIZE];
+
+static StringView key(int i)
+{
+	return SV_FROM_CSTR(keys[i]);
+}
+
+static int value_at(const char *cstr)
+{
+	const int *value = ART_GET(tree, SV_FROM_CSTR(cstr));
+	return value ? *value : -1;
+}
+
+static void insert(const char *cstr, int value)
+{
+	ART_INSERT(&tree, SV_FROM_CSTR(cstr), &value);
+}
+
+// Inserts the first `count` keys, each valued by its index
+static void fill(int count)
+{
+	for (int i = 0; i < count; i++)
+		ART_INSERT(&tree, key(i), &i);
+}
+
+// Whether every key below `count` is valued by its index, except for removed
+// ones
+static CRZ_BOOL holds(int count, int removed_every)
+{
+	for (int i = 0; i < count; i++) {
+		const int *value = ART_GET(tree, key(i));
+		CRZ_BOOL removed = removed_every && i % removed_every == 0;
+		if (removed ? value != CRZ_NULL : !value || *value != i)
+			return CRZ_FALSE;
+	}
+	return CRZ_TRUE;
+}
+
+// The value of the longest key prefixing `search`, or -1 if there is none
+static int longest(const char *search)
+{
+	const int *value = ART_LONGEST_PREFIX(tree, SV_FROM_CSTR(search),
+					      CRZ_NULL);
+	return value ? *value : -1;
+}
+
+// Whether the keys starting with `prefix` are iterated in increasing order,
+// with `count` of them
+static CRZ_BOOL iterates_in_order(const char *prefix, CRZ_SIZE count)
+{
+	CRZ_SIZE seen = 0;
+	StringView last = SV_FROM_CSTR("");
+	StringView start = SV_FROM_CSTR(prefix);
+	ART_FOR_PREFIX(tree, start, iter)
+	{
+		if (seen > 0 && SV_CMP(last, iter.key) >= 0)
+			return CRZ_FALSE;
+		if (iter.key.len < start.len ||
+		    CRZ_MEMCMP(iter.key.ptr, start.ptr, start.len) != 0)
+			return CRZ_FALSE;
+		if (*(int *)ART_GET(tree, iter.key) != *(int *)iter.value)
+			return CRZ_FALSE;
+		last = iter.key;
+		seen++;
+	}
+	return seen == count;
+}
+
+// Every single-byte key, forcing the root to grow to a `CRZART_NODE256`
+static char bytes[256][2];
+
+static void fill_bytes(void)
+{
+	for (int i = 0; i < 256; i++) {
+		bytes[i][0] = (char)i;
+		ART_INSERT(&tree, SV_FROM_BUF(bytes[i], 1), &i);
+	}
+}
+
+static CRZ_BOOL holds_bytes(int removed_below)
+{
+	for (int i = 0; i < 256; i++) {
+		const int *value = ART_GET(tree, SV_FROM_BUF(bytes[i], 1));
+		CRZ_BOOL removed = i < removed_below;
+		if (removed ? value != CRZ_NULL : !value || *value != i)
+			return CRZ_FALSE;
+	}
+	return CRZ_TRUE;
+}
+
+void reset(void)
+{
+	tree = ART_NEW(int);
+	for (int i = 0; i < COUNT; i++) {
+		// Paths sharing long prefixes, with keys prefixing others
+		CRZ_SPRINTF(keys[i], "/api/v%d/users/%d", i % 3, i / 3);
+	}
+}
+
+void cleanup(void)
+{
+	ART_FREE(&tree);
+}
+
+TEST_MAIN({
+	BEFORE_EACH(reset);
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("ART_INSERT", {
+		TEST("Getting inserted keys", {
+			// Act
+			fill(COUNT);
+
+			// Assert
+			EXPECT(tree.len == COUNT);
+			EXPECT(holds(COUNT, 0));
+			EXPECT(value_at("/api/v0/users/") == -1);
+			EXPECT(value_at("/api/v0/users/10000") == -1);
+			EXPECT(value_at("/api") == -1);
+		});
+
+		TEST("Overwriting a key", {
+			// Arrange
+			fill(10);
+			int value = 42;
+
+			// Act
+			CRZ_BOOL inserted = ART_INSERT(&tree, key(5), &value);
+
+			// Assert
+			EXPECT(!inserted);
+			EXPECT(tree.len == 10);
+			EXPECT(*(int *)ART_GET(tree, key(5)) == 42);
+		});
+
+		TEST("Inserting keys which prefix each other", {
+			// Act
+			insert("/a/b/c", 3);
+			insert("/a", 1);
+			insert("/a/b", 2);
+			insert("", 0);
+
+			// Assert
+			EXPECT(tree.len == 4);
+			EXPECT(value_at("") == 0);
+			EXPECT(value_at("/a") == 1);
+			EXPECT(value_at("/a/b") == 2);
+			EXPECT(value_at("/a/b/c") == 3);
+			EXPECT(value_at("/a/") == -1);
+		});
+
+		TEST("Splitting prefixes longer than the stored bytes", {
+			// Act
+			insert("/a/very/long/shared/prefix/one", 1);
+			insert("/a/very/long/shared/prefix/two", 2);
+			insert("/a/very/long/other", 3);
+			insert("/a/very/long/shared/prefix/t", 4);
+
+			// Assert
+			EXPECT(value_at("/a/very/long/shared/prefix/one") == 1);
+			EXPECT(value_at("/a/very/long/shared/prefix/two") == 2);
+			EXPECT(value_at("/a/very/long/other") == 3);
+			EXPECT(value_at("/a/very/long/shared/prefix/t") == 4);
+			EXPECT(value_at("/a/very/LONG/shared/prefix/one") ==
+			       -1);
+		});
+
+		TEST("Growing a node to every byte", {
+			// Act
+			fill_bytes();
+
+			// Assert
+			EXPECT(tree.len == 256);
+			EXPECT(crzart_kind(tree.root) == CRZART_NODE256);
+			EXPECT(holds_bytes(0));
+			EXPECT(tree.pools[CRZART_NODE256].chunks.len == 1);
+			EXPECT(tree.pools[CRZART_NODE256].chunk_len ==
+			       CRZART_POOL_CHUNK256);
+		});
+	});
+
+	DESCRIBE("ART_REMOVE", {
+		TEST("Removing keys", {
+			// Arrange
+			fill(COUNT);
+
+			// Act
+			CRZ_BOOL removed = CRZ_TRUE;
+			for (int i = 0; i < COUNT; i += 7)
+				removed = removed && ART_REMOVE(&tree, key(i));
+
+			// Assert
+			EXPECT(removed);
+			EXPECT(tree.len == COUNT - (COUNT + 6) / 7);
+			EXPECT(holds(COUNT, 7));
+			EXPECT(!ART_REMOVE(&tree, key(0)));
+			EXPECT(!ART_REMOVE(&tree, SV_FROM_CSTR("/api")));
+		});
+
+		TEST("Removing every key", {
+			// Arrange
+			fill(COUNT);
+
+			// Act
+			for (int i = COUNT - 1; i >= 0; i--)
+				ART_REMOVE(&tree, key(i));
+
+			// Assert
+			EXPECT(tree.len == 0);
+			EXPECT(tree.root == CRZ_NULL);
+		});
+
+		TEST("Removing a key which prefixes others", {
+			// Arrange
+			insert("/a", 1);
+			insert("/a/b", 2);
+			insert("/a/c", 3);
+
+			// Act
+			CRZ_BOOL removed =
+				ART_REMOVE(&tree, SV_FROM_CSTR("/a"));
+
+			// Assert
+			EXPECT(removed);
+			EXPECT(value_at("/a") == -1);
+			EXPECT(value_at("/a/b") == 2);
+			EXPECT(value_at("/a/c") == 3);
+		});
+
+		TEST("Merging nodes left with one child", {
+			// Arrange
+			insert("/a/very/long/shared/prefix/one", 1);
+			insert("/a/very/long/shared/prefix/two", 2);
+			insert("/a/very/long/other", 3);
+
+			// Act
+			ART_REMOVE(&tree, SV_FROM_CSTR("/a/very/long/other"));
+			insert("/a/very/long/shared/prefix/three", 4);
+
+			// Assert
+			EXPECT(value_at("/a/very/long/shared/prefix/one") == 1);
+			EXPECT(value_at("/a/very/long/shared/prefix/two") == 2);
+			EXPECT(value_at("/a/very/long/shared/prefix/three") ==
+			       4);
+			EXPECT(value_at("/a/very/long/other") == -1);
+		});
+
+		TEST("Shrinking a node as its children are removed", {
+			// Arrange
+			fill_bytes();
+
+			// Act
+			for (int i = 0; i < 254; i++)
+				ART_REMOVE(&tree, SV_FROM_BUF(bytes[i], 1));
+
+			// Assert
+			EXPECT(crzart_kind(tree.root) == CRZART_NODE4);
+			EXPECT(holds_bytes(254));
+		});
+	});
+
+	DESCRIBE("ART_LONGEST_PREFIX", {
+		TEST("Matching the longest route of a path", {
+			// Arrange
+			insert("/", 0);
+			insert("/api", 1);
+			insert("/api/v1", 2);
+			insert("/api/v1/users", 3);
+			insert("/static/", 4);
+
+			// Assert
+			EXPECT(longest("/api/v1/users/42") == 3);
+			EXPECT(longest("/api/v1/orders") == 2);
+			EXPECT(longest("/api/v2") == 1);
+			EXPECT(longest("/api") == 1);
+			EXPECT(longest("/static") == 0);
+			EXPECT(longest("/static/app.js") == 4);
+			EXPECT(longest("api") == -1);
+		});
+
+		TEST("Getting the matched key", {
+			// Arrange
+			insert("/a/very/long/shared/prefix/one", 1);
+			insert("/a/very/long/shared/prefix/two", 2);
+			StringView route =
+				SV_FROM_CSTR("/a/very/long/shared/prefix/two");
+			StringView search = SV_FROM_CSTR("/a/very/long/shared/"
+							 "prefix/two/x");
+			StringView matched = SV_FROM_CSTR("");
+
+			// Act
+			const int *value =
+				ART_LONGEST_PREFIX(tree, search, &matched);
+
+			// Assert
+			EXPECT(value && *value == 2);
+			EXPECT(SV_EQ(matched, route));
+			EXPECT(longest("/a/very/long/shared/prefix/tw") == -1);
+			EXPECT(longest("/a/very/LONG/shared/prefix/two") == -1);
+		});
+	});
+
+	DESCRIBE("ART_FOR_PREFIX", {
+		TEST("Iterating over every key in order", {
+			// Arrange
+			fill(COUNT);
+
+			// Assert
+			EXPECT(iterates_in_order("", COUNT));
+		});
+
+		TEST("Iterating over the keys with a prefix in order", {
+			// Arrange
+			fill(COUNT);
+
+			// Assert
+			EXPECT(iterates_in_order("/api/v1/", COUNT / 3));
+			// users/1, users/10 to 19 and users/100 to 199
+			EXPECT(iterates_in_order("/api/v2/users/1", 111));
+			EXPECT(iterates_in_order("/api/v2/users/999", 1));
+			EXPECT(iterates_in_order("/api/v2/users/9999", 0));
+			EXPECT(iterates_in_order("/api/v3", 0));
+		});
+
+		TEST("Iterating over keys which prefix each other", {
+			// Arrange
+			insert("/a/b", 2);
+			insert("/a", 1);
+			insert("/a/b/c", 3);
+			insert("/b", 4);
+
+			// Assert
+			EXPECT(iterates_in_order("/a", 3));
+			EXPECT(iterates_in_order("/a/b", 2));
+			EXPECT(iterates_in_order("", 4));
+		});
+
+		TEST("Iterating over an empty tree", {
+			// Assert
+			EXPECT(iterates_in_order("", 0));
+		});
+	});
+})
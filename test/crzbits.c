@@ -0,0 +1,279 @@
+#include "crzbits.h"
+#include "crztest.h"
+
+static Bitset a = BITSET_NEW();
+static Bitset b = BITSET_NEW();
+static Roaring ra = ROARING_NEW();
+static Roaring rb = ROARING_NEW();
+static Roaring out = ROARING_NEW();
+
+// Whether the builtins and their fallbacks agree on words with a single bit
+// set, and on words with every bit up to it set
+static CRZ_BOOL fallbacks_agree(void)
+{
+	for (int i = 0; i < 64; i++) {
+		uint64_t bit = 1ull << i;
+		uint64_t below = bit | (bit - 1);
+		if (CRZ_CTZ(bit) != crzdef_ctz_fallback(bit) ||
+		    CRZ_CLZ(bit) != crzdef_clz_fallback(bit) ||
+		    CRZ_CLZ(below) != crzdef_clz_fallback(below) ||
+		    CRZ_POPCOUNT(below) != crzdef_popcount_fallback(below))
+			return CRZ_FALSE;
+	}
+	return CRZ_TRUE;
+}
+
+void cleanup(void)
+{
+	BITSET_FREE(&a);
+	BITSET_FREE(&b);
+	ROARING_FREE(&ra);
+	ROARING_FREE(&rb);
+	ROARING_FREE(&out);
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("CRZBITS_POPCOUNT", {
+		TEST("Counting bits as the fallbacks do", {
+			// Assert
+			EXPECT(CRZBITS_POPCOUNT(~0ull) == 64);
+			EXPECT(CRZBITS_CTZ(1ull << 63) == 63);
+			EXPECT(CRZBITS_CLZ(1) == 63);
+			EXPECT(fallbacks_agree());
+		});
+	});
+
+	DESCRIBE("BITSET_SET", {
+		TEST("Setting bits grows the bitset", {
+			// Act
+			BITSET_SET(&a, 3);
+			BITSET_SET(&a, 200);
+
+			// Assert
+			EXPECT(a.len == 4);
+			EXPECT(BITSET_TEST(a, 3));
+			EXPECT(BITSET_TEST(a, 200));
+			EXPECT(!BITSET_TEST(a, 4));
+			EXPECT(!BITSET_TEST(a, 100000));
+			EXPECT(BITSET_COUNT(a) == 2);
+		});
+
+		TEST("Clearing bits", {
+			// Arrange
+			BITSET_SET(&a, 3);
+			BITSET_SET(&a, 64);
+
+			// Act
+			BITSET_CLEAR(&a, 3);
+			BITSET_CLEAR(&a, 100000);
+
+			// Assert
+			EXPECT(!BITSET_TEST(a, 3));
+			EXPECT(BITSET_TEST(a, 64));
+			EXPECT(BITSET_COUNT(a) == 1);
+		});
+	});
+
+	DESCRIBE("BITSET_NEXT", {
+		TEST("Finding set bits across words", {
+			// Arrange
+			BITSET_SET(&a, 0);
+			BITSET_SET(&a, 63);
+			BITSET_SET(&a, 64);
+			BITSET_SET(&a, 300);
+
+			// Act
+			CRZ_SIZE found[4];
+			CRZ_SIZE count = 0;
+			BITSET_FOR(a, bit) {
+				found[count++] = bit;
+			}
+
+			// Assert
+			EXPECT(count == 4);
+			EXPECT(found[0] == 0 && found[1] == 63);
+			EXPECT(found[2] == 64 && found[3] == 300);
+			EXPECT(BITSET_NEXT(a, 65) == 300);
+			EXPECT(BITSET_NEXT(a, 301) == CRZBITS_NONE);
+		});
+	});
+
+	DESCRIBE("BITSET_AND", {
+		TEST("Combining bitsets of different lengths", {
+			// Arrange
+			BITSET_SET(&a, 1);
+			BITSET_SET(&a, 2);
+			BITSET_SET(&a, 500);
+			BITSET_SET(&b, 2);
+			BITSET_SET(&b, 3);
+
+			// Act
+			BITSET_AND(&a, b);
+
+			// Assert
+			EXPECT(BITSET_COUNT(a) == 1);
+			EXPECT(BITSET_TEST(a, 2));
+		});
+	});
+
+	DESCRIBE("BITSET_OR", {
+		TEST("Growing to the longer bitset", {
+			// Arrange
+			BITSET_SET(&a, 1);
+			BITSET_SET(&b, 2);
+			BITSET_SET(&b, 500);
+
+			// Act
+			BITSET_OR(&a, b);
+
+			// Assert
+			EXPECT(BITSET_COUNT(a) == 3);
+			EXPECT(BITSET_TEST(a, 500));
+		});
+	});
+
+	DESCRIBE("BITSET_XOR", {
+		TEST("Keeping bits set in only one bitset", {
+			// Arrange
+			BITSET_SET(&a, 1);
+			BITSET_SET(&a, 2);
+			BITSET_SET(&b, 2);
+			BITSET_SET(&b, 3);
+
+			// Act
+			BITSET_XOR(&a, b);
+
+			// Assert
+			EXPECT(BITSET_COUNT(a) == 2);
+			EXPECT(BITSET_TEST(a, 1) && BITSET_TEST(a, 3));
+		});
+	});
+
+	DESCRIBE("BITSET_ANDNOT", {
+		TEST("Clearing bits set in the other bitset", {
+			// Arrange
+			BITSET_SET(&a, 1);
+			BITSET_SET(&a, 2);
+			BITSET_SET(&b, 2);
+
+			// Act
+			BITSET_ANDNOT(&a, b);
+
+			// Assert
+			EXPECT(BITSET_COUNT(a) == 1);
+			EXPECT(BITSET_TEST(a, 1));
+		});
+	});
+
+	DESCRIBE("ROARING_ADD", {
+		TEST("Adding sparse values", {
+			// Act
+			ROARING_ADD(&ra, 7);
+			ROARING_ADD(&ra, 1u << 20);
+			ROARING_ADD(&ra, 0xffffffffu);
+			ROARING_ADD(&ra, 7);
+
+			// Assert
+			EXPECT(ra.len == 3);
+			EXPECT(ROARING_COUNT(ra) == 3);
+			EXPECT(ROARING_CONTAINS(ra, 7));
+			EXPECT(ROARING_CONTAINS(ra, 1u << 20));
+			EXPECT(ROARING_CONTAINS(ra, 0xffffffffu));
+			EXPECT(!ROARING_CONTAINS(ra, 8));
+		});
+
+		TEST("Converting a dense container to a bitmap and back", {
+			// Act
+			for (uint32_t i = 0; i <= CRZBITS_ARRAY_MAX; i++)
+				ROARING_ADD(&ra, i * 2);
+			CRZ_BOOL was_bitmap = ra.ptr[0].bitmap != CRZ_NULL;
+			ROARING_REMOVE(&ra, 0);
+
+			// Assert
+			EXPECT(was_bitmap);
+			EXPECT(ra.ptr[0].bitmap == CRZ_NULL);
+			EXPECT(ROARING_COUNT(ra) == CRZBITS_ARRAY_MAX);
+			EXPECT(!ROARING_CONTAINS(ra, 0));
+			EXPECT(ROARING_CONTAINS(ra, 2));
+			EXPECT(!ROARING_CONTAINS(ra, 3));
+			EXPECT(ROARING_CONTAINS(ra, CRZBITS_ARRAY_MAX * 2));
+		});
+	});
+
+	DESCRIBE("ROARING_REMOVE", {
+		TEST("Removing the last value of a container", {
+			// Arrange
+			ROARING_ADD(&ra, 1);
+			ROARING_ADD(&ra, 1u << 20);
+
+			// Act
+			ROARING_REMOVE(&ra, 1);
+			ROARING_REMOVE(&ra, 2);
+
+			// Assert
+			EXPECT(ra.len == 1);
+			EXPECT(ROARING_COUNT(ra) == 1);
+			EXPECT(!ROARING_CONTAINS(ra, 1));
+		});
+	});
+
+	DESCRIBE("ROARING_AND", {
+		TEST("Intersecting array and bitmap containers", {
+			// Arrange
+			for (uint32_t i = 0; i < 10000; i++)
+				ROARING_ADD(&ra, i);
+			ROARING_ADD(&ra, 1u << 20);
+			for (uint32_t i = 0; i < 20000; i += 3)
+				ROARING_ADD(&rb, i);
+
+			// Act
+			ROARING_AND(ra, rb, &out);
+
+			// Assert
+			EXPECT(out.len == 1);
+			EXPECT(ROARING_COUNT(out) == 3334);
+			EXPECT(ROARING_CONTAINS(out, 9999));
+			EXPECT(!ROARING_CONTAINS(out, 1));
+			EXPECT(!ROARING_CONTAINS(out, 1u << 20));
+		});
+	});
+
+	DESCRIBE("ROARING_OR", {
+		TEST("Uniting array containers", {
+			// Arrange
+			ROARING_ADD(&ra, 1);
+			ROARING_ADD(&ra, 5);
+			ROARING_ADD(&rb, 5);
+			ROARING_ADD(&rb, 9);
+			ROARING_ADD(&rb, 1u << 20);
+
+			// Act
+			ROARING_OR(ra, rb, &out);
+
+			// Assert
+			EXPECT(out.len == 2);
+			EXPECT(ROARING_COUNT(out) == 4);
+			EXPECT(ROARING_CONTAINS(out, 1));
+			EXPECT(ROARING_CONTAINS(out, 9));
+			EXPECT(ROARING_CONTAINS(out, 1u << 20));
+		});
+
+		TEST("Uniting into a bitmap container", {
+			// Arrange
+			for (uint32_t i = 0; i < 6000; i += 2)
+				ROARING_ADD(&ra, i);
+			for (uint32_t i = 1; i < 6000; i += 2)
+				ROARING_ADD(&rb, i);
+
+			// Act
+			ROARING_OR(ra, rb, &out);
+
+			// Assert
+			EXPECT(out.ptr[0].bitmap != CRZ_NULL);
+			EXPECT(ROARING_COUNT(out) == 6000);
+			EXPECT(ROARING_CONTAINS(out, 5999));
+		});
+	});
+})
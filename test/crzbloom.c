@@ -0,0 +1,253 @@
+#include "crzbloom.h"
+#include "crztest.h"
+#include <stdio.h>
+
+#define COUNT 10000
+#define MISSES 100000
+
+static BloomFilter filter = BLOOM_FILTER_NEW();
+static CuckooFilter cuckoo = CUCKOO_FILTER_NEW();
+static FILTERED_HASH_TABLE(int) ht = FILTERED_HASH_TABLE_NEW();
+static char key[32];
+
+static char *hit(int i)
+{
+	CRZ_SPRINTF(key, "key-%d", i);
+	return key;
+}
+
+static char *miss(int i)
+{
+	CRZ_SPRINTF(key, "miss-%d", i);
+	return key;
+}
+
+static CRZ_SIZE count_false_positives(void)
+{
+	CRZ_SIZE false_positives = 0;
+	for (int i = 0; i < MISSES; i++)
+		false_positives += BLOOM_FILTER_HAS(filter, miss(i));
+	return false_positives;
+}
+
+static CRZ_BOOL masks_agree(uint64_t mixed)
+{
+	uint32_t scalar[CRZBLOOM_LANES];
+	crzbloom_mask_scalar(mixed, scalar);
+#ifdef CRZBLOOM_AVX2
+	uint32_t simd[CRZBLOOM_LANES];
+	_mm256_storeu_si256((__m256i *)simd, crzbloom_mask_avx2(mixed));
+	return memcmp(scalar, simd, sizeof(scalar)) == 0;
+#else
+	return CRZ_TRUE;
+#endif // CRZBLOOM_AVX2
+}
+
+void cleanup(void)
+{
+	BLOOM_FILTER_FREE(&filter);
+	CUCKOO_FILTER_FREE(&cuckoo);
+	FILTERED_HASH_TABLE_FREE(&ht);
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("BloomFilter", {
+		TEST("Finding every added key", {
+			// Arrange
+			BLOOM_FILTER_INIT(&filter, COUNT, 0.01);
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				BLOOM_FILTER_ADD(&filter, hit(i));
+
+			// Assert
+			for (int i = 0; i < COUNT; i++) {
+				EXPECTF(BLOOM_FILTER_HAS(filter, hit(i)),
+					"Key %d", i);
+			}
+		});
+
+		TEST("Keeping near the false positive rate", {
+			// Arrange
+			BLOOM_FILTER_INIT(&filter, COUNT, 0.01);
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				BLOOM_FILTER_ADD(&filter, hit(i));
+
+			// Assert
+			CRZ_SIZE false_positives = count_false_positives();
+			EXPECTF(false_positives < MISSES / 100 * 3 / 2,
+				"%zu false positives", false_positives);
+		});
+
+		TEST("Lowering the false positive rate", {
+			// Arrange
+			BLOOM_FILTER_INIT(&filter, COUNT, 0.001);
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				BLOOM_FILTER_ADD(&filter, hit(i));
+
+			// Assert
+			CRZ_SIZE false_positives = count_false_positives();
+			EXPECTF(false_positives < MISSES / 1000 * 3 / 2,
+				"%zu false positives", false_positives);
+		});
+
+		TEST("Adding keys by hash", {
+			// Arrange
+			BLOOM_FILTER_INIT(&filter, COUNT, 0.01);
+
+			// Act
+			for (uint64_t i = 0; i < COUNT; i++)
+				BLOOM_FILTER_ADD_HASH(&filter, i);
+
+			// Assert
+			for (uint64_t i = 0; i < COUNT; i++)
+				EXPECT(BLOOM_FILTER_HAS_HASH(filter, i));
+		});
+
+		TEST("SIMD and scalar masks agree", {
+			// Assert
+			uint64_t mixed = 1;
+			for (int i = 0; i < 1000; i++) {
+				mixed = crzbloom_mix(mixed + i);
+				EXPECT(masks_agree(mixed));
+			}
+		});
+	});
+
+	DESCRIBE("CuckooFilter", {
+		TEST("Finding every added key", {
+			// Arrange
+			CUCKOO_FILTER_INIT(&cuckoo, COUNT);
+
+			// Act
+			CRZ_BOOL added = CRZ_TRUE;
+			for (int i = 0; i < COUNT; i++)
+				added = added &&
+					CUCKOO_FILTER_ADD(&cuckoo, hit(i));
+
+			// Assert
+			EXPECT(added);
+			EXPECT(cuckoo.len == COUNT);
+			for (int i = 0; i < COUNT; i++) {
+				EXPECTF(CUCKOO_FILTER_HAS(cuckoo, hit(i)),
+					"Key %d", i);
+			}
+		});
+
+		TEST("Rejecting most missing keys", {
+			// Arrange
+			CUCKOO_FILTER_INIT(&cuckoo, COUNT);
+			for (int i = 0; i < COUNT; i++)
+				CUCKOO_FILTER_ADD(&cuckoo, hit(i));
+
+			// Act
+			CRZ_SIZE false_positives = 0;
+			for (int i = 0; i < MISSES; i++) {
+				false_positives +=
+					CUCKOO_FILTER_HAS(cuckoo, miss(i));
+			}
+
+			// Assert
+			EXPECTF(false_positives < MISSES / 1000,
+				"%zu false positives", false_positives);
+		});
+
+		TEST("Removing keys", {
+			// Arrange
+			CUCKOO_FILTER_INIT(&cuckoo, COUNT);
+			for (int i = 0; i < COUNT; i++)
+				CUCKOO_FILTER_ADD(&cuckoo, hit(i));
+
+			// Act
+			CRZ_BOOL removed = CRZ_TRUE;
+			for (int i = 0; i < COUNT; i += 2) {
+				removed = removed &&
+					  CUCKOO_FILTER_REMOVE(&cuckoo, hit(i));
+			}
+
+			// Assert
+			EXPECT(removed);
+			EXPECT(cuckoo.len == COUNT / 2);
+			CRZ_SIZE still_found = 0;
+			for (int i = 0; i < COUNT; i++) {
+				CRZ_BOOL found =
+					CUCKOO_FILTER_HAS(cuckoo, hit(i));
+				if (i % 2 == 1)
+					EXPECTF(found, "Key %d", i);
+				else
+					still_found += found;
+			}
+			EXPECT(still_found < 10);
+		});
+
+		TEST("Filling a filter past its capacity", {
+			// Arrange
+			CUCKOO_FILTER_INIT(&cuckoo, 100);
+
+			// Act
+			int added = 0;
+			while (CUCKOO_FILTER_ADD(&cuckoo, hit(added)))
+				added++;
+
+			// Assert
+			EXPECT(added >= 100);
+			for (int i = 0; i < added; i++) {
+				EXPECTF(CUCKOO_FILTER_HAS(cuckoo, hit(i)),
+					"Key %d", i);
+			}
+		});
+	});
+
+	DESCRIBE("FILTERED_HASH_TABLE", {
+		TEST("Getting inserted keys", {
+			// Arrange
+			FILTERED_HASH_TABLE_INIT(&ht, 2 * COUNT, COUNT, 0.01);
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				FILTERED_HASH_TABLE_INSERT(&ht, hit(i), i);
+
+			// Assert
+			for (int i = 0; i < COUNT; i++) {
+				HASH_PAIR(int) *pair =
+					FILTERED_HASH_TABLE_GET(ht, hit(i));
+				EXPECTF(pair && pair->value == i, "Key %d", i);
+			}
+		});
+
+		TEST("Getting missing keys", {
+			// Arrange
+			FILTERED_HASH_TABLE_INIT(&ht, 2 * COUNT, COUNT, 0.01);
+			for (int i = 0; i < COUNT; i++)
+				FILTERED_HASH_TABLE_INSERT(&ht, hit(i), i);
+
+			// Act & Assert
+			for (int i = 0; i < COUNT; i++) {
+				EXPECT(FILTERED_HASH_TABLE_GET(ht, miss(i)) ==
+				       CRZ_NULL);
+			}
+		});
+
+		TEST("Getting entries", {
+			// Arrange
+			FILTERED_HASH_TABLE_INIT(&ht, 16, 16, 0.01);
+			CRZ_BOOL created;
+
+			// Act
+			HASH_PAIR(int) *pair = FILTERED_HASH_TABLE_ENTRY(
+				&ht, "word", &created);
+			pair->value += 1;
+
+			// Assert
+			EXPECT(created);
+			EXPECT(FILTERED_HASH_TABLE_GET(ht, "word") == pair);
+			EXPECT(pair->value == 1);
+		});
+	});
+})
@@ -0,0 +1,299 @@
+#include "crzbtree.h"
+#include "crzsv.h"
+#include "crztest.h"
+#include <stdlib.h>
+
+#define COUNT 5000
+
+DEFINE_BTREE(IntTree, int, int, CRZBTREE_CMP_NUMBER)
+DEFINE_BTREE(NameTree, StringView, int, SV_CMP)
+
+static IntTree tree = BTREE_NEW();
+static NameTree names = BTREE_NEW();
+static ARRAY(IntTree_Entry) entries = ARRAY_NEW();
+static CRZ_BOOL present[COUNT];
+
+// Whether the tree holds the keys marked in `present` in order, valued twice
+static CRZ_BOOL matches_present(void)
+{
+	CRZ_SIZE expected = 0;
+	int key = 0;
+	BTREE_FOR(IntTree, tree, iter)
+	{
+		while (key < COUNT && !present[key])
+			key++;
+		if (key == COUNT || BTREE_ITER_KEY(iter) != key ||
+		    BTREE_ITER_VALUE(iter) != key * 2)
+			return CRZ_FALSE;
+		key++;
+		expected++;
+	}
+	while (key < COUNT && !present[key])
+		key++;
+	return key == COUNT && expected == tree.len;
+}
+
+static IntTree_Entry entry(int key)
+{
+	IntTree_Entry result = { .key = key, .value = key * 2 };
+	return result;
+}
+
+static void insert_shuffled(void)
+{
+	srand(1);
+	for (int i = 0; i < COUNT; i++) {
+		int key = rand() % COUNT;
+		IntTree_insert(&tree, key, key * 2);
+		present[key] = CRZ_TRUE;
+	}
+}
+
+void cleanup(void)
+{
+	IntTree_free(&tree);
+	NameTree_free(&names);
+	ARRAY_FREE(&entries);
+	for (int i = 0; i < COUNT; i++)
+		present[i] = CRZ_FALSE;
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("Inserting", {
+		TEST("Getting from an empty tree", {
+			// Assert
+			EXPECT(IntTree_get(&tree, 1) == CRZ_NULL);
+			EXPECT(!BTREE_ITER_VALID(IntTree_first(&tree)));
+		});
+
+		TEST("Getting inserted keys", {
+			// Act
+			insert_shuffled();
+
+			// Assert
+			EXPECT(tree.height > 0);
+			for (int i = 0; i < COUNT; i++) {
+				int *value = IntTree_get(&tree, i);
+				EXPECTF(present[i] ? value && *value == i * 2 :
+						     value == CRZ_NULL,
+					"Key %d", i);
+			}
+		});
+
+		TEST("Iterating over inserted keys in order", {
+			// Act
+			insert_shuffled();
+
+			// Assert
+			EXPECT(matches_present());
+		});
+
+		TEST("Overriding the value of a key", {
+			// Arrange
+			IntTree_insert(&tree, 7, 1);
+
+			// Act
+			IntTree_insert(&tree, 7, 2);
+
+			// Assert
+			EXPECT(tree.len == 1);
+			EXPECT(*IntTree_get(&tree, 7) == 2);
+		});
+	});
+
+	DESCRIBE("Removing", {
+		TEST("Removing a missing key", {
+			// Arrange
+			IntTree_insert(&tree, 1, 2);
+
+			// Act & Assert
+			EXPECT(!IntTree_remove(&tree, 2));
+			EXPECT(tree.len == 1);
+		});
+
+		TEST("Removing keys in random order", {
+			// Arrange
+			insert_shuffled();
+
+			// Act
+			CRZ_BOOL removed_present = CRZ_TRUE;
+			for (int i = 0; i < COUNT; i++) {
+				int key = rand() % COUNT;
+				removed_present = removed_present &&
+						  IntTree_remove(&tree, key) ==
+							  present[key];
+				present[key] = CRZ_FALSE;
+			}
+
+			// Assert
+			EXPECT(removed_present);
+			EXPECT(matches_present());
+		});
+
+		TEST("Removing every key", {
+			// Arrange
+			insert_shuffled();
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				IntTree_remove(&tree, i);
+
+			// Assert
+			EXPECT(tree.len == 0);
+			EXPECT(tree.root == CRZ_NULL);
+		});
+
+		TEST("Reusing removed nodes", {
+			// Arrange
+			insert_shuffled();
+			CRZ_SIZE chunks = tree.leaves.chunks.len;
+			for (int i = 0; i < COUNT; i++)
+				IntTree_remove(&tree, i);
+
+			// Act
+			insert_shuffled();
+
+			// Assert
+			EXPECT(tree.leaves.chunks.len == chunks);
+			EXPECT(matches_present());
+		});
+	});
+
+	DESCRIBE("Ranges", {
+		TEST("Finding the lower bound of a key", {
+			// Arrange
+			for (int i = 0; i < COUNT; i += 2)
+				IntTree_insert(&tree, i, i * 2);
+
+			// Act
+			IntTree_Iter found = IntTree_lower_bound(&tree, 100);
+			IntTree_Iter missing = IntTree_lower_bound(&tree, 101);
+			IntTree_Iter end = IntTree_lower_bound(&tree, COUNT);
+
+			// Assert
+			EXPECT(BTREE_ITER_KEY(found) == 100);
+			EXPECT(BTREE_ITER_KEY(missing) == 102);
+			EXPECT(!BTREE_ITER_VALID(end));
+		});
+
+		TEST("Iterating over a range", {
+			// Arrange
+			insert_shuffled();
+
+			// Act
+			CRZ_SIZE count = 0;
+			int previous = 999;
+			CRZ_BOOL sorted = CRZ_TRUE;
+			BTREE_FOR_FROM(IntTree, tree, 1000, iter)
+			{
+				int key = BTREE_ITER_KEY(iter);
+				if (key >= 2000)
+					break;
+				sorted = sorted && key > previous;
+				previous = key;
+				count++;
+			}
+
+			// Assert
+			CRZ_SIZE expected = 0;
+			for (int i = 1000; i < 2000; i++)
+				expected += present[i];
+			EXPECT(sorted);
+			EXPECT(count == expected);
+		});
+	});
+
+	DESCRIBE("Bulk loading", {
+		TEST("Bulk-loading sorted entries", {
+			// Arrange
+			for (int i = 0; i < COUNT; i += 3) {
+				ARRAY_PUSH(&entries, entry(i));
+				present[i] = CRZ_TRUE;
+			}
+
+			// Act
+			IntTree_bulk_load(&tree, entries.ptr, entries.len);
+
+			// Assert
+			EXPECT(tree.len == entries.len);
+			EXPECT(matches_present());
+			EXPECT(*IntTree_get(&tree, 300) == 600);
+			EXPECT(IntTree_get(&tree, 301) == CRZ_NULL);
+		});
+
+		TEST("Modifying a bulk-loaded tree", {
+			// Arrange
+			for (int i = 0; i < COUNT; i += 2) {
+				ARRAY_PUSH(&entries, entry(i));
+				present[i] = CRZ_TRUE;
+			}
+			IntTree_bulk_load(&tree, entries.ptr, entries.len);
+
+			// Act
+			for (int i = 0; i < COUNT; i++) {
+				if (i % 3 == 0) {
+					IntTree_insert(&tree, i, i * 2);
+					present[i] = CRZ_TRUE;
+				} else if (i % 3 == 1) {
+					IntTree_remove(&tree, i);
+					present[i] = CRZ_FALSE;
+				}
+			}
+
+			// Assert
+			EXPECT(matches_present());
+		});
+	});
+
+	DESCRIBE("StringView keys", {
+		TEST("Iterating over names in order", {
+			// Arrange
+			NameTree_insert(&names, SV_FROM_CSTR("carol"), 3);
+			NameTree_insert(&names, SV_FROM_CSTR("alice"), 1);
+			NameTree_insert(&names, SV_FROM_CSTR("bob"), 2);
+			NameTree_insert(&names, SV_FROM_CSTR("al"), 0);
+
+			// Act
+			int order = 0;
+			CRZ_BOOL sorted = CRZ_TRUE;
+			BTREE_FOR(NameTree, names, iter)
+			{
+				int value = BTREE_ITER_VALUE(iter);
+				sorted = sorted && value == order;
+				order++;
+			}
+
+			// Assert
+			EXPECT(sorted && order == 4);
+			StringView bob = SV_FROM_CSTR("bob");
+			StringView b = SV_FROM_CSTR("b");
+			EXPECT(*NameTree_get(&names, bob) == 2);
+			EXPECT(NameTree_get(&names, b) == CRZ_NULL);
+		});
+
+		TEST("Iterating over names with a prefix", {
+			// Arrange
+			NameTree_insert(&names, SV_FROM_CSTR("apple"), 0);
+			NameTree_insert(&names, SV_FROM_CSTR("banana"), 1);
+			NameTree_insert(&names, SV_FROM_CSTR("band"), 2);
+			NameTree_insert(&names, SV_FROM_CSTR("bank"), 3);
+			NameTree_insert(&names, SV_FROM_CSTR("cherry"), 4);
+			StringView prefix = SV_FROM_CSTR("ban");
+
+			// Act
+			int count = 0;
+			BTREE_FOR_FROM(NameTree, names, prefix, iter)
+			{
+				StringView name = BTREE_ITER_KEY(iter);
+				if (!SV_HAS_PREFIX(name, prefix))
+					break;
+				count++;
+			}
+
+			// Assert
+			EXPECT(count == 3);
+		});
+	});
+})
@@ -0,0 +1,340 @@
+#define CRZ_STATS
+#define CRZCACHE_SHARDED
+#include "crzcache.h"
+#include "crztest.h"
+#include <stdio.h>
+
+#define COUNT 1000
+#define THREADS 4
+
+static CACHE(int) cache = CACHE_NEW();
+static CACHE(char *) names = CACHE_NEW();
+static SHARDED_CACHE(int) sharded;
+static CRZ_BOOL sharded_used = CRZ_FALSE;
+static CRZ_SIZE dropped = 0;
+
+static char *key(int i)
+{
+	static char buffer[32];
+	CRZ_SPRINTF(buffer, "key-%d", i);
+	return buffer;
+}
+
+static void drop_name(void *value)
+{
+	CRZ_FREE(*(char **)value);
+	dropped += 1;
+}
+
+// Each thread puts and gets its own range of keys
+static void *use_sharded(void *arg)
+{
+	int start = *(int *)arg;
+	char buffer[32];
+	CRZ_BOOL found = CRZ_TRUE;
+	for (int i = start; i < start + COUNT; i++) {
+		CRZ_SPRINTF(buffer, "key-%d", i);
+		SHARDED_CACHE_PUT(&sharded, buffer, i, 1);
+		int value = -1;
+		found = found &&
+			SHARDED_CACHE_GET(&sharded, buffer, &value) &&
+			value == i;
+	}
+	return found ? arg : CRZ_NULL;
+}
+
+static void init_sharded(CRZ_SIZE entry_budget)
+{
+	SHARDED_CACHE_INIT(&sharded, entry_budget, 0, CRZ_NULL);
+	sharded_used = CRZ_TRUE;
+}
+
+void reset(void)
+{
+	CRZ_STATS_RESET();
+	dropped = 0;
+}
+
+void cleanup(void)
+{
+	CACHE_FREE(&cache);
+	CACHE_FREE(&names);
+	if (sharded_used)
+		SHARDED_CACHE_FREE(&sharded);
+	sharded_used = CRZ_FALSE;
+}
+
+TEST_MAIN({
+	BEFORE_EACH(reset);
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("CACHE_GET", {
+		TEST("Getting a put value", {
+			// Arrange
+			CACHE_INIT(&cache, 4, 0, CRZ_NULL);
+			CACHE_PUT(&cache, "a", 1, 1);
+
+			// Act
+			int *value = CACHE_GET(&cache, "a");
+
+			// Assert
+			EXPECT(value != CRZ_NULL && *value == 1);
+			EXPECT(cache.stats.hits == 1);
+			EXPECT(cache.stats.misses == 0);
+		});
+
+		TEST("Returning CRZ_NULL when not cached", {
+			// Arrange
+			CACHE_INIT(&cache, 4, 0, CRZ_NULL);
+			CACHE_PUT(&cache, "a", 1, 1);
+
+			// Act
+			int *value = CACHE_GET(&cache, "b");
+
+			// Assert
+			EXPECT(value == CRZ_NULL);
+			EXPECT(cache.stats.hits == 0);
+			EXPECT(cache.stats.misses == 1);
+		});
+
+		TEST("Not allocating on hits", {
+			// Arrange
+			CACHE_INIT(&cache, COUNT, 0, CRZ_NULL);
+			for (int i = 0; i < COUNT; i++)
+				CACHE_PUT(&cache, key(i), i, 1);
+			CRZ_STATS_RESET();
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				CACHE_GET(&cache, key(i));
+
+			// Assert
+			EXPECT(cache.stats.hits == COUNT);
+			EXPECT(crzstats.hash.allocations == 0);
+			EXPECT(crzstats.arr.allocations == 0);
+			EXPECT(crzstats.arr.reallocations == 0);
+		});
+	});
+
+	DESCRIBE("CACHE_PUT", {
+		TEST("Replacing the value of a cached key", {
+			// Arrange
+			CACHE_INIT(&names, 4, 0, drop_name);
+			CACHE_PUT(&names, "a", CRZ_STRDUP("first"), 1);
+
+			// Act
+			CACHE_PUT(&names, "a", CRZ_STRDUP("second"), 1);
+
+			// Assert
+			char **value = CACHE_GET(&names, "a");
+			EXPECT(value != CRZ_NULL);
+			EXPECT(strcmp(*value, "second") == 0);
+			EXPECT(names.len == 1);
+			EXPECT(dropped == 1);
+		});
+
+		TEST("Staying within the entry budget", {
+			// Arrange
+			CACHE_INIT(&cache, 10, 0, CRZ_NULL);
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				CACHE_PUT(&cache, key(i), i, 1);
+
+			// Assert
+			EXPECT(cache.len == 10);
+			EXPECT(cache.slots.len == 10);
+			EXPECT(cache.stats.insertions == COUNT);
+			EXPECT(cache.stats.evictions == COUNT - 10);
+			int *value = CACHE_GET(&cache, key(COUNT - 1));
+			EXPECT(value != CRZ_NULL && *value == COUNT - 1);
+		});
+
+		TEST("Staying within the cost budget", {
+			// Arrange
+			CACHE_INIT(&cache, 0, 100, CRZ_NULL);
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				CACHE_PUT(&cache, key(i), i, 1 + i % 7);
+
+			// Assert
+			EXPECT(cache.cost <= 100);
+			EXPECT(cache.len > 100 / 7);
+			CRZ_SIZE cost = 0;
+			for (int i = 0; i < COUNT; i++) {
+				if (CACHE_GET(&cache, key(i)))
+					cost += 1 + i % 7;
+			}
+			EXPECT(cost == cache.cost);
+		});
+
+		TEST("Sparing referenced entries", {
+			// Arrange
+			CACHE_INIT(&cache, 3, 0, CRZ_NULL);
+			CACHE_PUT(&cache, "a", 1, 1);
+			CACHE_PUT(&cache, "b", 2, 1);
+			CACHE_PUT(&cache, "c", 3, 1);
+			CACHE_GET(&cache, "a");
+
+			// Act
+			CACHE_PUT(&cache, "d", 4, 1);
+
+			// Assert
+			EXPECT(CACHE_GET(&cache, "a") != CRZ_NULL);
+			EXPECT(CACHE_GET(&cache, "b") == CRZ_NULL);
+			EXPECT(CACHE_GET(&cache, "c") != CRZ_NULL);
+			EXPECT(CACHE_GET(&cache, "d") != CRZ_NULL);
+		});
+
+		TEST("Caching an entry costing more than the budget", {
+			// Arrange
+			CACHE_INIT(&cache, 0, 10, CRZ_NULL);
+			CACHE_PUT(&cache, "a", 1, 4);
+			CACHE_PUT(&cache, "b", 2, 4);
+
+			// Act
+			CACHE_PUT(&cache, "c", 3, 20);
+
+			// Assert
+			EXPECT(cache.len == 1);
+			EXPECT(cache.cost == 20);
+			EXPECT(CACHE_GET(&cache, "c") != CRZ_NULL);
+		});
+
+		TEST("Evicting others when a cached entry grows", {
+			// Arrange
+			CACHE_INIT(&cache, 0, 10, CRZ_NULL);
+			CACHE_PUT(&cache, "a", 1, 4);
+			CACHE_PUT(&cache, "b", 2, 4);
+
+			// Act
+			CACHE_PUT(&cache, "a", 1, 8);
+
+			// Assert
+			EXPECT(cache.len == 1);
+			EXPECT(cache.cost == 8);
+			EXPECT(CACHE_GET(&cache, "a") != CRZ_NULL);
+		});
+	});
+
+	DESCRIBE("CACHE_REMOVE", {
+		TEST("Removing a cached key", {
+			// Arrange
+			CACHE_INIT(&cache, 4, 0, CRZ_NULL);
+			CACHE_PUT(&cache, "a", 1, 1);
+			CACHE_PUT(&cache, "b", 2, 1);
+
+			// Act
+			CRZ_BOOL removed = CACHE_REMOVE(&cache, "a");
+
+			// Assert
+			EXPECT(removed);
+			EXPECT(!CACHE_REMOVE(&cache, "a"));
+			EXPECT(cache.len == 1);
+			EXPECT(CACHE_GET(&cache, "a") == CRZ_NULL);
+			EXPECT(CACHE_GET(&cache, "b") != CRZ_NULL);
+		});
+
+		TEST("Reusing the slot of a removed key", {
+			// Arrange
+			CACHE_INIT(&cache, 0, 0, CRZ_NULL);
+			CACHE_PUT(&cache, "a", 1, 1);
+			CACHE_PUT(&cache, "b", 2, 1);
+			CACHE_REMOVE(&cache, "a");
+
+			// Act
+			CACHE_PUT(&cache, "c", 3, 1);
+
+			// Assert
+			EXPECT(cache.slots.len == 2);
+			int *value = CACHE_GET(&cache, "c");
+			EXPECT(value != CRZ_NULL && *value == 3);
+		});
+	});
+
+	DESCRIBE("CACHE_FREE", {
+		TEST("Dropping every value let go of", {
+			// Arrange
+			CACHE_INIT(&names, 10, 0, drop_name);
+			for (int i = 0; i < 20; i++) {
+				char *name = CRZ_STRDUP(key(i));
+				CACHE_PUT(&names, key(i), name, 1);
+			}
+			CACHE_REMOVE(&names, key(19));
+
+			// Act
+			CACHE_FREE(&names);
+
+			// Assert
+			EXPECT(dropped == 20);
+			EXPECT(names.len == 0);
+		});
+	});
+
+	DESCRIBE("SHARDED_CACHE", {
+		TEST("Getting put values across shards", {
+			// Arrange
+			init_sharded(COUNT * 2);
+			for (int i = 0; i < COUNT; i++)
+				SHARDED_CACHE_PUT(&sharded, key(i), i, 1);
+
+			// Act
+			CRZ_BOOL found = CRZ_TRUE;
+			for (int i = 0; i < COUNT; i++) {
+				int value = -1;
+				found = found &&
+					SHARDED_CACHE_GET(&sharded, key(i),
+							  &value) &&
+					value == i;
+			}
+
+			// Assert
+			EXPECT(found);
+			EXPECT(SHARDED_CACHE_STATS(&sharded).hits == COUNT);
+			EXPECT(SHARDED_CACHE_REMOVE(&sharded, key(0)));
+			EXPECT(SHARDED_CACHE_STATS(&sharded).misses == 0);
+		});
+
+		TEST("Using the cache from several threads", {
+			// Arrange
+			init_sharded(COUNT * THREADS * 2);
+			pthread_t threads[THREADS];
+			int starts[THREADS];
+
+			// Act
+			for (int i = 0; i < THREADS; i++) {
+				starts[i] = i * COUNT;
+				pthread_create(&threads[i], CRZ_NULL,
+					       use_sharded, &starts[i]);
+			}
+			CRZ_BOOL found = CRZ_TRUE;
+			for (int i = 0; i < THREADS; i++) {
+				void *result;
+				pthread_join(threads[i], &result);
+				found = found && result != CRZ_NULL;
+			}
+
+			// Assert
+			CacheStats stats = SHARDED_CACHE_STATS(&sharded);
+			EXPECT(found);
+			EXPECT(stats.insertions == COUNT * THREADS);
+			EXPECT(stats.hits == COUNT * THREADS);
+		});
+
+		TEST("Staying within each shard's budget", {
+			// Arrange
+			init_sharded(CRZCACHE_SHARDS * 4);
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				SHARDED_CACHE_PUT(&sharded, key(i), i, 1);
+
+			// Assert
+			CRZ_BOOL within = CRZ_TRUE;
+			for (int i = 0; i < CRZCACHE_SHARDS; i++)
+				within = within && sharded.shards[i].len <= 4;
+			EXPECT(within);
+		});
+	});
+})
@@ -0,0 +1,297 @@
+#include "crzcodec.h"
+#include "crztest.h"
+
+#define BLOB_SIZE 1000
+
+// The bytes which base64 encode to each character in order
+static const char every_character[] = "\x00\x10\x83\x10\x51\x87\x20\x92"
+				      "\x8b\x30\xd3\x8f\x41\x14\x93\x51"
+				      "\x55\x97\x61\x96\x9b\x71\xd7\x9f"
+				      "\x82\x18\xa3\x92\x59\xa7\xa2\x9a"
+				      "\xab\xb2\xdb\xaf\xc3\x1c\xb3\xd3"
+				      "\x5d\xb7\xe3\x9e\xbb\xf3\xdf\xbf";
+
+static StringBuilder sb;
+static StringBuilder decoded;
+static unsigned char blob[BLOB_SIZE];
+
+// Every byte value, several times over, so each SIMD step sees all of them
+static void fill_blob(void)
+{
+	for (CRZ_SIZE i = 0; i < BLOB_SIZE; i++)
+		blob[i] = (unsigned char)(i * 167 + i / 256);
+}
+
+static CRZ_BOOL holds(const StringBuilder *selfp, const char *expected)
+{
+	CRZ_SIZE len = CRZ_STRLEN(expected);
+	return selfp->len == len && CRZ_MEMCMP(selfp->ptr, expected, len) == 0;
+}
+
+static CRZ_BOOL holds_blob(const StringBuilder *selfp, CRZ_SIZE len)
+{
+	if (selfp->len != len)
+		return CRZ_FALSE;
+	return len == 0 || CRZ_MEMCMP(selfp->ptr, blob, len) == 0;
+}
+
+static StringView encoded(void)
+{
+	return SV_FROM_BUF(sb.ptr, sb.len);
+}
+
+// Whether decoding `input` with `decode` fails and leaves `decoded` empty
+static CRZ_BOOL rejects(CRZ_BOOL (*decode)(const char *, CRZ_SIZE,
+					   StringBuilder *),
+			const char *input)
+{
+	return !decode(input, CRZ_STRLEN(input), &decoded) && decoded.len == 0;
+}
+
+// Whether the first `len` bytes of `blob` decode back from their hex, which
+// each SIMD step and the scalar tail take part in for some length
+static CRZ_BOOL round_trips_hex(CRZ_SIZE len)
+{
+	sb.len = 0;
+	decoded.len = 0;
+	SB_PUSH_HEX(&sb, blob, len);
+	if (sb.len != CRZCODEC_HEX_SIZE(len))
+		return CRZ_FALSE;
+	return SV_DECODE_HEX(encoded(), &decoded) && holds_blob(&decoded, len);
+}
+
+// Whether a quote at `at` in a run of letters is escaped, and only it is
+static CRZ_BOOL escapes_quote_at(CRZ_SIZE at)
+{
+	char text[101];
+	memset(text, 'a', sizeof(text));
+	text[at] = '"';
+	sb.len = 0;
+	SB_PUSH_JSON_ESCAPED(&sb, text, sizeof(text));
+	return sb.len == sizeof(text) + 1 && sb.ptr[at] == '\\' &&
+	       sb.ptr[at + 1] == '"' && sb.ptr[sizeof(text)] == 'a';
+}
+
+// Whether the first `len` bytes of `blob` decode back from their base64
+static CRZ_BOOL round_trips_base64(CRZ_SIZE len)
+{
+	sb.len = 0;
+	decoded.len = 0;
+	SB_PUSH_BASE64(&sb, blob, len);
+	if (sb.len != CRZCODEC_BASE64_SIZE(len))
+		return CRZ_FALSE;
+	return SV_DECODE_BASE64(encoded(), &decoded) &&
+	       holds_blob(&decoded, len);
+}
+
+static CRZ_BOOL rejects_json(const char *input)
+{
+	return rejects(crzcodec_decode_json_escaped, input);
+}
+
+void reset(void)
+{
+	sb = (StringBuilder)SB_NEW();
+	decoded = (StringBuilder)SB_NEW();
+	fill_blob();
+}
+
+void cleanup(void)
+{
+	SB_FREE(&sb);
+	SB_FREE(&decoded);
+}
+
+TEST_MAIN({
+	BEFORE_EACH(reset);
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("SB_PUSH_HEX", {
+		TEST("Pushing hex", {
+			// Act
+			SB_PUSH_CSTR(&sb, "id=");
+			SB_PUSH_HEX(&sb, "\x00\x7f\x80\xff\x12", 5);
+
+			// Assert
+			EXPECT(holds(&sb, "id=007f80ff12"));
+		});
+
+		TEST("Decoding pushed hex of every byte value", {
+			// Act
+			SB_PUSH_HEX(&sb, blob, BLOB_SIZE);
+
+			// Assert
+			EXPECT(sb.len == BLOB_SIZE * 2);
+			EXPECT(SV_DECODE_HEX(encoded(), &decoded));
+			EXPECT(holds_blob(&decoded, BLOB_SIZE));
+		});
+
+		TEST("Decoding pushed hex of every length", {
+			// Arrange
+			CRZ_BOOL decodes = CRZ_TRUE;
+
+			// Act
+			for (CRZ_SIZE len = 0; len <= 100; len++) {
+				decodes = decodes && round_trips_hex(len);
+			}
+
+			// Assert
+			EXPECT(decodes);
+		});
+
+		TEST("Decoding uppercase hex", {
+			// Act
+			CRZ_BOOL result =
+				SV_DECODE_HEX(SV_FROM_CSTR("ABCDEF09abcdef09"
+							   "0123456789ABCDEF"
+							   "ff"),
+					      &decoded);
+
+			// Assert
+			EXPECT(result);
+			EXPECT(decoded.len == 17);
+			EXPECT((unsigned char)decoded.ptr[0] == 0xAB);
+			EXPECT((unsigned char)decoded.ptr[15] == 0xEF);
+			EXPECT((unsigned char)decoded.ptr[16] == 0xFF);
+		});
+
+		TEST("Rejecting invalid hex", {
+			// Assert
+			EXPECT(rejects(crzcodec_decode_hex, "abc"));
+			EXPECT(rejects(crzcodec_decode_hex, "0g"));
+			EXPECT(rejects(crzcodec_decode_hex,
+				       "00000000000000000000000000000:00"));
+			EXPECT(rejects(crzcodec_decode_hex,
+				       "0000000000000000000000000000000G"));
+			EXPECT(rejects(crzcodec_decode_hex,
+				       "0000000000000000000000000000000\xe0"));
+		});
+	});
+
+	DESCRIBE("SB_PUSH_BASE64", {
+		TEST("Pushing base64 with padding", {
+			// Act
+			SB_PUSH_BASE64(&sb, "f", 1);
+			SB_PUSH_CHAR(&sb, ' ');
+			SB_PUSH_BASE64(&sb, "fo", 2);
+			SB_PUSH_CHAR(&sb, ' ');
+			SB_PUSH_BASE64(&sb, "foobar", 6);
+
+			// Assert
+			EXPECT(holds(&sb, "Zg== Zm8= Zm9vYmFy"));
+		});
+
+		TEST("Pushing base64 of every character", {
+			// Act
+			SB_PUSH_BASE64(&sb, every_character, 48);
+
+			// Assert
+			EXPECT(holds(&sb, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdef"
+					  "ghijklmnopqrstuvwxyz0123456789+/"));
+		});
+
+		TEST("Decoding pushed base64 of every length", {
+			// Arrange
+			CRZ_BOOL decodes = CRZ_TRUE;
+
+			// Act
+			for (CRZ_SIZE len = 0; len <= 100; len++) {
+				decodes = decodes && round_trips_base64(len);
+			}
+
+			// Assert
+			EXPECT(decodes);
+		});
+
+		TEST("Decoding pushed base64 of every byte value", {
+			// Act
+			SB_PUSH_BASE64(&sb, blob, BLOB_SIZE);
+
+			// Assert
+			EXPECT(SV_DECODE_BASE64(encoded(), &decoded));
+			EXPECT(holds_blob(&decoded, BLOB_SIZE));
+		});
+
+		TEST("Rejecting invalid base64", {
+			// Assert
+			EXPECT(rejects(crzcodec_decode_base64, "Zm9"));
+			EXPECT(rejects(crzcodec_decode_base64, "Zm=v"));
+			EXPECT(rejects(crzcodec_decode_base64, "Z==="));
+			EXPECT(rejects(crzcodec_decode_base64,
+				       "AAAAAAAAAAAAAAA-AAAAAAAA"));
+			EXPECT(rejects(crzcodec_decode_base64,
+				       "AAAAAAAAAAAAAAA\xc1" "AAAAAAAA"));
+		});
+	});
+
+	DESCRIBE("SB_PUSH_JSON_ESCAPED", {
+		TEST("Pushing escaped characters", {
+			// Act
+			const char *text = "say \"hi\"\\\n\t\x01\x1f/é";
+			SB_PUSH_JSON_ESCAPED(&sb, text, CRZ_STRLEN(text));
+
+			// Assert
+			EXPECT(holds(&sb, "say \\\"hi\\\"\\\\"
+					  "\\n\\t\\u0001\\u001f/é"));
+		});
+
+		TEST("Pushing a long string without escapes", {
+			// Arrange
+			const char *text = "The quick brown fox jumps over "
+					   "the lazy dog, again and again";
+
+			// Act
+			SB_PUSH_JSON_ESCAPED(&sb, text, CRZ_STRLEN(text));
+
+			// Assert
+			EXPECT(holds(&sb, text));
+		});
+
+		TEST("Finding an escape at every position", {
+			// Arrange
+			CRZ_BOOL escapes = CRZ_TRUE;
+
+			// Act
+			for (CRZ_SIZE at = 0; at < 100; at++) {
+				escapes = escapes && escapes_quote_at(at);
+			}
+
+			// Assert
+			EXPECT(escapes);
+		});
+
+		TEST("Decoding pushed escapes of every byte value", {
+			// Act
+			SB_PUSH_JSON_ESCAPED(&sb, blob, BLOB_SIZE);
+
+			// Assert
+			EXPECT(SV_DECODE_JSON_ESCAPED(encoded(), &decoded));
+			EXPECT(holds_blob(&decoded, BLOB_SIZE));
+		});
+
+		TEST("Decoding unicode escapes as UTF-8", {
+			// Act
+			StringView escaped =
+				SV_FROM_CSTR("\\u0041\\u00e9\\u20AC"
+					     "\\ud83d\\ude00\\/");
+			CRZ_BOOL result =
+				SV_DECODE_JSON_ESCAPED(escaped, &decoded);
+
+			// Assert
+			EXPECT(result);
+			EXPECT(holds(&decoded, "Aé€😀/"));
+		});
+
+		TEST("Rejecting invalid escapes", {
+			// Assert
+			EXPECT(rejects_json("a\"b"));
+			EXPECT(rejects_json("a\nb"));
+			EXPECT(rejects_json("a\\"));
+			EXPECT(rejects_json("\\x41"));
+			EXPECT(rejects_json("\\u00g1"));
+			EXPECT(rejects_json("\\ud83d"));
+			EXPECT(rejects_json("\\ud83d\\u0041"));
+			EXPECT(rejects_json("\\ude00"));
+		});
+	});
+})
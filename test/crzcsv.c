@@ -0,0 +1,226 @@
+#include "crzcsv.h"
+#include "crztest.h"
+#include <stdlib.h>
+
+#define MAX_FIELDS 256
+
+static StringView fields[MAX_FIELDS];
+static CRZ_BOOL ends[MAX_FIELDS];
+static CRZ_SIZE count;
+static StringBuilder sb;
+static char long_input[1024];
+
+static void read_all(const char *input, char delimiter)
+{
+	CsvReader reader = CSV_READER_NEW(SV_FROM_CSTR(input), delimiter);
+	count = 0;
+	while (count < MAX_FIELDS &&
+	       CSV_NEXT_FIELD(&reader, &fields[count], &ends[count]))
+		count++;
+}
+
+static CRZ_BOOL field_is(CRZ_SIZE index, const char *expected)
+{
+	return index < count && SV_EQ(fields[index], SV_FROM_CSTR(expected));
+}
+
+static CRZ_BOOL masks_agree(const char *block)
+{
+	Crzcsv_Masks scalar = crzcsv_masks_scalar(block, ',');
+#ifdef CRZCSV_SSE2
+	Crzcsv_Masks simd = crzcsv_masks_sse2(block, ',');
+#else
+	Crzcsv_Masks simd = scalar;
+#endif // CRZCSV_SSE2
+	return scalar.delimiters == simd.delimiters &&
+	       scalar.quotes == simd.quotes &&
+	       scalar.newlines == simd.newlines;
+}
+
+static void cleanup(void)
+{
+	count = 0;
+	SB_FREE(&sb);
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("Splitting", {
+		TEST("Reading an empty input", {
+			// Act
+			read_all("", ',');
+
+			// Assert
+			EXPECT(count == 0);
+		});
+
+		TEST("Reading records of CSV", {
+			// Act
+			read_all("a,b,c\nd,e,f\n", ',');
+
+			// Assert
+			EXPECT(count == 6);
+			EXPECT(field_is(0, "a") && !ends[0]);
+			EXPECT(field_is(2, "c") && ends[2]);
+			EXPECT(field_is(3, "d") && !ends[3]);
+			EXPECT(field_is(5, "f") && ends[5]);
+		});
+
+		TEST("Reading TSV", {
+			// Act
+			read_all("a,b\tc\n", '\t');
+
+			// Assert
+			EXPECT(count == 2);
+			EXPECT(field_is(0, "a,b"));
+			EXPECT(field_is(1, "c"));
+		});
+
+		TEST("Reading a last record without a newline", {
+			// Act
+			read_all("a,b\nc,d", ',');
+
+			// Assert
+			EXPECT(count == 4);
+			EXPECT(field_is(3, "d") && ends[3]);
+		});
+
+		TEST("Reading empty fields", {
+			// Act
+			read_all(",a,,\n,", ',');
+
+			// Assert
+			EXPECT(count == 6);
+			EXPECT(field_is(0, "") && field_is(2, ""));
+			EXPECT(field_is(3, "") && ends[3]);
+			EXPECT(field_is(4, "") && field_is(5, "") && ends[5]);
+		});
+
+		TEST("Dropping carriage returns", {
+			// Act
+			read_all("a,b\r\nc\r\n", ',');
+
+			// Assert
+			EXPECT(count == 3);
+			EXPECT(field_is(1, "b") && ends[1]);
+			EXPECT(field_is(2, "c") && ends[2]);
+		});
+
+		TEST("Dropping a carriage return at the end of the input", {
+			// Act
+			read_all("a,b\r\nc,d\r", ',');
+
+			// Assert
+			EXPECT(count == 4);
+			EXPECT(field_is(1, "b") && ends[1]);
+			EXPECT(field_is(3, "d") && ends[3]);
+		});
+
+		TEST("Reading quoted fields", {
+			// Act
+			read_all("\"a,b\",\"c\nd\",\"e\"\"f\"\n", ',');
+
+			// Assert
+			EXPECT(count == 3);
+			EXPECT(field_is(0, "\"a,b\""));
+			EXPECT(field_is(1, "\"c\nd\""));
+			EXPECT(field_is(2, "\"e\"\"f\"") && ends[2]);
+		});
+
+		TEST("Reading fields across blocks", {
+			// Arrange
+			CRZ_SIZE len = 0;
+			for (CRZ_SIZE i = 0; i < 100; i++) {
+				long_input[len++] = 'x';
+				long_input[len++] = i % 10 == 9 ? '\n' : ',';
+			}
+			long_input[len] = '\0';
+
+			// Act
+			read_all(long_input, ',');
+
+			// Assert
+			EXPECT(count == 100);
+			for (CRZ_SIZE i = 0; i < count; i++) {
+				EXPECTF(field_is(i, "x"), "Field %zu", i);
+				EXPECTF(ends[i] == (i % 10 == 9), "End %zu", i);
+			}
+		});
+
+		TEST("Reading quoted fields across blocks", {
+			// Arrange
+			CRZ_SIZE len = 0;
+			long_input[len++] = '"';
+			for (CRZ_SIZE i = 0; i < 150; i++)
+				long_input[len++] = i % 2 == 0 ? ',' : '\n';
+			long_input[len++] = '"';
+			long_input[len++] = ',';
+			long_input[len++] = 'y';
+			long_input[len] = '\0';
+
+			// Act
+			read_all(long_input, ',');
+
+			// Assert
+			EXPECT(count == 2);
+			EXPECT(fields[0].len == 152);
+			EXPECT(field_is(1, "y"));
+		});
+	});
+
+	DESCRIBE("Unescaping", {
+		TEST("CSV_UNESCAPE of an unquoted field", {
+			// Act
+			CSV_UNESCAPE(&sb, SV_FROM_CSTR("abc"));
+
+			// Assert
+			EXPECT(sb.len == 3 && memcmp(sb.ptr, "abc", 3) == 0);
+		});
+
+		TEST("CSV_UNESCAPE of a quoted field", {
+			// Arrange
+			StringView field = SV_FROM_CSTR("\"a,\"\"b\"\"\"");
+
+			// Act
+			CSV_UNESCAPE(&sb, field);
+
+			// Assert
+			EXPECT(CSV_IS_QUOTED(field));
+			EXPECT(sb.len == 5);
+			EXPECT(memcmp(sb.ptr, "a,\"b\"", 5) == 0);
+		});
+
+		TEST("CSV_UNESCAPE of an empty quoted field", {
+			// Act
+			CSV_UNESCAPE(&sb, SV_FROM_CSTR("\"\""));
+
+			// Assert
+			EXPECT(sb.len == 0);
+		});
+	});
+
+	DESCRIBE("Classifying blocks", {
+		TEST("SIMD and scalar masks agree", {
+			// Arrange
+			const char alphabet[] = "ab,\t\"\n\r";
+			CRZ_SIZE size = sizeof(alphabet) - 1;
+			srand(1);
+
+			for (int round = 0; round < 100; round++) {
+				for (CRZ_SIZE i = 0; i < CRZCSV_BLOCK_SIZE; i++)
+					long_input[i] = alphabet[rand() % size];
+
+				// Act & Assert
+				EXPECT(masks_agree(long_input));
+			}
+		});
+
+		TEST("crzcsv_prefix_xor", {
+			// Assert
+			EXPECT(crzcsv_prefix_xor(0) == 0);
+			EXPECT(crzcsv_prefix_xor(1) == ~(uint64_t)0);
+			EXPECT(crzcsv_prefix_xor(0x12) == 0x0e);
+		});
+	});
+})
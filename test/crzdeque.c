@@ -0,0 +1,112 @@
+#include "crzdeque.h"
+#include "crztest.h"
+
+#define COUNT 100
+
+static DEQUE(int) d = DEQUE_NEW();
+
+void cleanup(void)
+{
+	DEQUE_FREE(&d);
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("DEQUE_PUSH_BACK", {
+		TEST("Pushing elements in order", {
+			// Act
+			DEQUE_PUSH_BACK(&d, 1);
+			DEQUE_PUSH_BACK(&d, 2);
+
+			// Assert
+			EXPECT(d.len == 2);
+			EXPECT(DEQUE_GET(d, 0) == 1 && DEQUE_GET(d, 1) == 2);
+		});
+	});
+
+	DESCRIBE("DEQUE_PUSH_FRONT", {
+		TEST("Pushing elements in reverse order", {
+			// Act
+			DEQUE_PUSH_FRONT(&d, 1);
+			DEQUE_PUSH_FRONT(&d, 2);
+			DEQUE_PUSH_BACK(&d, 3);
+
+			// Assert
+			EXPECT(d.len == 3);
+			EXPECT(DEQUE_GET(d, 0) == 2);
+			EXPECT(DEQUE_GET(d, 1) == 1);
+			EXPECT(DEQUE_GET(d, 2) == 3);
+		});
+
+		TEST("Unwrapping the buffer while growing", {
+			// Arrange
+			for (int i = 0; i < CRZARR_MINIMUM_CAPACITY; i++)
+				DEQUE_PUSH_FRONT(&d, i);
+			CRZ_SIZE wrapped_cap = d.cap;
+
+			// Act
+			for (int i = CRZARR_MINIMUM_CAPACITY; i < COUNT; i++)
+				DEQUE_PUSH_FRONT(&d, i);
+
+			// Assert
+			EXPECT(d.cap > wrapped_cap);
+			EXPECT(d.len == COUNT);
+			DEQUE_FOR(d, i) {
+				EXPECTF(DEQUE_GET(d, i) == COUNT - 1 - (int)i,
+					"Mismatch at %zu\n", i);
+			}
+		});
+	});
+
+	DESCRIBE("DEQUE_POP_FRONT", {
+		TEST("Using the deque as a queue", {
+			// Arrange
+			int popped[COUNT];
+
+			// Act
+			for (int i = 0; i < COUNT; i++) {
+				DEQUE_PUSH_BACK(&d, i);
+				DEQUE_PUSH_BACK(&d, i);
+				popped[i] = DEQUE_POP_FRONT(&d);
+			}
+
+			// Assert
+			EXPECT(d.len == COUNT);
+			for (int i = 0; i < COUNT; i++)
+				EXPECT(popped[i] == i / 2);
+			EXPECT(DEQUE_GET(d, 0) == COUNT / 2);
+		});
+	});
+
+	DESCRIBE("DEQUE_POP_BACK", {
+		TEST("Using the deque as a stack across the wrap", {
+			// Arrange
+			DEQUE_PUSH_FRONT(&d, 1);
+			DEQUE_PUSH_BACK(&d, 2);
+
+			// Act
+			int back = DEQUE_POP_BACK(&d);
+			int front = DEQUE_POP_BACK(&d);
+
+			// Assert
+			EXPECT(back == 2 && front == 1);
+			EXPECT(d.len == 0);
+		});
+	});
+
+	DESCRIBE("DEQUE_GROW_BY", {
+		TEST("Keeping wrapped elements in order", {
+			// Arrange
+			DEQUE_PUSH_BACK(&d, 1);
+			DEQUE_PUSH_FRONT(&d, 0);
+
+			// Act
+			DEQUE_GROW_BY(&d, COUNT);
+
+			// Assert
+			EXPECT(d.cap >= COUNT);
+			EXPECT(DEQUE_GET(d, 0) == 0 && DEQUE_GET(d, 1) == 1);
+		});
+	});
+})
@@ -0,0 +1,148 @@
+#include "crzfrozen.h"
+#include "crztest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COUNT 500
+#define KEY_SIZE 16
+
+static HASH_TABLE(size_t) ht = HASH_TABLE_NEW();
+static FROZEN_TABLE(size_t) frozen = FROZEN_TABLE_NEW();
+
+static char source[4096];
+
+// Writes `frozen` as C source into `source`, returning its length
+static size_t emit(void)
+{
+	FILE *file = tmpfile();
+	CRZ_ASSERT(file && "Could not create temporary file");
+	FROZEN_TABLE_EMIT(frozen, file, table, size_t, "%zu");
+	rewind(file);
+	size_t len = fread(source, 1, sizeof(source) - 1, file);
+	source[len] = '\0';
+	fclose(file);
+	return len;
+}
+
+// Whether the bytes written for the keys of `source` are those of `frozen`,
+// each as an unsigned byte which fits the `unsigned char` array
+static CRZ_BOOL emits_unsigned_keys(void)
+{
+	const char *header = "static const unsigned char table_keys[] = {";
+	const char *ptr = strstr(source, header);
+	if (ptr == CRZ_NULL)
+		return CRZ_FALSE;
+	ptr += strlen(header);
+
+	size_t keys_len = 0;
+	for (size_t i = 0; i < frozen.size; i++)
+		keys_len += strlen(frozen.keys + frozen.key_offsets[i]) + 1;
+	for (size_t i = 0; i < keys_len; i++) {
+		char *end;
+		long byte = strtol(ptr, &end, 10);
+		if (end == ptr || *end != ',' || byte < 0 || byte > 255 ||
+		    byte != (unsigned char)frozen.keys[i])
+			return CRZ_FALSE;
+		ptr = end + 1;
+	}
+	return strstr(source, "\t.keys = (char *)table_keys,\n") != CRZ_NULL;
+}
+
+void cleanup(void)
+{
+	HASH_TABLE_FREE(&ht);
+	FROZEN_TABLE_FREE(&frozen);
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("HASH_TABLE_FREEZE", {
+		TEST("Freezing a table keeps every pair", {
+			// Arrange
+			char key[KEY_SIZE];
+			HASH_TABLE_INIT(&ht, COUNT * 2);
+			for (size_t i = 0; i < COUNT; i++) {
+				CRZ_SPRINTF(key, "key-%zu", i);
+				HASH_TABLE_INSERT(&ht, key, i);
+			}
+
+			// Act
+			HASH_TABLE_FREEZE(ht, &frozen);
+			HASH_TABLE_FREE(&ht);
+
+			// Assert
+			EXPECT(frozen.size == COUNT);
+			for (size_t i = 0; i < COUNT; i++) {
+				CRZ_SPRINTF(key, "key-%zu", i);
+				size_t *result = FROZEN_TABLE_GET(frozen, key);
+				EXPECTF(result != CRZ_NULL && *result == i,
+					"Missing %s\n", key);
+			}
+		});
+
+		TEST("Freezing an empty table", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+
+			// Act
+			HASH_TABLE_FREEZE(ht, &frozen);
+
+			// Assert
+			EXPECT(frozen.size == 0);
+			EXPECT(FROZEN_TABLE_GET(frozen, "a") == CRZ_NULL);
+		});
+	});
+
+	DESCRIBE("FROZEN_TABLE_GET", {
+		TEST("Returning CRZ_NULL when nonexistent", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 4);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+			HASH_TABLE_INSERT(&ht, "b", 2);
+			HASH_TABLE_FREEZE(ht, &frozen);
+
+			// Act
+			size_t *result = FROZEN_TABLE_GET(frozen, "c");
+
+			// Assert
+			EXPECT(result == CRZ_NULL);
+		});
+	});
+
+	DESCRIBE("FROZEN_TABLE_EMIT", {
+		TEST("Writing C source for a frozen table", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 4);
+			HASH_TABLE_INSERT(&ht, "a\"b", 1);
+			HASH_TABLE_FREEZE(ht, &frozen);
+
+			// Act
+			size_t read = emit();
+
+			// Assert
+			EXPECT(read > 0);
+			EXPECT(strstr(source, "97, 34, 98, 0,") != CRZ_NULL);
+			EXPECT(strstr(source, "static size_t table_values[] = {\n"
+					      "\t1,\n") != CRZ_NULL);
+			EXPECT(strstr(source, "static FROZEN_TABLE(size_t) table"
+					      " = {") != CRZ_NULL);
+		});
+
+		TEST("Writing the source for a table with non-ASCII keys", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 4);
+			HASH_TABLE_INSERT(&ht, "café", 7);
+			HASH_TABLE_INSERT(&ht, "naïve", 8);
+			HASH_TABLE_FREEZE(ht, &frozen);
+
+			// Act
+			emit();
+
+			// Assert
+			EXPECT(emits_unsigned_keys());
+			EXPECT(strstr(source, "-61") == CRZ_NULL);
+		});
+	});
+})
@@ -0,0 +1,235 @@
+#include "crzhamt.h"
+#include "crztest.h"
+#include <pthread.h>
+#include <stdio.h>
+
+#define COUNT 5000
+#define READERS 4
+#define VERSIONS 2000
+
+static Hamt map;
+static Hamt next;
+static HamtCell cell;
+static CRZ_BOOL cell_used = CRZ_FALSE;
+static atomic_bool publishing_done;
+
+static char *key(int i)
+{
+	static char buffer[32];
+	CRZ_SPRINTF(buffer, "key-%d", i);
+	return buffer;
+}
+
+static int value_at(const Hamt *selfp, int i)
+{
+	const int *value = HAMT_GET(*selfp, key(i));
+	return value ? *value : -1;
+}
+
+static void set(Hamt *selfp, int i, int value)
+{
+	Hamt result = HAMT_SET(*selfp, key(i), &value);
+	HAMT_FREE(selfp);
+	*selfp = result;
+}
+
+static void fill(int count)
+{
+	for (int i = 0; i < count; i++)
+		set(&map, i, i * 2);
+}
+
+// Whether every key below `count` is valued twice, except for removed ones
+static CRZ_BOOL holds(const Hamt *selfp, int count, int removed_every)
+{
+	for (int i = 0; i < count; i++) {
+		CRZ_BOOL removed = removed_every && i % removed_every == 0;
+		if (value_at(selfp, i) != (removed ? -1 : i * 2))
+			return CRZ_FALSE;
+	}
+	return CRZ_TRUE;
+}
+
+// Each version has both keys valued the same, so a torn read would show
+static void *read_versions(void *arg)
+{
+	CRZ_BOOL consistent = CRZ_TRUE;
+	while (!atomic_load(&publishing_done)) {
+		Hamt version = HAMT_CELL_LOAD(&cell);
+		const int *a = HAMT_GET(version, "a");
+		const int *b = HAMT_GET(version, "b");
+		consistent = consistent && (a == CRZ_NULL) == (b == CRZ_NULL) &&
+			     (a == CRZ_NULL || *a == *b);
+		HAMT_FREE(&version);
+	}
+	return consistent ? arg : CRZ_NULL;
+}
+
+void reset(void)
+{
+	map = HAMT_NEW(int);
+	next = HAMT_NEW(int);
+}
+
+void cleanup(void)
+{
+	HAMT_FREE(&map);
+	HAMT_FREE(&next);
+	if (cell_used)
+		HAMT_CELL_FREE(&cell);
+	cell_used = CRZ_FALSE;
+}
+
+TEST_MAIN({
+	BEFORE_EACH(reset);
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("HAMT_SET", {
+		TEST("Getting from an empty map", {
+			// Assert
+			EXPECT(HAMT_GET(map, "a") == CRZ_NULL);
+			EXPECT(map.len == 0);
+		});
+
+		TEST("Getting set keys", {
+			// Act
+			fill(COUNT);
+
+			// Assert
+			EXPECT(map.len == COUNT);
+			EXPECT(holds(&map, COUNT, 0));
+			EXPECT(HAMT_GET(map, "missing") == CRZ_NULL);
+		});
+
+		TEST("Keeping the previous version unchanged", {
+			// Arrange
+			fill(COUNT);
+			int value = -2;
+
+			// Act
+			next = HAMT_SET(map, key(7), &value);
+
+			// Assert
+			EXPECT(value_at(&next, 7) == -2);
+			EXPECT(value_at(&map, 7) == 14);
+			EXPECT(next.len == COUNT);
+			EXPECT(holds(&map, COUNT, 0));
+		});
+
+		TEST("Sharing all but the path to the set key", {
+			// Arrange
+			fill(COUNT);
+			int value = 1;
+
+			// Act
+			next = HAMT_SET(map, key(COUNT), &value);
+
+			// Assert
+			Crzhamt_Inner *root = (Crzhamt_Inner *)next.root;
+			CRZ_SIZE count = crzhamt_count(root);
+			CRZ_SIZE shared = 0;
+			for (CRZ_SIZE i = 0; i < count; i++) {
+				Crzhamt_Node *child = root->children[i];
+				shared += atomic_load(&child->refs) == 2;
+			}
+			EXPECT(next.len == COUNT + 1);
+			EXPECT(shared == count - 1);
+		});
+	});
+
+	DESCRIBE("HAMT_REMOVE", {
+		TEST("Removing keys", {
+			// Arrange
+			fill(COUNT);
+
+			// Act
+			next = HAMT_CLONE(map);
+			for (int i = 0; i < COUNT; i += 3) {
+				Hamt removed = HAMT_REMOVE(next, key(i));
+				HAMT_FREE(&next);
+				next = removed;
+			}
+
+			// Assert
+			EXPECT(next.len == COUNT - (COUNT + 2) / 3);
+			EXPECT(holds(&next, COUNT, 3));
+			EXPECT(holds(&map, COUNT, 0));
+		});
+
+		TEST("Removing a missing key", {
+			// Arrange
+			fill(10);
+
+			// Act
+			next = HAMT_REMOVE(map, "missing");
+
+			// Assert
+			EXPECT(next.root == map.root);
+			EXPECT(next.len == 10);
+		});
+
+		TEST("Removing every key", {
+			// Arrange
+			fill(COUNT);
+
+			// Act
+			for (int i = 0; i < COUNT; i++) {
+				Hamt removed = HAMT_REMOVE(map, key(i));
+				HAMT_FREE(&map);
+				map = removed;
+			}
+
+			// Assert
+			EXPECT(map.len == 0);
+			EXPECT(map.root == CRZ_NULL);
+		});
+	});
+
+	DESCRIBE("HamtCell", {
+		TEST("Loading a published version", {
+			// Arrange
+			HAMT_CELL_INIT(&cell, int);
+			cell_used = CRZ_TRUE;
+			fill(10);
+
+			// Act
+			HAMT_CELL_PUBLISH(&cell, map);
+			next = HAMT_CELL_LOAD(&cell);
+
+			// Assert
+			EXPECT(next.root == map.root);
+			EXPECT(holds(&next, 10, 0));
+		});
+
+		TEST("Publishing while other threads read", {
+			// Arrange
+			HAMT_CELL_INIT(&cell, int);
+			cell_used = CRZ_TRUE;
+			atomic_store(&publishing_done, CRZ_FALSE);
+			pthread_t readers[READERS];
+			for (int i = 0; i < READERS; i++) {
+				pthread_create(&readers[i], CRZ_NULL,
+					       read_versions, &cell);
+			}
+
+			// Act
+			for (int version = 0; version < VERSIONS; version++) {
+				Hamt a = HAMT_SET(map, "a", &version);
+				HAMT_FREE(&map);
+				map = HAMT_SET(a, "b", &version);
+				HAMT_FREE(&a);
+				HAMT_CELL_PUBLISH(&cell, map);
+			}
+			atomic_store(&publishing_done, CRZ_TRUE);
+
+			// Assert
+			CRZ_BOOL consistent = CRZ_TRUE;
+			for (int i = 0; i < READERS; i++) {
+				void *result;
+				pthread_join(readers[i], &result);
+				consistent = consistent && result != CRZ_NULL;
+			}
+			EXPECT(consistent);
+		});
+	});
+})
@@ -0,0 +1,93 @@
+// Hash keys by their first letter only, so that most keys collide
+#define CRZHASH_HASH(key) ((CRZ_SIZE)(unsigned char)(key)[0])
+#include "crzhamt.h"
+#include "crztest.h"
+
+static Hamt map;
+static Hamt next;
+
+static void set(Hamt *selfp, CRZ_STRING set_key, int value)
+{
+	Hamt result = HAMT_SET(*selfp, set_key, &value);
+	HAMT_FREE(selfp);
+	*selfp = result;
+}
+
+static int value_at(const Hamt *selfp, CRZ_STRING get_key)
+{
+	const int *value = HAMT_GET(*selfp, get_key);
+	return value ? *value : -1;
+}
+
+void reset(void)
+{
+	map = HAMT_NEW(int);
+	next = HAMT_NEW(int);
+}
+
+void cleanup(void)
+{
+	HAMT_FREE(&map);
+	HAMT_FREE(&next);
+}
+
+TEST_MAIN({
+	BEFORE_EACH(reset);
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("Colliding hashes", {
+		TEST("Getting keys which share a hash", {
+			// Act
+			set(&map, "apple", 1);
+			set(&map, "avocado", 2);
+			set(&map, "apricot", 3);
+			set(&map, "banana", 4);
+
+			// Assert
+			EXPECT(map.len == 4);
+			EXPECT(value_at(&map, "apple") == 1);
+			EXPECT(value_at(&map, "avocado") == 2);
+			EXPECT(value_at(&map, "apricot") == 3);
+			EXPECT(value_at(&map, "banana") == 4);
+			EXPECT(value_at(&map, "almond") == -1);
+		});
+
+		TEST("Replacing a key which shares a hash", {
+			// Arrange
+			set(&map, "apple", 1);
+			set(&map, "avocado", 2);
+
+			// Act
+			int value = 5;
+			next = HAMT_SET(map, "avocado", &value);
+
+			// Assert
+			EXPECT(next.len == 2);
+			EXPECT(value_at(&next, "avocado") == 5);
+			EXPECT(value_at(&map, "avocado") == 2);
+		});
+
+		TEST("Removing keys which share a hash", {
+			// Arrange
+			set(&map, "apple", 1);
+			set(&map, "avocado", 2);
+			set(&map, "apricot", 3);
+			set(&map, "banana", 4);
+
+			// Act
+			next = HAMT_REMOVE(map, "avocado");
+			Hamt fewer = HAMT_REMOVE(next, "apple");
+
+			// Assert
+			EXPECT(next.len == 3);
+			EXPECT(value_at(&next, "avocado") == -1);
+			EXPECT(value_at(&next, "apricot") == 3);
+			EXPECT(fewer.len == 2);
+			EXPECT(fewer.root->kind == CRZHAMT_INNER);
+			EXPECT(value_at(&fewer, "apricot") == 3);
+			EXPECT(value_at(&fewer, "banana") == 4);
+			EXPECT(value_at(&map, "avocado") == 2);
+			HAMT_FREE(&fewer);
+		});
+	});
+})
@@ -7,11 +7,16 @@
 		HASH_TABLE_DEBUG(ht, "%zu"); \
 	} while (0)
 
+// Not a multiple of `CRZHASH_BATCH_SIZE`, to cover a partial batch
+#define BATCH_COUNT 100
+
 static HASH_TABLE(size_t) ht = HASH_TABLE_NEW();
+static HASH_TABLE(size_t) exact = HASH_TABLE_NEW();
 
 void cleanup(void)
 {
 	HASH_TABLE_FREE(&ht);
+	HASH_TABLE_FREE(&exact);
 }
 
 TEST_MAIN({
@@ -100,5 +105,337 @@ TEST_MAIN({
 			// Assert
 			EXPECT(result == CRZ_NULL);
 		});
+
+		TEST("Returning CRZ_NULL when nonexistent in a full table", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+			HASH_TABLE_INSERT(&ht, "b", 2);
+
+			// Act
+			HASH_PAIR(size_t) *result = HASH_TABLE_GET(ht, "c");
+
+			// Assert
+			EXPECT(ht.size == 2);
+			EXPECT(result == CRZ_NULL);
+		});
+	});
+
+	DESCRIBE("HASH_TABLE_GET_BATCH", {
+		TEST("Returning the same pairs as HASH_TABLE_GET", {
+			// Arrange
+			char keys[BATCH_COUNT][32];
+			CRZ_STRING key_ptrs[BATCH_COUNT];
+			HASH_TABLE_INIT(&ht, 8);
+			for (size_t i = 0; i < BATCH_COUNT; i++) {
+				CRZ_SPRINTF(keys[i], "key-%zu", i);
+				key_ptrs[i] = keys[i];
+				// Leave every third key out of the table
+				if (i % 3 != 0)
+					HASH_TABLE_INSERT(&ht, keys[i], i);
+			}
+
+			// Act
+			HASH_PAIR(size_t) *results[BATCH_COUNT];
+			HASH_TABLE_GET_BATCH(ht, key_ptrs, BATCH_COUNT,
+					     results);
+
+			// Assert
+			for (size_t i = 0; i < BATCH_COUNT; i++) {
+				void *expected = HASH_TABLE_GET(ht, keys[i]);
+				EXPECTF(results[i] == expected,
+					"Mismatch for %s\n", keys[i]);
+				EXPECT((expected == CRZ_NULL) == (i % 3 == 0));
+			}
+		});
+
+		TEST("Handling an empty batch", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+
+			// Act
+			HASH_TABLE_GET_BATCH(ht, CRZ_NULL, 0, CRZ_NULL);
+
+			// Assert
+			EXPECT(ht.size == 2);
+		});
+	});
+
+	DESCRIBE("HASH_TABLE_ENTRY", {
+		TEST("Creating a zeroed pair when nonexistent", {
+			// Arrange
+			CRZ_BOOL created = CRZ_FALSE;
+			HASH_TABLE_INIT(&ht, 2);
+
+			// Act
+			HASH_PAIR(size_t) *entry =
+				HASH_TABLE_ENTRY(&ht, "a", &created);
+
+			// Assert
+			EXPECT(created);
+			EXPECT(entry != CRZ_NULL && entry->value == 0);
+			EXPECT(entry == HASH_TABLE_GET(ht, "a"));
+		});
+
+		TEST("Returning the existing pair", {
+			// Arrange
+			CRZ_BOOL created = CRZ_TRUE;
+			HASH_TABLE_INIT(&ht, 2);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+
+			// Act
+			HASH_PAIR(size_t) *entry =
+				HASH_TABLE_ENTRY(&ht, "a", &created);
+
+			// Assert
+			EXPECT(!created);
+			EXPECT(entry != CRZ_NULL && entry->value == 1);
+		});
+
+		TEST("Counting in place while growing", {
+			// Arrange
+			char key[32];
+			HASH_TABLE_INIT(&ht, 2);
+
+			// Act
+			for (size_t i = 0; i < BATCH_COUNT * 3; i++) {
+				CRZ_SPRINTF(key, "key-%zu", i % BATCH_COUNT);
+				HASH_PAIR(size_t) *entry =
+					HASH_TABLE_ENTRY(&ht, key, CRZ_NULL);
+				entry->value += 1;
+			}
+
+			// Assert
+			EXPECT(HASH_TABLE_STATS(ht).count == BATCH_COUNT);
+			for (size_t i = 0; i < BATCH_COUNT; i++) {
+				CRZ_SPRINTF(key, "key-%zu", i);
+				HASH_PAIR(size_t) *result =
+					HASH_TABLE_GET(ht, key);
+				EXPECTF(result && result->value == 3,
+					"Wrong count for %s\n", key);
+			}
+		});
+	});
+
+	DESCRIBE("HASH_TABLE_REMOVE", {
+		TEST("Removing an existing key", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 4);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+			HASH_TABLE_INSERT(&ht, "b", 2);
+
+			// Act
+			CRZ_BOOL removed = HASH_TABLE_REMOVE(&ht, "a");
+
+			// Assert
+			EXPECT(removed);
+			EXPECT(HASH_TABLE_GET(ht, "a") == CRZ_NULL);
+			HASH_PAIR(size_t) *result = HASH_TABLE_GET(ht, "b");
+			EXPECT(result != CRZ_NULL && result->value == 2);
+		});
+
+		TEST("Removing a nonexistent key", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+			HASH_TABLE_INSERT(&ht, "b", 2);
+
+			// Act & Assert
+			EXPECT(!HASH_TABLE_REMOVE(&ht, "c"));
+			EXPECT(HASH_TABLE_GET(ht, "a") != CRZ_NULL);
+		});
+
+		TEST("Keeping colliding keys reachable", {
+			// Arrange
+			char key[32];
+			HASH_TABLE_INIT(&ht, 64);
+			for (size_t i = 0; i < 48; i++) {
+				CRZ_SPRINTF(key, "key-%zu", i);
+				HASH_TABLE_INSERT(&ht, key, i);
+			}
+
+			// Act
+			for (size_t i = 0; i < 48; i += 2) {
+				CRZ_SPRINTF(key, "key-%zu", i);
+				HASH_TABLE_REMOVE(&ht, key);
+			}
+
+			// Assert
+			EXPECT(HASH_TABLE_STATS(ht).count == 24);
+			for (size_t i = 0; i < 48; i++) {
+				CRZ_SPRINTF(key, "key-%zu", i);
+				HASH_PAIR(size_t) *result =
+					HASH_TABLE_GET(ht, key);
+				CRZ_BOOL kept = result && result->value == i;
+				EXPECTF(i % 2 == 0 ? result == CRZ_NULL : kept,
+					"Key %zu", i);
+			}
+		});
+	});
+
+	DESCRIBE("HASH_TABLE_STATS", {
+		TEST("Reporting an empty table", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 4);
+
+			// Act
+			HashTableStats stats = HASH_TABLE_STATS(ht);
+
+			// Assert
+			EXPECT(stats.size == 4);
+			EXPECT(stats.count == 0);
+			EXPECT(stats.load_factor == 0.0);
+			EXPECT(stats.cluster_count == 0);
+		});
+
+		TEST("Reporting probe lengths and clusters with collision", {
+			// Invariant
+			EXPECT(crzhash_djb2("ab") % 4 ==
+			       crzhash_djb2("ba") % 4);
+
+			// Arrange
+			HASH_TABLE_INIT(&ht, 4);
+			HASH_TABLE_INSERT(&ht, "ab", 1);
+			HASH_TABLE_INSERT(&ht, "ba", 2);
+
+			// Act
+			HashTableStats stats = HASH_TABLE_STATS(ht);
+
+			// Assert
+			EXPECT(stats.count == 2);
+			EXPECT(stats.load_factor == 0.5);
+			EXPECT(stats.max_probe_length == 1);
+			EXPECT(stats.average_probe_length == 0.5);
+			EXPECT(stats.cluster_count == 1);
+			EXPECT(stats.max_cluster_size == 2);
+		});
+	});
+
+	DESCRIBE("HASH_TABLE_RESERVE", {
+		TEST("Initializing a zero-initialized table", {
+			// Act
+			HASH_TABLE_RESERVE(&ht, 3);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+
+			// Assert
+			HASH_PAIR(size_t) *result = HASH_TABLE_GET(ht, "a");
+			EXPECT(result != CRZ_NULL && result->value == 1);
+			EXPECT(ht.size * CRZHASH_TARGET_LOAD_PERCENT >=
+			       3 * 100);
+		});
+
+		TEST("Growing a table while keeping its pairs", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+			HASH_TABLE_INSERT(&ht, "b", 2);
+
+			// Act
+			HASH_TABLE_RESERVE(&ht, 100);
+
+			// Assert
+			HASH_PAIR(size_t) *result = HASH_TABLE_GET(ht, "b");
+			EXPECT(result != CRZ_NULL && result->value == 2);
+			EXPECT(HASH_TABLE_STATS(ht).load_factor <=
+			       CRZHASH_TARGET_LOAD_PERCENT / 100.0);
+		});
+
+		TEST("Not shrinking a large enough table", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 64);
+
+			// Act
+			HASH_TABLE_RESERVE(&ht, 2);
+
+			// Assert
+			EXPECT(ht.size == 64);
+		});
+	});
+
+	DESCRIBE("HASH_TABLE_SHRINK", {
+		TEST("Shrinking a sparse table while keeping its pairs", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 64);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+			HASH_TABLE_INSERT(&ht, "b", 2);
+			HASH_TABLE_INSERT(&ht, "c", 3);
+
+			// Act
+			HASH_TABLE_SHRINK(&ht);
+
+			// Assert
+			EXPECT(ht.size == 4);
+			HASH_PAIR(size_t) *result = HASH_TABLE_GET(ht, "c");
+			EXPECT(result != CRZ_NULL && result->value == 3);
+		});
+	});
+
+	DESCRIBE("crzhash_key_hash", {
+		TEST("Hashing keys regardless of case", {
+			// Assert
+			EXPECT(crzhash_key_hash(CRZ_TRUE, "Content-Type") ==
+			       crzhash_key_hash(CRZ_TRUE, "content-TYPE"));
+			EXPECT(crzhash_key_hash(CRZ_FALSE, "Content-Type") ==
+			       CRZHASH_HASH("Content-Type"));
+			EXPECT(crzhash_key_eq(CRZ_TRUE, "Content-Type",
+					      "content-TYPE"));
+			EXPECT(!crzhash_key_eq(CRZ_TRUE, "Content-Type",
+					       "Content-Typ"));
+			EXPECT(!crzhash_key_eq(CRZ_TRUE, "Content-Typ",
+					       "Content-Type"));
+			EXPECT(!crzhash_key_eq(CRZ_FALSE, "Content-Type",
+					       "content-TYPE"));
+		});
+	});
+
+	DESCRIBE("HASH_TABLE_INIT_ICASE", {
+		TEST("Looking up a hash table regardless of case", {
+			// Arrange
+			HASH_TABLE_INIT_ICASE(&ht, 8);
+
+			// Act
+			HASH_TABLE_INSERT(&ht, "Content-Type", 1);
+			HASH_TABLE_INSERT(&ht, "CONTENT-TYPE", 2);
+
+			// Assert
+			HASH_PAIR(size_t) *result =
+				HASH_TABLE_GET(ht, "content-type");
+			EXPECT(result != CRZ_NULL && result->value == 2);
+			EXPECT(HASH_TABLE_STATS(ht).count == 1);
+			EXPECT(HASH_TABLE_REMOVE(&ht, "content-type"));
+		});
+
+		TEST("Keeping other tables case-sensitive", {
+			// Arrange
+			HASH_TABLE_INIT_ICASE(&ht, 8);
+			HASH_TABLE_INIT(&exact, 8);
+
+			// Act
+			HASH_TABLE_INSERT(&ht, "Host", 1);
+			HASH_TABLE_INSERT(&exact, "Host", 1);
+
+			// Assert
+			EXPECT(HASH_TABLE_GET(ht, "HOST") != CRZ_NULL);
+			EXPECT(HASH_TABLE_GET(exact, "HOST") == CRZ_NULL);
+			EXPECT(HASH_TABLE_GET(exact, "Host") != CRZ_NULL);
+		});
+
+		TEST("Ignoring case after resizing", {
+			// Arrange
+			char key[16];
+			HASH_TABLE_INIT_ICASE(&ht, 2);
+
+			// Act
+			for (int i = 0; i < 100; i++) {
+				CRZ_SPRINTF(key, "Header-%d", i);
+				HASH_TABLE_INSERT(&ht, key, (size_t)i);
+			}
+
+			// Assert
+			HASH_PAIR(size_t) *result =
+				HASH_TABLE_GET(ht, "HEADER-99");
+			EXPECT(ht.icase);
+			EXPECT(result != CRZ_NULL && result->value == 99);
+		});
 	});
 })
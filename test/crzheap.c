@@ -0,0 +1,174 @@
+#include "crzheap.h"
+#include "crztest.h"
+#include <stdlib.h>
+
+#define COUNT 1000
+#define K 10
+
+#define INT_LESS(a, b) ((a) < (b))
+
+typedef struct {
+	unsigned long deadline;
+	int id;
+} Timer;
+
+#define TIMER_LESS(a, b) ((a).deadline < (b).deadline)
+
+static ARRAY(int) h = ARRAY_NEW();
+static ARRAY(Timer) timers = ARRAY_NEW();
+
+Timer timer(unsigned long deadline, int id)
+{
+	Timer result = { .deadline = deadline, .id = id };
+	return result;
+}
+
+void cleanup(void)
+{
+	ARRAY_FREE(&h);
+	ARRAY_FREE(&timers);
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("HEAP_PUSH", {
+		TEST("Popping pushed elements in order", {
+			// Arrange
+			srand(1);
+			for (int i = 0; i < COUNT; i++)
+				HEAP_PUSH(&h, rand() % 100, INT_LESS);
+
+			// Act
+			int previous = -1;
+			CRZ_BOOL sorted = CRZ_TRUE;
+			while (h.len > 0) {
+				int popped;
+				HEAP_POP(&h, &popped, INT_LESS);
+				sorted = sorted && previous <= popped;
+				previous = popped;
+			}
+
+			// Assert
+			EXPECT(sorted);
+		});
+
+		TEST("Ordering structs by a field", {
+			// Arrange
+			Timer a = timer(30, 1);
+			Timer b = timer(10, 2);
+			Timer c = timer(20, 3);
+
+			// Act
+			HEAP_PUSH(&timers, a, TIMER_LESS);
+			HEAP_PUSH(&timers, b, TIMER_LESS);
+			HEAP_PUSH(&timers, c, TIMER_LESS);
+
+			// Assert
+			EXPECT(HEAP_PEEK(timers).id == 2);
+			Timer popped;
+			HEAP_POP(&timers, &popped, TIMER_LESS);
+			EXPECT(popped.id == 2 && HEAP_PEEK(timers).id == 3);
+		});
+	});
+
+	DESCRIBE("HEAPIFY", {
+		TEST("Reordering an existing array", {
+			// Arrange
+			srand(2);
+			for (int i = 0; i < COUNT; i++)
+				ARRAY_PUSH(&h, rand() % 100);
+
+			// Act
+			HEAPIFY(&h, INT_LESS);
+
+			// Assert
+			for (CRZ_SIZE i = 1; i < h.len; i++)
+				EXPECT(h.ptr[(i - 1) / 2] <= h.ptr[i]);
+		});
+	});
+
+	DESCRIBE("HEAP_PUSH_BOUNDED", {
+		TEST("Keeping the largest elements", {
+			// Act
+			for (int i = 0; i < COUNT; i++) {
+				// Push in a scrambled order
+				int element = (i * 7919) % COUNT;
+				HEAP_PUSH_BOUNDED(&h, element, K, INT_LESS);
+			}
+
+			// Assert
+			EXPECT(h.len == K);
+			EXPECT(HEAP_PEEK(h) == COUNT - K);
+		});
+
+		TEST("Evaluating the element once", {
+			// Arrange
+			int next = 0;
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				HEAP_PUSH_BOUNDED(&h, next++, K, INT_LESS);
+
+			// Assert
+			EXPECT(next == COUNT);
+			EXPECT(h.len == K);
+			EXPECT(HEAP_PEEK(h) == COUNT - K);
+		});
+	});
+
+	DESCRIBE("DARY_HEAP_PUSH", {
+		TEST("Popping pushed elements in order", {
+			// Arrange
+			srand(3);
+			for (int i = 0; i < COUNT; i++)
+				DARY_HEAP_PUSH(&h, rand() % 100, INT_LESS);
+
+			// Act
+			int previous = -1;
+			CRZ_BOOL sorted = CRZ_TRUE;
+			while (h.len > 0) {
+				int popped;
+				DARY_HEAP_POP(&h, &popped, INT_LESS);
+				sorted = sorted && previous <= popped;
+				previous = popped;
+			}
+
+			// Assert
+			EXPECT(sorted);
+		});
+	});
+
+	DESCRIBE("DARY_HEAPIFY", {
+		TEST("Reordering an existing array", {
+			// Arrange
+			srand(4);
+			for (int i = 0; i < COUNT; i++)
+				ARRAY_PUSH(&h, rand() % 100);
+
+			// Act
+			DARY_HEAPIFY(&h, INT_LESS);
+
+			// Assert
+			for (CRZ_SIZE i = 1; i < h.len; i++) {
+				EXPECT(h.ptr[(i - 1) / CRZHEAP_ARITY] <=
+				       h.ptr[i]);
+			}
+		});
+	});
+
+	DESCRIBE("DARY_HEAP_PUSH_BOUNDED", {
+		TEST("Keeping the largest elements", {
+			// Act
+			for (int i = 0; i < COUNT; i++) {
+				int element = (i * 7919) % COUNT;
+				DARY_HEAP_PUSH_BOUNDED(&h, element, K,
+						       INT_LESS);
+			}
+
+			// Assert
+			EXPECT(h.len == K);
+			EXPECT(HEAP_PEEK(h) == COUNT - K);
+		});
+	});
+})
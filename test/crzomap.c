@@ -0,0 +1,128 @@
+#include "crzomap.h"
+#include "crztest.h"
+
+#define COUNT 100
+#define KEY_SIZE 32
+
+static ORDERED_TABLE(size_t) ot = ORDERED_TABLE_NEW();
+
+void cleanup(void)
+{
+	ORDERED_TABLE_FREE(&ot);
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("ORDERED_TABLE_INSERT", {
+		TEST("Inserting into a zero-initialized table", {
+			// Act
+			ORDERED_TABLE_INSERT(&ot, "a", 1);
+
+			// Assert
+			ORDERED_PAIR(size_t) *result =
+				ORDERED_TABLE_GET(ot, "a");
+			EXPECT(result != CRZ_NULL && result->value == 1);
+			EXPECT(ot.pairs.len == 1);
+		});
+
+		TEST("Properly inserting with collision", {
+			// Invariant
+			EXPECT(crzhash_djb2("ab") % 2 ==
+			       crzhash_djb2("ba") % 2);
+
+			// Arrange
+			ORDERED_TABLE_INIT(&ot, 2);
+
+			// Act
+			ORDERED_TABLE_INSERT(&ot, "ab", 1);
+			ORDERED_TABLE_INSERT(&ot, "ba", 2);
+
+			// Assert
+			ORDERED_PAIR(size_t) *ab = ORDERED_TABLE_GET(ot, "ab");
+			ORDERED_PAIR(size_t) *ba = ORDERED_TABLE_GET(ot, "ba");
+			EXPECT(ab != CRZ_NULL && ab->value == 1);
+			EXPECT(ba != CRZ_NULL && ba->value == 2);
+		});
+
+		TEST("Keeping insertion order while growing", {
+			// Arrange
+			char key[KEY_SIZE];
+			ORDERED_TABLE_INIT(&ot, 2);
+
+			// Act
+			for (size_t i = 0; i < COUNT; i++) {
+				CRZ_SPRINTF(key, "key-%zu", i);
+				ORDERED_TABLE_INSERT(&ot, key, i);
+			}
+
+			// Assert
+			EXPECT(ot.pairs.len == COUNT);
+			EXPECT(ot.pairs.len * 100 <=
+			       ot.size * CRZHASH_TARGET_LOAD_PERCENT);
+			ORDERED_TABLE_FOR(ot, i) {
+				CRZ_SPRINTF(key, "key-%zu", i);
+				EXPECTF(CRZ_STRING_EQ(ot.pairs.ptr[i].key,
+						      key) &&
+						ot.pairs.ptr[i].value == i,
+					"Out of order at %zu\n", i);
+			}
+		});
+
+		TEST("Overriding existing value in place", {
+			// Arrange
+			ORDERED_TABLE_INSERT(&ot, "a", 1);
+			ORDERED_TABLE_INSERT(&ot, "b", 2);
+
+			// Act
+			ORDERED_TABLE_INSERT(&ot, "a", 3);
+
+			// Assert
+			EXPECT(ot.pairs.len == 2);
+			EXPECT(CRZ_STRING_EQ(ot.pairs.ptr[0].key, "a"));
+			EXPECT(ot.pairs.ptr[0].value == 3);
+			EXPECT(CRZ_STRING_EQ(ot.pairs.ptr[1].key, "b"));
+		});
+	});
+
+	DESCRIBE("ORDERED_TABLE_GET", {
+		TEST("Returning CRZ_NULL from a zero-initialized table", {
+			// Act
+			ORDERED_PAIR(size_t) *result =
+				ORDERED_TABLE_GET(ot, "a");
+
+			// Assert
+			EXPECT(result == CRZ_NULL);
+		});
+
+		TEST("Returning CRZ_NULL when nonexistent", {
+			// Arrange
+			ORDERED_TABLE_INSERT(&ot, "a", 1);
+
+			// Act
+			ORDERED_PAIR(size_t) *result =
+				ORDERED_TABLE_GET(ot, "b");
+
+			// Assert
+			EXPECT(result == CRZ_NULL);
+		});
+	});
+
+	DESCRIBE("ORDERED_TABLE_INIT_ICASE", {
+		TEST("Looking up an ordered table regardless of case", {
+			// Arrange
+			ORDERED_TABLE_INIT_ICASE(&ot, 8);
+
+			// Act
+			ORDERED_TABLE_INSERT(&ot, "Host", 1);
+			ORDERED_TABLE_INSERT(&ot, "Accept", 2);
+			ORDERED_TABLE_INSERT(&ot, "host", 3);
+
+			// Assert
+			ORDERED_PAIR(size_t) *result =
+				ORDERED_TABLE_GET(ot, "HOST");
+			EXPECT(result != CRZ_NULL && result->value == 3);
+			EXPECT(ot.pairs.len == 2);
+		});
+	});
+})
@@ -0,0 +1,351 @@
+#include "crzpack.h"
+#include "crztest.h"
+
+#define COUNT 1000
+
+typedef ARRAY(uint64_t) U64Array;
+typedef ARRAY(int64_t) I64Array;
+typedef ARRAY(uint32_t) U32Array;
+
+static const int64_t samples[] = { 0, -1, 1, -64, 64, INT64_MIN, INT64_MAX };
+#define SAMPLES (sizeof(samples) / sizeof(samples[0]))
+
+static StringBuilder sb;
+static U64Array values;
+static U64Array unpacked;
+static I64Array signed_values;
+static I64Array signed_unpacked;
+static U32Array small_values;
+static U32Array small_unpacked;
+
+// Sorted IDs with small gaps, as kept in ID lists
+static void fill_sorted(void)
+{
+	uint64_t id = 1000000;
+	for (uint64_t i = 0; i < COUNT; i++) {
+		id += (i * 7919) % 300 + 1;
+		ARRAY_PUSH(&values, id);
+		ARRAY_PUSH(&small_values, (uint32_t)id);
+	}
+}
+
+// Values of every byte length, including the largest
+static void fill_mixed(void)
+{
+	for (uint64_t i = 0; i < COUNT; i++) {
+		uint64_t value = (i * 0x9e3779b97f4a7c15ull) >> (i % 64);
+		ARRAY_PUSH(&values, value);
+		ARRAY_PUSH(&small_values, (uint32_t)(value >> (i % 32)));
+	}
+	ARRAY_PUSH(&values, UINT64_MAX);
+	ARRAY_PUSH(&small_values, UINT32_MAX);
+}
+
+static StringView packed(void)
+{
+	return SV_FROM_BUF(sb.ptr, sb.len);
+}
+
+static CRZ_BOOL same_values(void)
+{
+	if (unpacked.len != values.len)
+		return CRZ_FALSE;
+	return memcmp(unpacked.ptr, values.ptr,
+		      values.len * sizeof(uint64_t)) == 0;
+}
+
+static CRZ_BOOL same_small_values(void)
+{
+	if (small_unpacked.len != small_values.len)
+		return CRZ_FALSE;
+	return memcmp(small_unpacked.ptr, small_values.ptr,
+		      small_values.len * sizeof(uint32_t)) == 0;
+}
+
+// Whether iterating over `sb` yields `values`
+static CRZ_BOOL iterates_values(void)
+{
+	PackIter iter;
+	uint64_t value;
+	CRZ_SIZE count = 0;
+	if (!PACK_ITER_INIT(&iter, packed()))
+		return CRZ_FALSE;
+	while (PACK_ITER_NEXT(&iter, &value)) {
+		if (count >= values.len || value != values.ptr[count])
+			return CRZ_FALSE;
+		count++;
+	}
+	return count == values.len;
+}
+
+void reset(void)
+{
+	sb = (StringBuilder)ARRAY_NEW();
+	values = (U64Array)ARRAY_NEW();
+	unpacked = (U64Array)ARRAY_NEW();
+	signed_values = (I64Array)ARRAY_NEW();
+	signed_unpacked = (I64Array)ARRAY_NEW();
+	small_values = (U32Array)ARRAY_NEW();
+	small_unpacked = (U32Array)ARRAY_NEW();
+}
+
+void cleanup(void)
+{
+	ARRAY_FREE(&sb);
+	ARRAY_FREE(&values);
+	ARRAY_FREE(&unpacked);
+	ARRAY_FREE(&signed_values);
+	ARRAY_FREE(&signed_unpacked);
+	ARRAY_FREE(&small_values);
+	ARRAY_FREE(&small_unpacked);
+}
+
+TEST_MAIN({
+	BEFORE_EACH(reset);
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("PACK_VARINTS", {
+		TEST("Unpacking packed values", {
+			// Arrange
+			fill_mixed();
+
+			// Act
+			PACK_VARINTS(&sb, values);
+
+			// Assert
+			EXPECT(UNPACK_VARINTS(packed(), &unpacked));
+			EXPECT(same_values());
+			EXPECT(iterates_values());
+		});
+
+		TEST("Packing small values into a byte each", {
+			// Arrange
+			for (uint64_t i = 0; i < 128; i++)
+				ARRAY_PUSH(&values, i);
+
+			// Act
+			PACK_VARINTS(&sb, values);
+
+			// Assert
+			EXPECT(sb.len == 1 + 2 + 128);
+		});
+
+		TEST("Unpacking no values", {
+			// Act
+			PACK_VARINTS(&sb, values);
+
+			// Assert
+			EXPECT(UNPACK_VARINTS(packed(), &unpacked));
+			EXPECT(unpacked.len == 0);
+			EXPECT(iterates_values());
+		});
+	});
+
+	DESCRIBE("PACK_ZIGZAGS", {
+		TEST("Unpacking packed signed values", {
+			// Arrange
+			for (CRZ_SIZE i = 0; i < SAMPLES; i++)
+				ARRAY_PUSH(&signed_values, samples[i]);
+
+			// Act
+			PACK_ZIGZAGS(&sb, signed_values);
+
+			// Assert
+			EXPECT(UNPACK_ZIGZAGS(packed(), &signed_unpacked));
+			EXPECT(signed_unpacked.len == SAMPLES);
+			EXPECT(memcmp(signed_unpacked.ptr, samples,
+				      sizeof(samples)) == 0);
+		});
+
+		TEST("Packing small negative values into a byte each", {
+			// Arrange
+			for (int64_t i = -64; i < 0; i++)
+				ARRAY_PUSH(&signed_values, i);
+
+			// Act
+			PACK_ZIGZAGS(&sb, signed_values);
+
+			// Assert
+			EXPECT(sb.len == 2 + 64);
+		});
+	});
+
+	DESCRIBE("PACK_DELTAS", {
+		TEST("Unpacking packed sorted values", {
+			// Arrange
+			fill_sorted();
+
+			// Act
+			PACK_DELTAS(&sb, values);
+
+			// Assert
+			EXPECT(UNPACK_DELTAS(packed(), &unpacked));
+			EXPECT(same_values());
+			EXPECT(iterates_values());
+			EXPECT(sb.len < COUNT * 2 + 8);
+		});
+
+		TEST("Unpacking packed unsorted values", {
+			// Arrange
+			fill_mixed();
+
+			// Act
+			PACK_DELTAS(&sb, values);
+
+			// Assert
+			EXPECT(UNPACK_DELTAS(packed(), &unpacked));
+			EXPECT(same_values());
+			EXPECT(iterates_values());
+		});
+	});
+
+	DESCRIBE("PACK_FOR", {
+		TEST("Unpacking packed sorted values", {
+			// Arrange
+			fill_sorted();
+
+			// Act
+			PACK_FOR(&sb, values);
+
+			// Assert
+			EXPECT(UNPACK_FOR(packed(), &unpacked));
+			EXPECT(same_values());
+			EXPECT(iterates_values());
+			EXPECT(sb.len < COUNT * 2);
+		});
+
+		TEST("Unpacking packed values of every bit width", {
+			// Arrange
+			fill_mixed();
+
+			// Act
+			PACK_FOR(&sb, values);
+
+			// Assert
+			EXPECT(UNPACK_FOR(packed(), &unpacked));
+			EXPECT(same_values());
+			EXPECT(iterates_values());
+		});
+
+		TEST("Packing equal values without any words", {
+			// Arrange
+			for (int i = 0; i < CRZPACK_BLOCK; i++)
+				ARRAY_PUSH(&values, 42);
+
+			// Act
+			PACK_FOR(&sb, values);
+
+			// Assert
+			EXPECT(sb.len == 1 + 2 + 1 + 1);
+			EXPECT(UNPACK_FOR(packed(), &unpacked));
+			EXPECT(same_values());
+		});
+	});
+
+	DESCRIBE("PACK_STREAMVBYTE", {
+		TEST("Unpacking packed values of every byte length", {
+			// Arrange
+			fill_mixed();
+
+			// Act
+			PACK_STREAMVBYTE(&sb, small_values);
+
+			// Assert
+			EXPECT(UNPACK_STREAMVBYTE(packed(), &small_unpacked));
+			EXPECT(same_small_values());
+		});
+
+		TEST("Unpacking packed sorted values as deltas", {
+			// Arrange
+			fill_sorted();
+
+			// Act
+			PACK_STREAMVBYTE_DELTAS(&sb, small_values);
+
+			// Assert
+			EXPECT(UNPACK_STREAMVBYTE_DELTAS(packed(),
+							 &small_unpacked));
+			EXPECT(same_small_values());
+			EXPECT(sb.len < COUNT * 2 + COUNT / 4 + 8);
+		});
+
+		TEST("Iterating over packed values", {
+			// Arrange
+			fill_sorted();
+
+			// Act
+			PACK_STREAMVBYTE_DELTAS(&sb, small_values);
+
+			// Assert
+			EXPECT(iterates_values());
+		});
+
+		TEST("Unpacking an amount which is not a multiple of 4", {
+			// Arrange
+			for (uint32_t i = 0; i < 7; i++)
+				ARRAY_PUSH(&small_values, i << (i * 4));
+
+			// Act
+			PACK_STREAMVBYTE(&sb, small_values);
+
+			// Assert
+			EXPECT(UNPACK_STREAMVBYTE(packed(), &small_unpacked));
+			EXPECT(same_small_values());
+		});
+	});
+
+	DESCRIBE("Malformed input", {
+		TEST("Rejecting another format", {
+			// Arrange
+			fill_sorted();
+			PACK_DELTAS(&sb, values);
+
+			// Assert
+			EXPECT(!UNPACK_VARINTS(packed(), &unpacked));
+			EXPECT(!UNPACK_FOR(packed(), &unpacked));
+			EXPECT(!UNPACK_STREAMVBYTE(packed(), &small_unpacked));
+		});
+
+		TEST("Rejecting cut short input", {
+			// Arrange
+			fill_mixed();
+			PACK_VARINTS(&sb, values);
+
+			// Act
+			StringView half = SV_FROM_BUF(sb.ptr, sb.len / 2);
+
+			// Assert
+			EXPECT(!UNPACK_VARINTS(half, &unpacked));
+			EXPECT(!UNPACK_VARINTS(SV_FROM_BUF(sb.ptr, 0),
+					       &unpacked));
+		});
+
+		TEST("Rejecting trailing bytes", {
+			// Arrange
+			fill_sorted();
+			PACK_STREAMVBYTE(&sb, small_values);
+			SB_PUSH_CHAR(&sb, 0);
+
+			// Assert
+			EXPECT(!UNPACK_STREAMVBYTE(packed(), &small_unpacked));
+		});
+
+		TEST("Stopping iteration at cut short input", {
+			// Arrange
+			fill_sorted();
+			PACK_FOR(&sb, values);
+			PackIter iter;
+			uint64_t value;
+			CRZ_SIZE count = 0;
+
+			// Act
+			PACK_ITER_INIT(&iter, SV_FROM_BUF(sb.ptr, sb.len - 8));
+			while (PACK_ITER_NEXT(&iter, &value))
+				count++;
+
+			// Assert
+			EXPECT(count < COUNT);
+			EXPECT(count % CRZPACK_BLOCK == 0);
+		});
+	});
+})
@@ -0,0 +1,58 @@
+#include "crzpool.h"
+#include "crztest.h"
+
+#define COUNT 10
+
+static Pool pool = POOL_NEW(4);
+static Pool zeroed = { 0 };
+
+void cleanup(void)
+{
+	POOL_FREE(&pool);
+	POOL_FREE(&zeroed);
+	pool.chunk_len = 4;
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("POOL_ALLOC", {
+		TEST("Allocating nodes in chunks of the pool's length", {
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				*(int *)POOL_ALLOC(&pool, sizeof(void *)) = i;
+
+			// Assert
+			EXPECT(pool.chunks.len == 3);
+			EXPECT(pool.used == 2);
+		});
+
+		TEST("Allocating a default chunk for a zeroed pool", {
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				POOL_ALLOC(&zeroed, sizeof(void *));
+
+			// Assert
+			EXPECT(zeroed.chunks.len == 1);
+			EXPECT(zeroed.used == COUNT);
+		});
+	});
+
+	DESCRIBE("POOL_RELEASE", {
+		TEST("Reusing released nodes", {
+			// Arrange
+			void *first = POOL_ALLOC(&pool, sizeof(void *));
+			void *second = POOL_ALLOC(&pool, sizeof(void *));
+			POOL_RELEASE(&pool, first);
+			POOL_RELEASE(&pool, second);
+
+			// Act
+			void *reused = POOL_ALLOC(&pool, sizeof(void *));
+
+			// Assert
+			EXPECT(reused == second);
+			EXPECT(POOL_ALLOC(&pool, sizeof(void *)) == first);
+			EXPECT(pool.used == 2);
+		});
+	});
+})
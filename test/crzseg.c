@@ -0,0 +1,94 @@
+#include "crzseg.h"
+#include "crztest.h"
+
+#define COUNT 1000
+
+static SEGMENTED_ARRAY(int) a = SEGMENTED_ARRAY_NEW();
+
+void cleanup(void)
+{
+	SEGMENTED_ARRAY_FREE(&a);
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("SEGMENTED_ARRAY_PUSH", {
+		TEST("Pushing a single element", {
+			// Act
+			SEGMENTED_ARRAY_PUSH(&a, 1);
+
+			// Assert
+			EXPECT(a.len == 1);
+			EXPECT(a.segment_count == 1);
+			EXPECT(SEGMENTED_ARRAY_GET(a, 0) == 1);
+		});
+
+		TEST("Keeping elements across segments", {
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				SEGMENTED_ARRAY_PUSH(&a, i);
+
+			// Assert
+			EXPECT(a.len == COUNT);
+			EXPECT(crzseg_capacity(a.segment_count) >= COUNT);
+			EXPECT(crzseg_capacity(a.segment_count - 1) < COUNT);
+			SEGMENTED_ARRAY_FOR(a, i) {
+				EXPECTF(SEGMENTED_ARRAY_GET(a, i) == (int)i,
+					"Mismatch at %zu\n", i);
+			}
+		});
+
+		TEST("Keeping element addresses stable while growing", {
+			// Arrange
+			SEGMENTED_ARRAY_PUSH(&a, 42);
+			int *first = SEGMENTED_ARRAY_AT(a, 0);
+
+			// Act
+			for (int i = 0; i < COUNT; i++)
+				SEGMENTED_ARRAY_PUSH(&a, i);
+
+			// Assert
+			EXPECT(SEGMENTED_ARRAY_AT(a, 0) == first);
+			EXPECT(*first == 42);
+		});
+	});
+
+	DESCRIBE("SEGMENTED_ARRAY_AT", {
+		TEST("Mapping indexes to segment boundaries", {
+			// Assert
+			EXPECT(crzseg_segment(0) == 0);
+			EXPECT(crzseg_segment(CRZSEG_FIRST_SIZE - 1) == 0);
+			EXPECT(crzseg_segment(CRZSEG_FIRST_SIZE) == 1);
+			EXPECT(crzseg_offset(CRZSEG_FIRST_SIZE) == 0);
+			EXPECT(crzseg_segment(CRZSEG_FIRST_SIZE * 3) == 2);
+			EXPECT(crzseg_offset(CRZSEG_FIRST_SIZE * 3 + 1) == 1);
+		});
+	});
+
+	DESCRIBE("SEGMENTED_ARRAY_RESERVE", {
+		TEST("Allocating segments without pushing", {
+			// Act
+			SEGMENTED_ARRAY_RESERVE(&a, COUNT);
+
+			// Assert
+			EXPECT(a.len == 0);
+			EXPECT(crzseg_capacity(a.segment_count) >= COUNT);
+		});
+	});
+
+	DESCRIBE("SEGMENTED_ARRAY_POP", {
+		TEST("Popping the last element", {
+			// Arrange
+			for (int i = 0; i <= (int)CRZSEG_FIRST_SIZE; i++)
+				SEGMENTED_ARRAY_PUSH(&a, i);
+
+			// Act
+			int popped = SEGMENTED_ARRAY_POP(&a);
+
+			// Assert
+			EXPECT(popped == (int)CRZSEG_FIRST_SIZE);
+			EXPECT(a.len == CRZSEG_FIRST_SIZE);
+		});
+	});
+})
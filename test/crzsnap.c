@@ -0,0 +1,285 @@
+#include "crzsnap.h"
+#include "crztest.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+#define COUNT 100
+#define KEY_SIZE 16
+
+static HASH_TABLE(size_t) ht = HASH_TABLE_NEW();
+static TableSnapshot snapshot = TABLE_SNAPSHOT_NEW();
+static char path[] = "/tmp/crzsnap-XXXXXX";
+
+static TableSnapshot previous = TABLE_SNAPSHOT_NEW();
+
+// Inserts `count` keys valued `base` more than their index
+static void fill(size_t count, size_t base)
+{
+	char key[32];
+	for (size_t i = 0; i < count; i++) {
+		CRZ_SPRINTF(key, "key-%zu", i);
+		HASH_TABLE_INSERT(&ht, key, base + i);
+	}
+}
+
+// Whether `selfp` holds the first `count` keys valued `base` more than their
+// index
+static CRZ_BOOL holds(TableSnapshot *selfp, size_t count, size_t base)
+{
+	char key[32];
+	for (size_t i = 0; i < count; i++) {
+		CRZ_SPRINTF(key, "key-%zu", i);
+		const size_t *result = TABLE_SNAPSHOT_GET(*selfp, key);
+		if (result == CRZ_NULL || *result != base + i)
+			return CRZ_FALSE;
+	}
+	return CRZ_TRUE;
+}
+
+// Overwrites every slot of the snapshot at `path` with `offset`, as a corrupt
+// file might have
+static void corrupt_slots(uint64_t offset)
+{
+	Crzsnap_Header header;
+	int fd = open(path, O_RDWR);
+	CRZ_ASSERT(fd >= 0 && "Could not open snapshot to corrupt");
+	ssize_t read_size = pread(fd, &header, sizeof(header), 0);
+	CRZ_ASSERT(read_size == sizeof(header) &&
+		   "Could not read snapshot header");
+	(void)read_size;
+	for (uint64_t i = 0; i < header.slot_count; i++) {
+		off_t at = (off_t)(sizeof(header) + i * sizeof(offset));
+		ssize_t written = pwrite(fd, &offset, sizeof(offset), at);
+		CRZ_ASSERT(written == sizeof(offset) &&
+			   "Could not corrupt snapshot slot");
+		(void)written;
+	}
+	close(fd);
+}
+
+static CRZ_BOOL exists(const char *file_path)
+{
+	return access(file_path, F_OK) == 0;
+}
+
+void setup(void)
+{
+	CRZ_MEMCPY(path + sizeof(path) - 7, "XXXXXX", 6);
+	int fd = mkstemp(path);
+	CRZ_ASSERT(fd >= 0 && "Could not create temporary file");
+	close(fd);
+}
+
+void cleanup(void)
+{
+	HASH_TABLE_FREE(&ht);
+	TABLE_SNAPSHOT_CLOSE(&snapshot);
+	TABLE_SNAPSHOT_CLOSE(&previous);
+	unlink(path);
+}
+
+TEST_MAIN({
+	BEFORE_EACH(setup);
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("HASH_TABLE_WRITE_SNAPSHOT", {
+		TEST("Writing and mapping a table keeps every pair", {
+			// Arrange
+			char key[KEY_SIZE];
+			HASH_TABLE_INIT(&ht, 8);
+			for (size_t i = 0; i < COUNT; i++) {
+				CRZ_SPRINTF(key, "key-%zu", i);
+				HASH_TABLE_INSERT(&ht, key, i);
+			}
+
+			// Act
+			CRZ_BOOL written = HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+			HASH_TABLE_FREE(&ht);
+			CRZ_BOOL opened =
+				TABLE_SNAPSHOT_OPEN(&snapshot, path, size_t);
+
+			// Assert
+			EXPECT(written);
+			EXPECT(opened);
+			EXPECT(TABLE_SNAPSHOT_COUNT(snapshot) == COUNT);
+			for (size_t i = 0; i < COUNT; i++) {
+				CRZ_SPRINTF(key, "key-%zu", i);
+				const size_t *result =
+					TABLE_SNAPSHOT_GET(snapshot, key);
+				EXPECTF(result != CRZ_NULL && *result == i,
+					"Missing %s\n", key);
+			}
+		});
+
+		TEST("Writing an empty table", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+
+			// Act
+			HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+			TABLE_SNAPSHOT_OPEN(&snapshot, path, size_t);
+
+			// Assert
+			EXPECT(TABLE_SNAPSHOT_COUNT(snapshot) == 0);
+			EXPECT(TABLE_SNAPSHOT_GET(snapshot, "a") == CRZ_NULL);
+		});
+	});
+
+	DESCRIBE("HASH_TABLE_WRITE_SNAPSHOT replacing a snapshot", {
+		TEST("Keeping a mapped snapshot readable", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, COUNT * 2);
+			fill(COUNT, 0);
+			HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+			TABLE_SNAPSHOT_OPEN(&previous, path, size_t);
+			HASH_TABLE_FREE(&ht);
+			HASH_TABLE_INIT(&ht, 2);
+			fill(1, 1000);
+
+			// Act
+			CRZ_BOOL written = HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+			TABLE_SNAPSHOT_OPEN(&snapshot, path, size_t);
+
+			// Assert
+			EXPECT(written);
+			EXPECT(holds(&previous, COUNT, 0));
+			EXPECT(TABLE_SNAPSHOT_COUNT(snapshot) == 1);
+			EXPECT(holds(&snapshot, 1, 1000));
+		});
+
+		TEST("Leaving no temporary file behind", {
+			// Arrange
+			char tmp_path[sizeof(path) + 4];
+			CRZ_SPRINTF(tmp_path, "%s.tmp", path);
+			HASH_TABLE_INIT(&ht, 2);
+			fill(1, 0);
+
+			// Act
+			HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+
+			// Assert
+			EXPECT(exists(path));
+			EXPECT(!exists(tmp_path));
+		});
+	});
+
+	DESCRIBE("TABLE_SNAPSHOT_OPEN", {
+		TEST("Rejecting a snapshot of a table ignoring case", {
+			// Arrange
+			HASH_TABLE_INIT_ICASE(&ht, 2);
+			HASH_TABLE_INSERT(&ht, "Content-Type", 1);
+			HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+
+			// Act
+			CRZ_BOOL opened =
+				TABLE_SNAPSHOT_OPEN(&snapshot, path, size_t);
+
+			// Assert
+			EXPECT(!opened);
+			EXPECT(snapshot.base == CRZ_NULL);
+		});
+
+		TEST("Mapping a snapshot of a table ignoring case", {
+			// Arrange
+			HASH_TABLE_INIT_ICASE(&ht, 2);
+			HASH_TABLE_INSERT(&ht, "Content-Type", 1);
+			HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+
+			// Act
+			CRZ_BOOL opened = TABLE_SNAPSHOT_OPEN_ICASE(
+				&snapshot, path, size_t);
+			const size_t *result =
+				TABLE_SNAPSHOT_GET(snapshot, "content-TYPE");
+
+			// Assert
+			EXPECT(opened);
+			EXPECT(result != CRZ_NULL && *result == 1);
+		});
+
+		TEST("Rejecting a case-sensitive snapshot as ignoring case", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+			HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+
+			// Act
+			CRZ_BOOL opened = TABLE_SNAPSHOT_OPEN_ICASE(
+				&snapshot, path, size_t);
+
+			// Assert
+			EXPECT(!opened);
+		});
+
+		TEST("Rejecting a snapshot with a different value type", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+			HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+
+			// Act
+			CRZ_BOOL opened =
+				TABLE_SNAPSHOT_OPEN(&snapshot, path, char);
+
+			// Assert
+			EXPECT(!opened);
+			EXPECT(snapshot.base == CRZ_NULL);
+		});
+
+		TEST("Rejecting a file which is not a snapshot", {
+			// Act
+			CRZ_BOOL opened =
+				TABLE_SNAPSHOT_OPEN(&snapshot, path, size_t);
+
+			// Assert
+			EXPECT(!opened);
+		});
+	});
+
+	DESCRIBE("TABLE_SNAPSHOT_GET", {
+		TEST("Returning CRZ_NULL when nonexistent", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+			HASH_TABLE_INSERT(&ht, "a", 1);
+			HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+			TABLE_SNAPSHOT_OPEN(&snapshot, path, size_t);
+
+			// Act
+			const size_t *result = TABLE_SNAPSHOT_GET(snapshot, "b");
+
+			// Assert
+			EXPECT(result == CRZ_NULL);
+		});
+
+		TEST("Ignoring entries outside of a corrupt file", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+			fill(1, 0);
+			HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+			corrupt_slots(1ull << 40);
+			TABLE_SNAPSHOT_OPEN(&snapshot, path, size_t);
+
+			// Act
+			const size_t *result =
+				TABLE_SNAPSHOT_GET(snapshot, "key-0");
+
+			// Assert
+			EXPECT(result == CRZ_NULL);
+		});
+
+		TEST("Stopping on a corrupt file without empty slots", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+			fill(1, 0);
+			HASH_TABLE_WRITE_SNAPSHOT(ht, path);
+			corrupt_slots(sizeof(Crzsnap_Header));
+			TABLE_SNAPSHOT_OPEN(&snapshot, path, size_t);
+
+			// Act
+			const size_t *result =
+				TABLE_SNAPSHOT_GET(snapshot, "missing");
+
+			// Assert
+			EXPECT(result == CRZ_NULL);
+		});
+	});
+})
@@ -0,0 +1,114 @@
+#include "crzsoa.h"
+#include "crztest.h"
+#include <stdint.h>
+
+#define POINT_FIELDS(X) X(char, tag) X(double, x) X(int, id)
+DEFINE_SOA(Points, POINT_FIELDS)
+
+#define COUNT 100
+
+static Points points = SOA_NEW();
+
+void cleanup(void)
+{
+	Points_free(&points);
+}
+
+TEST_MAIN({
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("Points_push", {
+		TEST("Pushing records into every field", {
+			// Act
+			Points_push(&points, (Points_Record){ 'a', 1.5, 1 });
+			Points_push(&points, (Points_Record){ 'b', 2.5, 2 });
+
+			// Assert
+			EXPECT(points.len == 2);
+			EXPECT(points.tag[0] == 'a' && points.tag[1] == 'b');
+			EXPECT(points.x[0] == 1.5 && points.x[1] == 2.5);
+			EXPECT(points.id[0] == 1 && points.id[1] == 2);
+		});
+
+		TEST("Keeping records and alignment while growing", {
+			// Act
+			for (int i = 0; i < COUNT; i++) {
+				Points_push(&points, (Points_Record){
+							     'a' + i % 26, i * 0.5, i });
+			}
+
+			// Assert
+			EXPECT(points.len == COUNT);
+			EXPECT(points.cap >= COUNT);
+			EXPECT((uintptr_t)points.tag % CRZSOA_ALIGNMENT == 0);
+			EXPECT((uintptr_t)points.x % CRZSOA_ALIGNMENT == 0);
+			EXPECT((uintptr_t)points.id % CRZSOA_ALIGNMENT == 0);
+			SOA_FOR(points, i) {
+				Points_Record record = Points_get(&points, i);
+				EXPECTF(record.tag == 'a' + (int)i % 26 &&
+						record.x == (double)i * 0.5 &&
+						record.id == (int)i,
+					"Mismatch at %zu\n", i);
+			}
+		});
+	});
+
+	DESCRIBE("Points_grow_by", {
+		TEST("Reserving space without pushing", {
+			// Act
+			Points_grow_by(&points, COUNT);
+
+			// Assert
+			EXPECT(points.len == 0);
+			EXPECT(points.cap == COUNT);
+		});
+	});
+
+	DESCRIBE("Points_pop", {
+		TEST("Popping the last record", {
+			// Arrange
+			Points_push(&points, (Points_Record){ 'a', 1.5, 1 });
+			Points_push(&points, (Points_Record){ 'b', 2.5, 2 });
+
+			// Act
+			Points_Record record = Points_pop(&points);
+
+			// Assert
+			EXPECT(points.len == 1);
+			EXPECT(record.tag == 'b' && record.id == 2);
+		});
+	});
+
+	DESCRIBE("Points_remove", {
+		TEST("Removing records from the middle", {
+			// Arrange
+			for (int i = 0; i < 5; i++) {
+				Points_push(&points,
+					    (Points_Record){ 'a' + i, i, i });
+			}
+
+			// Act
+			Points_remove(&points, 1, 2);
+
+			// Assert
+			EXPECT(points.len == 3);
+			EXPECT(points.id[0] == 0 && points.id[1] == 3 &&
+			       points.id[2] == 4);
+			EXPECT(points.tag[1] == 'd' && points.x[2] == 4);
+		});
+	});
+
+	DESCRIBE("Points_set", {
+		TEST("Overriding a record", {
+			// Arrange
+			Points_push(&points, (Points_Record){ 'a', 1.5, 1 });
+
+			// Act
+			Points_set(&points, 0, (Points_Record){ 'z', 9, 9 });
+
+			// Assert
+			EXPECT(points.tag[0] == 'z' && points.x[0] == 9 &&
+			       points.id[0] == 9);
+		});
+	});
+})
@@ -0,0 +1,85 @@
+#define CRZ_STATS
+#include "crzarr.h"
+#include "crzhash.h"
+#include "crztest.h"
+
+static ARRAY(int) a = ARRAY_NEW();
+static HASH_TABLE(size_t) ht = HASH_TABLE_NEW();
+
+void reset(void)
+{
+	CRZ_STATS_RESET();
+}
+
+void cleanup(void)
+{
+	ARRAY_FREE(&a);
+	HASH_TABLE_FREE(&ht);
+}
+
+TEST_MAIN({
+	BEFORE_EACH(reset);
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("crzarr", {
+		TEST("Counting allocations and reallocations", {
+			// Arrange + act
+			for (int i = 0; i < CRZARR_MINIMUM_CAPACITY + 1; i++)
+				ARRAY_PUSH(&a, i);
+
+			// Assert
+			EXPECT(crzstats.arr.allocations == 1);
+			EXPECT(crzstats.arr.reallocations == 1);
+			EXPECT(crzstats.arr.bytes_allocated ==
+			       (CRZARR_MINIMUM_CAPACITY * 3) * sizeof(int));
+		});
+
+		TEST("Counting bytes copied by ARRAY_SPLICE", {
+			// Arrange
+			ARRAY_PUSH_MANY(&a, ((int[]){ 1, 2, 3 }), 3);
+			CRZ_STATS_RESET();
+
+			// Act
+			ARRAY_INSERT(&a, 0, ((int[]){ 0 }), 1);
+
+			// Assert
+			EXPECT(crzstats.arr.bytes_copied == 4 * sizeof(int));
+		});
+	});
+
+	DESCRIBE("crzhash", {
+		TEST("Counting resizes", {
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+
+			// Act
+			HASH_TABLE_INSERT(&ht, "a", 1);
+			HASH_TABLE_INSERT(&ht, "b", 2);
+			HASH_TABLE_INSERT(&ht, "c", 3);
+
+			// Assert
+			EXPECT(crzstats.hash.resizes == 1);
+		});
+
+		TEST("Counting probe lengths and collisions", {
+			// Invariant
+			EXPECT(crzhash_djb2("ab") % 2 ==
+			       crzhash_djb2("ba") % 2);
+
+			// Arrange
+			HASH_TABLE_INIT(&ht, 2);
+			HASH_TABLE_INSERT(&ht, "ab", 1);
+			HASH_TABLE_INSERT(&ht, "ba", 2);
+			CRZ_STATS_RESET();
+
+			// Act
+			HASH_TABLE_GET(ht, "ab");
+			HASH_TABLE_GET(ht, "ba");
+
+			// Assert
+			EXPECT(crzstats.hash.probe_lengths[0] == 1);
+			EXPECT(crzstats.hash.probe_lengths[1] == 1);
+			EXPECT(crzstats.hash.collisions == 1);
+		});
+	});
+})
@@ -8,6 +8,22 @@
 static const StringView target = SV_CONSTANT(TARGET, TARGET_LEN);
 
 static StringView sv;
+static char long_text[256];
+static char swapped_text[256];
+
+static void fill_long_text(const char *tail)
+{
+	CRZ_SIZE len = 0;
+	while (len < 100)
+		long_text[len++] = 'a';
+	CRZ_MEMCPY(long_text + len, tail, CRZ_STRLEN(tail) + 1);
+}
+
+static char swap_case(char c)
+{
+	CRZ_BOOL letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+	return letter ? c ^ 0x20 : c;
+}
 
 TEST_MAIN({
 	DESCRIBE("Trimming", {
@@ -116,4 +132,125 @@ TEST_MAIN({
 			});
 		});
 	});
+
+	DESCRIBE("UTF-8", {
+		TEST("SV_UTF8_VALID of valid text", {
+			// Arrange
+			sv = SV_FROM_CSTR("caf\xc3\xa9 \xe2\x82\xac "
+					  "\xf0\x9f\x98\x80");
+
+			// Assert
+			EXPECT(SV_UTF8_VALID(sv));
+			EXPECT(SV_UTF8_VALID(SV_FROM_CSTR("")));
+		});
+
+		TEST("SV_UTF8_VALID of invalid text", {
+			// Arrange
+			const char *too_large = "\xf4\x90\x80\x80";
+
+			// Assert
+			EXPECT(!SV_UTF8_VALID(SV_FROM_CSTR("\x80")));
+			EXPECT(!SV_UTF8_VALID(SV_FROM_CSTR("\xc3")));
+			EXPECT(!SV_UTF8_VALID(SV_FROM_CSTR("\xc0\xaf")));
+			EXPECT(!SV_UTF8_VALID(SV_FROM_CSTR("\xed\xa0\x80")));
+			EXPECT(!SV_UTF8_VALID(SV_FROM_CSTR(too_large)));
+			EXPECT(!SV_UTF8_VALID(SV_FROM_CSTR("\xff")));
+		});
+
+		TEST("SV_UTF8_VALID after a long ASCII prefix", {
+			// Arrange
+			fill_long_text("\xe2\x82\xac");
+			sv = SV_FROM_CSTR(long_text);
+
+			// Act
+			CRZ_BOOL valid = SV_UTF8_VALID(sv);
+			sv.len -= 1;
+			CRZ_BOOL truncated = SV_UTF8_VALID(sv);
+
+			// Assert
+			EXPECT(valid);
+			EXPECT(!truncated);
+		});
+
+		TEST("SV_UTF8_NEXT", {
+			// Arrange
+			sv = SV_FROM_CSTR("a\xc3\xa9\xf0\x9f\x98\x80\xff");
+			uint32_t codepoints[5] = { 0 };
+			CRZ_SIZE count = 0;
+			uint32_t *next = codepoints;
+
+			// Act
+			while (count < 5 && SV_UTF8_NEXT(&sv, next++))
+				count++;
+
+			// Assert
+			EXPECT(count == 4);
+			EXPECT(codepoints[0] == 'a');
+			EXPECT(codepoints[1] == 0xE9);
+			EXPECT(codepoints[2] == 0x1F600);
+			EXPECT(codepoints[3] == CRZSV_UTF8_REPLACEMENT);
+			EXPECT(sv.len == 0);
+		});
+
+		TEST("SV_UTF8_COUNT", {
+			// Arrange
+			fill_long_text("\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80");
+
+			// Assert
+			EXPECT(SV_UTF8_COUNT(SV_FROM_CSTR(long_text)) == 103);
+			EXPECT(SV_UTF8_COUNT(SV_FROM_CSTR("")) == 0);
+		});
+	});
+
+	DESCRIBE("Case-insensitive comparison", {
+		TEST("SV_EQ_ICASE", {
+			// Arrange
+			fill_long_text("Content-Type");
+			StringView text = SV_FROM_CSTR(long_text);
+			for (CRZ_SIZE i = 0; i < text.len; i++)
+				swapped_text[i] = swap_case(long_text[i]);
+			StringView other = SV_FROM_BUF(swapped_text, text.len);
+
+			// Assert
+			EXPECT(SV_EQ_ICASE(text, other));
+			EXPECT(!SV_EQ(text, other));
+			EXPECT(SV_EQ_ICASE(SV_FROM_CSTR("Host"),
+					   SV_FROM_CSTR("hOST")));
+			EXPECT(!SV_EQ_ICASE(SV_FROM_CSTR("Host"),
+					    SV_FROM_CSTR("Hose")));
+			EXPECT(!SV_EQ_ICASE(SV_FROM_CSTR("@[{"),
+					    SV_FROM_CSTR("`{[")));
+			EXPECT(!SV_EQ_ICASE(SV_FROM_CSTR("\xc1"),
+					    SV_FROM_CSTR("\xe1")));
+		});
+
+		TEST("crzsv_lower64 of every byte", {
+			for (int c = 0; c < 256; c++) {
+				// Arrange
+				uint64_t word = (uint64_t)c << 24;
+
+				// Act
+				uint64_t lower = crzsv_lower64(word);
+
+				// Assert
+				unsigned char expected = CRZ_ASCII_LOWER(c);
+				EXPECTF(lower == (uint64_t)expected << 24,
+					"Byte %d\n", c);
+			}
+		});
+
+		TEST("SV_HAS_PREFIX and SV_HAS_SUFFIX", {
+			// Arrange
+			sv = SV_FROM_CSTR("www.Example.COM");
+
+			// Assert
+			EXPECT(SV_HAS_PREFIX(sv, SV_FROM_CSTR("www.")));
+			EXPECT(!SV_HAS_PREFIX(sv, SV_FROM_CSTR("WWW.")));
+			EXPECT(SV_HAS_SUFFIX(sv, SV_FROM_CSTR(".COM")));
+			EXPECT(!SV_HAS_SUFFIX(sv, SV_FROM_CSTR(".com")));
+			EXPECT(SV_HAS_PREFIX_ICASE(sv, SV_FROM_CSTR("WWW.ex")));
+			EXPECT(SV_HAS_SUFFIX_ICASE(sv, SV_FROM_CSTR("e.com")));
+			EXPECT(!SV_HAS_SUFFIX_ICASE(SV_FROM_CSTR("com"), sv));
+		});
+	});
 })
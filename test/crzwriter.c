@@ -0,0 +1,236 @@
+#include "crztest.h"
+#include "crzwriter.h"
+#include <stdlib.h>
+
+#define LINES 2000
+#define BUFFER_SIZE 64
+
+static Writer writer;
+static StringBuilder expected;
+static StringBuilder contents;
+static char path[] = "/tmp/crzwriter-XXXXXX";
+static int fd = -1;
+static int pipe_fds[2];
+
+static const char dots[] = "........................................";
+
+// Pushes numbered lines of varying lengths, keeping a copy in `expected`
+static void push_lines(int count)
+{
+	char line[64];
+	for (int i = 0; i < count; i++) {
+		int len = CRZ_SPRINTF(line, "line %d %.*s\n", i, i % 40, dots);
+		WRITER_PUSH_BUF(&writer, line, (CRZ_SIZE)len);
+		SB_PUSH_BUF(&expected, line, (CRZ_SIZE)len);
+	}
+}
+
+// Reads all of `from` until its end into `contents`
+static void read_all(int from)
+{
+	char chunk[256];
+	ssize_t len;
+	while ((len = read(from, chunk, sizeof(chunk))) > 0)
+		SB_PUSH_BUF(&contents, chunk, (CRZ_SIZE)len);
+}
+
+static void read_file(void)
+{
+	int file = open(path, O_RDONLY);
+	read_all(file);
+	close(file);
+}
+
+// Drains the pipe slowly, so the writer runs out of free buffers
+static void *read_pipe_slowly(void *arg)
+{
+	char chunk[BUFFER_SIZE];
+	ssize_t len;
+	while ((len = read(pipe_fds[0], chunk, sizeof(chunk))) > 0) {
+		SB_PUSH_BUF(&contents, chunk, (CRZ_SIZE)len);
+		usleep(50);
+	}
+	return arg;
+}
+
+// Swaps the ring of the writer, if it uses one, for a file which is not a
+// ring, so that submitting to it fails outright, returning whether it did
+static CRZ_BOOL break_ring(void)
+{
+#ifdef CRZWRITER_IO_URING
+	if (writer.uses_ring) {
+		close(writer.ring.fd);
+		writer.ring.fd = open("/dev/null", O_RDONLY);
+		return CRZ_TRUE;
+	}
+#endif // CRZWRITER_IO_URING
+	return CRZ_FALSE;
+}
+
+static CRZ_BOOL holds_expected(void)
+{
+	return SB_EQ(contents, expected);
+}
+
+void setup(void)
+{
+	expected = (StringBuilder)SB_NEW();
+	contents = (StringBuilder)SB_NEW();
+	CRZ_MEMCPY(path + sizeof(path) - 7, "XXXXXX", 6);
+	fd = mkstemp(path);
+	CRZ_ASSERT(fd >= 0 && "Could not create temporary file");
+}
+
+void cleanup(void)
+{
+	SB_FREE(&expected);
+	SB_FREE(&contents);
+	close(fd);
+	unlink(path);
+}
+
+TEST_MAIN({
+	BEFORE_EACH(setup);
+	AFTER_EACH(cleanup);
+
+	DESCRIBE("WRITER_PUSH_BUF", {
+		TEST("Writing lines to a file in order", {
+			// Arrange
+			WRITER_INIT(&writer, fd, 3, BUFFER_SIZE);
+
+			// Act
+			push_lines(LINES);
+			WRITER_FREE(&writer);
+			read_file();
+
+			// Assert
+			EXPECT(holds_expected());
+		});
+
+		TEST("Writing data larger than a buffer", {
+			// Arrange
+			WRITER_INIT(&writer, fd, 2, BUFFER_SIZE);
+			for (int i = 0; i < BUFFER_SIZE * 10; i++)
+				SB_PUSH_CHAR(&expected, (char)('a' + i % 26));
+
+			// Act
+			WRITER_PUSH_CSTR(&writer, "head ");
+			WRITER_PUSH_SB(&writer, expected);
+			WRITER_FREE(&writer);
+			read_file();
+			SB_INSERT_CSTR(&expected, 0, "head ");
+
+			// Assert
+			EXPECT(holds_expected());
+		});
+
+		TEST("Writing to an append-only file with the flush thread", {
+			// Arrange
+			close(fd);
+			fd = open(path, O_WRONLY | O_APPEND);
+			WRITER_INIT(&writer, fd, 2, BUFFER_SIZE);
+
+			// Act
+			CRZ_BOOL uses_ring = writer.uses_ring;
+			push_lines(LINES);
+			WRITER_FREE(&writer);
+			read_file();
+
+			// Assert
+			EXPECT(!uses_ring);
+			EXPECT(holds_expected());
+		});
+
+		TEST("Holding back pushes to a slow pipe", {
+			// Arrange
+			close(fd);
+			int piped = pipe(pipe_fds);
+			CRZ_ASSERT(piped == 0 && "Could not create pipe");
+			(void)piped;
+			fd = pipe_fds[1];
+			pthread_t reader;
+			pthread_create(&reader, CRZ_NULL, read_pipe_slowly,
+				       CRZ_NULL);
+			WRITER_INIT(&writer, fd, 2, BUFFER_SIZE);
+
+			// Act
+			push_lines(LINES);
+			CRZ_SIZE stalls = writer.stalls;
+			WRITER_FREE(&writer);
+			close(fd);
+			fd = -1;
+			pthread_join(reader, CRZ_NULL);
+			close(pipe_fds[0]);
+
+			// Assert
+			EXPECT(stalls > 0);
+			EXPECT(holds_expected());
+		});
+	});
+
+	DESCRIBE("WRITER_FLUSH", {
+		TEST("Flushing writes the active buffer", {
+			// Arrange
+			WRITER_INIT(&writer, fd, 2, BUFFER_SIZE);
+
+			// Act
+			WRITER_PUSH_CSTR(&writer, "partial");
+			CRZ_BOOL flushed = WRITER_FLUSH(&writer);
+			read_file();
+			WRITER_FREE(&writer);
+
+			// Assert
+			EXPECT(flushed);
+			EXPECT(contents.len == 7);
+		});
+
+		TEST("Leaving the file positioned after the written data", {
+			// Arrange
+			WRITER_INIT(&writer, fd, 2, BUFFER_SIZE);
+
+			// Act
+			push_lines(100);
+			WRITER_FREE(&writer);
+			ssize_t tail = write(fd, "tail\n", 5);
+			SB_PUSH_CSTR(&expected, "tail\n");
+			read_file();
+
+			// Assert
+			EXPECT(tail == 5);
+			EXPECT(holds_expected());
+		});
+
+		TEST("Reporting the first failed write", {
+			// Arrange
+			close(fd);
+			fd = open(path, O_RDONLY);
+			WRITER_INIT(&writer, fd, 2, BUFFER_SIZE);
+
+			// Act
+			push_lines(10);
+			CRZ_BOOL flushed = WRITER_FLUSH(&writer);
+			int error = WRITER_ERROR(writer);
+			WRITER_FREE(&writer);
+
+			// Assert
+			EXPECT(!flushed);
+			EXPECT(error == EBADF);
+		});
+
+		TEST("Reporting a write the ring does not take", {
+			// Arrange
+			WRITER_INIT(&writer, fd, 2, BUFFER_SIZE);
+			CRZ_BOOL broken = break_ring();
+
+			// Act
+			WRITER_PUSH_CSTR(&writer, "lost");
+			CRZ_BOOL flushed = WRITER_FLUSH(&writer);
+			int error = WRITER_ERROR(writer);
+			WRITER_FREE(&writer);
+
+			// Assert
+			EXPECT(!broken || !flushed);
+			EXPECT(!broken || error != 0);
+		});
+	});
+})